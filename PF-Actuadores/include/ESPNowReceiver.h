@@ -4,15 +4,64 @@
 #include <WiFi.h>
 #include <esp_now.h>
 #include <esp_wifi.h>
-#include "dataActuator.h"  // Usamos la estructura para estados de actuadores
+#include "dataActuator.h"  // Usamos las tramas canal/valor de actuadores
 
+// Recibe ActuatorCommand del Edge (lista canal/valor) y responde con un
+// ActuatorAck con el valor realmente aplicado en cada canal del comando.
+// Una retransmisión (misma secuencia) solo se vuelve a confirmar, y los
+// canales cuyo valor no cambia no llaman al callback ni escriben por Serial.
 class ESPNowActuatorReceiver {
 private:
     uint8_t _channel;
-    void (*_onReceiveCallback)(const ActuatorState&);  // Callback con estructura ActuatorState
+    uint8_t (*_onChannelCallback)(uint8_t channel, uint8_t value);  // Devuelve el valor aplicado
+    void (*_onOtherFrameCallback)(const uint8_t* mac, const uint8_t* data, int len) = nullptr;
+    uint16_t _lastSeq = 0;
+    bool _hasLastSeq = false;
+    ActuatorAck _lastAck;
+    uint8_t _applied[ACTUATOR_MAX_CHANNELS] = {0};
+    bool _known[ACTUATOR_MAX_CHANNELS] = {false};
+
+    void sendAck(const uint8_t* mac) {
+        sendFrame(mac, (const uint8_t *)&_lastAck, _lastAck.frameLength());
+    }
+
+    void apply(const ActuatorCommand& cmd) {
+        _lastAck.seq = cmd.seq;
+        _lastAck.count = 0;
+        for (uint8_t k = 0; k < cmd.count; k++) {
+            uint8_t id = cmd.values[k].channel;
+            if (id >= ACTUATOR_MAX_CHANNELS) continue;
+
+            // Mismo valor que el aplicado: nada que hacer en los pines
+            bool unchanged = _known[id] && _applied[id] == cmd.values[k].value;
+            if (!unchanged && _onChannelCallback) {
+                _applied[id] = _onChannelCallback(id, cmd.values[k].value);
+                _known[id] = true;
+            }
+            _lastAck.values[_lastAck.count].channel = id;
+            _lastAck.values[_lastAck.count].value = _applied[id];
+            _lastAck.count++;
+        }
+    }
 
 public:
-    ESPNowActuatorReceiver(uint8_t channel = 1) : _channel(channel), _onReceiveCallback(nullptr) {}
+    ESPNowActuatorReceiver(uint8_t channel = 1) : _channel(channel), _onChannelCallback(nullptr) {}
+
+    // Trama propia hacia `mac` (el Edge), dándolo de alta como peer si hace falta
+    bool sendFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        if (!esp_now_is_peer_exist(mac)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, mac, 6);
+            peerInfo.channel = 0;  // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            if (esp_now_add_peer(&peerInfo) != ESP_OK) return false;
+        }
+        return esp_now_send(mac, data, len) == ESP_OK;
+    }
+
+    // Canal guardado en NVS; antes de begin()
+    void setChannel(uint8_t channel) { _channel = channel; }
 
     void begin() {
         WiFi.mode(WIFI_STA);
@@ -24,18 +73,21 @@ public:
         }
 
         esp_now_register_recv_cb([](const uint8_t *mac, const uint8_t *incomingDataRaw, int len) {
-            ActuatorState state;
-            memcpy(&state, incomingDataRaw, sizeof(ActuatorState));
-            
-            Serial.println("📥 Estado de actuadores recibido:");
-            Serial.print("💧 Bomba: "); Serial.print(state.waterPump ? "ON" : "OFF");
-            Serial.print(" | 🌬️ Ventilador: "); Serial.print(state.fan ? "ON" : "OFF");
-            Serial.print(" | 💡 LEDs: "); Serial.println(state.leds ? "ON" : "OFF");
-
-            // Llama al callback si está definido
-            if (_instance && _instance->_onReceiveCallback) {
-                _instance->_onReceiveCallback(state);
+            if (!_instance) return;
+
+            ActuatorCommand cmd;
+            if (!decodeChannelFrame(incomingDataRaw, len, ACTUATOR_FRAME_CMD, cmd)) {
+                if (_instance->_onOtherFrameCallback) _instance->_onOtherFrameCallback(mac, incomingDataRaw, len);
+                return;
             }
+
+            // Retransmisión: el ACK anterior se perdió, basta con repetirlo
+            if (!_instance->_hasLastSeq || cmd.seq != _instance->_lastSeq) {
+                _instance->apply(cmd);
+                _instance->_lastSeq = cmd.seq;
+                _instance->_hasLastSeq = true;
+            }
+            _instance->sendAck(mac);
         });
 
         _instance = this;
@@ -43,9 +95,14 @@ public:
         Serial.println("✅ ESP-NOW Receptor de actuadores listo");
     }
 
-    // Registrar callback personalizado
-    void onReceive(void (*callback)(const ActuatorState&)) {
-        _onReceiveCallback = callback;
+    // Registrar callback por canal; debe devolver el valor aplicado (leído del pin)
+    void onChannel(uint8_t (*callback)(uint8_t channel, uint8_t value)) {
+        _onChannelCallback = callback;
+    }
+
+    // Tramas que no son comandos (balizas del Edge)
+    void onOtherFrame(void (*callback)(const uint8_t* mac, const uint8_t* data, int len)) {
+        _onOtherFrameCallback = callback;
     }
 
 private:
@@ -2,27 +2,38 @@
 #define LED_RGB_H
 
 #include <Arduino.h>
+#include "PwmOutput.h"
 
+// Tira LED regulable (PWM a 5 kHz, rampa de 800 ms de apagado a máximo)
 class LedRGB {
   private:
-    int pin;
+    PwmOutput pwm;
 
   public:
-    LedRGB(int pin) {
-      this->pin = pin;
-    }
+    LedRGB(int pin, uint8_t ledcChannel) : pwm(pin, ledcChannel, 5000, 800) {}
 
     void begin() {
-      pinMode(pin, OUTPUT);
-      digitalWrite(pin, LOW);
+      pwm.begin();
     }
 
     void on() {
-      digitalWrite(pin, HIGH);
+      pwm.setDuty(255);
     }
 
     void off() {
-      digitalWrite(pin, LOW);
+      pwm.setDuty(0);
+    }
+
+    void setLevel(uint8_t level) {
+      pwm.setDuty(level);
+    }
+
+    uint8_t getLevel() const {
+      return pwm.getDuty();
+    }
+
+    bool isOn() const {
+      return pwm.getDuty() > 0;
     }
 };
 
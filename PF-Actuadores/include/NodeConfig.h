@@ -0,0 +1,56 @@
+#ifndef NODE_CONFIG_H
+#define NODE_CONFIG_H
+
+#include <Arduino.h>
+#include "ConfigBlob.h"
+
+// Configuración persistente del nodo actuador (NVS). Solo se añaden campos
+// al final; al cambiar el esquema se sube VERSION (ver ConfigBlob).
+struct NodeConfigData {
+    // v1
+    uint8_t channel;     // canal ESP-NOW (el del WiFi del Edge)
+};
+
+// Se edita por la consola serie (115200):
+//   mostrar | canal <1-14> | guardar
+// El canal se aplica al reiniciar (normalmente lo aprende solo, de la
+// baliza del Edge).
+class NodeConfig {
+public:
+    static constexpr uint16_t VERSION = 1;
+
+    NodeConfig() : _blob("nodo", VERSION) {}
+
+    void begin(const NodeConfigData& defaults) {
+        memcpy(&_data, &defaults, sizeof(_data));
+        uint16_t version = _blob.load(_data);
+        if (version > 0) Serial.println("💾 Configuración cargada de NVS (v" + String(version) + ")");
+    }
+
+    NodeConfigData& get() { return _data; }
+
+    bool save() { return _blob.save(_data); }
+
+    // Devuelve la respuesta para la consola
+    String handleCommand(String line) {
+        line.trim();
+        int space = line.indexOf(' ');
+        String name = space > 0 ? line.substring(0, space) : line;
+        String value = space > 0 ? line.substring(space + 1) : String();
+        value.trim();
+
+        if (name == "mostrar") return "canal=" + String(_data.channel);
+        if (name == "guardar") return save() ? "💾 Guardado." : "⚠️ No se pudo escribir en NVS.";
+        if (name == "canal" && value.toInt() >= 1 && value.toInt() <= 14) {
+            _data.channel = (uint8_t)value.toInt();
+            return "✅ Canal " + value + " (al reiniciar; usa guardar).";
+        }
+        return "⚠️ Comandos: mostrar | canal <1-14> | guardar";
+    }
+
+private:
+    ConfigBlob<NodeConfigData> _blob;
+    NodeConfigData _data;
+};
+
+#endif
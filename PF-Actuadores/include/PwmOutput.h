@@ -0,0 +1,65 @@
+#ifndef PWM_OUTPUT_H
+#define PWM_OUTPUT_H
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+
+// Salida PWM por LEDC con arranque suave: los cambios de ciclo de trabajo
+// se hacen con el fade por hardware del LEDC, en un tiempo proporcional al
+// salto (rampMs para 0 -> 255), así no hay picos de corriente al encender.
+//
+// En el core Arduino los canales LEDC 0-7 son de alta velocidad y cada par
+// (0-1, 2-3, ...) comparte temporizador: dos salidas con frecuencias
+// distintas deben ir en pares distintos.
+class PwmOutput {
+  private:
+    int pin;
+    uint8_t channel;
+    uint32_t frequency;
+    uint16_t rampMs;
+    uint8_t duty = 0;
+
+    static bool fadeInstalled;
+
+    ledc_mode_t speedMode() const { return (ledc_mode_t)(channel / 8); }
+    ledc_channel_t ledcChannel() const { return (ledc_channel_t)(channel % 8); }
+
+  public:
+    PwmOutput(int pin, uint8_t channel, uint32_t frequency, uint16_t rampMs) {
+      this->pin = pin;
+      this->channel = channel;
+      this->frequency = frequency;
+      this->rampMs = rampMs;
+    }
+
+    void begin() {
+      ledcSetup(channel, frequency, 8);   // resolución de 8 bits: 0-255
+      ledcAttachPin(pin, channel);
+      ledcWrite(channel, 0);
+      if (!fadeInstalled) {
+        ledc_fade_func_install(0);
+        fadeInstalled = true;
+      }
+    }
+
+    void setDuty(uint8_t target) {
+      if (target == duty) return;
+      uint32_t ms = (uint32_t)rampMs * abs((int)target - (int)duty) / 255;
+      if (ms == 0) {
+        ledcWrite(channel, target);
+      } else {
+        ledc_set_fade_with_time(speedMode(), ledcChannel(), target, ms);
+        ledc_fade_start(speedMode(), ledcChannel(), LEDC_FADE_NO_WAIT);
+      }
+      duty = target;
+    }
+
+    // Ciclo de trabajo objetivo (la rampa puede no haber terminado)
+    uint8_t getDuty() const {
+      return duty;
+    }
+};
+
+bool PwmOutput::fadeInstalled = false;
+
+#endif
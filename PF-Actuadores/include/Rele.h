@@ -20,6 +20,11 @@ public:
     void setState(bool activo) {
         digitalWrite(pin, activo ? HIGH : LOW); // Prueba lógica activa alta
     }
+
+    // Lee el nivel real del pin de salida
+    bool getState() {
+        return digitalRead(pin) == HIGH;
+    }
 };
 
 #endif
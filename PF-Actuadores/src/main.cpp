@@ -2,6 +2,14 @@
 #include "ESPNowReceiver.h"
 #include "Rele.h"
 #include "LedRGB.h"
+#include "PwmOutput.h"
+#include "NodeConfig.h"
+#include "PairingClient.h"
+#include "OtaUpdater.h"
+#include "LinkPowerClient.h"
+
+// Versión de este firmware (la que se da a /ota en el Edge)
+#define FIRMWARE_VERSION "1.0"
 
 // Pines definidos (ajusta según tu circuito)
 #define PIN_BOMBA      25
@@ -12,40 +20,68 @@
 #define PIN_LED_4      32
 
 // Instancia del receptor
-ESPNowActuatorReceiver receiver(1);  // Canal 1
+#define CHANNEL 1  // valor de fábrica; si hay configuración en NVS, manda esa
+ESPNowActuatorReceiver receiver(CHANNEL);
+NodeConfig config;
+PairingClient pairing;  // sigue al Edge si cambia de canal
+OtaUpdater ota(OTA_KIND_ACTUATOR, FIRMWARE_VERSION);  // firmware nuevo desde el Edge (/ota)
+LinkPowerClient txPower;  // potencia según el enlace medido por el Edge
 
-// Actuadores
+// Actuadores. El ventilador va por PWM (driver MOSFET, 25 kHz, rampa de
+// 2 s); la bomba sigue en relé, que solo admite ON/OFF.
+// Canales LEDC: ventilador 0 (temporizador propio), LEDs 2-5.
 Rele bomba(PIN_BOMBA);
-Rele ventilador(PIN_VENTILADOR);
-LedRGB led1(PIN_LED_1);
-LedRGB led2(PIN_LED_2);
-LedRGB led3(PIN_LED_3);
-LedRGB led4(PIN_LED_4);
-
-// Función para activar o desactivar los LEDs
-void setAllLeds(bool state) {
-    if (state) {
-        led1.on(); led2.on(); led3.on(); led4.on();
-    } else {
-        led1.off(); led2.off(); led3.off(); led4.off();
-    }
-}
+PwmOutput ventilador(PIN_VENTILADOR, 0, 25000, 2000);
+LedRGB led1(PIN_LED_1, 2);
+LedRGB led2(PIN_LED_2, 3);
+LedRGB led3(PIN_LED_3, 4);
+LedRGB led4(PIN_LED_4, 5);
+
+// Tabla de canales del nodo: el id es el índice que usa el Edge en sus
+// comandos (debe coincidir con setupActuatorTable() de PF-Edge)
+struct OutputChannel {
+    ActuatorChannel desc;
+    Rele* rele;
+    PwmOutput* pwm;
+    LedRGB* led;
+};
 
-// Callback personalizado al recibir datos
-void onActuatorStateReceived(const ActuatorState& state) {
-    Serial.println("🔄 Callback ejecutado con datos recibidos:");
-    Serial.print("💧 Bomba: "); Serial.println(state.waterPump ? "Encendida" : "Apagada");
-    Serial.print("🌬️ Ventilador: "); Serial.println(state.fan ? "Encendido" : "Apagado");
-    Serial.print("💡 LEDs: "); Serial.println(state.leds ? "Encendidos" : "Apagados");
+OutputChannel channels[] = {
+    {{0, CHANNEL_RELAY, 0, ROLE_PUMP}, &bomba, nullptr, nullptr},
+    {{1, CHANNEL_PWM, 0, ROLE_FAN}, nullptr, &ventilador, nullptr},
+    {{2, CHANNEL_LED, 0, ROLE_LIGHT}, nullptr, nullptr, &led1},
+    {{3, CHANNEL_LED, 0, ROLE_LIGHT}, nullptr, nullptr, &led2},
+    {{4, CHANNEL_LED, 0, ROLE_LIGHT}, nullptr, nullptr, &led3},
+    {{5, CHANNEL_LED, 0, ROLE_LIGHT}, nullptr, nullptr, &led4},
+};
 
-    bomba.setState(state.waterPump);
-    ventilador.setState(state.fan);
-    setAllLeds(state.leds);
+// Callback por canal; devuelve el valor aplicado (relé leído del pin,
+// PWM el ciclo de trabajo hacia el que va la rampa)
+uint8_t onChannelReceived(uint8_t id, uint8_t value) {
+    for (OutputChannel& c : channels) {
+        if (c.desc.id != id) continue;
+
+        Serial.print("🔄 Canal "); Serial.print(id);
+        Serial.print(": "); Serial.println(value);
+
+        if (c.rele) {
+            c.rele->setState(value != 0);
+            return c.rele->getState() ? ACTUATOR_VALUE_ON : 0;
+        }
+        if (c.pwm) {
+            c.pwm->setDuty(value);
+            return c.pwm->getDuty();
+        }
+        c.led->setLevel(value);
+        return c.led->getLevel();
+    }
+    return 0;  // canal no existente en este nodo
 }
 
 void setup() {
     Serial.begin(115200);
     delay(1000);
+    ota.begin();  // vuelve a la versión anterior si la nueva no se confirma
 
     // Inicializar actuadores
     bomba.begin();
@@ -55,13 +91,47 @@ void setup() {
     led3.begin();
     led4.begin();
 
+    NodeConfigData defaults = {};
+    defaults.channel = CHANNEL;
+    config.begin(defaults);
+
     // Inicializar receptor y registrar callback
+    receiver.setChannel(config.get().channel);
     receiver.begin();
-    receiver.onReceive(onActuatorStateReceived);
+    receiver.onChannel(onChannelReceived);
+
+    // Emparejamiento por baliza: los ACK van a la MAC de origen de cada
+    // comando, así que del Edge solo interesa el canal
+    const uint8_t unknownEdge[6] = {0};
+    pairing.begin(config.get().channel, unknownEdge);
+    receiver.onOtherFrame([](const uint8_t* mac, const uint8_t* data, int len) {
+        if (pairing.handleFrame(mac, data, len) || ota.handleFrame(mac, data, len)) return;
+        txPower.handleFrame(mac, data, len);
+    });
+    pairing.onPaired([](const uint8_t* mac, uint8_t channel) {
+        config.get().channel = channel;
+        config.save();  // solo escribe si cambió
+    });
 
     Serial.println("🔌 Sistema receptor listo.");
 }
 
 void loop() {
-    delay(1000);  // Esperar datos sin saturar el puerto serie
+    pairing.update();
+
+    // Consola de configuración (ver NodeConfig)
+    if (Serial.available()) {
+        String line = Serial.readStringUntil('\n');
+        Serial.println(config.handleCommand(line));
+    }
+
+    // Potencia de emisión: baja si sobra margen, sube si hay pérdidas
+    LinkStatus linkStatus;
+    if (txPower.update(pairing.getEdgeMac(), true, linkStatus)) {
+        receiver.sendFrame(pairing.getEdgeMac(), (const uint8_t*)&linkStatus, sizeof(linkStatus));
+    }
+
+    // Actualización de firmware: la confirma en cuanto vuelve a oír al Edge
+    ota.update(pairing.isPaired(), pairing.getEdgeMac());
+    delay(ota.busy() ? 2 : 100);  // durante la transferencia, al ritmo del Edge
 }
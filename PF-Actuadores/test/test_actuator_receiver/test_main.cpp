@@ -0,0 +1,120 @@
+// Recepción de comandos en el nodo actuador (ESPNowReceiver.h): ACK con
+// los valores aplicados, retransmisiones (misma secuencia) que solo se
+// vuelven a confirmar, canales sin cambio que no se reescriben y tramas que
+// no son comandos. Los comandos entran por el aire simulado del host
+// (HostRadio) y los ACK se recogen en el Edge.
+//   pio test -e native -f test_actuator_receiver
+#include <unity.h>
+#include <vector>
+#include "ESPNowReceiver.h"
+
+static const uint8_t EDGE[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xEE};
+
+static std::mutex ackMutex;
+static std::vector<ActuatorAck> acks;
+static ESPNowActuatorReceiver receiver;
+static uint8_t pins[ACTUATOR_MAX_CHANNELS];
+static int writes = 0;
+static int otherFrames = 0;
+
+// El canal 2 es PWM de 8 niveles: el pin lee el nivel cuantizado
+static uint8_t writePin(uint8_t channel, uint8_t value) {
+    writes++;
+    pins[channel] = channel == 2 ? value & 0xE0 : value;
+    return pins[channel];
+}
+
+// Los ACK van por el hilo del aire: espera a que haya `count` (o un tiempo máximo)
+static std::vector<ActuatorAck> waitFor(size_t count) {
+    std::vector<ActuatorAck> out;
+    for (int i = 0; i < 100; i++) {
+        delay(5);
+        std::lock_guard<std::mutex> lock(ackMutex);
+        out = acks;
+        if (out.size() >= count) break;
+    }
+    return out;
+}
+
+static void command(uint16_t seq, std::initializer_list<ChannelValue> values) {
+    ActuatorCommand cmd;
+    cmd.seq = seq;
+    for (const ChannelValue& v : values) cmd.values[cmd.count++] = v;
+    HostRadio::inject(EDGE, (const uint8_t*)&cmd, cmd.frameLength());
+}
+
+void setUp() {
+    delay(20);   // lo que quede en el aire de la prueba anterior
+    std::lock_guard<std::mutex> lock(ackMutex);
+    acks.clear();
+    writes = 0;
+}
+
+void tearDown() {}
+
+void test_command_is_applied_and_acked() {
+    command(100, {{0, 255}, {2, 100}});
+    std::vector<ActuatorAck> got = waitFor(1);
+    TEST_ASSERT_EQUAL_UINT(1, got.size());
+    TEST_ASSERT_EQUAL_UINT16(100, got[0].seq);
+    TEST_ASSERT_EQUAL_UINT8(2, got[0].count);
+    TEST_ASSERT_EQUAL_UINT8(0, got[0].values[0].channel);
+    TEST_ASSERT_EQUAL_UINT8(255, got[0].values[0].value);
+    // El ACK lleva lo que lee el pin, no lo pedido
+    TEST_ASSERT_EQUAL_UINT8(96, got[0].values[1].value);
+    TEST_ASSERT_EQUAL_INT(2, writes);
+}
+
+void test_duplicate_seq_is_only_reacked() {
+    command(200, {{1, 255}});
+    command(200, {{1, 0}});   // misma secuencia: retransmisión, no se mira el contenido
+    std::vector<ActuatorAck> got = waitFor(2);
+    TEST_ASSERT_EQUAL_UINT(2, got.size());
+    TEST_ASSERT_EQUAL_UINT16(200, got[1].seq);
+    TEST_ASSERT_EQUAL_UINT8(255, got[1].values[0].value);
+    TEST_ASSERT_EQUAL_UINT8(255, pins[1]);
+    TEST_ASSERT_EQUAL_INT(1, writes);
+}
+
+void test_unchanged_channel_is_not_rewritten() {
+    command(300, {{3, 255}});
+    command(301, {{3, 255}, {4, 255}});
+    std::vector<ActuatorAck> got = waitFor(2);
+    TEST_ASSERT_EQUAL_UINT(2, got.size());
+    TEST_ASSERT_EQUAL_UINT8(2, got[1].count);
+    TEST_ASSERT_EQUAL_UINT8(255, got[1].values[0].value);
+    TEST_ASSERT_EQUAL_INT(2, writes);   // el canal 3 solo una vez
+}
+
+void test_other_frames_go_to_callback() {
+    uint8_t beacon[] = {0xB1, 6};
+    HostRadio::inject(EDGE, beacon, sizeof(beacon));
+    ActuatorCommand bad;
+    bad.count = 2;   // dice 2 canales y no los trae
+    HostRadio::inject(EDGE, (const uint8_t*)&bad, 4);
+    TEST_ASSERT_EQUAL_INT(2, otherFrames);
+    TEST_ASSERT_EQUAL_UINT(0, waitFor(1).size());
+    TEST_ASSERT_EQUAL_INT(0, writes);
+}
+
+int main() {
+    HostRadio::attach(EDGE, [](const uint8_t*, const uint8_t* data, int len) {
+        ActuatorAck ack;
+        if (!decodeChannelFrame(data, len, ACTUATOR_FRAME_ACK, ack)) return;
+        std::lock_guard<std::mutex> lock(ackMutex);
+        acks.push_back(ack);
+    });
+    receiver.begin();
+    receiver.onChannel(writePin);
+    receiver.onOtherFrame([](const uint8_t*, const uint8_t*, int) { otherFrames++; });
+
+    UNITY_BEGIN();
+    RUN_TEST(test_command_is_applied_and_acked);
+    RUN_TEST(test_duplicate_seq_is_only_reacked);
+    RUN_TEST(test_unchanged_channel_is_not_rewritten);
+    RUN_TEST(test_other_frames_go_to_callback);
+    int failures = UNITY_END();
+    fflush(stdout);
+    // El hilo del aire no termina: salir sin destructores
+    std::_Exit(failures);
+}
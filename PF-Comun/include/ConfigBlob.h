@@ -0,0 +1,97 @@
+#ifndef CONFIG_BLOB_H
+#define CONFIG_BLOB_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// Bloque de configuración en NVS: cabecera (magia, versión de esquema,
+// tamaño y CRC32 del contenido) seguida del struct T tal cual.
+//
+// Migración: los campos nuevos se añaden siempre al final de T. Al cargar
+// un bloque de una versión anterior (más corto) se copian sus bytes sobre
+// los valores por defecto y los campos nuevos conservan el defecto; para
+// cambios incompatibles, el llamador recibe la versión leída y corrige.
+//
+// save() no escribe si el contenido no cambió desde la última escritura
+// (mismo CRC), para no gastar la flash.
+template <typename T>
+class ConfigBlob {
+public:
+    static constexpr uint32_t MAGIC = 0x46435656;   // "VVCF"
+    static constexpr size_t MAX_SIZE = 2048;         // bloque más grande que se acepta al cargar
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t size;
+        uint32_t crc;
+    };
+
+    ConfigBlob(const char* nvsNamespace, uint16_t version) : _namespace(nvsNamespace), _version(version) {}
+
+    // Carga sobre `value` (que llega con los valores por defecto). Devuelve
+    // la versión leída, o 0 si no había bloque válido.
+    uint16_t load(T& value) {
+        Preferences prefs;
+        if (!prefs.begin(_namespace, true)) return 0;
+        size_t len = prefs.getBytesLength("cfg");
+        static_assert(sizeof(T) <= MAX_SIZE, "ConfigBlob: T no cabe en MAX_SIZE");
+        uint8_t buf[sizeof(Header) + MAX_SIZE];
+        if (len < sizeof(Header) || len > sizeof(buf)) {
+            prefs.end();
+            return 0;
+        }
+        prefs.getBytes("cfg", buf, len);
+        prefs.end();
+
+        Header h;
+        memcpy(&h, buf, sizeof(h));
+        if (h.magic != MAGIC || h.size != len - sizeof(Header) || crc32(buf + sizeof(Header), h.size) != h.crc) {
+            Serial.println("⚠️ Configuración en NVS no válida, se usan valores por defecto");
+            return 0;
+        }
+
+        memcpy(&value, buf + sizeof(Header), h.size < sizeof(T) ? h.size : sizeof(T));
+        _savedCrc = h.version == _version && h.size == sizeof(T) ? h.crc : 0;
+        return h.version;
+    }
+
+    bool save(const T& value) {
+        uint32_t crc = crc32((const uint8_t*)&value, sizeof(T));
+        if (crc == _savedCrc) return true;
+
+        uint8_t buf[sizeof(Header) + sizeof(T)];
+        Header h = {MAGIC, _version, (uint16_t)sizeof(T), crc};
+        memcpy(buf, &h, sizeof(h));
+        memcpy(buf + sizeof(h), &value, sizeof(T));
+
+        Preferences prefs;
+        if (!prefs.begin(_namespace, false)) return false;
+        bool ok = prefs.putBytes("cfg", buf, sizeof(buf)) == sizeof(buf);
+        prefs.end();
+        if (ok) {
+            _savedCrc = crc;
+            _writes++;
+        }
+        return ok;
+    }
+
+    unsigned long writes() const { return _writes; }
+
+    static uint32_t crc32(const uint8_t* data, size_t len) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+        return ~crc;
+    }
+
+private:
+    const char* _namespace;
+    uint16_t _version;
+    uint32_t _savedCrc = 0;
+    unsigned long _writes = 0;
+};
+
+#endif
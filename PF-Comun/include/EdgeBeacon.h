@@ -0,0 +1,101 @@
+#ifndef EDGE_BEACON_H
+#define EDGE_BEACON_H
+
+#include <cstdint>
+#include <cstring>
+
+// Baliza de emparejamiento: el Edge la difunde (broadcast) con el canal
+// WiFi en el que está. Los nodos la usan para aprender la MAC del Edge
+// (origen de la trama) y su canal, y para volver a encontrarlo si el AP
+// cambia de canal. Sale cada BEACON_FAST_PERIOD_MS durante
+// BEACON_FAST_WINDOW_MS tras arrancar, cambiar de canal o recibir una
+// petición de emparejamiento (PairingRequest), y cada BEACON_PERIOD_MS el
+// resto del tiempo. Lo usan los tres proyectos.
+#define PAIRING_FRAME_BEACON 0xB1
+#define BEACON_PERIOD_MS 2000
+#define BEACON_FAST_PERIOD_MS 250
+#define BEACON_FAST_WINDOW_MS 10000
+
+#pragma pack(push, 1)
+struct EdgeBeacon {
+    uint8_t type = PAIRING_FRAME_BEACON;
+    uint8_t version = 1;
+    uint8_t channel = 0;     // canal actual del Edge (el del AP)
+    uint16_t seq = 0;
+};
+#pragma pack(pop)
+
+// Base de tiempo del Edge: cada TIME_SYNC_PERIOD_MS, también por
+// broadcast, su millis() en el momento de enviar. Los nodos sensores
+// estiman con ella su desfase y deriva respecto al Edge y sellan con esa
+// base la salida de cada trama (RelayHeader::sentMs).
+#define PAIRING_FRAME_TIME 0xB2
+#define TIME_SYNC_PERIOD_MS 5000
+
+#pragma pack(push, 1)
+struct EdgeTimeSync {
+    uint8_t type = PAIRING_FRAME_TIME;
+    uint8_t version = 1;
+    uint16_t seq = 0;
+    uint32_t edgeMs = 0;
+};
+#pragma pack(pop)
+
+// Baliza repetida por un nodo sensor en modo relevo (SensorRelay.h) para
+// los nodos que no oyen al Edge: su canal y MAC, a cuántos saltos está el
+// relevo y quién es su padre (para no elegir como padre a un hijo propio).
+// Sirve para emparejarse igual que la del Edge.
+#define PAIRING_FRAME_RELAY 0xB3
+#define RELAY_BEACON_PERIOD_MS 1000
+#define RELAY_MAX_HOPS 4
+
+#pragma pack(push, 1)
+struct RelayBeacon {
+    uint8_t type = PAIRING_FRAME_RELAY;
+    uint8_t version = 1;
+    uint8_t channel = 0;
+    uint8_t hops = 0;          // saltos del relevo al Edge (1: lo oye directamente)
+    uint8_t edgeMac[6] = {0};
+    uint8_t parent[6] = {0};
+};
+#pragma pack(pop)
+
+// Petición de emparejamiento: la difunde un nodo al arrancar y en cada
+// canal mientras busca al Edge; el Edge (o un relevo) responde con su
+// baliza sin esperar al periodo lento.
+#define PAIRING_FRAME_REQUEST 0xB4
+
+#pragma pack(push, 1)
+struct PairingRequest {
+    uint8_t type = PAIRING_FRAME_REQUEST;
+    uint8_t version = 1;
+};
+#pragma pack(pop)
+
+static const uint8_t BEACON_BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+inline bool decodeBeacon(const uint8_t* data, int len, EdgeBeacon& out) {
+    if (len != (int)sizeof(EdgeBeacon) || data[0] != PAIRING_FRAME_BEACON) return false;
+    memcpy(&out, data, sizeof(EdgeBeacon));
+    return out.channel >= 1 && out.channel <= 14;
+}
+
+inline bool decodeRelayBeacon(const uint8_t* data, int len, RelayBeacon& out) {
+    if (len != (int)sizeof(RelayBeacon) || data[0] != PAIRING_FRAME_RELAY) return false;
+    memcpy(&out, data, sizeof(RelayBeacon));
+    return out.channel >= 1 && out.channel <= 14 && out.hops >= 1 && out.hops < RELAY_MAX_HOPS;
+}
+
+inline bool decodePairingRequest(const uint8_t* data, int len, PairingRequest& out) {
+    if (len != (int)sizeof(PairingRequest) || data[0] != PAIRING_FRAME_REQUEST) return false;
+    memcpy(&out, data, sizeof(PairingRequest));
+    return true;
+}
+
+inline bool decodeTimeSync(const uint8_t* data, int len, EdgeTimeSync& out) {
+    if (len != (int)sizeof(EdgeTimeSync) || data[0] != PAIRING_FRAME_TIME) return false;
+    memcpy(&out, data, sizeof(EdgeTimeSync));
+    return true;
+}
+
+#endif
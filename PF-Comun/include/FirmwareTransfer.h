@@ -0,0 +1,292 @@
+#ifndef FIRMWARE_TRANSFER_H
+#define FIRMWARE_TRANSFER_H
+
+#include <cstdint>
+#include <cstring>
+
+// Actualización de firmware por ESP-NOW: el Edge reparte una imagen de la
+// SD a los nodos en bloques de OTA_CHUNK_SIZE bytes (lo que cabe en una
+// trama de 250 dentro del sobre de bajada de los relevos, SensorRelay.h).
+// Lo usan los tres proyectos.
+//
+//   OFFER   Edge -> nodo  imagen (tipo de nodo, tamaño, CRC32, versión);
+//                         repetida sirve de sondeo del estado
+//   DATA    Edge -> nodo  un bloque (índice + datos)
+//   COMMIT  Edge -> nodo  todos los bloques confirmados: verificar y activar
+//   STATUS  nodo -> Edge  estado, primer bloque que falta (base) y mapa de
+//                         bits de los OTA_WINDOW siguientes ya recibidos
+//
+// Ventana deslizante con ACK selectivo: el Edge tiene en vuelo como mucho
+// OTA_WINDOW bloques a partir de base y solo reenvía los que el mapa no
+// marca. La sesión es función de la imagen (CRC y tamaño): si el enlace se
+// corta o cualquiera de los dos se reinicia, la misma oferta reanuda desde
+// lo que el nodo ya tiene escrito.
+#define OTA_FRAME_OFFER 0xE1
+#define OTA_FRAME_DATA 0xE2
+#define OTA_FRAME_COMMIT 0xE3
+#define OTA_FRAME_STATUS 0xE4
+
+#define OTA_CHUNK_SIZE 200
+#define OTA_WINDOW 32          // bloques en vuelo (bits del mapa)
+#define OTA_ACK_EVERY 8        // el nodo responde cada tantos bloques nuevos
+#define OTA_VERSION_LEN 16
+
+enum OtaNodeKind : uint8_t {
+    OTA_KIND_SENSOR = 1,
+    OTA_KIND_ACTUATOR = 2
+};
+
+enum OtaState : uint8_t {
+    OTA_IDLE = 0,          // sin transferencia (version: la que corre)
+    OTA_RECEIVING = 1,
+    OTA_READY = 2,         // imagen verificada y activada: el nodo reinicia
+    OTA_ERROR_CRC = 3,     // la imagen completa no coincide: se repite desde 0
+    OTA_ERROR_STORAGE = 4, // no se pudo preparar o escribir la partición
+    OTA_REJECTED = 5       // imagen para otro tipo de nodo o demasiado grande
+};
+
+#pragma pack(push, 1)
+struct OtaOffer {
+    uint8_t type = OTA_FRAME_OFFER;
+    uint8_t kind = 0;
+    uint32_t session = 0;
+    uint32_t size = 0;
+    uint32_t crc = 0;
+    char version[OTA_VERSION_LEN] = {0};
+};
+
+// Solo viajan los bytes del bloque (9 + len)
+struct OtaData {
+    uint8_t type = OTA_FRAME_DATA;
+    uint32_t session = 0;
+    uint32_t index = 0;
+    uint8_t payload[OTA_CHUNK_SIZE];
+};
+
+struct OtaCommit {
+    uint8_t type = OTA_FRAME_COMMIT;
+    uint32_t session = 0;
+};
+
+struct OtaStatus {
+    uint8_t type = OTA_FRAME_STATUS;
+    uint8_t kind = 0;
+    uint8_t state = OTA_IDLE;
+    uint32_t session = 0;
+    uint32_t base = 0;     // primer bloque que falta
+    uint32_t bitmap = 0;   // bit i: bloque base + i ya recibido
+    char version[OTA_VERSION_LEN] = {0};
+};
+#pragma pack(pop)
+
+static constexpr int OTA_DATA_HEADER = 9;
+
+// CRC32 incremental (mismo polinomio que ConfigBlob): empezar con
+// 0xFFFFFFFF y negar al terminar
+inline uint32_t otaCrc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return crc;
+}
+
+inline uint32_t otaSessionId(uint32_t crc, uint32_t size) {
+    return (crc ^ (size * 2654435761u)) | 1;   // nunca 0 (0: sin sesión)
+}
+
+inline uint32_t otaChunkCount(uint32_t size) { return (size + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE; }
+
+template <typename T>
+inline bool decodeOtaFrame(const uint8_t* data, int len, uint8_t type, T& out) {
+    if (len != (int)sizeof(T) || data[0] != type) return false;
+    memcpy(&out, data, sizeof(T));
+    return true;
+}
+
+inline bool decodeOtaData(const uint8_t* data, int len, OtaData& out) {
+    if (len <= OTA_DATA_HEADER || len > (int)sizeof(OtaData) || data[0] != OTA_FRAME_DATA) return false;
+    memcpy(&out, data, len);
+    return true;
+}
+
+// Receptor del nodo, independiente del hardware. Storage (partición de
+// flash en el ESP32, memoria en el simulador) ofrece:
+//   bool begin(uint32_t session, uint32_t size, uint32_t& resumeBytes)
+//        prepara la imagen; resumeBytes: lo ya escrito de esa sesión
+//   bool write(uint32_t offset, const uint8_t* data, uint16_t len)
+//   bool read(uint32_t offset, uint8_t* data, uint16_t len)
+//   void saveProgress(uint32_t session, uint32_t bytes)
+//   bool activate()   arrancar con la imagen nueva al reiniciar
+//
+// Los bloques se escriben en orden; los que llegan adelantados dentro de
+// la ventana esperan en un búfer (OTA_WINDOW x OTA_CHUNK_SIZE bytes). El
+// CRC se calcula al escribir, así que COMMIT no vuelve a leer la imagen.
+template <typename Storage>
+class OtaReceiver {
+public:
+    static constexpr uint32_t PROGRESS_EVERY = 64;   // bloques entre escrituras del progreso (15 KB)
+
+    OtaReceiver(Storage& storage, uint8_t kind, const char* version, uint32_t maxSize)
+        : _storage(storage), _kind(kind), _maxSize(maxSize) {
+        strncpy(_version, version, OTA_VERSION_LEN - 1);
+    }
+
+    // Si el límite solo se conoce después de construirlo (la partición)
+    void setMaxSize(uint32_t maxSize) { _maxSize = maxSize; }
+
+    // Procesa una trama del Edge; true si hay que responder con `reply`
+    bool handle(const uint8_t* data, int len, OtaStatus& reply) {
+        if (len < 1) return false;
+        if (data[0] == OTA_FRAME_OFFER) {
+            OtaOffer offer;
+            if (!decodeOtaFrame(data, len, OTA_FRAME_OFFER, offer)) return false;
+            onOffer(offer);
+        } else if (data[0] == OTA_FRAME_DATA) {
+            OtaData frame;
+            if (!decodeOtaData(data, len, frame)) return false;
+            if (!onData(frame, len - OTA_DATA_HEADER)) return false;
+        } else if (data[0] == OTA_FRAME_COMMIT) {
+            OtaCommit commit;
+            if (!decodeOtaFrame(data, len, OTA_FRAME_COMMIT, commit) || commit.session != _session) return false;
+            onCommit();
+        } else {
+            return false;
+        }
+        fillStatus(reply);
+        return true;
+    }
+
+    uint8_t state() const { return _state; }
+    uint32_t received() const { return _base; }
+    uint32_t chunks() const { return _chunks; }
+    unsigned long duplicates() const { return _duplicates; }
+
+private:
+    Storage& _storage;
+    uint8_t _kind;
+    char _version[OTA_VERSION_LEN] = {0};
+    uint32_t _maxSize;
+
+    uint8_t _state = OTA_IDLE;
+    uint32_t _session = 0;
+    uint32_t _size = 0;
+    uint32_t _crc = 0;             // esperado
+    uint32_t _runningCrc = 0xFFFFFFFF;
+    uint32_t _chunks = 0;
+    uint32_t _base = 0;
+    uint32_t _bitmap = 0;
+    uint8_t _sinceAck = 0;
+    unsigned long _duplicates = 0;
+    uint8_t _window[OTA_WINDOW][OTA_CHUNK_SIZE];
+
+    void onOffer(const OtaOffer& offer) {
+        bool same = offer.session == _session && _state != OTA_IDLE && _state != OTA_ERROR_CRC &&
+                    _state != OTA_ERROR_STORAGE;
+        if (same) return;   // sondeo: solo el estado
+        if (strncmp(offer.version, _version, OTA_VERSION_LEN) == 0) {   // ya la tiene
+            _state = OTA_IDLE;
+            _session = 0;
+            return;
+        }
+        if (offer.kind != _kind || offer.size == 0 || offer.size > _maxSize) {
+            _state = OTA_REJECTED;
+            _session = offer.session;
+            return;
+        }
+
+        _session = offer.session;
+        _size = offer.size;
+        _crc = offer.crc;
+        _chunks = otaChunkCount(offer.size);
+        _base = 0;
+        _bitmap = 0;
+        _sinceAck = 0;
+        _runningCrc = 0xFFFFFFFF;
+        uint32_t resumeBytes = 0;
+        if (!_storage.begin(_session, _size, resumeBytes)) {
+            _state = OTA_ERROR_STORAGE;
+            return;
+        }
+
+        // Reanudar: el CRC de lo ya escrito se recalcula leyendo la flash
+        uint8_t buf[OTA_CHUNK_SIZE];
+        uint32_t resumeChunks = resumeBytes / OTA_CHUNK_SIZE;
+        for (uint32_t i = 0; i < resumeChunks && i < _chunks; i++) {
+            uint16_t n = chunkLength(i);
+            if (!_storage.read(i * OTA_CHUNK_SIZE, buf, n)) break;
+            _runningCrc = otaCrc32Update(_runningCrc, buf, n);
+            _base = i + 1;
+        }
+        _state = OTA_RECEIVING;
+    }
+
+    // false si la trama no merece respuesta
+    bool onData(const OtaData& frame, int len) {
+        if (frame.session != _session || _state != OTA_RECEIVING || frame.index >= _chunks) return false;
+        if (len != chunkLength(frame.index)) return false;
+        if (frame.index >= _base + OTA_WINDOW) return false;   // antes del desplazamiento (< 32 bits)
+        if (frame.index < _base || (frame.index > _base && (_bitmap >> (frame.index - _base) & 1))) {
+            _duplicates++;   // el ACK se perdió: se repite el estado
+            return true;
+        }
+
+        if (frame.index > _base) {
+            memcpy(_window[frame.index % OTA_WINDOW], frame.payload, len);
+            _bitmap |= 1u << (frame.index - _base);
+        } else if (!commitChunk(frame.payload)) {
+            return true;
+        }
+        // Los adelantados que ya son contiguos
+        while (_state == OTA_RECEIVING && (_bitmap & 1) && _base < _chunks) {
+            if (!commitChunk(_window[_base % OTA_WINDOW])) return true;
+        }
+        if (++_sinceAck >= OTA_ACK_EVERY || _base == _chunks || _bitmap != 0) {
+            _sinceAck = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // Escribe el bloque base y avanza
+    bool commitChunk(const uint8_t* payload) {
+        uint16_t n = chunkLength(_base);
+        if (!_storage.write(_base * OTA_CHUNK_SIZE, payload, n)) {
+            _state = OTA_ERROR_STORAGE;
+            return false;
+        }
+        _runningCrc = otaCrc32Update(_runningCrc, payload, n);
+        _base++;
+        _bitmap >>= 1;
+        if (_base % PROGRESS_EVERY == 0) _storage.saveProgress(_session, _base * OTA_CHUNK_SIZE);
+        return true;
+    }
+
+    void onCommit() {
+        if (_state != OTA_RECEIVING || _base != _chunks) return;
+        if (~_runningCrc != _crc) {
+            _state = OTA_ERROR_CRC;
+            _storage.saveProgress(_session, 0);
+            return;
+        }
+        _storage.saveProgress(0, 0);
+        _state = _storage.activate() ? OTA_READY : OTA_ERROR_STORAGE;
+    }
+
+    uint16_t chunkLength(uint32_t index) const {
+        uint32_t left = _size - index * OTA_CHUNK_SIZE;
+        return (uint16_t)(left < OTA_CHUNK_SIZE ? left : OTA_CHUNK_SIZE);
+    }
+
+    void fillStatus(OtaStatus& s) const {
+        s = OtaStatus();
+        s.kind = _kind;
+        s.state = _state;
+        s.session = _session;
+        s.base = _base;
+        s.bitmap = _bitmap;
+        memcpy(s.version, _version, OTA_VERSION_LEN);
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef LINK_POWER_CLIENT_H
+#define LINK_POWER_CLIENT_H
+
+#include <Arduino.h>
+#include <esp_wifi.h>
+#include "LinkQuality.h"
+
+// Potencia de emisión del nodo según los informes de enlace del Edge
+// (LinkQuality.h). Lo usan PF-Sensores y PF-Actuadores.
+//
+// handleFrame() se llama desde el callback de ESP-NOW y solo guarda el
+// último informe; update(), desde loop(), lo aplica y da la respuesta.
+class LinkPowerClient {
+public:
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        LinkReport report;
+        if (!decodeLinkReport(data, len, report)) return false;
+        portENTER_CRITICAL(&_mux);
+        memcpy(_mac, mac, 6);
+        _report = report;
+        _pending = true;
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    // Desde loop(). edgeMac: solo se atiende al Edge emparejado; con adapt
+    // false (p. ej. un relevo, cuyos hijos el Edge no mide) se queda al
+    // máximo. true si hay que enviar `status` al Edge.
+    bool update(const uint8_t* edgeMac, bool adapt, LinkStatus& status) {
+        portENTER_CRITICAL(&_mux);
+        bool pending = _pending && memcmp(_mac, edgeMac, 6) == 0;
+        LinkReport report = _report;
+        _pending = false;
+        portEXIT_CRITICAL(&_mux);
+
+        unsigned long now = millis();
+        int8_t before = _control.qdbm();
+        if (pending && adapt) _control.onReport(report, now);
+        _control.checkTimeout(now);
+        if (!adapt && _control.qdbm() != TxPowerControl::MAX_QDBM) _control = TxPowerControl();
+        if (_control.qdbm() != before) {
+            esp_wifi_set_max_tx_power(_control.qdbm());
+            String why = pending && adapt ? "RSSI en el Edge " + String(report.rssi) + " dBm, " +
+                                                String(report.lossPermille / 10.0f, 1) + " % perdidas"
+                                          : String("sin informes del Edge");
+            Serial.println("📶 Potencia de emisión: " + String(_control.qdbm() / 4.0f, 2) + " dBm (" + why + ")");
+        }
+        status.txPowerQdbm = _control.qdbm();
+        return pending;
+    }
+
+    int8_t qdbm() const { return _control.qdbm(); }
+
+private:
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t _mac[6] = {0};
+    LinkReport _report;
+    bool _pending = false;
+    TxPowerControl _control;
+};
+
+#endif
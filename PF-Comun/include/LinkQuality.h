@@ -0,0 +1,95 @@
+#ifndef LINK_QUALITY_H
+#define LINK_QUALITY_H
+
+#include <cstdint>
+#include <cstring>
+
+// Calidad de los enlaces ESP-NOW y potencia de emisión de los nodos. Lo
+// usan los tres proyectos.
+//
+// El Edge mide, por cada nodo que oye directamente, el RSSI con que le
+// llegan sus tramas y la pérdida (huecos en la secuencia del sobre de
+// relevo en los sensores, reintentos de los comandos en los actuadores), y
+// se lo devuelve cada cierto tiempo en un LinkReport. El nodo ajusta con
+// ello su potencia (TxPowerControl) y contesta con la que usa (LinkStatus).
+#define LINK_FRAME_REPORT 0xF1   // Edge -> nodo
+#define LINK_FRAME_STATUS 0xF2   // nodo -> Edge
+
+#pragma pack(push, 1)
+struct LinkReport {
+    uint8_t type = LINK_FRAME_REPORT;
+    int8_t rssi = 0;              // dBm en el Edge (media); 0: sin medida
+    uint16_t samples = 0;         // tramas esperadas en la ventana
+    uint16_t lossPermille = 0;    // de ellas, perdidas (‰)
+};
+
+struct LinkStatus {
+    uint8_t type = LINK_FRAME_STATUS;
+    int8_t txPowerQdbm = 0;       // potencia en uso, en cuartos de dBm
+};
+#pragma pack(pop)
+
+inline bool decodeLinkReport(const uint8_t* data, int len, LinkReport& out) {
+    if (len != (int)sizeof(LinkReport) || data[0] != LINK_FRAME_REPORT) return false;
+    memcpy(&out, data, sizeof(out));
+    return out.lossPermille <= 1000;
+}
+
+inline bool decodeLinkStatus(const uint8_t* data, int len, LinkStatus& out) {
+    if (len != (int)sizeof(LinkStatus) || data[0] != LINK_FRAME_STATUS) return false;
+    memcpy(&out, data, sizeof(out));
+    return true;
+}
+
+// Potencia del nodo según los LinkReport (unidades de esp_wifi_set_max_tx_power).
+// Sube deprisa (STEP_UP) si la pérdida pasa de RAISE_LOSS_PERMILLE o el RSSI
+// cae por debajo de TARGET_RSSI; baja despacio (STEP_DOWN) si sobra margen
+// (RSSI por encima de TARGET_RSSI + MARGIN_DB) y no se perdió nada. Sin
+// informes en REPORT_TIMEOUT_MS vuelve al máximo: mejor gastar que perder
+// el enlace.
+class TxPowerControl {
+public:
+    static constexpr int8_t MIN_QDBM = 8;        // 2 dBm
+    static constexpr int8_t MAX_QDBM = 80;       // 20 dBm, el de fábrica
+    static constexpr int8_t STEP_UP = 8;         // 2 dB
+    static constexpr int8_t STEP_DOWN = 4;       // 1 dB
+    static constexpr int8_t TARGET_RSSI = -75;
+    static constexpr int8_t MARGIN_DB = 10;
+    static constexpr uint16_t RAISE_LOSS_PERMILLE = 100;
+    static constexpr uint16_t MIN_SAMPLES = 5;   // menos: la pérdida no dice nada
+    static constexpr unsigned long REPORT_TIMEOUT_MS = 90000;
+
+    // true si cambió la potencia (hay que aplicarla)
+    bool onReport(const LinkReport& report, unsigned long now) {
+        _lastReportMs = now;
+        _reports++;
+        int8_t before = _qdbm;
+        bool lossy = report.samples >= MIN_SAMPLES && report.lossPermille > RAISE_LOSS_PERMILLE;
+        bool weak = report.rssi != 0 && report.rssi < TARGET_RSSI;
+        bool strong = report.rssi != 0 && report.rssi > TARGET_RSSI + MARGIN_DB;
+        int next = _qdbm;
+        if (lossy || weak) next += STEP_UP;
+        else if (strong && report.lossPermille == 0) next -= STEP_DOWN;
+        if (next > MAX_QDBM) next = MAX_QDBM;
+        if (next < MIN_QDBM) next = MIN_QDBM;
+        _qdbm = (int8_t)next;
+        return _qdbm != before;
+    }
+
+    // true si venció el plazo y se volvió al máximo
+    bool checkTimeout(unsigned long now) {
+        if (_qdbm == MAX_QDBM || now - _lastReportMs < REPORT_TIMEOUT_MS) return false;
+        _qdbm = MAX_QDBM;
+        return true;
+    }
+
+    int8_t qdbm() const { return _qdbm; }
+    unsigned long reports() const { return _reports; }
+
+private:
+    int8_t _qdbm = MAX_QDBM;
+    unsigned long _lastReportMs = 0;
+    unsigned long _reports = 0;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef LINK_RSSI_H
+#define LINK_RSSI_H
+
+#include <Arduino.h>
+#include <esp_wifi.h>
+
+// RSSI de lo que se oye por ESP-NOW, por MAC de origen (media móvil). El
+// callback de recepción de ESP-NOW no lo da; se toma de la cabecera radio
+// de cada trama de gestión en modo promiscuo, sin cambiar de canal ni
+// afectar a la recepción normal. Solo cuentan las tramas ESP-NOW (acción
+// específica del fabricante con el OUI de Espressif): las balizas y sondas
+// de los AP cercanos desplazarían a los nodos de la tabla. Lo usan PF-Edge
+// y PF-Sensores.
+class LinkRssi {
+public:
+    static constexpr uint8_t MAX_PEERS = 8;
+    static constexpr unsigned long STALE_MS = 10000;
+
+    void begin() {
+        _instance = this;
+        wifi_promiscuous_filter_t filter = {};
+        filter.filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT;
+        esp_wifi_set_promiscuous_filter(&filter);
+        esp_wifi_set_promiscuous_rx_cb(onPacket);
+        esp_wifi_set_promiscuous(true);
+    }
+
+    // dBm; 0 si no se ha oído a `mac` en STALE_MS
+    int8_t get(const uint8_t* mac) {
+        int8_t rssi = 0;
+        portENTER_CRITICAL(&_mux);
+        for (uint8_t i = 0; i < _count; i++) {
+            if (memcmp(_peers[i].mac, mac, 6) == 0 && millis() - _peers[i].lastMs < STALE_MS) {
+                rssi = (int8_t)lroundf(_peers[i].rssi);
+            }
+        }
+        portEXIT_CRITICAL(&_mux);
+        return rssi;
+    }
+
+private:
+    struct Peer {
+        uint8_t mac[6];
+        float rssi;
+        unsigned long lastMs;
+    };
+
+    static LinkRssi* _instance;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    Peer _peers[MAX_PEERS];
+    uint8_t _count = 0;
+
+    // Cabecera 802.11 de gestión (24 bytes) y cuerpo de la trama de acción
+    static constexpr uint8_t ACTION_SUBTYPE = 0xD0;
+    static constexpr uint8_t VENDOR_CATEGORY = 127;
+
+    static bool isEspNow(const uint8_t* frame) {
+        return frame[0] == ACTION_SUBTYPE && frame[24] == VENDOR_CATEGORY &&
+               frame[25] == 0x18 && frame[26] == 0xFE && frame[27] == 0x34;
+    }
+
+    static void onPacket(void* buf, wifi_promiscuous_pkt_type_t type) {
+        if (type != WIFI_PKT_MGMT || !_instance) return;
+        const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)buf;
+        if (pkt->rx_ctrl.sig_len < 28 || !isEspNow(pkt->payload)) return;
+        _instance->record(pkt->payload + 10, pkt->rx_ctrl.rssi);   // addr2: emisor
+    }
+
+    // Llena, se sustituye al que lleva más tiempo sin oírse
+    void record(const uint8_t* mac, int rssi) {
+        unsigned long now = millis();
+        portENTER_CRITICAL(&_mux);
+        Peer* peer = nullptr;
+        for (uint8_t i = 0; i < _count && !peer; i++) {
+            if (memcmp(_peers[i].mac, mac, 6) == 0) peer = &_peers[i];
+        }
+        if (!peer) {
+            if (_count < MAX_PEERS) {
+                peer = &_peers[_count++];
+            } else {
+                peer = &_peers[0];
+                for (uint8_t i = 1; i < _count; i++) {
+                    if (now - _peers[i].lastMs > now - peer->lastMs) peer = &_peers[i];
+                }
+            }
+            memcpy(peer->mac, mac, 6);
+            peer->rssi = rssi;
+        }
+        if (now - peer->lastMs >= STALE_MS) peer->rssi = rssi;
+        peer->rssi += 0.25f * (rssi - peer->rssi);
+        peer->lastMs = now;
+        portEXIT_CRITICAL(&_mux);
+    }
+};
+
+LinkRssi* LinkRssi::_instance = nullptr;
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include "ConfigBlob.h"
+#include "FirmwareTransfer.h"
+
+// Estado de la actualización que sobrevive a un reinicio (NVS "ota")
+struct OtaProgress {
+    // v1
+    uint32_t session;    // imagen a medias (0: ninguna)
+    uint32_t bytes;      // bytes de esa imagen ya escritos
+    uint8_t verifying;   // corre una imagen nueva aún sin confirmar
+    uint8_t boots;       // arranques de esa imagen sin confirmar
+};
+
+// Imagen de firmware en la partición OTA libre (la que no está corriendo).
+// Cada sector de 4 KB se borra justo antes de escribir en él, así que
+// ninguna trama espera al borrado de la partición entera. El progreso va
+// a NVS para reanudar tras un reinicio del nodo.
+class OtaFlashStorage {
+public:
+    static constexpr uint32_t SECTOR = 4096;
+
+    OtaFlashStorage() : _blob("ota", 1) {}
+
+    void load() {
+        _progress = OtaProgress();
+        _blob.load(_progress);
+    }
+
+    OtaProgress& progress() { return _progress; }
+    bool saveState() { return _blob.save(_progress); }
+
+    uint32_t capacity() {
+        const esp_partition_t* p = esp_ota_get_next_update_partition(NULL);
+        return p ? p->size : 0;
+    }
+
+    bool begin(uint32_t session, uint32_t size, uint32_t& resumeBytes) {
+        _partition = esp_ota_get_next_update_partition(NULL);
+        if (!_partition || size > _partition->size) return false;
+        resumeBytes = _progress.session == session && _progress.bytes <= size ? _progress.bytes : 0;
+        // El sector a medias ya estaba borrado: reescribir lo mismo no cambia bits
+        _erasedTo = (resumeBytes + SECTOR - 1) / SECTOR * SECTOR;
+        return true;
+    }
+
+    bool write(uint32_t offset, const uint8_t* data, uint16_t len) {
+        while (offset + len > _erasedTo) {
+            if (esp_partition_erase_range(_partition, _erasedTo, SECTOR) != ESP_OK) return false;
+            _erasedTo += SECTOR;
+        }
+        return esp_partition_write(_partition, offset, data, len) == ESP_OK;
+    }
+
+    bool read(uint32_t offset, uint8_t* data, uint16_t len) {
+        return esp_partition_read(_partition, offset, data, len) == ESP_OK;
+    }
+
+    void saveProgress(uint32_t session, uint32_t bytes) {
+        _progress.session = session;
+        _progress.bytes = bytes;
+        saveState();
+    }
+
+    // Valida la cabecera de la imagen y la deja como partición de arranque
+    bool activate() { return esp_ota_set_boot_partition(_partition) == ESP_OK; }
+
+private:
+    const esp_partition_t* _partition = nullptr;
+    uint32_t _erasedTo = 0;
+    ConfigBlob<OtaProgress> _blob;
+    OtaProgress _progress = {};
+};
+
+// Actualización por ESP-NOW desde el Edge (FirmwareTransfer.h) y vuelta
+// atrás si la versión nueva no arranca bien. Lo usan PF-Sensores y
+// PF-Actuadores.
+//
+// handleFrame() se llama desde el callback de ESP-NOW y solo encola la
+// trama; update(), desde loop(), la procesa (la flash no se escribe desde
+// el callback) y responde al Edge.
+//
+// Tras activar una imagen el nodo reinicia en modo verificación: no
+// responde al Edge hasta que update() recibe healthy (emparejado con el
+// Edge, es decir, la radio funciona). Si no llega en VERIFY_MS, o el nodo
+// se reinicia MAX_BOOTS veces sin lograrlo, vuelve a la partición anterior.
+class OtaUpdater {
+public:
+    static constexpr uint8_t QUEUE_LEN = 12;              // tramas entre dos loop()
+    static constexpr unsigned long VERIFY_MS = 60000;
+    static constexpr uint8_t MAX_BOOTS = 3;
+    static constexpr unsigned long REBOOT_DELAY_MS = 500;  // que salga el último STATUS
+
+    // El receptor (con su ventana de OTA_WINDOW bloques) es parte del
+    // objeto: sin reservas en el montón
+    OtaUpdater(uint8_t kind, const char* version)
+        : _kind(kind), _version(version), _receiver(_storage, kind, version, 0) {}
+
+    // En setup(), antes que nada que pueda colgar el arranque
+    void begin() {
+        _storage.load();
+        OtaProgress& p = _storage.progress();
+        _verifying = p.verifying;
+        if (_verifying) {
+            p.boots++;
+            _storage.saveState();
+            Serial.println("🔎 Firmware " + String(_version) + " a prueba (arranque " + String(p.boots) + ")");
+            if (p.boots > MAX_BOOTS) rollback();
+        }
+        _receiver.setMaxSize(_storage.capacity());
+    }
+
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        if (len < 1 || data[0] < OTA_FRAME_OFFER || data[0] > OTA_FRAME_COMMIT) return false;
+        portENTER_CRITICAL(&_mux);
+        if (_count < QUEUE_LEN && len <= ESP_NOW_MAX_DATA_LEN) {
+            Frame& f = _queue[(_head + _count++) % QUEUE_LEN];
+            memcpy(f.mac, mac, 6);
+            memcpy(f.data, data, len);
+            f.len = len;
+        } else {
+            _dropped++;   // el Edge lo reenvía
+        }
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    // Desde loop(); edgeMac: el Edge emparejado (solo se le atiende a él)
+    void update(bool healthy, const uint8_t* edgeMac) {
+        if (_verifying) {
+            if (healthy) confirm();
+            else if (millis() >= VERIFY_MS) rollback();
+        }
+
+        Frame f;
+        while (pop(f)) {
+            if (_verifying || !healthy || memcmp(f.mac, edgeMac, 6) != 0) continue;
+            OtaStatus reply;
+            if (!_receiver.handle(f.data, f.len, reply)) continue;
+            send(f.mac, reply);
+            if (reply.state == OTA_READY && !_rebootAt) {
+                Serial.println("📦 Firmware recibido y verificado; reiniciando...");
+                setVerifying(true);
+                _rebootAt = millis() + REBOOT_DELAY_MS;
+            }
+        }
+        if (_rebootAt && (long)(millis() - _rebootAt) >= 0) ESP.restart();
+    }
+
+    // Respuestas por otro camino (p. ej. el sobre de relevo de los
+    // sensores); sin él, directas al Edge
+    void setSender(bool (*send)(const uint8_t* data, int len)) { _sender = send; }
+
+    // Hay una transferencia en curso: conviene llamar a update() a menudo
+    bool busy() const { return _receiver.state() == OTA_RECEIVING; }
+
+    unsigned long getDropped() const { return _dropped; }
+
+private:
+    struct Frame {
+        uint8_t mac[6];
+        uint8_t data[ESP_NOW_MAX_DATA_LEN];
+        int len;
+    };
+
+    uint8_t _kind;
+    const char* _version;
+    OtaFlashStorage _storage;
+    OtaReceiver<OtaFlashStorage> _receiver;
+    bool _verifying = false;
+    unsigned long _rebootAt = 0;
+    bool (*_sender)(const uint8_t* data, int len) = nullptr;
+
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    Frame _queue[QUEUE_LEN];
+    uint8_t _head = 0;
+    uint8_t _count = 0;
+    unsigned long _dropped = 0;
+
+    bool pop(Frame& out) {
+        portENTER_CRITICAL(&_mux);
+        bool any = _count > 0;
+        if (any) {
+            out = _queue[_head];
+            _head = (_head + 1) % QUEUE_LEN;
+            _count--;
+        }
+        portEXIT_CRITICAL(&_mux);
+        return any;
+    }
+
+    void send(const uint8_t* mac, const OtaStatus& reply) {
+        if (_sender) {
+            _sender((const uint8_t*)&reply, sizeof(reply));
+            return;
+        }
+        if (!esp_now_is_peer_exist(mac)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, mac, 6);
+            peerInfo.channel = 0;   // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            if (esp_now_add_peer(&peerInfo) != ESP_OK) return;
+        }
+        esp_now_send(mac, (const uint8_t*)&reply, sizeof(reply));
+    }
+
+    void setVerifying(bool verifying) {
+        _storage.progress().verifying = verifying;
+        _storage.progress().boots = 0;
+        _storage.saveState();
+    }
+
+    void confirm() {
+        _verifying = false;
+        setVerifying(false);
+        esp_ota_mark_app_valid_cancel_rollback();   // por si el bootloader también vigila
+        Serial.println("✅ Firmware " + String(_version) + " confirmado.");
+    }
+
+    // Arrancar de nuevo con la imagen anterior (la otra partición OTA)
+    void rollback() {
+        setVerifying(false);
+        const esp_partition_t* previous = esp_ota_get_next_update_partition(NULL);
+        Serial.println("↩️ Firmware " + String(_version) + " sin confirmar: vuelta a la versión anterior.");
+        if (previous && esp_ota_set_boot_partition(previous) == ESP_OK) ESP.restart();
+        _verifying = false;   // no hay a dónde volver: se sigue con esta
+    }
+};
+
+#endif
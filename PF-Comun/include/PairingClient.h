@@ -0,0 +1,149 @@
+#ifndef PAIRING_CLIENT_H
+#define PAIRING_CLIENT_H
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include "EdgeBeacon.h"
+
+// Emparejamiento del nodo con el Edge a partir de su baliza (EdgeBeacon):
+//  - arranca en el canal guardado y, si en LOST_MS no oye ninguna baliza
+//    (o fallan MAX_SEND_FAILS envíos seguidos), recorre los canales 1-13
+//    escuchando DWELL_MS en cada uno;
+//  - al arrancar y al llegar a cada canal difunde una PairingRequest para
+//    que el Edge (o un relevo) responda sin esperar a su baliza lenta;
+//  - al oír una baliza fija el canal que anuncia y la MAC del Edge, y avisa
+//    con onPaired() si cambiaron (para guardarlos y rehacer el peer). La
+//    baliza repetida por un relevo (RelayBeacon) vale igual: lleva el canal
+//    y la MAC del Edge aunque este quede fuera de alcance.
+// handleFrame() y onSendResult() se llaman desde los callbacks de ESP-NOW;
+// el cambio de canal se hace en update(), desde loop().
+class PairingClient {
+public:
+    static constexpr unsigned long LOST_MS = 4 * BEACON_PERIOD_MS + 500;   // 4 balizas lentas seguidas
+    static constexpr unsigned long DWELL_MS = 300;     // > BEACON_FAST_PERIOD_MS
+    static constexpr uint8_t MAX_CHANNEL = 13;
+    static constexpr uint8_t MAX_SEND_FAILS = 5;
+
+    void begin(uint8_t channel, const uint8_t edgeMac[6]) {
+        _channel = channel;
+        memcpy(_edgeMac, edgeMac, 6);
+        _lastBeacon = millis();   // margen para el canal guardado
+        _searchStart = _lastBeacon;
+        _paired = true;
+        _requestDue = true;
+    }
+
+    // Devuelve true si la trama era una baliza
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        EdgeBeacon beacon;
+        RelayBeacon relay;
+        const uint8_t* edgeMac = mac;
+        uint8_t channel;
+        if (decodeBeacon(data, len, beacon)) {
+            channel = beacon.channel;
+        } else if (decodeRelayBeacon(data, len, relay)) {
+            edgeMac = relay.edgeMac;
+            channel = relay.channel;
+        } else {
+            return false;
+        }
+        portENTER_CRITICAL(&_mux);
+        memcpy(_beaconMac, edgeMac, 6);
+        _beaconChannel = channel;
+        _pending = true;
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    void onSendResult(bool ok) {
+        _sendFails = ok ? 0 : _sendFails + 1;
+    }
+
+    void update() {
+        unsigned long now = millis();
+        if (_requestDue) sendRequest();
+
+        uint8_t mac[6];
+        uint8_t channel = 0;
+        portENTER_CRITICAL(&_mux);
+        if (_pending) {
+            memcpy(mac, _beaconMac, 6);
+            channel = _beaconChannel;
+            _pending = false;
+        }
+        portEXIT_CRITICAL(&_mux);
+
+        if (channel) {
+            bool changed = !_paired || channel != _channel || memcmp(mac, _edgeMac, 6) != 0;
+            _lastBeacon = now;
+            _sendFails = 0;
+            if (changed) {
+                if (channel != _channel) esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+                _channel = channel;
+                memcpy(_edgeMac, mac, 6);
+                _paired = true;
+                Serial.println("🔗 Edge encontrado en el canal " + String(channel) + " (" +
+                               String((now - _searchStart) / 1000.0, 1) + " s)");
+                if (_onPaired) _onPaired(_edgeMac, _channel);
+            }
+            return;
+        }
+
+        if (_paired && (now - _lastBeacon > LOST_MS || _sendFails >= MAX_SEND_FAILS)) {
+            _paired = false;
+            _searchStart = now;
+            _dwellStart = now;
+            Serial.println("🔍 Edge perdido, buscando su canal...");
+            sendRequest();
+            return;
+        }
+
+        if (!_paired && now - _dwellStart >= DWELL_MS) {
+            _channel = _channel % MAX_CHANNEL + 1;
+            esp_wifi_set_channel(_channel, WIFI_SECOND_CHAN_NONE);
+            _dwellStart = now;
+            sendRequest();
+        }
+    }
+
+    void onPaired(void (*callback)(const uint8_t* mac, uint8_t channel)) { _onPaired = callback; }
+
+    bool isPaired() const { return _paired; }
+    uint8_t getChannel() const { return _channel; }
+    const uint8_t* getEdgeMac() const { return _edgeMac; }
+
+private:
+    uint8_t _channel = 1;
+    uint8_t _edgeMac[6] = {0};
+    bool _paired = false;
+    unsigned long _lastBeacon = 0;
+    unsigned long _searchStart = 0;
+    unsigned long _dwellStart = 0;
+    volatile uint8_t _sendFails = 0;
+    bool _requestDue = false;
+    void (*_onPaired)(const uint8_t* mac, uint8_t channel) = nullptr;
+
+    // Por broadcast en el canal actual
+    void sendRequest() {
+        _requestDue = false;
+        if (!esp_now_is_peer_exist(BEACON_BROADCAST_MAC)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, BEACON_BROADCAST_MAC, 6);
+            peerInfo.channel = 0;   // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            esp_now_add_peer(&peerInfo);
+        }
+        PairingRequest request;
+        esp_now_send(BEACON_BROADCAST_MAC, (const uint8_t*)&request, sizeof(request));
+    }
+
+    // Última baliza recibida, pendiente de procesar en update()
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t _beaconMac[6] = {0};
+    uint8_t _beaconChannel = 0;
+    bool _pending = false;
+};
+
+#endif
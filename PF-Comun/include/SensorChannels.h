@@ -0,0 +1,224 @@
+#ifndef SENSOR_CHANNELS_H
+#define SENSOR_CHANNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <math.h>
+
+// Registro de canales de medida: la única lista que hay que tocar para
+// añadir o cambiar un sensor. De ella salen, al compilar, la muestra
+// (SensorData), la trama ESP-NOW (SensorFrame) con su codificación, las
+// columnas del CSV y los recorridos que usan los formateadores (Telegram,
+// pantalla, JSON). Lo usan PF-Edge y PF-Sensores.
+//
+// Las muestras van en punto fijo de punta a punta: cada canal es un entero
+// en 1/escala de su unidad (centésimas de °C, mV...) desde la lectura del
+// sensor hasta la trama, los umbrales y los registros; los decimales solo
+// aparecen al presentar (formatSensorValue).
+//
+// Cada trama lleva la huella de la lista (SENSOR_LAYOUT_ID): si los dos
+// firmwares se compilaron con registros distintos, el Edge descarta la
+// trama en lugar de leer los campos desplazados. También lleva la edad de
+// la muestra (ageMs, 16 bits) y el Edge la fecha como sentMs - ageMs, con
+// sentMs el envío en su reloj (ver SensorFrame).
+//
+// X(ID, campo, clave, emoji, etiqueta, unidad, tipo en trama, escala, decimales)
+//   campo      miembro de SensorData
+//   clave      nombre corto: columna del CSV, campo JSON, prefijo de umbrales
+//   escala     valor guardado = round(valor * escala), saturado al tipo
+//   decimales  al presentar (la resolución de la trama es 1/escala)
+#define SENSOR_CHANNELS(X) \
+    X(TEMPERATURE, temperature,  "temp",    "🌡️", "Temp",  "°C",  int16_t,  100,  1) \
+    X(HUMIDITY,    humidity,     "hum",     "💧", "Hum",   "%",   uint16_t, 100,  1) \
+    X(LIGHT,       light,        "luz",     "☀️", "Luz",   "",    uint16_t, 1,    0) \
+    X(CO2,         co2ppm,       "co2",     "🫁", "CO2",   "ppm", uint16_t, 1,    0) \
+    X(SOIL,        soilMoisture, "suelo",   "🌱", "Suelo", "%",   uint16_t, 100,  1) \
+    X(VOLTAGE,     voltage,      "voltaje", "🔋", "Volt",  "V",   uint16_t, 1000, 2)
+
+#define SENSOR_FRAME_TYPE 0xD1
+
+struct SensorChannel {
+    const char* key;
+    const char* emoji;
+    const char* label;
+    const char* unit;
+    uint16_t scale;
+    uint8_t wireBytes;
+    uint8_t decimals;
+    uint8_t resolution;     // decimales que caben en la trama (log10 de la escala)
+    int32_t noReading;      // valor reservado: el sensor no dio lectura
+};
+
+constexpr uint8_t scaleDecimals(uint32_t scale) {
+    return scale >= 10 ? 1 + scaleDecimals(scale / 10) : 0;
+}
+
+// "Sin lectura" (p. ej. el DHT devolvió NaN): el extremo del tipo que no
+// puede ser una medida real (mínimo si tiene signo, máximo si no)
+template <typename T>
+constexpr T sensorNoReading() {
+    return std::numeric_limits<T>::is_signed ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+}
+
+enum SensorChannelId : uint8_t {
+#define SENSOR_X_ID(ID, field, key, emoji, label, unit, wire, scale, decimals) SENSOR_##ID,
+    SENSOR_CHANNELS(SENSOR_X_ID)
+#undef SENSOR_X_ID
+    SENSOR_CHANNEL_COUNT
+};
+
+constexpr SensorChannel SENSOR_CHANNEL_TABLE[SENSOR_CHANNEL_COUNT] = {
+#define SENSOR_X_DESC(ID, field, key, emoji, label, unit, wire, scale, decimals) \
+    {key, emoji, label, unit, scale, sizeof(wire), decimals, scaleDecimals(scale), (int32_t)sensorNoReading<wire>()},
+    SENSOR_CHANNELS(SENSOR_X_DESC)
+#undef SENSOR_X_DESC
+};
+
+// Muestra en punto fijo: el mismo formato en memoria y en la trama
+#pragma pack(push, 1)
+struct SensorData {
+#define SENSOR_X_FIELD(ID, field, key, emoji, label, unit, wire, scale, decimals) wire field = 0;
+    SENSOR_CHANNELS(SENSOR_X_FIELD)
+#undef SENSOR_X_FIELD
+};
+#pragma pack(pop)
+
+// Sin huecos de relleno aunque no estuviera empaquetada
+#define SENSOR_X_SIZE(ID, field, key, emoji, label, unit, wire, scale, decimals) + sizeof(wire)
+static_assert(sizeof(SensorData) == 0 SENSOR_CHANNELS(SENSOR_X_SIZE), "SensorData con relleno");
+#undef SENSOR_X_SIZE
+
+// Huella del registro: FNV-1a de campo, tipo y escala de cada canal
+constexpr uint32_t layoutHash(const char* s, uint32_t h = 2166136261u) {
+    return *s ? layoutHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
+#define SENSOR_X_LAYOUT(ID, field, key, emoji, label, unit, wire, scale, decimals) #field ":" #wire "*" #scale ";"
+constexpr uint16_t SENSOR_LAYOUT_ID =
+    (uint16_t)(layoutHash(SENSOR_CHANNELS(SENSOR_X_LAYOUT)) ^ (layoutHash(SENSOR_CHANNELS(SENSOR_X_LAYOUT)) >> 16));
+#undef SENSOR_X_LAYOUT
+
+// Columnas del CSV, en orden: ",temp,hum,..."
+#define SENSOR_X_CSV(ID, field, key, emoji, label, unit, wire, scale, decimals) "," key
+#define SENSOR_CSV_COLUMNS SENSOR_CHANNELS(SENSOR_X_CSV)
+
+// Trama nodo sensor -> Edge: cabecera + la muestra tal cual. ageMs es el
+// tiempo entre la lectura y el envío en el reloj del nodo (saturado a
+// SENSOR_AGE_MAX); el Edge lo resta del instante de envío en su propio
+// reloj para fechar la muestra, sin que el nodo tenga que mandar una hora.
+#define SENSOR_AGE_MAX 0xFFFF
+
+#pragma pack(push, 1)
+struct SensorFrame {
+    uint8_t type = SENSOR_FRAME_TYPE;
+    uint16_t layout = SENSOR_LAYOUT_ID;
+    uint16_t ageMs = 0;
+    SensorData data;
+};
+#pragma pack(pop)
+
+inline uint16_t sensorAge(unsigned long elapsedMs) {
+    return elapsedMs >= SENSOR_AGE_MAX ? (uint16_t)SENSOR_AGE_MAX : (uint16_t)elapsedMs;
+}
+
+inline SensorFrame encodeSensorFrame(const SensorData& d, uint16_t ageMs = 0) {
+    SensorFrame f;
+    f.ageMs = ageMs;
+    f.data = d;
+    return f;
+}
+
+// false si no es una trama de sensores o su registro no coincide
+inline bool decodeSensorFrame(const uint8_t* raw, int len, SensorData& out, uint16_t* ageMs = nullptr) {
+    if (len != (int)sizeof(SensorFrame) || raw[0] != SENSOR_FRAME_TYPE) return false;
+    uint16_t layout;
+    memcpy(&layout, raw + 1, sizeof(layout));
+    if (layout != SENSOR_LAYOUT_ID) return false;
+    if (ageMs) memcpy(ageMs, raw + offsetof(SensorFrame, ageMs), sizeof(uint16_t));
+    memcpy(&out, raw + offsetof(SensorFrame, data), sizeof(SensorData));
+    return true;
+}
+
+// Entero saturado al tipo del campo
+template <typename T>
+inline T clampFixed(int32_t v) {
+    if (v < (int32_t)std::numeric_limits<T>::min()) return std::numeric_limits<T>::min();
+    if (v > (int32_t)std::numeric_limits<T>::max()) return std::numeric_limits<T>::max();
+    return (T)v;
+}
+
+// Para fuentes que dan float (DHT, simulador): valor en la unidad del canal
+template <typename T>
+inline void setSensorValue(T& field, SensorChannelId ch, float value) {
+    float v = roundf(value * SENSOR_CHANNEL_TABLE[ch].scale);
+    if (isnan(v)) field = 0;
+    else if (v <= (float)std::numeric_limits<T>::min()) field = std::numeric_limits<T>::min();
+    else if (v >= (float)std::numeric_limits<T>::max()) field = std::numeric_limits<T>::max();
+    else field = (T)v;
+}
+
+// Solo para presentar o para cálculos en float (PID)
+inline float sensorToFloat(SensorChannelId ch, int32_t raw) {
+    return (float)raw / SENSOR_CHANNEL_TABLE[ch].scale;
+}
+
+// Umbral en la unidad del canal -> punto fijo del canal (sin saturar)
+inline int32_t sensorFromFloat(SensorChannelId ch, float value) {
+    return (int32_t)lroundf(value * SENSOR_CHANNEL_TABLE[ch].scale);
+}
+
+// "23.4" a partir de 2345 centésimas con 1 decimal, con aritmética entera
+// (sin float ni printf); "--" si no hay lectura. Devuelve la longitud escrita.
+inline size_t formatSensorValue(char* out, size_t size, const SensorChannel& ch, int32_t raw, uint8_t decimals) {
+    if (raw == ch.noReading) {
+        size_t len = size > 2 ? 2 : size - 1;
+        memcpy(out, "--", len);
+        out[len] = '\0';
+        return len;
+    }
+    if (decimals > ch.resolution) decimals = ch.resolution;
+    uint32_t div = 1;
+    for (uint8_t i = decimals; i < ch.resolution; i++) div *= 10;
+    uint32_t mag = raw < 0 ? (uint32_t)(-(int64_t)raw) : (uint32_t)raw;
+    mag = (mag + div / 2) / div;   // redondeo al último decimal mostrado
+    bool negative = raw < 0 && mag > 0;
+
+    char tmp[16];                  // al revés: decimales, punto, enteros, signo
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < decimals; i++, mag /= 10) tmp[n++] = (char)('0' + mag % 10);
+    if (decimals > 0) tmp[n++] = '.';
+    do {
+        tmp[n++] = (char)('0' + mag % 10);
+        mag /= 10;
+    } while (mag > 0);
+    if (negative) tmp[n++] = '-';
+
+    size_t len = n < size - 1 ? n : size - 1;
+    for (size_t i = 0; i < len; i++) out[i] = tmp[n - 1 - i];
+    out[len] = '\0';
+    return len;
+}
+
+// Recorre los canales en orden: f(const SensorChannel&, int32_t valor en
+// punto fijo). Se expande en línea, sin tabla ni switch por canal.
+template <typename F>
+inline void visitSensorChannels(const SensorData& d, F f) {
+#define SENSOR_X_VISIT(ID, field, key, emoji, label, unit, wire, scale, decimals) \
+    f(SENSOR_CHANNEL_TABLE[SENSOR_##ID], (int32_t)d.field);
+    SENSOR_CHANNELS(SENSOR_X_VISIT)
+#undef SENSOR_X_VISIT
+}
+
+// Rellena la muestra canal a canal: value(SensorChannelId) -> int32_t en
+// punto fijo (se satura al tipo del campo)
+template <typename F>
+inline void fillSensorChannels(SensorData& d, F value) {
+#define SENSOR_X_FILL(ID, field, key, emoji, label, unit, wire, scale, decimals) \
+    d.field = clampFixed<wire>(value(SENSOR_##ID));
+    SENSOR_CHANNELS(SENSOR_X_FILL)
+#undef SENSOR_X_FILL
+}
+
+#endif
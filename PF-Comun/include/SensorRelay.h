@@ -0,0 +1,123 @@
+#ifndef SENSOR_RELAY_H
+#define SENSOR_RELAY_H
+
+#include <cstdint>
+#include <cstring>
+#include "EdgeBeacon.h"
+
+// Relevo de tramas hacia el Edge: un nodo sensor fuera del alcance del
+// Edge envía a otro nodo (su padre) que tiene activado el modo relevo, y
+// este las reenvía, hasta RELAY_MAX_HOPS saltos. Los relevos se anuncian
+// con RelayBeacon (EdgeBeacon.h). Lo usan PF-Edge y PF-Sensores.
+//
+// Los nodos sensores envían siempre dentro de RELAY_FRAME_DATA: cabecera
+// (origen, secuencia del origen, relevos atravesados, instante del envío en
+// el reloj del Edge, padre del origen) + su trama tal cual (SensorFrame,
+// ACK de configuración...), con hops 0 si van directos al Edge. La
+// secuencia da al Edge la pérdida por nodo y camino, y el sello la
+// latencia. Los duplicados (p. ej. un reenvío tras cambiar de padre) se
+// descartan por (origen, secuencia) en cada relevo y en el Edge.
+//
+// Con el padre de cada nodo el Edge conoce el árbol y envía a los nodos
+// que llegan por relevo dentro de RELAY_FRAME_DOWN, con la ruta completa:
+// los relevos desde el Edge y, al final, el destino. Cada relevo comprueba
+// que es route[next], avanza next y la pasa al siguiente; el destino la
+// abre y la atiende como si viniera del Edge. A los directos, sin sobre.
+#define RELAY_FRAME_DATA 0xA1
+#define RELAY_FRAME_DOWN 0xA2
+
+#pragma pack(push, 1)
+struct RelayHeader {
+    uint8_t type = RELAY_FRAME_DATA;
+    uint8_t origin[6] = {0};
+    uint16_t seq = 0;
+    uint8_t hops = 0;        // relevos atravesados
+    uint32_t sentMs = 0;     // reloj del Edge al salir del origen (0: sin sincronizar)
+    uint8_t parent[6] = {0}; // a quién envía el origen (el Edge si va directo)
+};
+
+struct RelayDownHeader {
+    uint8_t type = RELAY_FRAME_DOWN;
+    uint8_t count = 0;       // MACs en route, destino incluido
+    uint8_t next = 0;        // índice del que debe recibirla ahora
+    uint8_t route[RELAY_MAX_HOPS][6];
+};
+#pragma pack(pop)
+
+static constexpr int RELAY_HEADER_LEN = sizeof(RelayHeader);
+static constexpr int RELAY_MAX_PAYLOAD = 250 - RELAY_HEADER_LEN;
+static constexpr int RELAY_DOWN_HEADER_LEN = sizeof(RelayDownHeader);
+static constexpr int RELAY_DOWN_MAX_PAYLOAD = 250 - RELAY_DOWN_HEADER_LEN;
+
+// Cabecera + carga en `out` (al menos RELAY_HEADER_LEN + len); devuelve la longitud
+inline int encodeRelayFrame(const RelayHeader& header, const uint8_t* payload, int len, uint8_t* out) {
+    if (len <= 0 || len > RELAY_MAX_PAYLOAD) return 0;
+    memcpy(out, &header, RELAY_HEADER_LEN);
+    memcpy(out + RELAY_HEADER_LEN, payload, len);
+    return RELAY_HEADER_LEN + len;
+}
+
+// payload apunta dentro de data
+inline bool decodeRelayFrame(const uint8_t* data, int len, RelayHeader& header, const uint8_t*& payload,
+                             int& payloadLen) {
+    if (len <= RELAY_HEADER_LEN || data[0] != RELAY_FRAME_DATA) return false;
+    memcpy(&header, data, RELAY_HEADER_LEN);
+    if (header.hops > RELAY_MAX_HOPS) return false;
+    payload = data + RELAY_HEADER_LEN;
+    payloadLen = len - RELAY_HEADER_LEN;
+    return true;
+}
+
+// Sobre de bajada con la ruta (count MACs, la última el destino) y next 0
+inline int encodeRelayDown(const uint8_t (*route)[6], uint8_t count, const uint8_t* payload, int len, uint8_t* out) {
+    if (count == 0 || count > RELAY_MAX_HOPS || len <= 0 || len > RELAY_DOWN_MAX_PAYLOAD) return 0;
+    RelayDownHeader header;
+    header.count = count;
+    memset(header.route, 0, sizeof(header.route));
+    memcpy(header.route, route, 6 * count);
+    memcpy(out, &header, RELAY_DOWN_HEADER_LEN);
+    memcpy(out + RELAY_DOWN_HEADER_LEN, payload, len);
+    return RELAY_DOWN_HEADER_LEN + len;
+}
+
+// payload apunta dentro de data
+inline bool decodeRelayDown(const uint8_t* data, int len, RelayDownHeader& header, const uint8_t*& payload,
+                            int& payloadLen) {
+    if (len <= RELAY_DOWN_HEADER_LEN || data[0] != RELAY_FRAME_DOWN) return false;
+    memcpy(&header, data, RELAY_DOWN_HEADER_LEN);
+    if (header.count == 0 || header.count > RELAY_MAX_HOPS || header.next >= header.count) return false;
+    payload = data + RELAY_DOWN_HEADER_LEN;
+    payloadLen = len - RELAY_DOWN_HEADER_LEN;
+    return true;
+}
+
+// Últimas (origen, secuencia) vistas; con SIZE entradas cubre varios
+// periodos de todos los nodos de una red pequeña
+class RelayDuplicateFilter {
+public:
+    static constexpr uint8_t SIZE = 32;
+
+    // true si ya se había visto (la trama se descarta); si no, la recuerda
+    bool seen(const uint8_t* origin, uint16_t seq) {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_entries[i].seq == seq && memcmp(_entries[i].origin, origin, 6) == 0) return true;
+        }
+        Entry& e = _entries[_next];
+        memcpy(e.origin, origin, 6);
+        e.seq = seq;
+        _next = (_next + 1) % SIZE;
+        if (_count < SIZE) _count++;
+        return false;
+    }
+
+private:
+    struct Entry {
+        uint8_t origin[6];
+        uint16_t seq;
+    };
+    Entry _entries[SIZE];
+    uint8_t _count = 0;
+    uint8_t _next = 0;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef SENSOR_SETTINGS_H
+#define SENSOR_SETTINGS_H
+
+#include "SensorChannels.h"
+
+// Parámetros del nodo sensor que el Edge puede cambiar por ESP-NOW
+// (calibración, periodo de lectura y umbrales de envío) sin reprogramarlo.
+// Lo usan PF-Edge y PF-Sensores, como SensorChannels.h.
+//
+// Cada parámetro es un entero en 1/escala de su unidad (como los canales);
+// por Telegram se escribe en la unidad ("volt_ajuste 1.02266"). Solo se
+// añaden parámetros al final: el nodo los guarda en NVS en este orden.
+//
+// X(ID, clave, escala, mínimo, máximo, defecto)   mín/máx/defecto en 1/escala
+//   periodo      ms entre lecturas
+//   envio_max    ms máximos sin enviar; 0: se envía cada lectura. Con más
+//                de 0 solo se envía si algún canal cambió al menos su
+//                <clave>_delta desde el último envío (o al cumplirse el
+//                plazo). Ambos < 10 s, el plazo con el que el Edge da por
+//                perdido a un nodo (ESPNowReceiver).
+//   seco/humedo  lecturas ADC del YL69 en suelo seco y saturado
+//   volt_r1/r2   divisor resistivo del sensor de tensión (ohmios)
+//   volt_ajuste  corrección de la referencia del ADC
+//   co2_ganancia/co2_offset  co2 = ADC * ganancia + offset (MQ135)
+#define SENSOR_SETTINGS(X) \
+    X(PERIOD,     "periodo",      1,      500,   8000,    3000) \
+    X(REPORT_MAX, "envio_max",    1,      0,     8000,    0) \
+    X(YL69_DRY,   "seco",         1,      1,     4095,    4095) \
+    X(YL69_WET,   "humedo",       1,      1,     4095,    2200) \
+    X(VOLT_R1,    "volt_r1",      1,      1,     1000000, 30000) \
+    X(VOLT_R2,    "volt_r2",      1,      1,     1000000, 7500) \
+    X(VOLT_GAIN,  "volt_ajuste",  100000, 50000, 200000,  102266) \
+    X(CO2_GAIN,   "co2_ganancia", 1000,   1,     10000,   1000) \
+    X(CO2_OFFSET, "co2_offset",   1,      -4095, 4095,    0)
+
+struct SensorSetting {
+    const char* key;
+    uint32_t scale;
+    int32_t min;
+    int32_t max;
+    int32_t def;
+};
+
+// Tras los de la lista, un <clave>_delta por canal (en su punto fijo)
+enum SensorSettingId : uint8_t {
+#define SENSOR_X_SETTING_ID(ID, key, scale, min, max, def) SETTING_##ID,
+    SENSOR_SETTINGS(SENSOR_X_SETTING_ID)
+#undef SENSOR_X_SETTING_ID
+    SETTING_DELTA_FIRST,
+    SENSOR_SETTING_COUNT = SETTING_DELTA_FIRST + SENSOR_CHANNEL_COUNT
+};
+
+constexpr SensorSetting SENSOR_SETTING_TABLE[SENSOR_SETTING_COUNT] = {
+#define SENSOR_X_SETTING_DESC(ID, key, scale, min, max, def) {key, scale, min, max, def},
+    SENSOR_SETTINGS(SENSOR_X_SETTING_DESC)
+#undef SENSOR_X_SETTING_DESC
+#define SENSOR_X_DELTA_DESC(ID, field, key, emoji, label, unit, wire, scale, decimals) {key "_delta", scale, 0, 65535, 0},
+    SENSOR_CHANNELS(SENSOR_X_DELTA_DESC)
+#undef SENSOR_X_DELTA_DESC
+};
+
+inline int sensorSettingIndex(const char* key) {
+    for (uint8_t i = 0; i < SENSOR_SETTING_COUNT; i++) {
+        if (strcmp(SENSOR_SETTING_TABLE[i].key, key) == 0) return i;
+    }
+    return -1;
+}
+
+inline void sensorSettingDefaults(int32_t* values) {
+    for (uint8_t i = 0; i < SENSOR_SETTING_COUNT; i++) values[i] = SENSOR_SETTING_TABLE[i].def;
+}
+
+// Aplica un cambio si es válido (rango y, para el YL69, seco > húmedo)
+inline bool applySensorSetting(int32_t* values, uint8_t id, int32_t value) {
+    if (id >= SENSOR_SETTING_COUNT) return false;
+    const SensorSetting& s = SENSOR_SETTING_TABLE[id];
+    if (value < s.min || value > s.max) return false;
+    if (id == SETTING_YL69_DRY && value <= values[SETTING_YL69_WET]) return false;
+    if (id == SETTING_YL69_WET && value >= values[SETTING_YL69_DRY]) return false;
+    values[id] = value;
+    return true;
+}
+
+// ¿Hay que enviar esta lectura? last: la última enviada; sinceMs: desde cuándo
+inline bool sensorReportDue(const int32_t* values, const SensorData& last, const SensorData& now, uint32_t sinceMs) {
+    if (values[SETTING_REPORT_MAX] == 0 || sinceMs >= (uint32_t)values[SETTING_REPORT_MAX]) return true;
+    int32_t prev[SENSOR_CHANNEL_COUNT];
+    uint8_t ch = 0;
+    visitSensorChannels(last, [&](const SensorChannel&, int32_t v) { prev[ch++] = v; });
+    bool due = false;
+    ch = 0;
+    visitSensorChannels(now, [&](const SensorChannel& channel, int32_t v) {
+        int32_t delta = values[SETTING_DELTA_FIRST + ch];
+        int32_t diff = v > prev[ch] ? v - prev[ch] : prev[ch] - v;
+        bool gone = (v == channel.noReading) != (prev[ch] == channel.noReading);
+        if (gone || (delta > 0 && diff >= delta)) due = true;
+        ch++;
+    });
+    return due;
+}
+
+// Tramas de configuración Edge <-> nodo sensor. SET lleva solo los
+// parámetros a cambiar (ninguno: solo consulta); el nodo los aplica, los
+// guarda y responde con un ACK del mismo seq que lleva TODOS sus valores
+// actuales: lo que no coincida con lo pedido fue rechazado.
+#define SENSOR_CONFIG_SET 0xC1
+#define SENSOR_CONFIG_ACK 0xC2
+#define SENSOR_CONFIG_MAX_ITEMS 16
+#define SENSOR_CONFIG_SAVE_FAILED 0x01   // flags del ACK: no se pudo escribir en NVS
+
+static_assert(SENSOR_SETTING_COUNT <= SENSOR_CONFIG_MAX_ITEMS, "el ACK no cabe en una trama");
+
+#pragma pack(push, 1)
+struct SettingValue {
+    uint8_t id;
+    int32_t value;
+};
+
+// Solo viajan `count` pares (7 + 5·count bytes)
+struct SensorConfigFrame {
+    uint8_t type = SENSOR_CONFIG_SET;
+    uint16_t layout = SENSOR_LAYOUT_ID;   // los ids dependen del registro de canales
+    uint16_t seq = 0;
+    uint8_t flags = 0;
+    uint8_t count = 0;
+    SettingValue items[SENSOR_CONFIG_MAX_ITEMS];
+
+    int frameLength() const { return 7 + 5 * count; }
+};
+#pragma pack(pop)
+
+inline bool decodeSensorConfig(const uint8_t* data, int len, uint8_t type, SensorConfigFrame& out) {
+    if (len < 7 || data[0] != type) return false;
+    uint8_t count = data[6];
+    if (count > SENSOR_CONFIG_MAX_ITEMS || len != 7 + 5 * count) return false;
+    memcpy(&out, data, len);
+    return out.layout == SENSOR_LAYOUT_ID;
+}
+
+#endif
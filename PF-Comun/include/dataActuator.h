@@ -0,0 +1,86 @@
+#ifndef DATA_ACTUATOR_H
+#define DATA_ACTUATOR_H
+
+#include <cstdint>
+#include <cstring>
+
+// Decisión de control por zona (lo que produce Thresholds::evaluate).
+// Cada campo es un nivel 0-255: 0 = OFF, 255 = ON completo; los valores
+// intermedios son el ciclo de trabajo PWM en los canales que lo admiten.
+struct ActuatorState {
+    uint8_t waterPump = 0;
+    uint8_t fan = 0;
+    uint8_t leds = 0;
+};
+
+// Modelo general de actuadores: cada nodo expone una tabla de canales con
+// id local, tipo de salida, zona y función. Los valores van de 0 a 255
+// (relé: 0 = OFF, cualquier otro = ON).
+enum ActuatorChannelType : uint8_t {
+    CHANNEL_RELAY = 0,
+    CHANNEL_PWM = 1,
+    CHANNEL_LED = 2
+};
+
+enum ActuatorRole : uint8_t {
+    ROLE_PUMP = 0,
+    ROLE_FAN = 1,
+    ROLE_LIGHT = 2,
+    ROLE_VALVE = 3,
+    ROLE_OTHER = 4
+};
+
+#define ACTUATOR_MAX_CHANNELS 16   // canales por nodo actuador (ids 0..15)
+#define ACTUATOR_VALUE_ON 255
+
+struct ActuatorChannel {
+    uint8_t id;
+    ActuatorChannelType type;
+    uint8_t zone;
+    ActuatorRole role;
+};
+
+// Tramas ESP-NOW entre Edge y nodo actuador
+enum ActuatorFrameType : uint8_t {
+    ACTUATOR_FRAME_CMD = 0xA1,   // Edge -> actuador
+    ACTUATOR_FRAME_ACK = 0xA2    // actuador -> Edge, con los valores aplicados
+};
+
+#pragma pack(push, 1)
+struct ChannelValue {
+    uint8_t channel;
+    uint8_t value;
+};
+
+// Lista compacta canal/valor: solo viajan `count` pares (4 + 2·count bytes)
+struct ActuatorCommand {
+    uint8_t type = ACTUATOR_FRAME_CMD;
+    uint16_t seq = 0;
+    uint8_t count = 0;
+    ChannelValue values[ACTUATOR_MAX_CHANNELS];
+
+    int frameLength() const { return 4 + 2 * count; }
+};
+
+// Mismo formato; los valores son los leídos de los pines tras aplicar
+struct ActuatorAck {
+    uint8_t type = ACTUATOR_FRAME_ACK;
+    uint16_t seq = 0;
+    uint8_t count = 0;
+    ChannelValue values[ACTUATOR_MAX_CHANNELS];
+
+    int frameLength() const { return 4 + 2 * count; }
+};
+#pragma pack(pop)
+
+// Decodifica una lista canal/valor recibida (CMD o ACK) sin leer de más
+template <typename T>
+inline bool decodeChannelFrame(const uint8_t* data, int len, uint8_t type, T& out) {
+    if (len < 4 || data[0] != type) return false;
+    uint8_t count = data[3];
+    if (count > ACTUATOR_MAX_CHANNELS || len != 4 + 2 * count) return false;
+    memcpy(&out, data, len);
+    return true;
+}
+
+#endif // DATA_ACTUATOR_H
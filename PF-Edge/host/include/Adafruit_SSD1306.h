@@ -0,0 +1,36 @@
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+// Sustituto de la OLED: el contenido de la página se acumula como texto
+// en `frame`, que el simulador puede volcar.
+
+#include <Arduino.h>
+#include "Wire.h"
+#include "Adafruit_GFX.h"
+
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_WHITE 1
+#define SSD1306_BLACK 0
+
+class Adafruit_SSD1306 {
+public:
+    String frame;
+    String lastFrame;
+
+    Adafruit_SSD1306(uint8_t, uint8_t, TwoWire*, int8_t) {}
+
+    bool begin(uint8_t, uint8_t) { return true; }
+    void clearDisplay() { frame = ""; }
+    void display() { lastFrame = frame; }
+    void setTextSize(uint8_t) {}
+    void setTextColor(uint16_t) {}
+    void setCursor(int16_t, int16_t) {}
+    void drawRect(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+    void fillRect(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+
+    template <typename T> void print(const T& v) { frame += String(v); }
+    template <typename T> void println(const T& v) { frame += String(v); frame += "\n"; }
+    void println() { frame += "\n"; }
+};
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Sustituto de Arduino.h para el entorno `native` (Linux).
+// Solo implementa lo que usa el firmware del Edge: String, tiempo, GPIO,
+// Serial, tareas/mutex de FreeRTOS y la hora NTP.
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// String
+// ---------------------------------------------------------------------------
+class String {
+private:
+    std::string _s;
+
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int v) : _s(std::to_string(v)) {}
+    String(unsigned int v) : _s(std::to_string(v)) {}
+    String(long v) : _s(std::to_string(v)) {}
+    String(unsigned long v) : _s(std::to_string(v)) {}
+    String(long long v) : _s(std::to_string(v)) {}
+    String(unsigned long long v) : _s(std::to_string(v)) {}
+    String(unsigned char v) : _s(std::to_string(v)) {}
+    String(short v) : _s(std::to_string(v)) {}
+    String(unsigned short v) : _s(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+    String(double v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+
+    unsigned int length() const { return (unsigned int)_s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    const char* c_str() const { return _s.c_str(); }
+    const std::string& str() const { return _s; }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+
+    char charAt(unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    int indexOf(char c, unsigned int from = 0) const { return find(_s.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return find(_s.find(s._s, from)); }
+    int indexOf(const char* s, unsigned int from = 0) const { return find(_s.find(s, from)); }
+    int lastIndexOf(char c) const { return find(_s.rfind(c)); }
+
+    String substring(unsigned int from) const {
+        return from >= _s.length() ? String() : String(_s.substr(from));
+    }
+
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= _s.length()) return String();
+        return String(_s.substr(from, to - from));
+    }
+
+    bool startsWith(const String& p) const { return _s.compare(0, p._s.length(), p._s) == 0; }
+    bool endsWith(const String& p) const {
+        return _s.length() >= p._s.length() &&
+               _s.compare(_s.length() - p._s.length(), p._s.length(), p._s) == 0;
+    }
+
+    long toInt() const { return std::strtol(_s.c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(_s.c_str(), nullptr); }
+
+    void trim() {
+        size_t b = _s.find_first_not_of(" \t\r\n");
+        size_t e = _s.find_last_not_of(" \t\r\n");
+        _s = b == std::string::npos ? std::string() : _s.substr(b, e - b + 1);
+    }
+
+    void toLowerCase() { for (auto& c : _s) c = (char)std::tolower((unsigned char)c); }
+    void replace(const String& from, const String& to) {
+        if (from._s.empty()) return;
+        size_t pos = 0;
+        while ((pos = _s.find(from._s, pos)) != std::string::npos) {
+            _s.replace(pos, from._s.length(), to._s);
+            pos += to._s.length();
+        }
+    }
+
+    String& operator+=(const String& o) { _s += o._s; return *this; }
+    String& operator+=(const char* o) { _s += o; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    String& operator+=(int v) { _s += std::to_string(v); return *this; }
+    String& operator+=(unsigned int v) { _s += std::to_string(v); return *this; }
+    String& operator+=(long v) { _s += std::to_string(v); return *this; }
+    String& operator+=(unsigned long v) { _s += std::to_string(v); return *this; }
+    bool concat(const char* s, unsigned int n) { _s.append(s, n); return true; }
+
+    bool operator==(const String& o) const { return _s == o._s; }
+    bool operator==(const char* o) const { return _s == o; }
+    bool operator!=(const String& o) const { return _s != o._s; }
+    bool operator!=(const char* o) const { return _s != o; }
+    bool operator<(const String& o) const { return _s < o._s; }
+
+private:
+    static int find(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+
+    void fromDouble(double v, unsigned int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        _s = buf;
+    }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+
+#define F(s) (s)
+
+// ---------------------------------------------------------------------------
+// Tiempo
+// ---------------------------------------------------------------------------
+namespace HostClock {
+    // "Arranque" del dispositivo: carga del programa
+    inline const std::chrono::steady_clock::time_point boot = std::chrono::steady_clock::now();
+    // Adelanto del reloj (pruebas: minutos simulados sin esperarlos)
+    inline std::atomic<long>& skewMs() { static std::atomic<long> ms{0}; return ms; }
+    inline std::chrono::steady_clock::time_point start() { return boot - std::chrono::milliseconds(skewMs().load()); }
+    inline void advance(unsigned long ms) { skewMs() += (long)ms; }
+}
+
+inline unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - HostClock::start()).count();
+}
+
+inline unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - HostClock::start()).count();
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() { std::this_thread::yield(); }
+
+// random(min, max) de Arduino: entero en [min, max)
+inline long random(long minValue, long maxValue) {
+    static std::mutex m;
+    static std::mt19937 rng(42);
+    std::lock_guard<std::mutex> lock(m);
+    if (maxValue <= minValue) return minValue;
+    return std::uniform_int_distribution<long>(minValue, maxValue - 1)(rng);
+}
+
+// Generador del hardware: distinto en cada arranque
+inline uint32_t esp_random() {
+    static std::mutex m;
+    static std::mt19937 rng(std::random_device{}());
+    std::lock_guard<std::mutex> lock(m);
+    return (uint32_t)rng();
+}
+
+// ---------------------------------------------------------------------------
+// GPIO (sin hardware: se recuerda el último valor escrito)
+// ---------------------------------------------------------------------------
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define LOW 0x0
+#define HIGH 0x1
+
+namespace HostGPIO {
+    inline int* levels() { static int pins[64] = {0}; return pins; }
+}
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < 64 && mode == INPUT_PULLUP) HostGPIO::levels()[pin] = HIGH;
+}
+inline void digitalWrite(uint8_t pin, uint8_t val) { if (pin < 64) HostGPIO::levels()[pin] = val; }
+inline int digitalRead(uint8_t pin) { return pin < 64 ? HostGPIO::levels()[pin] : LOW; }
+inline uint16_t analogRead(uint8_t pin) { return pin < 64 ? (uint16_t)HostGPIO::levels()[pin] : 0; }
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ---------------------------------------------------------------------------
+// IPAddress
+// ---------------------------------------------------------------------------
+class IPAddress {
+public:
+    uint8_t octets[4];
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(buf);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Serial (stdout; el simulador lo puede silenciar)
+// ---------------------------------------------------------------------------
+class HardwareSerial {
+public:
+    bool enabled = true;
+
+    void begin(unsigned long) {}
+
+    // Sin entrada por consola en el host
+    int available() { return 0; }
+    String readStringUntil(char) { return String(); }
+
+    void print(const String& s) { write(s.c_str()); }
+    void print(const char* s) { write(s); }
+    void print(char c) { char b[2] = {c, 0}; write(b); }
+    void print(const IPAddress& ip) { print(ip.toString()); }
+    void print(double v, int decimals = 2) { print(String(v, decimals)); }
+    void print(float v, int decimals = 2) { print(String(v, decimals)); }
+    template <typename T> void print(T v) { print(String(v)); }
+
+    void println() { write("\n"); }
+    template <typename T> void println(const T& v) { print(v); println(); }
+    void println(const char* s) { print(s); println(); }
+    void println(double v, int decimals) { print(v, decimals); println(); }
+
+    template <typename... Args> void printf(const char* fmt, Args... args) {
+        if (!enabled) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::printf(fmt, args...);
+    }
+
+private:
+    std::mutex _mutex;
+
+    void write(const char* s) {
+        if (!enabled) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::fputs(s, stdout);
+    }
+};
+
+inline HardwareSerial Serial;
+
+// ---------------------------------------------------------------------------
+// FreeRTOS: tareas como hilos, secciones críticas como mutex recursivos
+// ---------------------------------------------------------------------------
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define pdPASS 1
+#define pdTRUE 1
+#define pdFALSE 0
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+struct portMUX_TYPE {
+    std::recursive_mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL(mux) (mux)->m.unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL_ISR(mux) (mux)->m.unlock()
+
+inline BaseType_t xTaskCreatePinnedToCore(void (*fn)(void*), const char*, uint32_t, void* param,
+                                          unsigned int, TaskHandle_t* handle, int) {
+    std::thread(fn, param).detach();
+    if (handle) *handle = nullptr;
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(void (*fn)(void*), const char* name, uint32_t stack, void* param,
+                              unsigned int prio, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, param, prio, handle, 0);
+}
+
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+// ---------------------------------------------------------------------------
+// ESP-IDF / hora del sistema
+// ---------------------------------------------------------------------------
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_ESPNOW_NOT_FOUND 0x3069
+
+inline const char* esp_err_to_name(esp_err_t err) {
+    return err == ESP_OK ? "ESP_OK" : (err == ESP_ERR_ESPNOW_NOT_FOUND ? "ESP_ERR_ESPNOW_NOT_FOUND" : "ESP_FAIL");
+}
+
+namespace HostClock {
+    inline long& utcOffset() { static long offset = 0; return offset; }
+}
+
+inline void configTime(long gmtOffset_sec, int daylightOffset_sec, const char*, const char* = nullptr, const char* = nullptr) {
+    HostClock::utcOffset() = gmtOffset_sec + daylightOffset_sec;
+}
+
+inline bool getLocalTime(struct tm* info, uint32_t = 5000) {
+    time_t now = time(nullptr) + HostClock::utcOffset();
+    gmtime_r(&now, info);
+    return true;
+}
+
+#endif
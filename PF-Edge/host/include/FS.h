@@ -0,0 +1,167 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// Sustituto de FS.h: File sobre stdio y std::filesystem. Las rutas del
+// firmware ("/2025-01-01/10/data.csv") se resuelven dentro de un
+// directorio raíz del host.
+
+#include <Arduino.h>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace fs {
+
+class File {
+public:
+    File() {}
+
+    File(const std::string& hostPath, const std::string& name, const char* mode) : _name(name) {
+        if (std::filesystem::is_directory(hostPath)) {
+            _isDir = true;
+            for (auto& e : std::filesystem::directory_iterator(hostPath)) {
+                _entries.push_back(e.path().filename().string());
+            }
+            std::sort(_entries.begin(), _entries.end());
+            _hostPath = hostPath;
+            return;
+        }
+        // "w" en Arduino crea/trunca; "a" añade; "r" solo lectura; "r+" lee y
+        // escribe en el sitio
+        std::string m = mode;
+        if (m == "r") m = "rb";
+        else if (m == "w") m = "w+b";
+        else if (m == "a") m = "a+b";
+        else if (m == "r+") m = "r+b";
+        FILE* f = fopen(hostPath.c_str(), m.c_str());
+        if (f) {
+            _fp = std::shared_ptr<FILE>(f, fclose);
+            _hostPath = hostPath;
+        }
+    }
+
+    explicit operator bool() const { return _fp != nullptr || _isDir; }
+
+    size_t write(const uint8_t* buf, size_t len) { return _fp ? fwrite(buf, 1, len, _fp.get()) : 0; }
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    template <typename T> size_t print(T v) { return print(String(v)); }
+    size_t println() { return print("\r\n"); }
+    template <typename T> size_t println(const T& v) { return print(v) + println(); }
+    size_t println(const char* s) { return print(s) + println(); }
+
+    int read() {
+        if (!_fp) return -1;
+        int c = fgetc(_fp.get());
+        return c == EOF ? -1 : c;
+    }
+
+    size_t read(uint8_t* buf, size_t len) { return _fp ? fread(buf, 1, len, _fp.get()) : 0; }
+
+    String readStringUntil(char terminator) {
+        String s;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) s += (char)c;
+        return s;
+    }
+
+    int available() {
+        if (!_fp) return 0;
+        long pos = ftell(_fp.get());
+        return (int)(size() - (size_t)pos);
+    }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        return _fp && fseek(_fp.get(), (long)pos, mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END)) == 0;
+    }
+
+    size_t position() const { return _fp ? (size_t)ftell(_fp.get()) : 0; }
+
+    size_t size() const {
+        if (!_fp) return 0;
+        fflush(_fp.get());
+        std::error_code ec;
+        auto s = std::filesystem::file_size(_hostPath, ec);
+        return ec ? 0 : (size_t)s;
+    }
+
+    void flush() { if (_fp) fflush(_fp.get()); }
+    void close() { _fp.reset(); _isDir = false; _entries.clear(); }
+
+    const char* name() const {
+        size_t slash = _name.find_last_of('/');
+        return slash == std::string::npos ? _name.c_str() : _name.c_str() + slash + 1;
+    }
+    const char* path() const { return _name.c_str(); }
+    bool isDirectory() const { return _isDir; }
+
+    File openNextFile(const char* mode = FILE_READ) {
+        if (!_isDir || _next >= _entries.size()) return File();
+        const std::string& entry = _entries[_next++];
+        std::string child = (_name == "/" ? "" : _name) + "/" + entry;
+        return File(_hostPath + "/" + entry, child, mode);
+    }
+
+    void rewindDirectory() { _next = 0; }
+
+private:
+    std::shared_ptr<FILE> _fp;
+    std::string _hostPath;
+    std::string _name;
+    bool _isDir = false;
+    std::vector<std::string> _entries;
+    size_t _next = 0;
+};
+
+class FS {
+public:
+    // Directorio del host que hace de raíz de la tarjeta
+    std::string root = "sim_sd";
+
+    File open(const String& path, const char* mode = FILE_READ) {
+        std::string host = hostPath(path);
+        if (std::string(mode) == "r" && !std::filesystem::exists(host)) return File();
+        return File(host, path.str(), mode);
+    }
+
+    bool exists(const String& path) { return std::filesystem::exists(hostPath(path)); }
+    bool mkdir(const String& path) {
+        std::error_code ec;
+        return std::filesystem::create_directory(hostPath(path), ec) || std::filesystem::is_directory(hostPath(path));
+    }
+    bool remove(const String& path) {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(hostPath(path)) && std::filesystem::remove(hostPath(path), ec);
+    }
+    bool rmdir(const String& path) {
+        std::error_code ec;
+        return std::filesystem::is_directory(hostPath(path)) && std::filesystem::remove(hostPath(path), ec);
+    }
+    bool rename(const String& from, const String& to) {
+        std::error_code ec;
+        std::filesystem::rename(hostPath(from), hostPath(to), ec);
+        return !ec;
+    }
+
+protected:
+    std::string hostPath(const String& path) const {
+        std::string p = path.str();
+        if (p.empty() || p[0] != '/') p = "/" + p;
+        return root + (p == "/" ? "" : p);
+    }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
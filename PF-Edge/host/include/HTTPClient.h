@@ -0,0 +1,104 @@
+#ifndef HOST_HTTP_CLIENT_H
+#define HOST_HTTP_CLIENT_H
+
+// Sustituto de HTTPClient.h. No hay red: cada petición se resuelve con
+// HostHttp::handler, que por defecto imita a la API de Telegram
+// (sendMessage se imprime/cuenta y getUpdates entrega los comandos que el
+// simulador haya encolado con HostHttp::pushCommand()).
+
+#include <Arduino.h>
+#include <deque>
+#include <functional>
+#include "WiFiClientSecure.h"
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED -1
+
+namespace HostHttp {
+    using Handler = std::function<int(const String& method, const String& url, const String& body, String& response)>;
+
+    struct State {
+        std::mutex mutex;
+        std::deque<String> commands;
+        long nextUpdateId = 1;
+        unsigned long sent = 0;
+        unsigned long polled = 0;
+        bool echo = true;
+        Handler handler;
+    };
+
+    inline State& state() { static State s; return s; }
+
+    inline void pushCommand(const String& text) {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        state().commands.push_back(text);
+    }
+
+    inline String urldecode(const String& in) {
+        String out;
+        for (unsigned int i = 0; i < in.length(); i++) {
+            char c = in.charAt(i);
+            if (c == '%' && i + 2 < in.length()) {
+                char hex[3] = {in.charAt(i + 1), in.charAt(i + 2), 0};
+                out += (char)strtol(hex, nullptr, 16);
+                i += 2;
+            } else {
+                out += c == '+' ? ' ' : c;
+            }
+        }
+        return out;
+    }
+
+    inline int telegram(const String& method, const String& url, const String& body, String& response) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (url.indexOf("/sendMessage") >= 0) {
+            s.sent++;
+            if (s.echo) {
+                int t = body.indexOf("&text=");
+                printf("[telegram] %s\n", urldecode(t >= 0 ? body.substring(t + 6) : body).c_str());
+            }
+            response = "{\"ok\":true}";
+            return 200;
+        }
+        if (url.indexOf("/getUpdates") >= 0) {
+            s.polled++;
+            if (s.commands.empty()) {
+                response = "{\"ok\":true,\"result\":[]}";
+                return 200;
+            }
+            String text = s.commands.front();
+            s.commands.pop_front();
+            response = "{\"ok\":true,\"result\":[{\"update_id\":" + String(s.nextUpdateId++) +
+                       ",\"message\":{\"message_id\":1,\"chat\":{\"id\":1},\"text\":\"" + text + "\"}}]}";
+            return 200;
+        }
+        (void)method;
+        return 404;
+    }
+}
+
+class HTTPClient {
+public:
+    bool begin(WiFiClient&, const String& url) { _url = url; return true; }
+    bool begin(const String& url) { _url = url; return true; }
+    void addHeader(const String&, const String&) {}
+    void setTimeout(uint16_t) {}
+
+    int GET() { return request("GET", ""); }
+    int POST(const String& body) { return request("POST", body); }
+    String getString() { return _response; }
+    void end() {}
+
+private:
+    String _url;
+    String _response;
+
+    int request(const char* method, const String& body) {
+        if (WiFi.status() != WL_CONNECTED) return HTTPC_ERROR_CONNECTION_REFUSED;
+        HostHttp::Handler h = HostHttp::state().handler;
+        return h ? h(method, _url, body, _response) : HostHttp::telegram(method, _url, body, _response);
+    }
+};
+
+#endif
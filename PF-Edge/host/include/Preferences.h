@@ -0,0 +1,71 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// Sustituto de Preferences (NVS) para el entorno `native`: cada espacio de
+// nombres es un directorio bajo HostNvs::dir() ("sim_nvs") y cada clave un
+// archivo, así la configuración sobrevive entre ejecuciones del simulador.
+// Cuenta las escrituras para poder comprobar el desgaste.
+
+#include <Arduino.h>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace HostNvs {
+    inline std::string& dir() { static std::string d = "sim_nvs"; return d; }
+    inline unsigned long& writes() { static unsigned long n = 0; return n; }
+}
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        _path = HostNvs::dir() + "/" + name;
+        _readOnly = readOnly;
+        if (!readOnly) std::filesystem::create_directories(_path);
+        return true;
+    }
+
+    void end() { _path.clear(); }
+
+    size_t getBytesLength(const char* key) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file(key), ec);
+        return ec ? 0 : (size_t)size;
+    }
+
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        std::ifstream in(file(key), std::ios::binary);
+        if (!in) return 0;
+        in.read((char*)buf, (std::streamsize)maxLen);
+        return (size_t)in.gcount();
+    }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        if (_readOnly || _path.empty()) return 0;
+        std::ofstream out(file(key), std::ios::binary | std::ios::trunc);
+        if (!out) return 0;
+        out.write((const char*)value, (std::streamsize)len);
+        HostNvs::writes()++;
+        return len;
+    }
+
+    bool remove(const char* key) {
+        std::error_code ec;
+        return std::filesystem::remove(file(key), ec);
+    }
+
+    bool clear() {
+        std::error_code ec;
+        std::filesystem::remove_all(_path, ec);
+        std::filesystem::create_directories(_path, ec);
+        return true;
+    }
+
+private:
+    std::string _path;
+    bool _readOnly = false;
+
+    std::string file(const char* key) const { return _path + "/" + key; }
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef HOST_RTC_DS1302_H
+#define HOST_RTC_DS1302_H
+
+// Sustituto del DS1302: la hora es el reloj del host más un desfase que
+// fija SetDateTime(). RtcDateTime guarda segundos Unix.
+
+#include <Arduino.h>
+#include "ThreeWire.h"
+
+class RtcDateTime {
+public:
+    RtcDateTime(uint32_t unixSeconds = 0) : _unix(unixSeconds) {}
+
+    RtcDateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+        struct tm t = {};
+        t.tm_year = year - 1900;
+        t.tm_mon = month - 1;
+        t.tm_mday = day;
+        t.tm_hour = hour;
+        t.tm_min = minute;
+        t.tm_sec = second;
+        _unix = (uint32_t)timegm(&t);
+    }
+
+    // Formato de __DATE__ ("Jan  1 2025") y __TIME__ ("10:00:00")
+    RtcDateTime(const char* date, const char* time) {
+        static const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+        char mon[4] = {date[0], date[1], date[2], 0};
+        int month = (int)(strstr(months, mon) - months) / 3 + 1;
+        *this = RtcDateTime((uint16_t)atoi(date + 7), (uint8_t)month, (uint8_t)atoi(date + 4),
+                            (uint8_t)atoi(time), (uint8_t)atoi(time + 3), (uint8_t)atoi(time + 6));
+    }
+
+    uint16_t Year() const { return (uint16_t)(parts().tm_year + 1900); }
+    uint8_t Month() const { return (uint8_t)(parts().tm_mon + 1); }
+    uint8_t Day() const { return (uint8_t)parts().tm_mday; }
+    uint8_t Hour() const { return (uint8_t)parts().tm_hour; }
+    uint8_t Minute() const { return (uint8_t)parts().tm_min; }
+    uint8_t Second() const { return (uint8_t)parts().tm_sec; }
+    uint8_t DayOfWeek() const { return (uint8_t)parts().tm_wday; }
+
+    bool IsValid() const { return _unix >= 946684800u; }  // >= 2000-01-01
+    uint32_t Unix32Time() const { return _unix; }
+    void InitWithUnix32Time(uint32_t unixSeconds) { _unix = unixSeconds; }
+    uint32_t TotalSeconds() const { return _unix - 946684800u; }  // época 2000
+
+    bool operator<(const RtcDateTime& o) const { return _unix < o._unix; }
+    bool operator==(const RtcDateTime& o) const { return _unix == o._unix; }
+
+private:
+    uint32_t _unix;
+
+    struct tm parts() const {
+        time_t t = (time_t)_unix;
+        struct tm out;
+        gmtime_r(&t, &out);
+        return out;
+    }
+};
+
+template <typename T_WIRE_METHOD>
+class RtcDS1302 {
+public:
+    RtcDS1302(T_WIRE_METHOD&) {}
+
+    void Begin() {}
+    bool GetIsWriteProtected() { return false; }
+    void SetIsWriteProtected(bool) {}
+    bool GetIsRunning() { return true; }
+    void SetIsRunning(bool) {}
+    bool IsDateTimeValid() { return _set; }
+
+    RtcDateTime GetDateTime() {
+        return RtcDateTime((uint32_t)(time(nullptr) + _offset));
+    }
+
+    void SetDateTime(const RtcDateTime& dt) {
+        _offset = (long)dt.Unix32Time() - (long)time(nullptr);
+        _set = true;
+    }
+
+private:
+    long _offset = 0;
+    bool _set = false;
+};
+
+#endif
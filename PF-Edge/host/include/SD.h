@@ -0,0 +1,37 @@
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+// Sustituto de SD.h: la tarjeta es un directorio del host (HostSD).
+// La capacidad es configurable para simular una tarjeta llena.
+
+#include "FS.h"
+
+class SDFS : public fs::FS {
+public:
+    uint64_t capacityBytes = 4ULL * 1024 * 1024 * 1024;
+    bool present = true;
+
+    bool begin(uint8_t = 5) {
+        if (!present) return false;
+        std::error_code ec;
+        std::filesystem::create_directories(root, ec);
+        return !ec;
+    }
+
+    void end() {}
+
+    uint64_t totalBytes() { return capacityBytes; }
+
+    uint64_t usedBytes() {
+        uint64_t used = 0;
+        std::error_code ec;
+        for (auto& e : std::filesystem::recursive_directory_iterator(root, ec)) {
+            if (e.is_regular_file()) used += e.file_size();
+        }
+        return used;
+    }
+};
+
+inline SDFS SD;
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_THREE_WIRE_H
+#define HOST_THREE_WIRE_H
+
+#include <Arduino.h>
+
+class ThreeWire {
+public:
+    ThreeWire(uint8_t, uint8_t, uint8_t) {}
+    void begin() {}
+};
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// Sustituto de WiFi.h: una estación y un AP simulado. begin() asocia tras
+// HOST_WIFI_CONNECT_MS (si el AP está disponible y el canal indicado, si
+// lo hay, coincide) y avisa con los eventos de Arduino, como el ESP32.
+// El simulador puede cambiar disponibilidad, canal y RSSI en caliente.
+
+#include <Arduino.h>
+#include <atomic>
+#include <vector>
+
+#define HOST_WIFI_CONNECT_MS 300
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+    ARDUINO_EVENT_MAX = 64
+} arduino_event_id_t;
+
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+
+class WiFiClass {
+public:
+    // Parámetros del AP simulado
+    std::atomic<bool> apAvailable{true};
+    std::atomic<int> apChannel{2};
+    std::atomic<int> apRSSI{-55};
+
+    bool mode(wifi_mode_t m) { _mode = m; return true; }
+    bool setAutoReconnect(bool) { return true; }
+
+    void onEvent(WiFiEventCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _handlers.push_back({cb, event});
+    }
+
+    wl_status_t begin(const char* ssid, const char* = nullptr, int32_t channel = 0) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _ssid = ssid ? ssid : "";
+        _status = WL_DISCONNECTED;
+        unsigned attempt = ++_attempt;
+        std::thread([this, attempt, channel] {
+            delay(HOST_WIFI_CONNECT_MS);
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            if (attempt != _attempt) return;   // cancelado por disconnect()/begin()
+            bool ok = apAvailable && (channel == 0 || channel == apChannel);
+            _status = ok ? WL_CONNECTED : WL_NO_SSID_AVAIL;
+            fire(ok ? ARDUINO_EVENT_WIFI_STA_GOT_IP : ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+        }).detach();
+        return WL_DISCONNECTED;
+    }
+
+    wl_status_t status() {
+        if (_status == WL_CONNECTED && !apAvailable) _status = WL_CONNECTION_LOST;
+        return _status;
+    }
+
+    bool disconnect(bool = false) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        ++_attempt;
+        _status = WL_DISCONNECTED;
+        return true;
+    }
+
+    // Cae o vuelve el AP (el simulador); al caer se avisa como en el ESP32
+    void setApAvailable(bool available) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        apAvailable = available;
+        if (!available && _status == WL_CONNECTED) {
+            _status = WL_CONNECTION_LOST;
+            fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+        }
+    }
+
+    String SSID() { return status() == WL_CONNECTED ? String(_ssid.c_str()) : String(); }
+    int channel() { return apChannel; }
+    int RSSI() { return status() == WL_CONNECTED ? (int)apRSSI : 0; }
+    IPAddress localIP() { return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress(); }
+    String macAddress() { return String("E8:6B:EA:DF:21:0C"); }
+
+private:
+    struct Handler {
+        WiFiEventCb cb;
+        arduino_event_id_t event;
+    };
+
+    wifi_mode_t _mode = WIFI_OFF;
+    std::atomic<wl_status_t> _status{WL_IDLE_STATUS};
+    std::string _ssid;
+    std::recursive_mutex _mutex;
+    std::vector<Handler> _handlers;
+    unsigned _attempt = 0;
+
+    void fire(arduino_event_id_t event) {
+        for (const Handler& h : _handlers) {
+            if (h.event == ARDUINO_EVENT_MAX || h.event == event) h.cb(event);
+        }
+    }
+};
+
+inline WiFiClass WiFi;
+
+// Como en el core del ESP32, WiFi.h trae también cliente y servidor TCP
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+
+#endif
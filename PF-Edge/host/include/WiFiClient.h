@@ -0,0 +1,91 @@
+#ifndef HOST_WIFI_CLIENT_H
+#define HOST_WIFI_CLIENT_H
+
+// Sustituto de WiFiClient sobre un socket TCP del host (lo usa el servidor
+// HTTP local para poder probarlo con curl). Como en el ESP32, las copias
+// comparten el socket; stop() lo cierra. La lectura no bloquea; la
+// escritura sí, hasta enviarlo todo.
+
+#include <Arduino.h>
+#include <errno.h>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class WiFiClient {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : _fd(std::make_shared<Socket>(fd)) {}
+    virtual ~WiFiClient() {}
+
+    void setTimeout(uint32_t) {}
+    void setNoDelay(bool noDelay) {
+        int v = noDelay ? 1 : 0;
+        if (_fd) setsockopt(_fd->fd, IPPROTO_TCP, TCP_NODELAY, &v, sizeof(v));
+    }
+
+    // Conectado mientras el otro extremo no cierre o queden datos por leer
+    uint8_t connected() {
+        if (!_fd || _fd->fd < 0) return 0;
+        char c;
+        ssize_t n = recv(_fd->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n > 0) return 1;
+        if (n == 0) return 0;
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 1 : 0;
+    }
+
+    int available() {
+        int n = 0;
+        if (!_fd || _fd->fd < 0 || ioctl(_fd->fd, FIONREAD, &n) < 0) return 0;
+        return n;
+    }
+
+    int read() {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    int read(uint8_t* buf, size_t len) {
+        if (!_fd || _fd->fd < 0) return -1;
+        ssize_t n = recv(_fd->fd, buf, len, MSG_DONTWAIT);
+        return n < 0 ? -1 : (int)n;
+    }
+
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!_fd || _fd->fd < 0) return 0;
+        size_t sent = 0;
+        while (sent < len) {
+            ssize_t n = send(_fd->fd, buf + sent, len - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += (size_t)n;
+        }
+        return sent;
+    }
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+
+    void stop() {
+        if (_fd) _fd->close();
+    }
+
+    explicit operator bool() const { return _fd && _fd->fd >= 0; }
+    int fd() const { return _fd ? _fd->fd : -1; }
+
+private:
+    struct Socket {
+        int fd;
+        explicit Socket(int f) : fd(f) {}
+        ~Socket() { close(); }
+        void close() {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    };
+    std::shared_ptr<Socket> _fd;
+};
+
+#endif
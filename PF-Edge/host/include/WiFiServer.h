@@ -0,0 +1,72 @@
+#ifndef HOST_WIFI_SERVER_H
+#define HOST_WIFI_SERVER_H
+
+// Sustituto de WiFiServer: escucha en un puerto TCP del host y available()
+// acepta sin bloquear. Los puertos < 1024 (p. ej. el 80 del firmware) se
+// desplazan a HostNet::port() para no necesitar privilegios. Los sockets
+// aceptados tienen un búfer de envío del tamaño del de lwIP en el ESP32
+// (TCP_SND_BUF), para que un cliente lento se note igual que en la placa.
+
+#include <Arduino.h>
+#include <fcntl.h>
+#include "WiFiClient.h"
+
+namespace HostNet {
+    // Puerto del host para el 80 del firmware (el simulador lo cambia con --http-port)
+    inline int& port() { static int p = 8080; return p; }
+}
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port = 80, uint8_t maxClients = 4) : _port(port), _maxClients(maxClients) {}
+    ~WiFiServer() { end(); }
+
+    void begin(uint16_t port = 0) {
+        if (port) _port = port;
+        uint16_t hostPort = _port < 1024 ? (uint16_t)HostNet::port() : _port;
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (_fd < 0) return;
+        int one = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(hostPort);
+        if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(_fd, _maxClients) < 0) {
+            Serial.println("❌ WiFiServer: no se pudo abrir el puerto " + String(hostPort));
+            end();
+            return;
+        }
+        fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+        Serial.println("🌐 WiFiServer (host) en http://127.0.0.1:" + String(hostPort));
+    }
+
+    void setNoDelay(bool noDelay) { _noDelay = noDelay; }
+
+    WiFiClient available() {
+        if (_fd < 0) return WiFiClient();
+        int fd = ::accept(_fd, nullptr, nullptr);
+        if (fd < 0) return WiFiClient();
+        int sndbuf = 5744;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        WiFiClient client(fd);
+        client.setNoDelay(_noDelay);
+        return client;
+    }
+    WiFiClient accept() { return available(); }
+
+    void end() {
+        if (_fd >= 0) ::close(_fd);
+        _fd = -1;
+    }
+
+    explicit operator bool() const { return _fd >= 0; }
+
+private:
+    uint16_t _port;
+    uint8_t _maxClients;
+    int _fd = -1;
+    bool _noDelay = false;
+};
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef HOST_ESP_NOW_H
+#define HOST_ESP_NOW_H
+
+// Sustituto de esp_now.h: un "aire" en memoria. El Edge es el dispositivo
+// local; los nodos simulados se conectan con HostRadio::attach() y emiten
+// tramas con HostRadio::inject(). Los envíos del Edge se entregan desde un
+// hilo propio (como la tarea WiFi del ESP32) y todos los callbacks se
+// serializan con el mismo mutex.
+
+#include <Arduino.h>
+#include <functional>
+#include <map>
+#include <array>
+#include <random>
+#include <deque>
+#include <vector>
+#include <condition_variable>
+#include "esp_wifi.h"
+
+#define ESP_NOW_ETH_ALEN 6
+#define ESP_NOW_MAX_DATA_LEN 250
+
+typedef enum { ESP_NOW_SEND_SUCCESS = 0, ESP_NOW_SEND_FAIL } esp_now_send_status_t;
+
+typedef struct {
+    uint8_t peer_addr[ESP_NOW_ETH_ALEN];
+    uint8_t lmk[16];
+    uint8_t channel;
+    wifi_interface_t ifidx;
+    bool encrypt;
+    void* priv;
+} esp_now_peer_info_t;
+
+typedef void (*esp_now_recv_cb_t)(const uint8_t* mac, const uint8_t* data, int len);
+typedef void (*esp_now_send_cb_t)(const uint8_t* mac, esp_now_send_status_t status);
+
+namespace HostRadio {
+    using Mac = std::array<uint8_t, 6>;
+    using Handler = std::function<void(const uint8_t* src, const uint8_t* data, int len)>;
+
+    struct Frame {
+        Mac dst;
+        std::vector<uint8_t> data;
+    };
+
+    struct Air {
+        std::recursive_mutex mutex;      // serializa callbacks
+        std::mutex queueMutex;           // cola de salida y tabla de peers
+        std::condition_variable queueCv;
+        std::deque<Frame> queue;
+        bool dispatcherStarted = false;
+        esp_now_recv_cb_t recvCb = nullptr;
+        esp_now_send_cb_t sendCb = nullptr;
+        std::map<Mac, Handler> devices;
+        std::map<Mac, bool> peers;
+        float lossRate = 0.0f;
+        std::mt19937 rng{1234};
+        unsigned long framesOut = 0;
+        unsigned long framesIn = 0;
+        unsigned long bytesOut = 0;
+    };
+
+    inline Air& air() { static Air a; return a; }
+
+    inline Mac toMac(const uint8_t* m) { Mac r; memcpy(r.data(), m, 6); return r; }
+
+    inline bool lost() {
+        Air& a = air();
+        if (a.lossRate <= 0.0f) return false;
+        return std::uniform_real_distribution<float>(0.0f, 1.0f)(a.rng) < a.lossRate;
+    }
+
+    // Registra un nodo simulado que recibe lo que el Edge le envía
+    inline void attach(const uint8_t mac[6], Handler h) {
+        std::lock_guard<std::recursive_mutex> lock(air().mutex);
+        air().devices[toMac(mac)] = std::move(h);
+    }
+
+    // Trama de un nodo simulado hacia el Edge, recibida con `rssi` dBm
+    inline bool inject(const uint8_t src[6], const uint8_t* data, int len, int8_t rssi = -60) {
+        std::lock_guard<std::recursive_mutex> lock(air().mutex);
+        if (lost() || !air().recvCb) return false;
+        if (promiscuous() && promiscuousCb()) {
+            wifi_promiscuous_pkt_t pkt = {};
+            static const uint8_t action[] = {127, 0x18, 0xFE, 0x34};   // acción de Espressif
+            pkt.rx_ctrl.rssi = rssi;
+            pkt.rx_ctrl.sig_len = sizeof(pkt.payload);
+            pkt.payload[0] = 0xD0;
+            memcpy(pkt.payload + 10, src, 6);
+            memcpy(pkt.payload + 24, action, sizeof(action));
+            promiscuousCb()(&pkt, WIFI_PKT_MGMT);
+        }
+        air().framesIn++;
+        air().recvCb(src, data, len);
+        return true;
+    }
+
+    inline void setLossRate(float p) {
+        std::lock_guard<std::recursive_mutex> lock(air().mutex);
+        air().lossRate = p;
+    }
+}
+
+inline esp_err_t esp_now_init() { return ESP_OK; }
+inline esp_err_t esp_now_deinit() { return ESP_OK; }
+
+inline esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+    std::lock_guard<std::recursive_mutex> lock(HostRadio::air().mutex);
+    HostRadio::air().recvCb = cb;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) {
+    std::lock_guard<std::recursive_mutex> lock(HostRadio::air().mutex);
+    HostRadio::air().sendCb = cb;
+    return ESP_OK;
+}
+
+inline bool esp_now_is_peer_exist(const uint8_t* mac) {
+    std::lock_guard<std::mutex> lock(HostRadio::air().queueMutex);
+    return HostRadio::air().peers.count(HostRadio::toMac(mac)) > 0;
+}
+
+inline esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer) {
+    std::lock_guard<std::mutex> lock(HostRadio::air().queueMutex);
+    HostRadio::air().peers[HostRadio::toMac(peer->peer_addr)] = true;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_now_del_peer(const uint8_t* mac) {
+    std::lock_guard<std::mutex> lock(HostRadio::air().queueMutex);
+    HostRadio::air().peers.erase(HostRadio::toMac(mac));
+    return ESP_OK;
+}
+
+namespace HostRadio {
+    inline const Mac& broadcastMac() {
+        static const Mac b = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        return b;
+    }
+
+    inline const uint8_t* edgeMac() {
+        static const uint8_t self[6] = {0xE8, 0x6B, 0xEA, 0xDF, 0x21, 0x0C};
+        return self;
+    }
+
+    inline void deliver(const Frame& f) {
+        std::lock_guard<std::recursive_mutex> lock(air().mutex);
+        bool delivered = false;
+        for (auto& dev : air().devices) {
+            if (f.dst != broadcastMac() && dev.first != f.dst) continue;
+            if (lost()) continue;
+            dev.second(edgeMac(), f.data.data(), (int)f.data.size());
+            delivered = true;
+        }
+        if (air().sendCb) {
+            air().sendCb(f.dst.data(), delivered || f.dst == broadcastMac() ? ESP_NOW_SEND_SUCCESS : ESP_NOW_SEND_FAIL);
+        }
+    }
+
+    inline void dispatcher() {
+        Air& a = air();
+        while (true) {
+            Frame f;
+            {
+                std::unique_lock<std::mutex> lock(a.queueMutex);
+                a.queueCv.wait(lock, [&] { return !a.queue.empty(); });
+                f = std::move(a.queue.front());
+                a.queue.pop_front();
+            }
+            deliver(f);
+        }
+    }
+}
+
+inline esp_err_t esp_now_send(const uint8_t* mac, const uint8_t* data, size_t len) {
+    using namespace HostRadio;
+    Air& a = air();
+    Mac dst = toMac(mac);
+    if (len > ESP_NOW_MAX_DATA_LEN) return ESP_FAIL;
+
+    std::lock_guard<std::mutex> lock(a.queueMutex);
+    if (dst != broadcastMac() && !a.peers.count(dst)) return ESP_ERR_ESPNOW_NOT_FOUND;
+    if (!a.dispatcherStarted) {
+        std::thread(dispatcher).detach();
+        a.dispatcherStarted = true;
+    }
+    a.framesOut++;
+    a.bytesOut += len;
+    a.queue.push_back(Frame{dst, std::vector<uint8_t>(data, data + len)});
+    a.queueCv.notify_one();
+    return ESP_OK;
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef HOST_ESP_WIFI_H
+#define HOST_ESP_WIFI_H
+
+#include <Arduino.h>
+#include "WiFi.h"
+
+typedef enum { WIFI_SECOND_CHAN_NONE = 0, WIFI_SECOND_CHAN_ABOVE, WIFI_SECOND_CHAN_BELOW } wifi_second_chan_t;
+typedef enum { WIFI_IF_STA = 0, WIFI_IF_AP = 1 } wifi_interface_t;
+
+// Modo promiscuo: HostRadio::inject() pasa cada trama por aquí como una
+// trama de acción ESP-NOW con el RSSI del nodo simulado
+typedef struct { uint32_t filter_mask; } wifi_promiscuous_filter_t;
+#define WIFI_PROMIS_FILTER_MASK_MGMT (1 << 0)
+typedef enum { WIFI_PKT_MGMT, WIFI_PKT_CTRL, WIFI_PKT_DATA, WIFI_PKT_MISC } wifi_promiscuous_pkt_type_t;
+typedef struct { signed rssi : 8; unsigned sig_len : 12; } wifi_pkt_rx_ctrl_t;
+typedef struct {
+    wifi_pkt_rx_ctrl_t rx_ctrl;
+    uint8_t payload[32];   // cabecera 802.11 (addr2 en el byte 10) y cuerpo de la acción
+} wifi_promiscuous_pkt_t;
+typedef void (*wifi_promiscuous_cb_t)(void* buf, wifi_promiscuous_pkt_type_t type);
+
+namespace HostRadio {
+    inline uint8_t& localChannel() { static uint8_t ch = 1; return ch; }
+    inline bool& promiscuous() { static bool on = false; return on; }
+    inline wifi_promiscuous_cb_t& promiscuousCb() { static wifi_promiscuous_cb_t cb = nullptr; return cb; }
+    inline int8_t& txPowerQdbm() { static int8_t p = 80; return p; }
+}
+
+inline esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t) {
+    HostRadio::localChannel() = primary;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_wifi_get_channel(uint8_t* primary, wifi_second_chan_t* second) {
+    if (primary) *primary = HostRadio::localChannel();
+    if (second) *second = WIFI_SECOND_CHAN_NONE;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_wifi_set_max_tx_power(int8_t power) {
+    HostRadio::txPowerQdbm() = power;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_wifi_get_max_tx_power(int8_t* power) {
+    *power = HostRadio::txPowerQdbm();
+    return ESP_OK;
+}
+
+inline esp_err_t esp_wifi_get_mac(wifi_interface_t, uint8_t mac[6]) {
+    static const uint8_t self[6] = {0xE8, 0x6B, 0xEA, 0xDF, 0x21, 0x0C};
+    memcpy(mac, self, 6);
+    return ESP_OK;
+}
+
+inline esp_err_t esp_wifi_set_promiscuous(bool enable) {
+    HostRadio::promiscuous() = enable;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_wifi_set_promiscuous_filter(const wifi_promiscuous_filter_t*) { return ESP_OK; }
+
+inline esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t cb) {
+    HostRadio::promiscuousCb() = cb;
+    return ESP_OK;
+}
+
+#endif
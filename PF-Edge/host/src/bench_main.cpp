@@ -0,0 +1,324 @@
+// Benchmarks del camino por paquete del Edge (entorno `native_bench`).
+//
+// Mide ns/op y asignaciones de heap/op de cada etapa, con una muestra
+// suelta y con ráfagas de varios nodos. La salida --json (una línea JSON
+// por caso) se puede guardar como referencia y comparar después:
+//
+//   pio run -e native_bench
+//   .pio/build/native_bench/program --json > bench_baseline.json
+//   .pio/build/native_bench/program --baseline bench_baseline.json --tolerance 0.15
+//
+// Con --baseline el programa termina con código 2 si algún caso es más
+// lento que la referencia más la tolerancia o asigna más memoria.
+
+#include <Arduino.h>
+#include <atomic>
+#include <fstream>
+#include <new>
+#include <vector>
+#include "dataSensor.h"
+#include "dataActuator.h"
+#include "ESPNowReceiver.h"
+#include "ThresholdsController.h"
+#include "SensorQuality.h"
+#include "ZoneFusion.h"
+#include "SDLogger.h"
+#include "TelegramBot.h"
+
+// ---------------------------------------------------------------------------
+// Contador de asignaciones
+// ---------------------------------------------------------------------------
+static std::atomic<uint64_t> g_allocs{0};
+
+void* operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+template <typename T> inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp;
+    double allocsPerOp;
+    uint64_t ops;
+};
+
+struct BenchOptions {
+    unsigned long minMs = 200;
+    bool json = false;
+    std::string filter;
+    std::string baseline;
+    double tolerance = 0.15;
+};
+
+BenchOptions options;
+std::vector<BenchResult> results;
+
+// Ejecuta fn (que procesa `opsPerCall` operaciones) hasta cubrir minMs
+template <typename F> void bench(const std::string& name, unsigned opsPerCall, F&& fn) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+    for (int i = 0; i < 100; i++) fn();  // calentamiento
+
+    uint64_t calls = 0;
+    uint64_t batch = 64;
+    uint64_t allocsBefore = g_allocs.load();
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::nanoseconds(0);
+    while (elapsed < std::chrono::milliseconds(options.minMs)) {
+        for (uint64_t i = 0; i < batch; i++) fn();
+        calls += batch;
+        batch *= 2;
+        elapsed = std::chrono::steady_clock::now() - start;
+    }
+    uint64_t allocs = g_allocs.load() - allocsBefore;
+    uint64_t ops = calls * opsPerCall;
+
+    results.push_back({name, (double)elapsed.count() / ops, (double)allocs / ops, ops});
+}
+
+// ---------------------------------------------------------------------------
+// Datos de entrada
+// ---------------------------------------------------------------------------
+constexpr int BURST_NODES = 8;
+
+SensorData sample(int node, int i) {
+    SensorData d;
+    d.temperature = (int16_t)(2200 + (node * 7 + i) % 100 * 10);     // centésimas de °C
+    d.humidity = (uint16_t)(5500 + node % 10 * 100);
+    d.light = (uint16_t)(200 + (node * 37 + i * 13) % 900);
+    d.co2ppm = (uint16_t)(500 + (node * 91 + i * 17) % 600);
+    d.soilMoisture = (uint16_t)(3500 + (node * 11 + i * 3) % 50 * 100);
+    d.voltage = (uint16_t)(5500 + node % 4 * 500);                    // mV
+    return d;
+}
+
+std::vector<SensorData> burst() {
+    std::vector<SensorData> v;
+    for (int n = 0; n < BURST_NODES; n++) v.push_back(sample(n, n));
+    return v;
+}
+
+String updatesResponse(int updateId, const char* text) {
+    return String("{\"ok\":true,\"result\":[{\"update_id\":") + String(updateId) +
+           ",\n\"message\":{\"message_id\":812,\"from\":{\"id\":5152788448,\"is_bot\":false,"
+           "\"first_name\":\"Jose\",\"language_code\":\"es\"},\"chat\":{\"id\":5152788448,"
+           "\"first_name\":\"Jose\",\"type\":\"private\"},\"date\":1718000000,\"text\":\"" +
+           text + "\",\"entities\":[{\"offset\":0,\"length\":7,\"type\":\"bot_command\"}]}}]}";
+}
+
+void registerBenchmarks() {
+    const SensorData one = sample(0, 0);
+    const std::vector<SensorData> many = burst();
+    std::vector<std::vector<uint8_t>> frames;
+    for (auto& d : many) {
+        SensorFrame f = encodeSensorFrame(d);
+        const uint8_t* p = (const uint8_t*)&f;
+        frames.emplace_back(p, p + sizeof(f));
+    }
+
+    bench("encode/single", 1, [&] {
+        SensorFrame f = encodeSensorFrame(one);
+        doNotOptimize(f);
+    });
+    bench("decode/single", 1, [&] {
+        SensorData d;
+        ESPNowReceiver::decode(frames[0].data(), (int)frames[0].size(), d);
+        doNotOptimize(d);
+    });
+    bench("decode/burst8", BURST_NODES, [&] {
+        for (auto& f : frames) {
+            SensorData d;
+            ESPNowReceiver::decode(f.data(), (int)f.size(), d);
+            doNotOptimize(d);
+        }
+    });
+
+    // Etapa de calidad: una MAC por nodo, reloj que avanza como en el Edge
+    SensorQuality quality;
+    unsigned long qualityMs = 0;
+    bench("quality/single", 1, [&] {
+        static const uint8_t mac[6] = {0x24, 0x6F, 0x28, 0, 0, 1};
+        SampleQuality q = quality.check(mac, one, qualityMs += 3000);
+        doNotOptimize(q);
+    });
+    bench("quality/burst8", BURST_NODES, [&] {
+        uint8_t mac[6] = {0x24, 0x6F, 0x28, 0, 0, 0};
+        qualityMs += 3000;
+        for (auto& d : many) {
+            mac[5]++;
+            SampleQuality q = quality.check(mac, d, qualityMs);
+            doNotOptimize(q);
+        }
+    });
+
+    // Fusión: ocho nodos en la misma zona, una decisión por ráfaga
+    ZoneFusion fusion;
+    bench("fusion/zone8", BURST_NODES, [&] {
+        uint8_t mac[6] = {0x24, 0x6F, 0x28, 0, 0, 0};
+        qualityMs += 3000;
+        for (auto& d : many) {
+            mac[5]++;
+            fusion.update(mac, 0, 1, d, 0, qualityMs);
+        }
+        SensorData fused;
+        uint16_t unusable;
+        fusion.fuse(0, qualityMs, fused, unusable);
+        doNotOptimize(fused);
+    });
+
+    Thresholds thresholds;
+    bench("evaluate/single", 1, [&] {
+        ActuatorState s = thresholds.evaluate(one);
+        doNotOptimize(s);
+    });
+    bench("evaluate/burst8", BURST_NODES, [&] {
+        for (auto& d : many) {
+            ActuatorState s = thresholds.evaluate(d);
+            doNotOptimize(s);
+        }
+    });
+
+    bench("alert_diff/single", 1, [&] {
+        bool changed = thresholds.hasAlertChanged();
+        doNotOptimize(changed);
+    });
+    bench("alert_diff/burst8", BURST_NODES, [&] {
+        for (auto& d : many) {
+            thresholds.evaluate(d);
+            bool changed = thresholds.hasAlertChanged();
+            doNotOptimize(changed);
+        }
+    });
+
+    bench("format_sensor/single", 1, [&] {
+        String s = thresholds.formatSensorData(one);
+        doNotOptimize(s);
+    });
+    bench("format_sensor/burst8", BURST_NODES, [&] {
+        for (auto& d : many) {
+            String s = thresholds.formatSensorData(d);
+            doNotOptimize(s);
+        }
+    });
+
+    const String timestamp = "2025-06-10 14:32:05";
+    const String nodeId = "NODE_1";
+    bench("csv_line/single", 1, [&] {
+        String s = SDLogger::formatCsvLine(timestamp, nodeId, -61, one, 0);
+        doNotOptimize(s);
+    });
+    bench("csv_line/burst8", BURST_NODES, [&] {
+        for (auto& d : many) {
+            String s = SDLogger::formatCsvLine(timestamp, nodeId, -61, d, 0);
+            doNotOptimize(s);
+        }
+    });
+
+    thresholds.evaluate(sample(3, 40));
+    const String alarm = thresholds.returnAlarm(one);
+    const String datos = "📊 Últimos datos:\n🕒 " + timestamp + "\n" + thresholds.formatSensorData(one);
+    bench("urlencode/alarm", 1, [&] {
+        String s = TelegramBot::urlencode(alarm);
+        doNotOptimize(s);
+    });
+    bench("urlencode/datos", 1, [&] {
+        String s = TelegramBot::urlencode(datos);
+        doNotOptimize(s);
+    });
+
+    const String response = updatesResponse(900001, "/datos");
+    const String empty = "{\"ok\":true,\"result\":[]}";
+    bench("parse_updates/single", 1, [&] {
+        int lastUpdateId = 900000;
+        String cmd = TelegramBot::parseUpdate(response, lastUpdateId);
+        doNotOptimize(cmd);
+    });
+    bench("parse_updates/empty", 1, [&] {
+        int lastUpdateId = 900000;
+        String cmd = TelegramBot::parseUpdate(empty, lastUpdateId);
+        doNotOptimize(cmd);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Salida y comparación con la referencia
+// ---------------------------------------------------------------------------
+void printResults() {
+    for (auto& r : results) {
+        if (options.json) {
+            printf("{\"name\":\"%s\",\"ns_per_op\":%.2f,\"allocs_per_op\":%.3f,\"ops\":%llu}\n",
+                   r.name.c_str(), r.nsPerOp, r.allocsPerOp, (unsigned long long)r.ops);
+        } else {
+            printf("%-24s %12.2f ns/op %10.3f allocs/op\n", r.name.c_str(), r.nsPerOp, r.allocsPerOp);
+        }
+    }
+}
+
+int compareWithBaseline() {
+    std::ifstream in(options.baseline);
+    if (!in) {
+        fprintf(stderr, "No se pudo abrir %s\n", options.baseline.c_str());
+        return 1;
+    }
+
+    int regressions = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        char name[128];
+        double ns = 0, allocs = 0;
+        if (sscanf(line.c_str(), "{\"name\":\"%127[^\"]\",\"ns_per_op\":%lf,\"allocs_per_op\":%lf", name, &ns, &allocs) != 3) continue;
+        for (auto& r : results) {
+            if (r.name != name) continue;
+            bool slower = r.nsPerOp > ns * (1.0 + options.tolerance);
+            bool moreAllocs = r.allocsPerOp > allocs + 0.01;
+            if (slower || moreAllocs) {
+                regressions++;
+                fprintf(stderr, "REGRESIÓN %-24s %10.2f -> %10.2f ns/op  %6.3f -> %6.3f allocs/op\n",
+                        name, ns, r.nsPerOp, allocs, r.allocsPerOp);
+            }
+        }
+    }
+    return regressions ? 2 : 0;
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--json") options.json = true;
+        else if (arg == "--min-ms" && hasValue) options.minMs = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--baseline" && hasValue) options.baseline = argv[++i];
+        else if (arg == "--tolerance" && hasValue) options.tolerance = strtod(argv[++i], nullptr);
+        else {
+            printf("Uso: program [--json] [--min-ms MS] [--filter TEXTO]\n"
+                   "             [--baseline ARCHIVO] [--tolerance FRACCION]\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 1;
+    Serial.enabled = false;
+
+    registerBenchmarks();
+    printResults();
+
+    return options.baseline.empty() ? 0 : compareWithBaseline();
+}
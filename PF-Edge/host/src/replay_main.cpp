@@ -0,0 +1,285 @@
+// Reproduce trazas (trace.bin de TraceRecorder) o archivos data.csv del
+// SDLogger a través de la lógica de control del Edge, a máxima velocidad,
+// y compara dos versiones de reglas (A y B) muestra a muestra.
+//
+//   pio run -e native_replay
+//   .pio/build/native_replay/program --b "suelo_min 40" --b "temp_max 30" sd_backup/
+//
+// Cada --a/--b es un comando /umbral aplicado sobre los umbrales por
+// defecto. Los directorios se recorren recursivamente en orden de ruta
+// (que coincide con el orden temporal /AAAA-MM-DD/HH). Con una traza se
+// compara además A contra los comandos que el Edge envió realmente.
+//
+// Los canales marcados por la etapa de calidad no actúan, como en el Edge:
+// en el CSV se toman de la columna calidad; en una traza se vuelve a pasar
+// cada trama por SensorQuality con su MAC y su millis().
+
+#include <Arduino.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "dataSensor.h"
+#include "dataActuator.h"
+#include "ESPNowReceiver.h"
+#include "ThresholdsController.h"
+#include "SensorQuality.h"
+#include "TraceRecorder.h"
+
+namespace {
+
+struct ReplaySample {
+    uint32_t unixTime = 0;         // 0 si no se conoce
+    std::string timestamp;         // texto original (CSV) o derivado (traza)
+    std::string node;
+    SensorData data;
+    uint16_t unusable = 0;         // canales marcados por SensorQuality
+    bool hasRecorded = false;      // la traza incluye el comando real
+    ActuatorState recorded;
+};
+
+struct ReplayOptions {
+    std::vector<std::string> inputs;
+    std::vector<std::string> rulesA;
+    std::vector<std::string> rulesB;
+    size_t maxDiffs = 20;
+};
+
+ReplayOptions options;
+
+std::string formatUnix(uint32_t t) {
+    time_t tt = (time_t)t;
+    struct tm tm;
+    gmtime_r(&tt, &tm);
+    char buf[24];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    return buf;
+}
+
+std::string macToNode(const uint8_t* mac) {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return buf;
+}
+
+// ---------------------------------------------------------------------------
+// Lectores
+// ---------------------------------------------------------------------------
+bool readCsv(const std::string& path, std::vector<ReplaySample>& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    std::vector<std::string> f;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line.rfind("timestamp,", 0) == 0) continue;
+
+        f.clear();
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) f.push_back(field);
+        if (f.size() < 4 + SENSOR_CHANNEL_COUNT) continue;   // timestamp,nodeId,rssi,<canales>,state[,calidad]
+
+        ReplaySample s;
+        s.timestamp = f[0];
+        s.node = f[1];
+        fillSensorChannels(s.data, [&](uint8_t ch) {
+            const std::string& v = f[3 + ch];
+            if (v.empty()) return SENSOR_CHANNEL_TABLE[ch].noReading;   // sin lectura
+            return (int32_t)lround(strtod(v.c_str(), nullptr) * SENSOR_CHANNEL_TABLE[ch].scale);
+        });
+        if (f.size() > 4 + SENSOR_CHANNEL_COUNT) s.unusable = (uint16_t)strtoul(f[4 + SENSOR_CHANNEL_COUNT].c_str(), nullptr, 10);
+        out.push_back(s);
+    }
+    return true;
+}
+
+bool readTrace(const std::string& path, std::vector<ReplaySample>& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (buf.size() < 4 || memcmp(buf.data(), TraceRecorder::MAGIC, 4) != 0) {
+        fprintf(stderr, "⚠️ %s no es una traza VVT1\n", path.c_str());
+        return false;
+    }
+
+    // Cada bloque volcado termina con un registro de reloj: las muestras se
+    // fechan con el primer reloj que las sigue.
+    size_t first = out.size();
+    std::vector<std::pair<size_t, std::pair<uint32_t, uint32_t>>> clocks;  // índice, (millis, unix)
+    std::vector<uint32_t> sampleMillis;
+    SensorQuality quality;
+
+    size_t pos = 4;
+    while (pos + TraceRecorder::RECORD_HEADER <= buf.size()) {
+        uint8_t type = buf[pos];
+        uint8_t len = buf[pos + 1];
+        uint32_t ms = TraceRecorder::readLE32(&buf[pos + 2]);
+        const uint8_t* payload = &buf[pos + TraceRecorder::RECORD_HEADER];
+        if (pos + TraceRecorder::RECORD_HEADER + len > buf.size()) break;
+
+        if (type == TRACE_SENSOR_FRAME && len >= 6) {
+            ReplaySample s;
+            if (ESPNowReceiver::decode(payload + 6, len - 6, s.data)) {
+                s.node = macToNode(payload);
+                s.unusable = quality.check(payload, s.data, ms).unusable;
+                out.push_back(s);
+                sampleMillis.push_back(ms);
+            }
+        } else if (type == TRACE_ACTUATOR_CMD && len == 1 + sizeof(ActuatorState) && out.size() > first) {
+            memcpy(&out.back().recorded, payload + 1, sizeof(ActuatorState));
+            out.back().hasRecorded = true;
+        } else if (type == TRACE_CLOCK && len == 4) {
+            clocks.push_back({out.size(), {ms, TraceRecorder::readLE32(payload)}});
+        }
+        pos += TraceRecorder::RECORD_HEADER + len;
+    }
+
+    size_t c = 0;
+    for (size_t i = first; i < out.size(); i++) {
+        while (c < clocks.size() && clocks[c].first <= i) c++;
+        if (c == clocks.size()) break;
+        uint32_t clockMs = clocks[c].second.first;
+        uint32_t clockUnix = clocks[c].second.second;
+        out[i].unixTime = clockUnix - (clockMs - sampleMillis[i - first]) / 1000;
+        out[i].timestamp = formatUnix(out[i].unixTime);
+    }
+    return true;
+}
+
+bool readInput(const std::string& path, std::vector<ReplaySample>& out) {
+    namespace fs = std::filesystem;
+    if (fs::is_directory(path)) {
+        std::vector<std::string> files;
+        for (auto& e : fs::recursive_directory_iterator(path)) {
+            std::string ext = e.path().extension().string();
+            if (e.is_regular_file() && (ext == ".csv" || ext == ".bin")) files.push_back(e.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        for (auto& f : files) readInput(f, out);
+        return true;
+    }
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0) return readTrace(path, out);
+    return readCsv(path, out);
+}
+
+// ---------------------------------------------------------------------------
+// Comparación
+// ---------------------------------------------------------------------------
+struct ActuatorStats {
+    unsigned long onSamples[3] = {0, 0, 0};
+    unsigned long transitions[3] = {0, 0, 0};
+    ActuatorState last;
+    bool first = true;
+
+    void add(const ActuatorState& s) {
+        const uint8_t now[3] = {s.waterPump, s.fan, s.leds};
+        const uint8_t prev[3] = {last.waterPump, last.fan, last.leds};
+        for (int i = 0; i < 3; i++) {
+            if (now[i]) onSamples[i]++;
+            if (!first && now[i] != prev[i]) transitions[i]++;
+        }
+        last = s;
+        first = false;
+    }
+};
+
+bool sameState(const ActuatorState& a, const ActuatorState& b) {
+    return a.waterPump == b.waterPump && a.fan == b.fan && a.leds == b.leds;
+}
+
+std::string stateText(const ActuatorState& s) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "B%u V%u L%u", s.waterPump, s.fan, s.leds);
+    return buf;
+}
+
+void applyRules(Thresholds& t, const std::vector<std::string>& rules) {
+    for (auto& r : rules) t.updateFromCommand(String(("/umbral " + r).c_str()));
+}
+
+int run(const std::vector<ReplaySample>& samples) {
+    Thresholds a, b;
+    applyRules(a, options.rulesA);
+    applyRules(b, options.rulesB);
+
+    ActuatorStats statsA, statsB;
+    unsigned long diffs[3] = {0, 0, 0};
+    unsigned long diffSamples = 0;
+    unsigned long recordedSamples = 0;
+    unsigned long recordedMismatch = 0;
+    size_t printed = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& s : samples) {
+        ActuatorState sa = a.evaluate(s.data, s.unusable);
+        ActuatorState sb = b.evaluate(s.data, s.unusable);
+        statsA.add(sa);
+        statsB.add(sb);
+
+        if (s.hasRecorded) {
+            recordedSamples++;
+            if (!sameState(sa, s.recorded)) recordedMismatch++;
+        }
+
+        if (sameState(sa, sb)) continue;
+        diffSamples++;
+        if (sa.waterPump != sb.waterPump) diffs[0]++;
+        if (sa.fan != sb.fan) diffs[1]++;
+        if (sa.leds != sb.leds) diffs[2]++;
+
+        if (printed++ < options.maxDiffs) {
+            printf("%-19s %-17s T=%5.1f S=%5.1f L=%4.0f CO2=%6.0f  A[%s] B[%s]\n",
+                   s.timestamp.c_str(), s.node.c_str(), sensorToFloat(SENSOR_TEMPERATURE, s.data.temperature),
+                   sensorToFloat(SENSOR_SOIL, s.data.soilMoisture), sensorToFloat(SENSOR_LIGHT, s.data.light),
+                   sensorToFloat(SENSOR_CO2, s.data.co2ppm), stateText(sa).c_str(), stateText(sb).c_str());
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const char* names[3] = {"Bomba", "Ventilador", "Luces"};
+    printf("\nMuestras: %zu (%.0f muestras/s)\n", samples.size(), seconds > 0 ? samples.size() / seconds : 0.0);
+    printf("Muestras con diferencias A/B: %lu\n\n", diffSamples);
+    printf("%-11s %10s %10s %8s %8s %8s\n", "Actuador", "ON A", "ON B", "Conm. A", "Conm. B", "Difs");
+    for (int i = 0; i < 3; i++) {
+        printf("%-11s %10lu %10lu %8lu %8lu %8lu\n", names[i], statsA.onSamples[i], statsB.onSamples[i],
+               statsA.transitions[i], statsB.transitions[i], diffs[i]);
+    }
+    if (recordedSamples > 0) {
+        printf("\nComandos grabados: %lu, distintos de A: %lu\n", recordedSamples, recordedMismatch);
+    }
+    return 0;
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--a" && hasValue) options.rulesA.push_back(argv[++i]);
+        else if (arg == "--b" && hasValue) options.rulesB.push_back(argv[++i]);
+        else if (arg == "--diffs" && hasValue) options.maxDiffs = strtoul(argv[++i], nullptr, 10);
+        else if (arg.rfind("--", 0) == 0) {
+            printf("Uso: program [--a \"tipo valor\"]... [--b \"tipo valor\"]... [--diffs N] RUTA...\n"
+                   "RUTA: trace.bin, data.csv o un directorio copiado de la SD\n");
+            return false;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    return !options.inputs.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 1;
+    Serial.enabled = false;
+
+    std::vector<ReplaySample> samples;
+    for (auto& in : options.inputs) {
+        if (!readInput(in, samples)) fprintf(stderr, "⚠️ No se pudo leer %s\n", in.c_str());
+    }
+    return run(samples);
+}
@@ -0,0 +1,671 @@
+// Simulador del Edge en el host (entorno `native`).
+//
+// Ejecuta el firmware real de src/main.cpp (setup() + tareas FreeRTOS como
+// hilos) y lo alimenta con nodos sensores simulados a una tasa
+// configurable. Un nodo actuador simulado recibe los comandos y cierra el
+// lazo sobre un modelo de invernadero muy simple.
+//
+//   pio run -e native
+//   .pio/build/native/program --nodes 4 --period-ms 200 --duration-s 20
+//       --sd sim_sd --cmd /datos --cmd /actuadores --quiet
+//
+// La configuración (NVS) se guarda en --nvs DIR (sim_nvs por defecto) y
+// persiste entre ejecuciones.
+//
+// --ap-canal S:CH mueve el AP al canal CH en el segundo S; el nodo actuador
+// simulado escucha las balizas del Edge y el resumen muestra cuánto tardó
+// en anunciarse el canal nuevo. --ap-caida S:D deja el AP sin servicio D
+// segundos desde el segundo S: el lazo sensor -> actuador debe seguir igual.
+// --sonda-suelta S desconecta la sonda de suelo del nodo 0 en el segundo S
+// (lee 0 % fijo): la bomba de su zona no debe arrancar y debe saltar la
+// alerta sensor_falla. --sin-dht S hace lo mismo con el DHT (sin lectura).
+// Los nodos envían la edad de cada muestra (de la lectura al envío);
+// --retraso-ms MS retrasa su envío: edad_muestra_ms en /api/nodos y la hora
+// del data.csv deben seguir siendo las de la lectura.
+// Los nodos atienden la configuración remota (/nodo): periodo, envío por
+// cambio y el resto de parámetros, con ACK como PF-Sensores.
+// --ota-imagen BYTES deja en la SD (ota/sensor.bin y ota/actuador.bin)
+// imágenes aleatorias de ese tamaño; los nodos simulados las reciben con
+// el mismo OtaReceiver que los reales (memoria en lugar de partición) y
+// "reinician" con la versión nueva. Con --loss se ve la reanudación:
+//   --ota-imagen 300000 --loss 0.2 --cmd "/ota sensores sensor.bin 2.0"
+// Los nodos envían en el sobre de relevo (SensorRelay.h). Con --relevo K,
+// los nodos desde el K llegan a través del nodo 0 (un salto, con su
+// retraso y su pérdida de más) y de vez en cuando también directos, como
+// un duplicado; /rutas y "ruta" en /api/nodos muestran ambos caminos. El
+// Edge no les llega directo: /nodo, /ota y los informes de enlace van en
+// el sobre de bajada hasta el nodo 0, que lo pasa al destino.
+// Cada nodo llega al Edge con un RSSI que depende de su potencia (el nodo
+// i, --rssi DBM - 6·i a 20 dBm; el actuador, --rssi) y pierde tramas por
+// debajo de -88 dBm; ajusta la potencia con los informes del Edge como los
+// nodos reales (/enlaces, "enlace" en /api/nodos y /api/actuadores).
+//
+// --historial-dias N deja en la SD N días de CSV anteriores a ayer (una
+// fila por minuto) para ver el archivado y, con --sd-mb MB (tamaño de la
+// tarjeta) o /config sd_max_mb, el borrado de los más antiguos (/sd).
+//
+// La API HTTP local (puerto 80 en el ESP32) escucha en 127.0.0.1:8080, o
+// en el puerto de --http-port:
+//   curl http://127.0.0.1:8080/api/nodos
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <SD.h>
+#include <Preferences.h>
+#include <HTTPClient.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "dataSensor.h"
+#include "dataActuator.h"
+#include "EdgeBeacon.h"
+#include "SensorSettings.h"
+#include "FirmwareTransfer.h"
+#include "SensorRelay.h"
+#include "LinkQuality.h"
+#include "WiFiConnector.h"
+#include "SDLogger.h"
+
+void setup();
+void loop();
+extern WiFiConnector wifi;
+
+namespace {
+
+struct SimConfig {
+    int nodes = 1;
+    unsigned long periodMs = 3000;
+    unsigned long durationS = 30;
+    float lossRate = 0.0f;
+    bool quiet = false;
+    unsigned seed = 1;
+    std::vector<String> commands;
+    unsigned long apMoveS = 0;    // 0: el AP no cambia de canal
+    int apMoveChannel = 0;
+    unsigned long apDownS = 0;    // 0: el AP no cae
+    unsigned long apDownForS = 0;
+    unsigned long soilProbeOffS = 0;   // 0: sin fallo de sonda
+    unsigned long dhtOffS = 0;         // 0: sin fallo del DHT
+    unsigned long sendDelayMs = 0;     // entre la lectura y el envío
+    uint32_t otaImageBytes = 0;        // 0: sin imágenes de firmware en la SD
+    int relayFrom = 0;                 // 0: todos directos al Edge
+    int rssi = -50;                    // a 20 dBm, el nodo 0 y el actuador
+    int historyDays = 0;               // días de CSV antiguos en la SD al arrancar
+};
+
+const unsigned long SIM_RELAY_DELAY_MS = 40;   // hasta el loop() del relevo
+const float SIM_DIRECT_COPY_RATE = 0.05f;      // el Edge también oye al nodo lejano
+
+const uint8_t ACTUATOR_MAC[6] = {0xEC, 0xE3, 0x34, 0x8A, 0x55, 0xA0};
+
+// Respuesta de un nodo simulado hacia el Edge
+using SimReply = std::function<void(const uint8_t* data, int len)>;
+const char* SIM_FIRMWARE_VERSION = "1.0";
+const unsigned long SIM_REBOOT_MS = 1500;
+
+// Partición OTA en memoria; el progreso sobrevive al "reinicio" como en NVS
+struct SimOtaStorage {
+    std::vector<uint8_t> image;
+    uint32_t session = 0;
+    uint32_t progress = 0;
+
+    bool begin(uint32_t s, uint32_t size, uint32_t& resumeBytes) {
+        if (s != session) progress = 0;
+        session = s;
+        image.resize(size);
+        resumeBytes = progress;
+        return true;
+    }
+    bool write(uint32_t offset, const uint8_t* data, uint16_t len) {
+        memcpy(image.data() + offset, data, len);
+        return true;
+    }
+    bool read(uint32_t offset, uint8_t* data, uint16_t len) {
+        memcpy(data, image.data() + offset, len);
+        return true;
+    }
+    void saveProgress(uint32_t s, uint32_t bytes) {
+        if (s) session = s;
+        progress = bytes;
+    }
+    bool activate() { return true; }
+};
+
+// Radio de un nodo simulado: RSSI en el Edge según su potencia, pérdidas
+// con señal débil y la misma regulación de potencia que los nodos reales
+struct SimLink {
+    std::mutex mutex;
+    TxPowerControl control;
+    int baseRssi = -50;               // a potencia máxima
+    std::mt19937 rng{1};
+    std::atomic<unsigned long> reports{0};
+
+    int8_t rssi() {
+        std::lock_guard<std::mutex> lock(mutex);
+        float noise = std::normal_distribution<float>(0.0f, 1.5f)(rng);
+        int value = (int)lroundf(baseRssi + (control.qdbm() - TxPowerControl::MAX_QDBM) / 4.0f + noise);
+        return (int8_t)constrain(value, -100, -20);
+    }
+
+    // Trama hacia el Edge con el RSSI del momento; por debajo de -88 dBm
+    // se pierden cada vez más
+    bool send(const uint8_t* src, const uint8_t* data, int len) {
+        int8_t r = rssi();
+        float drop = constrain((-88 - r) / 10.0f, 0.0f, 1.0f);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (std::uniform_real_distribution<float>(0.0f, 1.0f)(rng) < drop) return false;
+        }
+        return HostRadio::inject(src, data, len, r);
+    }
+
+    // true si era un informe de enlace (responde con la potencia en uso)
+    bool onFrame(const uint8_t* data, int len, const SimReply& reply) {
+        LinkReport report;
+        if (!decodeLinkReport(data, len, report)) return false;
+        LinkStatus status;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            control.onReport(report, millis());
+            status.txPowerQdbm = control.qdbm();
+        }
+        reports++;
+        reply((const uint8_t*)&status, sizeof(status));
+        return true;
+    }
+};
+
+// Actualización de firmware de un nodo simulado: al quedar lista la imagen,
+// el nodo "reinicia" poco después con la versión ofrecida
+struct SimOtaNode {
+    SimOtaStorage storage;
+    std::unique_ptr<OtaReceiver<SimOtaStorage>> receiver;
+    uint8_t kind = 0;
+    String version = SIM_FIRMWARE_VERSION;
+    String pendingVersion;
+    unsigned long rebootAt = 0;
+    std::atomic<unsigned long> frames{0};
+    std::atomic<unsigned long> reboots{0};
+
+    void begin(uint8_t nodeKind) {
+        kind = nodeKind;
+        receiver.reset(new OtaReceiver<SimOtaStorage>(storage, kind, version.c_str(), 1536 * 1024));
+    }
+
+    // true si era una trama de OTA
+    bool onFrame(const uint8_t* data, int len, const SimReply& reply) {
+        if (len < 1 || data[0] < OTA_FRAME_OFFER || data[0] > OTA_FRAME_COMMIT) return false;
+        frames++;
+        if (rebootAt && (long)(millis() - rebootAt) >= 0) {
+            rebootAt = 0;
+            version = pendingVersion;
+            reboots++;
+            begin(kind);
+        }
+        if (data[0] == OTA_FRAME_OFFER && len == (int)sizeof(OtaOffer)) {
+            OtaOffer offer;
+            memcpy(&offer, data, sizeof(offer));
+            pendingVersion = String(offer.version);
+        }
+        OtaStatus status;
+        if (!receiver->handle(data, len, status)) return true;
+        if (status.state == OTA_READY && !rebootAt) rebootAt = millis() + SIM_REBOOT_MS;
+        reply((const uint8_t*)&status, sizeof(status));
+        return true;
+    }
+
+    // ¿Coincide la imagen recibida con el fichero de la SD?
+    bool matches(const char* path) const {
+        FILE* f = fopen((SD.root + path).c_str(), "rb");
+        if (!f) return false;
+        std::vector<uint8_t> file(storage.image.size() + 1);
+        size_t n = fread(file.data(), 1, file.size(), f);
+        fclose(f);
+        return n == storage.image.size() && memcmp(file.data(), storage.image.data(), n) == 0;
+    }
+};
+
+// Nodo actuador simulado con la misma tabla de canales que PF-Actuadores
+// (0 bomba, 1 ventilador, 2-5 LEDs): aplica la lista canal/valor, responde
+// con ACK y expone el estado agregado a la planta
+struct SimActuatorNode {
+    uint8_t values[ACTUATOR_MAX_CHANNELS] = {0};
+    std::atomic<uint8_t> waterPump{0};
+    std::atomic<uint8_t> fan{0};
+    std::atomic<uint8_t> leds{0};
+    std::atomic<unsigned long> frames{0};
+    std::atomic<unsigned long> changes{0};
+    std::atomic<unsigned long> duplicates{0};
+    uint16_t lastSeq = 0;
+    bool hasLastSeq = false;
+    std::atomic<unsigned long> beacons{0};
+    std::atomic<int> beaconChannel{0};
+    std::atomic<unsigned long> beaconChangedAt{0};   // millis() del último canal nuevo
+    SimOtaNode ota;
+    SimLink link;
+
+    void onFrame(const uint8_t*, const uint8_t* data, int len) {
+        if (ota.onFrame(data, len, [](const uint8_t* d, int l) { HostRadio::inject(ACTUATOR_MAC, d, l); })) return;
+        if (link.onFrame(data, len, [this](const uint8_t* d, int l) { link.send(ACTUATOR_MAC, d, l); })) return;
+        EdgeBeacon beacon;
+        if (decodeBeacon(data, len, beacon)) {
+            beacons++;
+            if (beacon.channel != beaconChannel) {
+                beaconChannel = beacon.channel;
+                beaconChangedAt = millis();
+            }
+            return;
+        }
+
+        ActuatorCommand cmd;
+        if (!decodeChannelFrame(data, len, ACTUATOR_FRAME_CMD, cmd)) return;
+        frames++;
+
+        ActuatorAck ack;
+        ack.seq = cmd.seq;
+        if (hasLastSeq && cmd.seq == lastSeq) {
+            duplicates++;
+        }
+        for (uint8_t k = 0; k < cmd.count; k++) {
+            uint8_t id = cmd.values[k].channel;
+            if (id >= ACTUATOR_MAX_CHANNELS) continue;
+            if (!(hasLastSeq && cmd.seq == lastSeq) && values[id] != cmd.values[k].value) {
+                values[id] = cmd.values[k].value;
+                changes++;
+            }
+            ack.values[ack.count++] = {id, values[id]};
+        }
+        lastSeq = cmd.seq;
+        hasLastSeq = true;
+
+        waterPump = values[0];
+        fan = values[1];
+        leds = std::max(std::max(values[2], values[3]), std::max(values[4], values[5]));
+        link.send(ACTUATOR_MAC, (const uint8_t*)&ack, ack.frameLength());
+    }
+};
+
+// Parámetros remotos de un nodo sensor simulado (SensorSettings.h), con la
+// misma validación que PF-Sensores; el periodo de partida es --period-ms
+struct SimSensorNode {
+    uint8_t mac[6];
+    std::mutex mutex;
+    int32_t settings[SENSOR_SETTING_COUNT];
+    std::atomic<unsigned long> configFrames{0};
+    SimOtaNode ota;
+    SimLink link;
+    bool relayed = false;            // fuera del alcance del Edge: por el nodo 0
+    std::atomic<uint16_t> seq{0};    // del sobre de relevo, datos y respuestas
+
+    void send(const uint8_t* data, int len);
+    void onFrame(const uint8_t* data, int len);
+    void onConfig(const uint8_t* data, int len) {
+        SensorConfigFrame req;
+        if (!decodeSensorConfig(data, len, SENSOR_CONFIG_SET, req)) return;
+        configFrames++;
+        SensorConfigFrame ack;
+        ack.type = SENSOR_CONFIG_ACK;
+        ack.seq = req.seq;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint8_t k = 0; k < req.count; k++) applySensorSetting(settings, req.items[k].id, req.items[k].value);
+            for (uint8_t id = 0; id < SENSOR_SETTING_COUNT; id++) ack.items[ack.count++] = {id, settings[id]};
+        }
+        send((const uint8_t*)&ack, ack.frameLength());
+    }
+};
+
+// Invernadero de juguete: cada nodo tiene su propio microclima, acoplado
+// a los actuadores compartidos.
+struct SimPlant {
+    float temperature;
+    float humidity;
+    float soilMoisture;
+    float co2;
+    float light;
+    float voltage;
+    std::mt19937 rng;
+
+    explicit SimPlant(unsigned seed)
+        : temperature(26.0f), humidity(60.0f), soilMoisture(55.0f), co2(600.0f),
+          light(800.0f), voltage(7.4f), rng(seed) {}
+
+    SensorData step(const SimActuatorNode& act, float dtS) {
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        // Efecto proporcional al nivel (0-255) de cada actuador
+        float fan = act.fan / 255.0f, pump = act.waterPump / 255.0f, leds = act.leds / 255.0f;
+        temperature += dtS * (0.02f - 0.08f * fan) + 0.05f * noise(rng);
+        soilMoisture += dtS * (-0.05f + 0.85f * pump) + 0.1f * noise(rng);
+        co2 += dtS * (1.0f - 6.0f * fan) + 2.0f * noise(rng);
+        light += dtS * (-2.0f + 7.0f * leds) + 5.0f * noise(rng);
+        humidity += 0.1f * noise(rng);
+        voltage -= dtS * 0.0005f;
+
+        soilMoisture = constrain(soilMoisture, 0.0f, 100.0f);
+        humidity = constrain(humidity, 0.0f, 100.0f);
+        light = constrain(light, 0.0f, 4095.0f);
+        co2 = constrain(co2, 0.0f, 4095.0f);
+
+        SensorData d;
+        setSensorValue(d.temperature, SENSOR_TEMPERATURE, temperature);
+        setSensorValue(d.humidity, SENSOR_HUMIDITY, humidity);
+        setSensorValue(d.light, SENSOR_LIGHT, light);
+        setSensorValue(d.co2ppm, SENSOR_CO2, co2);
+        setSensorValue(d.soilMoisture, SENSOR_SOIL, soilMoisture);
+        setSensorValue(d.voltage, SENSOR_VOLTAGE, voltage);
+        return d;
+    }
+};
+
+SimConfig config;
+SimActuatorNode actuatorNode;
+std::atomic<unsigned long> sensorFrames{0};
+std::atomic<unsigned long> downFrames{0};   // sobres de bajada que pasó el nodo 0
+SimSensorNode* sensorNodes = nullptr;
+
+SimSensorNode* findSensorNode(const uint8_t* mac) {
+    for (int i = 0; i < config.nodes; i++) {
+        if (memcmp(sensorNodes[i].mac, mac, 6) == 0) return &sensorNodes[i];
+    }
+    return nullptr;
+}
+
+// Trama propia hacia el Edge: directa o, por relevo, a través del nodo 0
+void SimSensorNode::send(const uint8_t* data, int len) {
+    if (!relayed) {
+        link.send(mac, data, len);
+        return;
+    }
+    RelayHeader header;
+    memcpy(header.origin, mac, 6);
+    memcpy(header.parent, sensorNodes[0].mac, 6);
+    header.seq = seq++;
+    header.hops = 1;
+    header.sentMs = (uint32_t)millis();
+    uint8_t out[ESP_NOW_MAX_DATA_LEN];
+    int outLen = encodeRelayFrame(header, data, len, out);
+    if (outLen > 0) HostRadio::inject(sensorNodes[0].mac, out, outLen);
+}
+
+// Lo que llega del Edge: el sobre de bajada se pasa al siguiente de la ruta
+// (como RelayRouter) o, en el destino, se abre
+void SimSensorNode::onFrame(const uint8_t* data, int len) {
+    RelayDownHeader down;
+    const uint8_t* payload;
+    int payloadLen;
+    if (decodeRelayDown(data, len, down, payload, payloadLen)) {
+        if (memcmp(down.route[down.next], mac, 6) != 0) return;
+        if (down.next + 1 < down.count) {
+            down.next++;
+            std::vector<uint8_t> frame(data, data + len);
+            memcpy(frame.data(), &down, RELAY_DOWN_HEADER_LEN);
+            SimSensorNode* child = findSensorNode(down.route[down.next]);
+            downFrames++;
+            if (child && !HostRadio::lost()) child->onFrame(frame.data(), len);
+            return;
+        }
+        data = payload;
+        len = payloadLen;
+    } else if (relayed) {
+        return;   // directo del Edge: no le llega
+    }
+    SimReply reply = [this](const uint8_t* d, int l) { send(d, l); };
+    if (ota.onFrame(data, len, reply) || link.onFrame(data, len, reply)) return;
+    onConfig(data, len);
+}
+
+void sensorNodeThread(int index) {
+    SimSensorNode& node = sensorNodes[index];
+    const uint8_t* mac = node.mac;
+    SimPlant plant(config.seed * 1000 + index);
+    unsigned long start = millis();
+    unsigned long next = start + (unsigned long)index * config.periodMs / config.nodes;
+    SensorData lastSent;
+    unsigned long lastSentMs = 0;
+    bool sentAny = false;
+    bool relayed = node.relayed;
+    std::mt19937 rng(config.seed * 7919 + index);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    RelayHeader header;
+    memcpy(header.origin, mac, 6);
+    memcpy(header.parent, relayed ? sensorNodes[0].mac : HostRadio::edgeMac(), 6);
+
+    while (true) {
+        unsigned long now = millis();
+        if ((long)(next - now) > 0) delay(next - now);
+        int32_t settings[SENSOR_SETTING_COUNT];
+        {
+            std::lock_guard<std::mutex> lock(node.mutex);
+            memcpy(settings, node.settings, sizeof(settings));
+        }
+        unsigned long periodMs = (unsigned long)settings[SETTING_PERIOD];
+        SensorData data = plant.step(actuatorNode, periodMs / 1000.0f);
+        unsigned long t = millis() - start;
+        if (index == 0 && config.soilProbeOffS && t >= config.soilProbeOffS * 1000UL) data.soilMoisture = 0;
+        if (index == 0 && config.dhtOffS && t >= config.dhtOffS * 1000UL) {
+            data.temperature = sensorNoReading<int16_t>();
+            data.humidity = sensorNoReading<uint16_t>();
+        }
+        next += periodMs;
+        if (sentAny && !sensorReportDue(settings, lastSent, data, millis() - lastSentMs)) continue;
+        lastSent = data;
+        lastSentMs = millis();
+        sentAny = true;
+        unsigned long acquiredMs = millis();
+        if (config.sendDelayMs) delay(config.sendDelayMs);
+        SensorFrame frame = encodeSensorFrame(data, sensorAge(millis() - acquiredMs));
+        uint8_t out[ESP_NOW_MAX_DATA_LEN];
+        header.hops = 0;
+        header.seq = node.seq++;
+        header.sentMs = (uint32_t)millis();
+        int len = encodeRelayFrame(header, (const uint8_t*)&frame, sizeof(frame), out);
+        if (!relayed) {
+            node.link.send(mac, out, len);
+        } else {
+            if (chance(rng) < SIM_DIRECT_COPY_RATE) node.link.send(mac, out, len);
+            bool firstHopOk = chance(rng) >= config.lossRate;   // nodo -> relevo
+            delay(SIM_RELAY_DELAY_MS);
+            out[offsetof(RelayHeader, hops)] = 1;
+            if (firstHopOk) HostRadio::inject(sensorNodes[0].mac, out, len);
+        }
+        sensorFrames++;
+    }
+}
+
+void usage() {
+    printf("Uso: program [--nodes N] [--period-ms MS] [--duration-s S] [--loss P]\n"
+           "             [--sd DIR] [--nvs DIR] [--ap-canal S:CH]\n"
+           "             [--ap-caida S:D] [--sonda-suelta S] [--sin-dht S] [--retraso-ms MS]\n"
+           "             [--ota-imagen BYTES] [--relevo K] [--rssi DBM] [--historial-dias N] [--sd-mb MB]\n"
+           "             [--http-port P] [--seed N] [--cmd /comando]... [--quiet]\n");
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--nodes" && hasValue) config.nodes = atoi(argv[++i]);
+        else if (arg == "--period-ms" && hasValue) config.periodMs = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--duration-s" && hasValue) config.durationS = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--loss" && hasValue) config.lossRate = strtof(argv[++i], nullptr);
+        else if (arg == "--sd" && hasValue) SD.root = argv[++i];
+        else if (arg == "--nvs" && hasValue) HostNvs::dir() = argv[++i];
+        else if (arg == "--http-port" && hasValue) HostNet::port() = atoi(argv[++i]);
+        else if (arg == "--ap-caida" && hasValue) {
+            String v = argv[++i];
+            config.apDownS = strtoul(v.c_str(), nullptr, 10);
+            config.apDownForS = v.indexOf(':') > 0 ? v.substring(v.indexOf(':') + 1).toInt() : 0;
+        }
+        else if (arg == "--ap-canal" && hasValue) {
+            String v = argv[++i];
+            config.apMoveS = strtoul(v.c_str(), nullptr, 10);
+            config.apMoveChannel = v.indexOf(':') > 0 ? v.substring(v.indexOf(':') + 1).toInt() : 0;
+        }
+        else if (arg == "--sonda-suelta" && hasValue) config.soilProbeOffS = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--sin-dht" && hasValue) config.dhtOffS = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--retraso-ms" && hasValue) config.sendDelayMs = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--ota-imagen" && hasValue) config.otaImageBytes = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--relevo" && hasValue) config.relayFrom = atoi(argv[++i]);
+        else if (arg == "--rssi" && hasValue) config.rssi = atoi(argv[++i]);
+        else if (arg == "--historial-dias" && hasValue) config.historyDays = atoi(argv[++i]);
+        else if (arg == "--sd-mb" && hasValue) SD.capacityBytes = strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+        else if (arg == "--seed" && hasValue) config.seed = (unsigned)atoi(argv[++i]);
+        else if (arg == "--cmd" && hasValue) config.commands.push_back(argv[++i]);
+        else if (arg == "--quiet") config.quiet = true;
+        else { usage(); return false; }
+    }
+    if (config.nodes < 1) config.nodes = 1;
+    if (config.periodMs < 1) config.periodMs = 1;
+    return true;
+}
+
+// Imagen de firmware aleatoria en la SD para /ota
+void writeOtaImage(const char* path, uint32_t size, unsigned seed) {
+    std::filesystem::create_directories(SD.root + "/ota");
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> image(size);
+    for (auto& b : image) b = (uint8_t)rng();
+    FILE* f = fopen((SD.root + path).c_str(), "wb");
+    if (!f) return;
+    fwrite(image.data(), 1, image.size(), f);
+    fclose(f);
+}
+
+// CSV de días pasados como los que deja SDLogger (una fila por minuto),
+// terminando anteayer para que ninguno sea "hoy" con la hora del RTC
+void writeHistory(int days) {
+    time_t now = time(nullptr);
+    for (int d = days + 1; d >= 2; d--) {
+        time_t day = now - (time_t)d * 86400;
+        char date[11];
+        strftime(date, sizeof(date), "%Y-%m-%d", gmtime(&day));
+        for (int hour = 0; hour < 24; hour++) {
+            char dir[32];
+            snprintf(dir, sizeof(dir), "/%s/%02d", date, hour);
+            std::filesystem::create_directories(SD.root + dir);
+            FILE* f = fopen((SD.root + dir + "/data.csv").c_str(), "wb");
+            if (!f) return;
+            fprintf(f, "timestamp,nodeId,rssi" SENSOR_CSV_COLUMNS ",state,calidad\n");
+            for (int minute = 0; minute < 60; minute++) {
+                float t = hour + minute / 60.0f;
+                SensorData data;
+                setSensorValue(data.temperature, SENSOR_TEMPERATURE, 24.0f + 4.0f * sinf(t * 0.26f));
+                setSensorValue(data.humidity, SENSOR_HUMIDITY, 65.0f - 10.0f * sinf(t * 0.26f));
+                setSensorValue(data.light, SENSOR_LIGHT, hour >= 6 && hour < 19 ? 1800.0f + 20.0f * minute : 0.0f);
+                setSensorValue(data.co2ppm, SENSOR_CO2, 550.0f + minute);
+                setSensorValue(data.soilMoisture, SENSOR_SOIL, 50.0f - 0.1f * minute);
+                setSensorValue(data.voltage, SENSOR_VOLTAGE, 7.4f);
+                if (minute == 30) data.humidity = sensorNoReading<uint16_t>();   // una lectura vacía por hora
+                char timestamp[20];
+                snprintf(timestamp, sizeof(timestamp), "%s %02d:%02d:00", date, hour, minute);
+                String line = SDLogger::formatCsvLine(timestamp, "NODE_1", -60 - minute % 5, data, 0, minute == 30 ? 2 : 0);
+                fprintf(f, "%s\n", line.c_str());
+            }
+            fclose(f);
+        }
+    }
+}
+
+void printOta(const char* name, const SimOtaNode& ota, const char* path) {
+    printf("OTA %-21s: %s, %lu tramas, %lu reinicios, %lu duplicadas, imagen %s\n", name, ota.version.c_str(),
+           ota.frames.load(), ota.reboots.load(), ota.receiver->duplicates(),
+           ota.storage.image.empty() ? "-" : ota.matches(path) ? "idéntica" : "DISTINTA");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 1;
+
+    Serial.enabled = !config.quiet;
+    HostHttp::state().echo = !config.quiet;
+    HostRadio::setLossRate(config.lossRate);
+    if (config.otaImageBytes) {
+        writeOtaImage("/ota/sensor.bin", config.otaImageBytes, config.seed);
+        writeOtaImage("/ota/actuador.bin", config.otaImageBytes, config.seed + 1);
+    }
+    if (config.historyDays > 0) writeHistory(config.historyDays);
+    actuatorNode.ota.begin(OTA_KIND_ACTUATOR);
+    actuatorNode.link.baseRssi = config.rssi;
+    actuatorNode.link.rng.seed(config.seed * 31);
+
+    HostRadio::attach(ACTUATOR_MAC, [](const uint8_t* src, const uint8_t* data, int len) {
+        actuatorNode.onFrame(src, data, len);
+    });
+
+    setup();
+
+    for (auto& cmd : config.commands) HostHttp::pushCommand(cmd);
+    sensorNodes = new SimSensorNode[config.nodes];
+    for (int i = 0; i < config.nodes; i++) {
+        SimSensorNode& node = sensorNodes[i];
+        const uint8_t mac[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, (uint8_t)(i + 1)};
+        memcpy(node.mac, mac, 6);
+        sensorSettingDefaults(node.settings);
+        node.settings[SETTING_PERIOD] = (int32_t)config.periodMs;
+        node.ota.begin(OTA_KIND_SENSOR);
+        node.link.baseRssi = config.rssi - 6 * i;
+        node.link.rng.seed(config.seed * 31 + i + 1);
+        node.relayed = config.relayFrom > 0 && i >= config.relayFrom;
+        HostRadio::attach(mac, [&node](const uint8_t*, const uint8_t* data, int len) { node.onFrame(data, len); });
+    }
+    for (int i = 0; i < config.nodes; i++) std::thread(sensorNodeThread, i).detach();
+
+    unsigned long start = millis();
+    unsigned long apMovedAt = 0;
+    while (millis() - start < config.durationS * 1000UL) {
+        if (config.apMoveS && !apMovedAt && millis() - start >= config.apMoveS * 1000UL) {
+            WiFi.apChannel = config.apMoveChannel;
+            apMovedAt = millis();
+        }
+        if (config.apDownS) {
+            unsigned long t = millis() - start;
+            bool down = t >= config.apDownS * 1000UL && t < (config.apDownS + config.apDownForS) * 1000UL;
+            if (down == (bool)WiFi.apAvailable) WiFi.setApAvailable(!down);
+        }
+        loop();
+        delay(10);
+    }
+
+    unsigned long elapsed = millis() - start;
+    printf("\n=== Simulación: %d nodos, %lu ms por nodo, %lu ms ===\n", config.nodes, config.periodMs, elapsed);
+    printf("Tramas sensores emitidas : %lu\n", sensorFrames.load());
+    printf("Tramas recibidas por Edge: %lu\n", HostRadio::air().framesIn);
+    printf("Tramas Edge -> radio     : %lu (%lu bytes)\n", HostRadio::air().framesOut, HostRadio::air().bytesOut);
+    printf("Tramas en nodo actuador  : %lu (%lu cambios, %lu duplicadas)\n", actuatorNode.frames.load(),
+           actuatorNode.changes.load(), actuatorNode.duplicates.load());
+    unsigned long configFrames = 0;
+    for (int i = 0; i < config.nodes; i++) configFrames += sensorNodes[i].configFrames;
+    printf("Config. en nodos sensor  : %lu tramas\n", configFrames);
+    if (config.relayFrom > 0) printf("Bajada por el nodo 0     : %lu tramas\n", downFrames.load());
+    printf("Mensajes Telegram        : %lu enviados, %lu sondeos\n", HostHttp::state().sent, HostHttp::state().polled);
+    printf("Actuadores finales       : bomba=%u ventilador=%u luces=%u\n",
+           actuatorNode.waterPump.load(), actuatorNode.fan.load(), actuatorNode.leds.load());
+    printf("Balizas en nodo actuador : %lu (canal anunciado %d", actuatorNode.beacons.load(),
+           actuatorNode.beaconChannel.load());
+    if (apMovedAt && actuatorNode.beaconChannel == config.apMoveChannel) {
+        printf(", %lu ms tras mover el AP", actuatorNode.beaconChangedAt.load() - apMovedAt);
+    }
+    printf(")\n");
+    printf("WiFi                     : %s, %lu conexiones\n", WiFiConnector::stateName(wifi.getState()),
+           wifi.getConnects());
+    printf("Escrituras NVS           : %lu\n", HostNvs::writes());
+    for (int i = 0; i < config.nodes; i++) {
+        printf("Potencia sensor %-9d: %.2f dBm (%lu informes)\n", i, sensorNodes[i].link.control.qdbm() / 4.0f,
+               sensorNodes[i].link.reports.load());
+    }
+    printf("Potencia actuador        : %.2f dBm (%lu informes)\n", actuatorNode.link.control.qdbm() / 4.0f,
+           actuatorNode.link.reports.load());
+    if (config.otaImageBytes) {
+        for (int i = 0; i < config.nodes; i++) {
+            printOta(("sensor " + String(i)).c_str(), sensorNodes[i].ota, "/ota/sensor.bin");
+        }
+        printOta("actuador", actuatorNode.ota, "/ota/actuador.bin");
+    }
+    fflush(stdout);
+
+    // Las tareas del firmware son bucles infinitos: salir sin destructores
+    std::_Exit(0);
+}
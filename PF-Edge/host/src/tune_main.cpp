@@ -0,0 +1,193 @@
+// Ajuste de lazos PID contra un modelo de planta simple (entorno
+// `native_tune`). Simula en tiempo virtual, a paso de 1 s, el mismo código
+// del Edge (ControlLoops y Thresholds::evaluate) y compara el PID con el
+// control por umbrales: error integrado, sobreoscilación, conmutaciones
+// del actuador y salida media (energía).
+//
+//   pio run -e native_tune
+//   .pio/build/native_tune/program --loop temp --sp 26 --kp 40 --ki 0.5
+//   .pio/build/native_tune/program --loop suelo --sp 55 --ki 0.1 --csv > suelo.csv
+//
+// Modelos (primer orden con retardo de transporte):
+//   temp   dT/dt = (32 - T)/600 - 0.015·u/255     (ventilador, retardo 30 s)
+//   suelo  dS/dt = -0.002 + 0.05·bomba                (relé, retardo 60 s)
+//   luz    L = ambiente (900 -> 100 en la simulación) + 3·u   (LEDs)
+
+#include <Arduino.h>
+#include <deque>
+#include <random>
+#include <string>
+#include "dataSensor.h"
+#include "dataActuator.h"
+#include "ThresholdsController.h"
+#include "ControlLoop.h"
+
+namespace {
+
+struct TuneOptions {
+    std::string loop = "temp";
+    float setpoint = NAN;
+    float kp = NAN, ki = NAN, kd = NAN;
+    unsigned long sampleMs = 0;
+    unsigned long minutes = 120;
+    float start = NAN;        // valor inicial de la planta
+    bool csv = false;
+    unsigned seed = 1;
+};
+
+TuneOptions options;
+
+struct Plant {
+    int loop;
+    float value;
+    std::deque<float> delayLine;   // salida aplicada con retardo (1 s por elemento)
+    std::mt19937 rng;
+
+    Plant(int loop, float start, unsigned seed) : loop(loop), value(start), rng(seed) {
+        size_t delay = loop == LOOP_TEMPERATURE ? 30 : (loop == LOOP_SOIL ? 60 : 0);
+        delayLine.assign(delay, 0.0f);
+    }
+
+    // Avanza 1 s con la salida u (0-255) y devuelve la medida con ruido
+    float step(float u, unsigned long t, unsigned long total) {
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        delayLine.push_back(u);
+        float applied = delayLine.front();
+        delayLine.pop_front();
+
+        if (loop == LOOP_TEMPERATURE) {
+            value += (32.0f - value) / 600.0f - 0.015f * applied / 255.0f;
+            return value + 0.05f * noise(rng);
+        }
+        if (loop == LOOP_SOIL) {
+            value += -0.002f + (applied > 0 ? 0.05f : 0.0f);
+            return value + 0.1f * noise(rng);
+        }
+        float ambient = 900.0f - 800.0f * t / (float)total;
+        value = ambient + 3.0f * applied;
+        return value + 5.0f * noise(rng);
+    }
+};
+
+struct Metrics {
+    double iae = 0;            // error absoluto integrado (unidad·s)
+    float maxOvershoot = 0;    // en el sentido que el actuador debe evitar
+    unsigned long switches = 0;
+    double outputSum = 0;
+    unsigned long samples = 0;
+};
+
+SensorData neutralSample(int loop, float measurement) {
+    SensorData d;
+    setSensorValue(d.temperature, SENSOR_TEMPERATURE, loop == LOOP_TEMPERATURE ? measurement : 25.0f);
+    setSensorValue(d.humidity, SENSOR_HUMIDITY, 60.0f);
+    setSensorValue(d.soilMoisture, SENSOR_SOIL, loop == LOOP_SOIL ? measurement : 55.0f);
+    setSensorValue(d.light, SENSOR_LIGHT, loop == LOOP_LIGHT ? measurement : 800.0f);
+    setSensorValue(d.co2ppm, SENSOR_CO2, 400.0f);
+    setSensorValue(d.voltage, SENSOR_VOLTAGE, 7.4f);
+    return d;
+}
+
+uint8_t outputOf(int loop, const ActuatorState& s) {
+    if (loop == LOOP_TEMPERATURE) return s.fan;
+    if (loop == LOOP_SOIL) return s.waterPump;
+    return s.leds;
+}
+
+Metrics simulate(int loop, bool pid, float setpoint, ControlLoops loops, Thresholds thresholds) {
+    Plant plant(loop, options.start, options.seed);
+    Metrics m;
+    unsigned long total = options.minutes * 60;
+    float measurement = plant.value;
+    uint8_t last = 0;
+
+    for (unsigned long t = 0; t < total; t++) {
+        SensorData d = neutralSample(loop, measurement);
+        ActuatorState state = thresholds.evaluate(d);
+        if (pid) loops.apply(d, t * 1000, state);
+        uint8_t u = outputOf(loop, state);
+
+        if (t > 0 && u != last) m.switches++;
+        last = u;
+        m.outputSum += u;
+        m.samples++;
+
+        measurement = plant.step(u, t, total);
+        float error = plant.value - setpoint;
+        m.iae += fabs(error);
+        // Temperatura: peor por encima; suelo y luz: peor por debajo
+        float overshoot = loop == LOOP_TEMPERATURE ? error : -error;
+        if (t > total / 10 && overshoot > m.maxOvershoot) m.maxOvershoot = overshoot;
+
+        if (options.csv) {
+            printf("%s,%lu,%.3f,%u\n", pid ? "pid" : "umbrales", t, plant.value, u);
+        }
+    }
+    return m;
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--loop" && hasValue) options.loop = argv[++i];
+        else if (arg == "--sp" && hasValue) options.setpoint = strtof(argv[++i], nullptr);
+        else if (arg == "--kp" && hasValue) options.kp = strtof(argv[++i], nullptr);
+        else if (arg == "--ki" && hasValue) options.ki = strtof(argv[++i], nullptr);
+        else if (arg == "--kd" && hasValue) options.kd = strtof(argv[++i], nullptr);
+        else if (arg == "--ts" && hasValue) options.sampleMs = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--minutes" && hasValue) options.minutes = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--start" && hasValue) options.start = strtof(argv[++i], nullptr);
+        else if (arg == "--seed" && hasValue) options.seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--csv") options.csv = true;
+        else {
+            printf("Uso: program [--loop temp|suelo|luz] [--sp X] [--kp X] [--ki X] [--kd X] [--ts ms]\n"
+                   "               [--minutes N] [--start X] [--seed N] [--csv]\n");
+            return false;
+        }
+    }
+    return ControlLoops::loopIndex(String(options.loop.c_str())) >= 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 1;
+    Serial.enabled = false;
+
+    int loop = ControlLoops::loopIndex(String(options.loop.c_str()));
+    ControlLoops loops;
+    PIDLoop& l = loops.loops[loop];
+    if (!std::isnan(options.setpoint)) l.setpoint = options.setpoint;
+    if (!std::isnan(options.kp)) l.kp = options.kp;
+    if (!std::isnan(options.ki)) l.ki = options.ki;
+    if (!std::isnan(options.kd)) l.kd = options.kd;
+    if (options.sampleMs) l.sampleMs = options.sampleMs;
+    l.enabled = true;
+
+    // Los umbrales equivalentes a la consigna, para comparar
+    Thresholds thresholds;
+    const char* rule = loop == LOOP_TEMPERATURE ? "temp_max" : (loop == LOOP_SOIL ? "suelo_min" : "luz_min");
+    thresholds.updateFromCommand(String("/umbral ") + rule + " " + String(l.setpoint));
+
+    if (std::isnan(options.start)) {
+        options.start = loop == LOOP_TEMPERATURE ? 30.0f : (loop == LOOP_SOIL ? 45.0f : 900.0f);
+    }
+
+    if (options.csv) printf("control,t,valor,salida\n");
+    Metrics a = simulate(loop, false, l.setpoint, loops, thresholds);
+    Metrics b = simulate(loop, true, l.setpoint, loops, thresholds);
+    if (options.csv) return 0;
+
+    printf("Lazo %s: sp %.2f, kp %.3f, ki %.3f, kd %.3f, ts %lu ms, %lu min\n\n", options.loop.c_str(),
+           l.setpoint, l.kp, l.ki, l.kd, l.sampleMs, options.minutes);
+    printf("%-9s %12s %12s %12s %12s\n", "Control", "IAE", "Sobreosc.", "Conmut.", "Salida med.");
+    const Metrics* rows[2] = {&a, &b};
+    const char* names[2] = {"umbrales", "PID"};
+    for (int i = 0; i < 2; i++) {
+        const Metrics& m = *rows[i];
+        printf("%-9s %12.1f %12.2f %12lu %12.1f\n", names[i], m.iae, m.maxOvershoot, m.switches,
+               m.samples ? m.outputSum / m.samples : 0.0);
+    }
+    return 0;
+}
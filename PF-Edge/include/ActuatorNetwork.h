@@ -0,0 +1,169 @@
+#ifndef ACTUATOR_NETWORK_H
+#define ACTUATOR_NETWORK_H
+
+#include <Arduino.h>
+#include "dataActuator.h"
+#include "ESPNowSender.h"
+
+// Tabla de actuadores del Edge: varios nodos actuadores (uno por MAC) y sus
+// canales, cada uno con tipo, zona y función. La lógica de control decide
+// por zona (ActuatorState, niveles 0-255) y aquí se traduce a valores por
+// canal, que cada ESPNowActuatorSender envía a su nodo como lista compacta.
+// Los canales de relé solo admiten ON/OFF: cualquier nivel > 0 es 255.
+class ActuatorNetwork {
+public:
+    static constexpr uint8_t MAX_NODES = 4;
+    static constexpr uint8_t MAX_CHANNELS = 32;
+    static constexpr uint8_t MAX_ZONES = 8;
+
+    struct Entry {
+        uint8_t node;            // índice en la tabla de nodos
+        ActuatorChannel channel; // id local en el nodo, tipo, zona y función
+    };
+
+    ActuatorNetwork(uint8_t espNowChannel) : _espNowChannel(espNowChannel) {}
+
+    // Antes de addNode()
+    void setEspNowChannel(uint8_t espNowChannel) { _espNowChannel = espNowChannel; }
+
+    // Devuelve el índice del nodo o -1 si la tabla está llena
+    int addNode(const uint8_t mac[6]) {
+        if (_nodeCount >= MAX_NODES) return -1;
+        _nodes[_nodeCount].setPeer(mac, _espNowChannel);
+        return _nodeCount++;
+    }
+
+    bool addChannel(uint8_t node, uint8_t id, ActuatorChannelType type, uint8_t zone, ActuatorRole role) {
+        if (node >= _nodeCount || _count >= MAX_CHANNELS || zone >= MAX_ZONES) return false;
+        if (!_nodes[node].addChannel(id)) return false;
+        _entries[_count++] = {node, {id, type, zone, role}};
+        return true;
+    }
+
+    void begin() {
+        for (uint8_t i = 0; i < _nodeCount; i++) _nodes[i].begin();
+    }
+
+    // Traduce la decisión de una zona a sus canales y envía solo lo que cambie.
+    // Devuelve true si salió alguna trama.
+    bool applyZoneState(uint8_t zone, const ActuatorState& state) {
+        for (uint8_t i = 0; i < _count; i++) {
+            const Entry& e = _entries[i];
+            if (e.channel.zone != zone) continue;
+            int level = roleValue(e.channel.role, state);
+            if (level < 0) continue;
+            _nodes[e.node].setChannel(e.channel.id, channelValue(e.channel, level));
+        }
+        return flush();
+    }
+
+    // Fija todos los canales de una función en una zona (comandos manuales)
+    void setRole(uint8_t zone, ActuatorRole role, uint8_t value) {
+        for (uint8_t i = 0; i < _count; i++) {
+            const Entry& e = _entries[i];
+            if (e.channel.zone == zone && e.channel.role == role) {
+                _nodes[e.node].setChannel(e.channel.id, channelValue(e.channel, value));
+            }
+        }
+    }
+
+    // Fija un canal por su índice global en la tabla del Edge
+    bool setChannel(uint8_t index, uint8_t value) {
+        if (index >= _count) return false;
+        _nodes[_entries[index].node].setChannel(_entries[index].channel.id, channelValue(_entries[index].channel, value));
+        return true;
+    }
+
+    bool flush() {
+        bool sent = false;
+        for (uint8_t i = 0; i < _nodeCount; i++) sent |= _nodes[i].flush();
+        return sent;
+    }
+
+    void update() {
+        for (uint8_t i = 0; i < _nodeCount; i++) _nodes[i].update();
+    }
+
+    // Entrega una trama entrante al nodo que la envió; true si era un ACK
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        for (uint8_t i = 0; i < _nodeCount; i++) {
+            if (_nodes[i].handleFrame(mac, data, len)) return true;
+        }
+        return false;
+    }
+
+    bool allConnected() const {
+        for (uint8_t i = 0; i < _nodeCount; i++) {
+            if (!_nodes[i].isPeerConnected()) return false;
+        }
+        return _nodeCount > 0;
+    }
+
+    // Estado confirmado de una zona: nivel máximo entre los canales de cada función
+    ActuatorState getZoneApplied(uint8_t zone) const {
+        ActuatorState s;
+        for (uint8_t i = 0; i < _count; i++) {
+            const Entry& e = _entries[i];
+            if (e.channel.zone != zone) continue;
+            int v = _nodes[e.node].getAppliedValue(e.channel.id);
+            if (v <= 0) continue;
+            if (e.channel.role == ROLE_PUMP && v > s.waterPump) s.waterPump = v;
+            else if (e.channel.role == ROLE_FAN && v > s.fan) s.fan = v;
+            else if (e.channel.role == ROLE_LIGHT && v > s.leds) s.leds = v;
+        }
+        return s;
+    }
+
+    uint8_t getChannelCount() const { return _count; }
+    uint8_t getNodeCount() const { return _nodeCount; }
+    const Entry& getEntry(uint8_t index) const { return _entries[index]; }
+    ESPNowActuatorSender& getNode(uint8_t index) { return _nodes[index]; }
+
+    String formatChannels() const {
+        static const char* types[] = {"relé", "PWM", "LED"};
+        static const char* roles[] = {"bomba", "ventilador", "luces", "válvula", "otro"};
+        String s = "🎛️ Canales:\n";
+        for (uint8_t i = 0; i < _count; i++) {
+            const Entry& e = _entries[i];
+            int desired = _nodes[e.node].getDesiredValue(e.channel.id);
+            int applied = _nodes[e.node].getAppliedValue(e.channel.id);
+            s += "#" + String(i) + " Z" + String(e.channel.zone) + " " + roles[e.channel.role] +
+                 " (" + types[e.channel.type] + ", nodo " + String(e.node) + "/" + String(e.channel.id) + "): " +
+                 String(desired) + " → " + (applied < 0 ? String("?") : String(applied)) + "\n";
+        }
+        return s;
+    }
+
+    String getLinkStats() const {
+        String s = "";
+        for (uint8_t i = 0; i < _nodeCount; i++) {
+            s += "📡 Nodo " + String(i) + (_nodes[i].isPeerConnected() ? " OK" : " SIN ACK") + "\n";
+            s += _nodes[i].getLinkStats() + "\n";
+        }
+        return s;
+    }
+
+private:
+    uint8_t _espNowChannel;
+    ESPNowActuatorSender _nodes[MAX_NODES];   // los _nodeCount primeros en uso
+    uint8_t _nodeCount = 0;
+    Entry _entries[MAX_CHANNELS];
+    uint8_t _count = 0;
+
+    static uint8_t channelValue(const ActuatorChannel& channel, uint8_t level) {
+        if (channel.type == CHANNEL_RELAY) return level ? ACTUATOR_VALUE_ON : 0;
+        return level;
+    }
+
+    // Nivel de una función según la decisión de la zona (-1: no controlada)
+    static int roleValue(ActuatorRole role, const ActuatorState& state) {
+        switch (role) {
+            case ROLE_PUMP: return state.waterPump;
+            case ROLE_FAN: return state.fan;
+            case ROLE_LIGHT: return state.leds;
+            default: return -1;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef CHANNEL_BEACON_H
+#define CHANNEL_BEACON_H
+
+#include <WiFi.h>
+#include <esp_now.h>
+#include "EdgeBeacon.h"
+
+// Anuncia el canal del Edge a los nodos (ver EdgeBeacon.h). Con WiFi
+// conectado el canal lo impone el AP: si cambia, la baliza lleva el nuevo
+// y los nodos lo siguen en pocos segundos. Sin WiFi se mantiene el último.
+// Baliza rápida (BEACON_FAST_PERIOD_MS) solo durante BEACON_FAST_WINDOW_MS
+// tras arrancar, cambiar de canal o recibir una PairingRequest; el resto
+// del tiempo, cada BEACON_PERIOD_MS.
+// Cada TIME_SYNC_PERIOD_MS difunde además la base de tiempo (EdgeTimeSync).
+class ChannelBeacon {
+public:
+    // Después de iniciar ESP-NOW, con el canal en uso
+    void begin(uint8_t channel) {
+        _channel = channel;
+        _fastSince = millis();
+        if (!esp_now_is_peer_exist(BEACON_BROADCAST_MAC)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, BEACON_BROADCAST_MAC, 6);
+            peerInfo.channel = 0;  // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            esp_now_add_peer(&peerInfo);
+        }
+    }
+
+    // Desde el callback de recepción de ESP-NOW; true si era una petición
+    bool handleFrame(const uint8_t*, const uint8_t* data, int len) {
+        PairingRequest request;
+        if (!decodePairingRequest(data, len, request)) return false;
+        _requested = true;
+        return true;
+    }
+
+    // Llamar a menudo (tarea de recepción); emite según el periodo en curso
+    void update() {
+        unsigned long now = millis();
+        bool force = false;
+        if (_requested) {
+            _requested = false;
+            _requests++;
+            _fastSince = now;
+            force = true;
+        }
+
+        if (WiFi.status() == WL_CONNECTED) {
+            uint8_t current = (uint8_t)WiFi.channel();
+            if (current >= 1 && current <= 14 && current != _channel) {
+                Serial.println("📡 Canal ESP-NOW: " + String(_channel) + " -> " + String(current));
+                _channel = current;
+                _fastSince = now;
+                force = true;
+                if (_onChannelChange) _onChannelChange(current);
+            }
+        }
+
+        unsigned long period = now - _fastSince < BEACON_FAST_WINDOW_MS ? BEACON_FAST_PERIOD_MS : BEACON_PERIOD_MS;
+        if (!force && _sent > 0 && now - _lastSent < period) return;
+
+        EdgeBeacon beacon;
+        beacon.channel = _channel;
+        beacon.seq = _seq++;
+        esp_now_send(BEACON_BROADCAST_MAC, (const uint8_t*)&beacon, sizeof(beacon));
+        _lastSent = now;
+        _sent++;
+
+        if (_timeSyncs == 0 || now - _lastTimeSync >= TIME_SYNC_PERIOD_MS) {
+            EdgeTimeSync sync;
+            sync.seq = (uint16_t)_timeSyncs;
+            sync.edgeMs = millis();
+            esp_now_send(BEACON_BROADCAST_MAC, (const uint8_t*)&sync, sizeof(sync));
+            _lastTimeSync = now;
+            _timeSyncs++;
+        }
+    }
+
+    // Aviso de cambio de canal (p. ej. para guardarlo en la configuración)
+    void onChannelChange(void (*callback)(uint8_t channel)) { _onChannelChange = callback; }
+
+    uint8_t getChannel() const { return _channel; }
+    unsigned long getSent() const { return _sent; }
+    unsigned long getTimeSyncs() const { return _timeSyncs; }
+    unsigned long getRequests() const { return _requests; }
+
+private:
+    uint8_t _channel = 0;
+    uint16_t _seq = 0;
+    unsigned long _lastSent = 0;
+    unsigned long _sent = 0;
+    unsigned long _lastTimeSync = 0;
+    unsigned long _timeSyncs = 0;
+    unsigned long _fastSince = 0;
+    unsigned long _requests = 0;
+    volatile bool _requested = false;
+    void (*_onChannelChange)(uint8_t channel) = nullptr;
+};
+
+#endif
@@ -0,0 +1,384 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "ConfigBlob.h"
+#include "ThresholdsController.h"
+#include "ControlLoop.h"
+#include "Scheduler.h"
+
+#define CONFIG_MAX_THRESHOLDS 16
+#define CONFIG_MAX_ACTUATOR_NODES 4
+#define CONFIG_MAX_ZONES 8
+#define CONFIG_MAX_WINDOWS 24
+
+// Parámetros de un lazo PID (el estado del lazo no se guarda)
+struct PidConfig {
+    float setpoint;
+    float kp, ki, kd;
+    uint32_t sampleMs;
+    uint8_t outMin, outMax;
+    uint8_t enabled;
+    uint8_t reserved;
+};
+
+// Parámetros de despliegue del Edge. Solo se añaden campos al final
+// (ver ConfigBlob); al cambiar el esquema se sube CONFIG_VERSION.
+struct EdgeConfig {
+    // v1
+    float thresholds[CONFIG_MAX_THRESHOLDS];   // en el orden de Thresholds::key()
+    uint8_t thresholdCount;
+    uint8_t espNowChannel;
+    uint8_t actuatorCount;
+    uint8_t actuatorMacs[CONFIG_MAX_ACTUATOR_NODES][6];
+    char wifiSsid[33];
+    char wifiPassword[65];
+    char botToken[64];
+    char chatId[24];
+    // v2
+    uint8_t apiEnabled;   // API HTTP local (ver LocalApi)
+    // v3
+    uint16_t sdBudgetMb;    // datos en la SD como mucho (0: sin límite; ver SDRetention)
+    uint16_t sdMinFreeMb;   // espacio libre que se quiere mantener
+    // v4
+    PidConfig pid[CONFIG_MAX_ZONES][LOOP_COUNT];   // por zona, en el orden de ControlLoopId
+    // v5
+    ScheduleWindow windows[CONFIG_MAX_WINDOWS];    // fotoperiodo y riego (ver Scheduler)
+    uint8_t windowCount;
+};
+
+static_assert(CONFIG_MAX_WINDOWS >= Scheduler::MAX_ENTRIES, "EdgeConfig: no caben todas las ventanas");
+
+// Configuración persistente del Edge: se carga una vez al arrancar y las
+// modificaciones se escriben a NVS con retardo (update() desde una tarea):
+// tras DEBOUNCE_MS sin cambios y como mucho una vez cada MIN_INTERVAL_MS,
+// así una ráfaga de /umbral acaba en una sola escritura.
+class ConfigStore {
+public:
+    static constexpr uint16_t CONFIG_VERSION = 5;
+    static constexpr unsigned long DEBOUNCE_MS = 5000;
+    static constexpr unsigned long MIN_INTERVAL_MS = 60000;
+
+    ConfigStore() : _blob("verdevital", CONFIG_VERSION) {}
+
+    // `defaults` lleva los valores de fábrica; devuelve true si había
+    // configuración guardada
+    bool begin(const EdgeConfig& defaults) {
+        memcpy(&_config, &defaults, sizeof(EdgeConfig));
+        uint16_t version = _blob.load(_config);
+        if (version == 0) return false;
+
+        // Umbrales añadidos después de guardar el bloque: valor de fábrica
+        for (uint8_t i = _config.thresholdCount; i < Thresholds::VALUE_COUNT; i++) {
+            _config.thresholds[i] = defaults.thresholds[i];
+        }
+        _config.thresholdCount = Thresholds::VALUE_COUNT;
+        // v1 ocupaba ya el relleno final donde cae apiEnabled (llega a 0)
+        if (version < 2) _config.apiEnabled = defaults.apiEnabled;
+        if (version < 3) {
+            _config.sdBudgetMb = defaults.sdBudgetMb;
+            _config.sdMinFreeMb = defaults.sdMinFreeMb;
+        }
+        if (version < 4) memcpy(_config.pid, defaults.pid, sizeof(_config.pid));
+        if (version < 5) _config.windowCount = 0;
+        if (version != CONFIG_VERSION) markDirty();
+        Serial.println("💾 Configuración cargada de NVS (v" + String(version) + ")");
+        return true;
+    }
+
+    // Valores de fábrica a partir de los objetos ya construidos (todo a 0
+    // primero: el CRC cubre también el relleno del struct)
+    static EdgeConfig makeDefaults(const Thresholds& t, uint8_t channel, const char* ssid, const char* password,
+                                   const String& token, const String& chat) {
+        EdgeConfig c;
+        memset(&c, 0, sizeof(c));
+        c.thresholdCount = Thresholds::VALUE_COUNT;
+        for (uint8_t i = 0; i < Thresholds::VALUE_COUNT; i++) c.thresholds[i] = t.getValue(i);
+        c.espNowChannel = channel;
+        strncpy(c.wifiSsid, ssid, sizeof(c.wifiSsid) - 1);
+        strncpy(c.wifiPassword, password, sizeof(c.wifiPassword) - 1);
+        strncpy(c.botToken, token.c_str(), sizeof(c.botToken) - 1);
+        strncpy(c.chatId, chat.c_str(), sizeof(c.chatId) - 1);
+        c.apiEnabled = 1;
+        c.sdBudgetMb = 0;
+        c.sdMinFreeMb = 64;
+        ControlLoops loops;
+        for (uint8_t zone = 0; zone < CONFIG_MAX_ZONES; zone++) {
+            for (uint8_t l = 0; l < LOOP_COUNT; l++) toPidConfig(loops.loops[l], c.pid[zone][l]);
+        }
+        return c;
+    }
+
+    const EdgeConfig& get() const { return _config; }
+
+    void applyThresholds(Thresholds& t) const {
+        for (uint8_t i = 0; i < Thresholds::VALUE_COUNT; i++) t.setValue(i, _config.thresholds[i]);
+    }
+
+    void captureThresholds(const Thresholds& t) {
+        portENTER_CRITICAL(&_mux);
+        for (uint8_t i = 0; i < Thresholds::VALUE_COUNT; i++) _config.thresholds[i] = t.getValue(i);
+        markDirtyLocked();
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    // Lazos PID guardados sobre los de cada zona; los activos empiezan de cero
+    void applyPid(ControlLoops* zones, uint8_t count) const {
+        for (uint8_t zone = 0; zone < count && zone < CONFIG_MAX_ZONES; zone++) {
+            for (uint8_t l = 0; l < LOOP_COUNT; l++) {
+                const PidConfig& c = _config.pid[zone][l];
+                PIDLoop& loop = zones[zone].loops[l];
+                loop.setpoint = c.setpoint;
+                loop.kp = c.kp;
+                loop.ki = c.ki;
+                loop.kd = c.kd;
+                loop.sampleMs = c.sampleMs;
+                loop.outMin = c.outMin;
+                loop.outMax = c.outMax;
+                loop.enabled = c.enabled;
+                loop.reset();
+            }
+        }
+    }
+
+    // Tras /pid: `loops` es una copia de los lazos de la zona
+    void capturePid(uint8_t zone, const ControlLoops& loops) {
+        if (zone >= CONFIG_MAX_ZONES) return;
+        PidConfig next[LOOP_COUNT];
+        for (uint8_t l = 0; l < LOOP_COUNT; l++) toPidConfig(loops.loops[l], next[l]);
+        portENTER_CRITICAL(&_mux);
+        memcpy(_config.pid[zone], next, sizeof(next));
+        markDirtyLocked();
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    void applySchedule(Scheduler& scheduler) const {
+        scheduler.importWindows(_config.windows, _config.windowCount);
+    }
+
+    // Tras /horario: ventanas exportadas de una copia del Scheduler
+    void captureSchedule(const ScheduleWindow* windows, uint8_t count) {
+        if (count > CONFIG_MAX_WINDOWS) count = CONFIG_MAX_WINDOWS;
+        portENTER_CRITICAL(&_mux);
+        memcpy(_config.windows, windows, count * sizeof(ScheduleWindow));
+        _config.windowCount = count;
+        markDirtyLocked();
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    // Cambia un parámetro por nombre: los de Thresholds::key() y además
+    // canal, actuadorN (MAC), ssid, clave_wifi, token, chat, api (0/1),
+    // sd_max_mb y sd_libre_mb (MB, 0-60000)
+    bool set(const String& name, const String& value) {
+        // Se interpreta fuera de la sección crítica (String, sscanf); dentro
+        // solo se copian los bytes del campo
+        FieldChange change;
+        if (!parseField(name, value, change)) return false;
+
+        portENTER_CRITICAL(&_mux);
+        bool ok = change.actuator < 0 || change.actuator <= _config.actuatorCount;
+        if (ok) {
+            memcpy((uint8_t*)&_config + change.offset, change.bytes, change.size);
+            if (change.actuator == _config.actuatorCount) _config.actuatorCount++;
+            markDirtyLocked();
+        }
+        portEXIT_CRITICAL(&_mux);
+        return ok;
+    }
+
+    // Una línea clave=valor por parámetro; sin secretos salvo que se pidan
+    String exportText(bool includeSecrets) const {
+        String s = "";
+        for (uint8_t i = 0; i < Thresholds::VALUE_COUNT; i++) {
+            s += String(Thresholds::key(i)) + "=" + String(_config.thresholds[i]) + "\n";
+        }
+        s += "canal=" + String(_config.espNowChannel) + "\n";
+        for (uint8_t i = 0; i < _config.actuatorCount; i++) {
+            s += "actuador" + String(i) + "=" + formatMac(_config.actuatorMacs[i]) + "\n";
+        }
+        s += "api=" + String(_config.apiEnabled) + "\n";
+        s += "sd_max_mb=" + String(_config.sdBudgetMb) + "\n";
+        s += "sd_libre_mb=" + String(_config.sdMinFreeMb) + "\n";
+        s += "ssid=" + String(_config.wifiSsid) + "\n";
+        s += "chat=" + String(_config.chatId) + "\n";
+        if (includeSecrets) {
+            s += "clave_wifi=" + String(_config.wifiPassword) + "\n";
+            s += "token=" + String(_config.botToken) + "\n";
+        }
+        return s;
+    }
+
+    // Aplica líneas clave=valor (separadas por salto de línea o ';').
+    // Devuelve cuántas se aplicaron; las no reconocidas van a `rejected`.
+    int importText(const String& text, String& rejected) {
+        int applied = 0;
+        unsigned int from = 0;
+        while (from < text.length()) {
+            int nl = text.indexOf('\n', from);
+            int sc = text.indexOf(';', from);
+            int end = nl < 0 ? sc : (sc < 0 ? nl : (nl < sc ? nl : sc));
+            if (end < 0) end = text.length();
+            String line = text.substring(from, end);
+            line.trim();
+            from = end + 1;
+            if (line.isEmpty()) continue;
+
+            int eq = line.indexOf('=');
+            String name = eq > 0 ? line.substring(0, eq) : line;
+            String value = eq > 0 ? line.substring(eq + 1) : String();
+            name.trim();
+            value.trim();
+            if (eq > 0 && set(name, value)) applied++;
+            else rejected += name + " ";
+        }
+        return applied;
+    }
+
+    void markDirty() {
+        portENTER_CRITICAL(&_mux);
+        markDirtyLocked();
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    // Escritura diferida; llamar periódicamente desde una tarea
+    void update() {
+        unsigned long now = millis();
+        if (!_dirty || now - _lastChange < DEBOUNCE_MS) return;
+        if (_hasCommitted && now - _lastCommit < MIN_INTERVAL_MS) return;
+        commitNow();
+    }
+
+    // La escritura a flash se hace sobre una copia, fuera de la sección crítica
+    bool commitNow() {
+        portENTER_CRITICAL(&_mux);
+        memcpy(&_snapshot, &_config, sizeof(EdgeConfig));
+        unsigned long changeAt = _lastChange;
+        portEXIT_CRITICAL(&_mux);
+
+        bool ok = _blob.save(_snapshot);
+        if (ok) {
+            portENTER_CRITICAL(&_mux);
+            if (_lastChange == changeAt) _dirty = false;   // sin cambios durante la escritura
+            portEXIT_CRITICAL(&_mux);
+            _lastCommit = millis();
+            _hasCommitted = true;
+        }
+        return ok;
+    }
+
+    bool isDirty() const { return _dirty; }
+    unsigned long writes() const { return _blob.writes(); }
+
+    static String formatMac(const uint8_t* mac) {
+        char buf[18];
+        snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        return String(buf);
+    }
+
+    static bool parseMac(const String& text, uint8_t out[6]) {
+        unsigned int b[6];
+        if (sscanf(text.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) return false;
+        for (int i = 0; i < 6; i++) {
+            if (b[i] > 0xFF) return false;
+            out[i] = (uint8_t)b[i];
+        }
+        return true;
+    }
+
+private:
+    ConfigBlob<EdgeConfig> _blob;
+    EdgeConfig _config;
+    EdgeConfig _snapshot;   // copia que se escribe
+    bool _dirty = false;
+    bool _hasCommitted = false;
+    unsigned long _lastChange = 0;
+    unsigned long _lastCommit = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    static void toPidConfig(const PIDLoop& loop, PidConfig& c) {
+        memset(&c, 0, sizeof(c));
+        c.setpoint = loop.setpoint;
+        c.kp = loop.kp;
+        c.ki = loop.ki;
+        c.kd = loop.kd;
+        c.sampleMs = (uint32_t)loop.sampleMs;
+        c.outMin = (uint8_t)lroundf(loop.outMin);
+        c.outMax = (uint8_t)lroundf(loop.outMax);
+        c.enabled = loop.enabled;
+    }
+
+    // Un parámetro ya interpretado: bytes nuevos de un campo de EdgeConfig
+    struct FieldChange {
+        size_t offset = 0;
+        size_t size = 0;
+        uint8_t bytes[65];
+        int8_t actuator = -1;   // actuadorN: n se valida con actuatorCount al aplicar
+    };
+
+    template <typename V>
+    static void putField(FieldChange& change, size_t offset, const V& value) {
+        change.offset = offset;
+        change.size = sizeof(V);
+        memcpy(change.bytes, &value, sizeof(V));
+    }
+
+    static bool parseField(const String& name, const String& value, FieldChange& change) {
+        int t = Thresholds::keyIndex(name);
+        float number = value.toFloat();
+        uint8_t mac[6];
+        bool ok = true;
+
+        if (t >= 0) {
+            putField(change, offsetof(EdgeConfig, thresholds) + t * sizeof(float), number);
+        } else if (name == "canal") {
+            ok = number >= 1 && number <= 14;
+            if (ok) putField(change, offsetof(EdgeConfig, espNowChannel), (uint8_t)number);
+        } else if (name.startsWith("actuador") && name.length() == 9) {
+            int n = name.charAt(8) - '0';
+            ok = n >= 0 && n < CONFIG_MAX_ACTUATOR_NODES && parseMac(value, mac);
+            if (ok) putField(change, offsetof(EdgeConfig, actuatorMacs) + n * sizeof(mac), mac);
+            change.actuator = (int8_t)n;
+        } else if (name == "api") {
+            ok = value == "0" || value == "1";
+            if (ok) putField(change, offsetof(EdgeConfig, apiEnabled), (uint8_t)number);
+        } else if (name == "sd_max_mb" || name == "sd_libre_mb") {
+            ok = value.length() > 0 && number >= 0 && number <= 60000;
+            if (ok) {
+                putField(change, name == "sd_max_mb" ? offsetof(EdgeConfig, sdBudgetMb) : offsetof(EdgeConfig, sdMinFreeMb),
+                         (uint16_t)number);
+            }
+        } else if (name == "ssid") {
+            ok = putText(change, offsetof(EdgeConfig, wifiSsid), sizeof(EdgeConfig::wifiSsid), value);
+        } else if (name == "clave_wifi") {
+            ok = putText(change, offsetof(EdgeConfig, wifiPassword), sizeof(EdgeConfig::wifiPassword), value);
+        } else if (name == "token") {
+            ok = putText(change, offsetof(EdgeConfig, botToken), sizeof(EdgeConfig::botToken), value);
+        } else if (name == "chat") {
+            ok = putText(change, offsetof(EdgeConfig, chatId), sizeof(EdgeConfig::chatId), value);
+        } else {
+            ok = false;
+        }
+        return ok;
+    }
+
+    static bool putText(FieldChange& change, size_t offset, size_t size, const String& value) {
+        if (size > sizeof(change.bytes)) return false;
+        change.offset = offset;
+        change.size = size;
+        return copyText((char*)change.bytes, size, value);
+    }
+
+    void markDirtyLocked() {
+        _dirty = true;
+        _lastChange = millis();
+    }
+
+    static bool copyText(char* out, size_t size, const String& value) {
+        if (value.length() >= size) return false;
+        memset(out, 0, size);
+        memcpy(out, value.c_str(), value.length());
+        return true;
+    }
+};
+
+#endif
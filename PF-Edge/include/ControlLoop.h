@@ -0,0 +1,189 @@
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+#include <Arduino.h>
+#include "dataSensor.h"
+#include "dataActuator.h"
+
+// Lazo PID discreto con salida acotada (por defecto 0-255, el nivel de
+// ActuatorState). Solo recalcula cuando ha pasado sampleMs desde el último
+// cálculo; el tiempo lo pasa quien llama, así el mismo código corre en el
+// Edge y contra el modelo de planta del host (host/src/tune_main.cpp).
+//
+// - Derivada sobre la medida (sin picos al cambiar la consigna).
+// - Anti-windup: no se integra mientras la salida está saturada en la
+//   dirección del error, y el integral se limita a [outMin, outMax].
+// - reverse = true para lazos de enfriamiento: la salida sube cuando la
+//   medida supera la consigna (ventilador).
+class PIDLoop {
+public:
+    float setpoint;
+    float kp, ki, kd;             // ki en 1/s, kd en s
+    float outMin = 0.0f;
+    float outMax = 255.0f;
+    unsigned long sampleMs = 2000;
+    bool reverse;
+    bool enabled = false;
+
+    PIDLoop(float setpoint, float kp, float ki, float kd, bool reverse)
+        : setpoint(setpoint), kp(kp), ki(ki), kd(kd), reverse(reverse) {}
+
+    void reset() {
+        _integral = 0.0f;
+        _output = 0.0f;
+        _hasLast = false;
+    }
+
+    // Devuelve true si tocaba muestrear; la salida queda en getOutput()
+    bool compute(float measurement, unsigned long nowMs) {
+        if (_hasLast && nowMs - _lastMs < sampleMs) return false;
+
+        float dt = _hasLast ? (nowMs - _lastMs) / 1000.0f : sampleMs / 1000.0f;
+        float error = reverse ? measurement - setpoint : setpoint - measurement;
+        float dError = _hasLast ? (reverse ? 1.0f : -1.0f) * (measurement - _lastMeasurement) / dt : 0.0f;
+
+        float p = kp * error;
+        float d = kd * dError;
+        float integral = _integral + ki * error * dt;
+        float unclamped = p + integral + d;
+
+        // Anti-windup por integración condicional
+        if ((unclamped > outMax && error > 0) || (unclamped < outMin && error < 0)) {
+            integral = _integral;
+        }
+        _integral = constrain(integral, outMin, outMax);
+        _output = constrain(p + _integral + d, outMin, outMax);
+
+        _lastError = error;
+        _lastMeasurement = measurement;
+        _lastMs = nowMs;
+        _hasLast = true;
+        return true;
+    }
+
+    float getOutput() const { return _output; }
+    float getIntegral() const { return _integral; }
+    float getLastError() const { return _lastError; }
+
+private:
+    float _integral = 0.0f;
+    float _output = 0.0f;
+    float _lastError = 0.0f;
+    float _lastMeasurement = 0.0f;
+    unsigned long _lastMs = 0;
+    bool _hasLast = false;
+};
+
+enum ControlLoopId : uint8_t {
+    LOOP_TEMPERATURE = 0,   // ventilador (PWM)
+    LOOP_SOIL = 1,          // bomba (relé, por duración de pulso)
+    LOOP_LIGHT = 2,         // LEDs (PWM)
+    LOOP_COUNT = 3
+};
+
+// Lazos de una zona. Si un lazo está activo sustituye la salida todo/nada
+// de Thresholds::evaluate para su actuador; las alertas no cambian.
+// La bomba va en relé: su salida se convierte en un pulso dentro de una
+// ventana fija (pumpWindowMs · salida/255 encendida al inicio de cada
+// ventana), con la resolución del periodo de muestreo de los sensores.
+class ControlLoops {
+public:
+    unsigned long pumpWindowMs = 60000;
+
+    PIDLoop loops[LOOP_COUNT] = {
+        PIDLoop(26.0f, 40.0f, 0.5f, 0.0f, true),     // °C
+        PIDLoop(55.0f, 40.0f, 0.1f, 0.0f, false),    // % humedad de suelo
+        PIDLoop(600.0f, 0.1f, 0.05f, 0.0f, false),   // luz
+    };
+
+    // Aplica los lazos activos sobre la decisión de la zona
+    // (los PID calculan en float, en la unidad de cada canal). Un lazo cuyo
+    // canal viene marcado en unusable (ver SensorQuality) no calcula con la
+    // muestra y deja su actuador como lo dejó evaluate (apagado).
+    void apply(const SensorData& data, unsigned long nowMs, ActuatorState& state, uint16_t unusable = 0) {
+        PIDLoop& temp = loops[LOOP_TEMPERATURE];
+        if (temp.enabled && !(unusable >> SENSOR_TEMPERATURE & 1)) {
+            temp.compute(sensorToFloat(SENSOR_TEMPERATURE, data.temperature), nowMs);
+            state.fan = quantize(temp.getOutput());
+        }
+
+        PIDLoop& light = loops[LOOP_LIGHT];
+        if (light.enabled && !(unusable >> SENSOR_LIGHT & 1)) {
+            light.compute(sensorToFloat(SENSOR_LIGHT, data.light), nowMs);
+            state.leds = quantize(light.getOutput());
+        }
+
+        PIDLoop& soil = loops[LOOP_SOIL];
+        if (soil.enabled && (unusable >> SENSOR_SOIL & 1)) {
+            _windowStarted = false;   // ventana nueva al volver la lectura
+        } else if (soil.enabled) {
+            if (!_windowStarted || nowMs - _windowStart >= pumpWindowMs) {
+                soil.compute(sensorToFloat(SENSOR_SOIL, data.soilMoisture), nowMs);
+                _windowStart = nowMs;
+                _windowStarted = true;
+                _pumpOnMs = (unsigned long)(pumpWindowMs * (soil.getOutput() / 255.0f));
+            }
+            state.waterPump = nowMs - _windowStart < _pumpOnMs ? ACTUATOR_VALUE_ON : 0;
+        }
+    }
+
+    // "/pid <lazo> <param> <valor>": lazo temp|suelo|luz; param sp, kp,
+    // ki, kd, min, max, ts (ms) u on/off sin valor. Devuelve false si no
+    // se reconoce.
+    bool updateFromCommand(const String& loopName, const String& param, float value) {
+        int id = loopIndex(loopName);
+        if (id < 0) return false;
+        PIDLoop& l = loops[id];
+
+        if (param == "on") {
+            l.reset();
+            l.enabled = true;
+            if (id == LOOP_SOIL) _windowStarted = false;
+        }
+        else if (param == "off") l.enabled = false;
+        else if (param == "sp") l.setpoint = value;
+        else if (param == "kp") l.kp = value;
+        else if (param == "ki") l.ki = value;
+        else if (param == "kd") l.kd = value;
+        else if (param == "min") l.outMin = constrain(value, 0.0f, 255.0f);
+        else if (param == "max") l.outMax = constrain(value, 0.0f, 255.0f);
+        else if (param == "ts" && value >= 100) l.sampleMs = (unsigned long)value;
+        else return false;
+        return true;
+    }
+
+    String getStatus() const {
+        static const char* names[LOOP_COUNT] = {"temp", "suelo", "luz"};
+        String s = "🎯 Lazos PID:\n";
+        for (uint8_t i = 0; i < LOOP_COUNT; i++) {
+            const PIDLoop& l = loops[i];
+            s += String(names[i]) + (l.enabled ? " ON" : " OFF") + ": sp " + String(l.setpoint) +
+                 ", kp " + String(l.kp, 3) + ", ki " + String(l.ki, 3) + ", kd " + String(l.kd, 3) +
+                 ", salida " + String(l.outMin, 0) + "-" + String(l.outMax, 0) +
+                 ", ts " + String(l.sampleMs) + " ms → " + String(l.getOutput(), 0) + "\n";
+        }
+        return s;
+    }
+
+    static int loopIndex(const String& name) {
+        if (name == "temp") return LOOP_TEMPERATURE;
+        if (name == "suelo") return LOOP_SOIL;
+        if (name == "luz") return LOOP_LIGHT;
+        return -1;
+    }
+
+private:
+    unsigned long _windowStart = 0;
+    unsigned long _pumpOnMs = 0;
+    bool _windowStarted = false;
+
+    // Pasos de 16, como Thresholds::proportionalDuty, para no reenviar por ruido
+    static uint8_t quantize(float output) {
+        if (output >= 255.0f) return 255;
+        if (output <= 0.0f) return 0;
+        int q = (int)(output + 8.0f) / 16 * 16;
+        return (uint8_t)(q > 255 ? 255 : q);
+    }
+};
+
+#endif
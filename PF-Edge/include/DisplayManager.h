@@ -6,6 +6,7 @@
 #include <Adafruit_SSD1306.h>
 #include "dataSensor.h"
 #include "dataActuator.h"
+#include "ThresholdsController.h"
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
@@ -29,6 +30,22 @@ private:
     String telegramCmd = "/start";
     String alerta = "";
 
+    // "Temp:  ": etiqueta del canal alineada a 7 columnas
+    static String padLabel(const char* label) {
+        String s = String(label) + ":";
+        while (s.length() < 7) s += " ";
+        return s;
+    }
+
+    // La fuente del SSD1306 no tiene "°": solo se dejan los caracteres ASCII
+    static String asciiOnly(const char* text) {
+        String s;
+        for (const char* p = text; *p; p++) {
+            if ((uint8_t)*p < 0x80) s += *p;
+        }
+        return s;
+    }
+
 public:
     // Constructor sin botón
     DisplayManager(bool autoMode = false)
@@ -55,27 +72,28 @@ public:
 
     void setSensorData(const SensorData& data, const String& rssiWifi = "") {
         sensorData = "";
-        sensorData += "Temp:  " + String(data.temperature, 1) + " C\n";
-        sensorData += "Hum:   " + String(data.humidity, 1) + " %\n";
-        sensorData += "Luz:   " + String(data.light) + "\n";
-        sensorData += "CO2:   " + String(data.co2ppm) + " ppm\n";
-        sensorData += "Suelo: " + String(data.soilMoisture, 1) + " %\n";
-        sensorData += "Volt:  " + String(data.voltage, 2) + " V\n";
+        char value[16];
+        visitSensorChannels(data, [&](const SensorChannel& ch, int32_t raw) {
+            formatSensorValue(value, sizeof(value), ch, raw, ch.decimals);
+            sensorData += padLabel(ch.label) + value;
+            if (*ch.unit) sensorData += " " + asciiOnly(ch.unit);
+            sensorData += "\n";
+        });
         sensorData += "RSSI:  " + rssiWifi + " dBm\n";
     }
 
     void setActuadorEstado(const ActuatorState& state) {
         actuadorEstado = "";
-        actuadorEstado += "Bomba: " + String(state.waterPump ? "ON" : "OFF") + "\n";
-        actuadorEstado += "Vent:  " + String(state.fan ? "ON" : "OFF") + "\n";
-        actuadorEstado += "Luces: " + String(state.leds ? "ON" : "OFF");
+        actuadorEstado += "Bomba: " + Thresholds::formatLevel(state.waterPump) + "\n";
+        actuadorEstado += "Vent:  " + Thresholds::formatLevel(state.fan) + "\n";
+        actuadorEstado += "Luces: " + Thresholds::formatLevel(state.leds);
     }
 
     void setTelegramCmd(const String& cmd) {
         telegramCmd = cmd;
     }
 
-    void setAlerta(bool criticState, bool lsoilM, bool hsoilM, bool lTemp, bool hTemp, bool co2, bool light, bool voltage, bool rssi, bool espsensor, bool espactuator) {
+    void setAlerta(bool criticState, bool lsoilM, bool hsoilM, bool lTemp, bool hTemp, bool co2, bool light, bool voltage, bool rssi, bool espsensor, bool espactuator, bool sensorFault) {
         alerta = "";
         if (criticState) alerta += "FALLA CRITICA!\n";
         if (voltage) alerta += " - Voltaje bajo\n";
@@ -88,6 +106,7 @@ public:
         if (co2) alerta += "CO2 alto\n";
         if (light) alerta += "Luz insuficiente\n";
         if (rssi) alerta += "Conexión WiFi débil\n";
+        if (sensorFault) alerta += "Fallo de sensor\n";
     }
 
     void mostrarPagina() {
@@ -5,20 +5,40 @@
 #include <esp_now.h>
 #include <esp_wifi.h>
 #include "dataSensor.h"
+#include "RelayPathTable.h"
 
 class ESPNowReceiver {
 private:
     uint8_t _channel;
-    void (*_onReceiveCallback)(const SensorData&);
+    void (*_onReceiveCallback)(const uint8_t* mac, const SensorData&, unsigned long sampleMs);
+    void (*_onRawFrameCallback)(const uint8_t* mac, const uint8_t* data, int len) = nullptr;
     static ESPNowReceiver* _instance;
 
     static constexpr unsigned long TIMEOUT_MS = 10000;  // 10 segundos
     unsigned long _lastReceivedTime = 0;
     bool _connected = false;
+    volatile unsigned long _layoutMismatches = 0;
+    bool _mismatchReported = false;
+    RelayPathTable _paths;   // caminos de los nodos (directos o por relevo)
+    portMUX_TYPE _pathMux = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t _ownMac[6] = {0};
+
+    static bool addPeer(const uint8_t* mac) {
+        if (esp_now_is_peer_exist(mac)) return true;
+        esp_now_peer_info_t peerInfo = {};
+        memcpy(peerInfo.peer_addr, mac, 6);
+        peerInfo.channel = 0;   // canal actual
+        peerInfo.encrypt = false;
+        peerInfo.ifidx = WIFI_IF_STA;
+        return esp_now_add_peer(&peerInfo) == ESP_OK;
+    }
 
 public:
     ESPNowReceiver(uint8_t channel = 1) : _channel(channel), _onReceiveCallback(nullptr) {}
 
+    // Antes de begin()
+    void setChannel(uint8_t channel) { _channel = channel; }
+
     void begin() {
         WiFi.mode(WIFI_STA);
         esp_wifi_set_channel(_channel, WIFI_SECOND_CHAN_NONE);
@@ -27,10 +47,40 @@ public:
             Serial.println("❌ Error al iniciar ESP-NOW");
             return;
         }
+        esp_wifi_get_mac(WIFI_IF_STA, _ownMac);
 
         esp_now_register_recv_cb([](const uint8_t *mac, const uint8_t *incomingDataRaw, int len) {
+            // Trama de un nodo en sobre de relevo (SensorRelay.h): se anota el
+            // camino, se descartan duplicados y se sigue con la del nodo de origen
+            unsigned long now = millis();
+            unsigned long sentMs = now;   // salida del origen en el reloj del Edge
+            RelayHeader relay;
+            const uint8_t* payload;
+            int payloadLen;
+            if (_instance && decodeRelayFrame(incomingDataRaw, len, relay, payload, payloadLen)) {
+                portENTER_CRITICAL(&_instance->_pathMux);
+                bool fresh = _instance->_paths.record(mac, relay, millis());
+                portEXIT_CRITICAL(&_instance->_pathMux);
+                if (!fresh) return;
+                // Por relevo, la hora de salida que selló el nodo (si la
+                // tiene y no cae en el futuro, p. ej. tras reiniciar el Edge)
+                if (relay.hops > 0 && relay.sentMs != 0 && (long)(now - relay.sentMs) >= 0) sentMs = relay.sentMs;
+                mac = relay.origin;
+                incomingDataRaw = payload;
+                len = payloadLen;
+            }
+
+            if (_instance && _instance->_onRawFrameCallback) {
+                _instance->_onRawFrameCallback(mac, incomingDataRaw, len);
+            }
+
             SensorData data;
-            memcpy(&data, incomingDataRaw, sizeof(SensorData));
+            uint16_t ageMs = 0;
+            if (!decode(incomingDataRaw, len, data, &ageMs)) {
+                // Trama de sensores de un firmware con otro registro de canales
+                if (_instance && len > 0 && incomingDataRaw[0] == SENSOR_FRAME_TYPE) _instance->_layoutMismatches++;
+                return;
+            }
 
             if (_instance) {
                 _instance->_lastReceivedTime = millis();
@@ -40,7 +90,7 @@ public:
                 _instance->_connected = true;
 
                 if (_instance->_onReceiveCallback) {
-                    _instance->_onReceiveCallback(data);
+                    _instance->_onReceiveCallback(mac, data, sentMs - ageMs);
                 }
             }
         });
@@ -50,11 +100,28 @@ public:
         Serial.println("✅ ESP-NOW Receptor listo");
     }
 
-    void onReceive(void (*callback)(const SensorData&)) {
+    // Decodifica una trama de sensores (SensorFrame); descarta las de otro
+    // tipo, tamaño o registro de canales
+    static bool decode(const uint8_t* raw, int len, SensorData& out, uint16_t* ageMs = nullptr) {
+        return decodeSensorFrame(raw, len, out, ageMs);
+    }
+
+    // sampleMs: instante de adquisición en millis() del Edge, la salida
+    // del nodo (su llegada si es directa) menos la edad de la muestra
+    void onReceive(void (*callback)(const uint8_t* mac, const SensorData&, unsigned long sampleMs)) {
         _onReceiveCallback = callback;
     }
 
+    // Recibe cada trama sin decodificar (p. ej. para grabar trazas)
+    void onRawFrame(void (*callback)(const uint8_t* mac, const uint8_t* data, int len)) {
+        _onRawFrameCallback = callback;
+    }
+
     void update() {
+        if (_layoutMismatches > 0 && !_mismatchReported) {
+            _mismatchReported = true;
+            Serial.println("⚠️ Tramas de sensores con otro registro de canales: actualiza el firmware del nodo");
+        }
         if (_connected && millis() - _lastReceivedTime > TIMEOUT_MS) {
             _connected = false;
             Serial.println("⚠️ Nodo inactivo (timeout)");
@@ -64,6 +131,33 @@ public:
     bool isConnected() const {
         return _connected;
     }
+
+    unsigned long getLayoutMismatches() const { return _layoutMismatches; }
+
+    // Trama del Edge hacia un nodo sensor: directa o, si llega por relevo,
+    // en el sobre de bajada por la ruta de padres que anunció (SensorRelay.h);
+    // sin ruta completa se intenta directa
+    esp_err_t sendDown(const uint8_t* mac, const uint8_t* data, int len) {
+        uint8_t route[RELAY_MAX_HOPS][6];
+        portENTER_CRITICAL(&_pathMux);
+        uint8_t count = _paths.route(mac, _ownMac, route);
+        portEXIT_CRITICAL(&_pathMux);
+        if (count <= 1) return esp_now_send(mac, data, len);
+
+        uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+        int frameLen = encodeRelayDown(route, count, data, len, frame);
+        if (frameLen == 0) return ESP_ERR_INVALID_SIZE;
+        if (!addPeer(route[0])) return ESP_ERR_ESPNOW_NOT_FOUND;
+        return esp_now_send(route[0], frame, frameLen);
+    }
+
+    // Copia de los caminos (pérdidas, latencia y saltos por nodo)
+    RelayPathTable getPaths() {
+        portENTER_CRITICAL(&_pathMux);
+        RelayPathTable copy = _paths;
+        portEXIT_CRITICAL(&_pathMux);
+        return copy;
+    }
 };
 
 ESPNowReceiver* ESPNowReceiver::_instance = nullptr;
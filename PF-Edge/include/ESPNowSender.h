@@ -4,19 +4,108 @@
 #include <WiFi.h>
 #include <esp_now.h>
 #include <esp_wifi.h>
-#include "dataActuator.h"  // Incluimos la estructura ActuatorState
-
-// Estructura que se enviará por ESP-NOW (idéntica a ActuatorState)
-typedef ActuatorState struct_message;
+#include "dataActuator.h"  // Incluimos las tramas de actuadores
 
+// Envío fiable a un nodo actuador. Se guarda el valor deseado y el último
+// confirmado de cada canal del nodo; flush() envía como lista canal/valor
+// solo los canales que aún no coinciden. Cada comando lleva un número de
+// secuencia y se retransmite con backoff exponencial hasta recibir el ACK
+// con los valores aplicados o agotar los intentos. La salud del enlace
+// (isPeerConnected) sale de los ACK, no del callback de la capa MAC.
+//
+// Si no hay diferencias no se transmite nada; update() manda además un
+// latido lento con todos los canales para resincronizar un nodo reiniciado.
 class ESPNowActuatorSender {
 private:
-    uint8_t _peerAddress[6];
-    uint8_t _channel;
-    static bool _peerConnected;  // Nuevo atributo
+    uint8_t _peerAddress[6] = {0};
+    uint8_t _channel = 1;
+    bool _peerConnected = false;
+
+    static constexpr unsigned long RETRY_BASE_MS = 60;
+    static constexpr uint8_t MAX_ATTEMPTS = 6;     // 60+120+240+480+960 ms ≈ 1.9 s
+    static constexpr unsigned long HEARTBEAT_MS = 30000;
+
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    // Canales del nodo (ids locales) y sus valores
+    uint8_t _ids[ACTUATOR_MAX_CHANNELS];
+    uint8_t _count = 0;
+    uint8_t _desired[ACTUATOR_MAX_CHANNELS] = {0};
+    uint8_t _applied[ACTUATOR_MAX_CHANNELS] = {0};
+    bool _known[ACTUATOR_MAX_CHANNELS] = {false};
+
+    uint16_t _nextSeq = 1;   // al azar en begin(): ver allí
+    ActuatorCommand _pending;
+    bool _hasPending = false;
+    uint8_t _attempts = 0;
+    unsigned long _firstSentUs = 0;
+    unsigned long _nextRetryAt = 0;
+    unsigned long _lastTxAt = 0;
+
+    // Estadísticas del enlace (latencia de extremo a extremo hasta el ACK)
+    unsigned long _lastLatencyUs = 0;
+    float _avgLatencyUs = 0.0f;
+    unsigned long _commands = 0;
+    unsigned long _retries = 0;
+    unsigned long _timeouts = 0;
+    unsigned long _suppressed = 0;
+
+    int indexOf(uint8_t id) const {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_ids[i] == id) return i;
+        }
+        return -1;
+    }
+
+    esp_err_t transmit(const ActuatorCommand& cmd) {
+        _lastTxAt = millis();
+        return esp_now_send(_peerAddress, (const uint8_t *)&cmd, cmd.frameLength());
+    }
+
+    // Construye y envía un comando; `all` incluye también los canales ya confirmados
+    bool sendPending(bool all) {
+        ActuatorCommand cmd;
+        portENTER_CRITICAL(&_mux);
+        for (uint8_t i = 0; i < _count; i++) {
+            if (all || !_known[i] || _applied[i] != _desired[i]) {
+                cmd.values[cmd.count].channel = _ids[i];
+                cmd.values[cmd.count].value = _desired[i];
+                cmd.count++;
+            }
+        }
+
+        bool inFlightSame = _hasPending && cmd.count == _pending.count &&
+                            memcmp(cmd.values, _pending.values, 2 * cmd.count) == 0;
+        if (cmd.count == 0 || (!all && inFlightSame)) {
+            if (cmd.count == 0) _hasPending = false;
+            _suppressed++;
+            portEXIT_CRITICAL(&_mux);
+            return false;
+        }
+
+        cmd.seq = _nextSeq++;
+        _pending = cmd;
+        _hasPending = true;
+        _attempts = 1;
+        _firstSentUs = micros();
+        _nextRetryAt = millis() + RETRY_BASE_MS;
+        _commands++;
+        portEXIT_CRITICAL(&_mux);
+
+        esp_err_t result = transmit(cmd);
+        if (result == ESP_OK) {
+            Serial.println("📨 Estado de actuadores enviado correctamente");
+        } else {
+            Serial.print("⚠️ Error al enviar estado: ");
+            Serial.println(esp_err_to_name(result));
+        }
+        return true;
+    }
 
 public:
-    ESPNowActuatorSender(const uint8_t mac[6], uint8_t channel) {
+    // Sin reservas: la tabla de ActuatorNetwork es un array fijo y cada
+    // entrada se asigna a su nodo con setPeer() antes de begin()
+    void setPeer(const uint8_t mac[6], uint8_t channel) {
         memcpy(_peerAddress, mac, 6);
         _channel = channel;
     }
@@ -25,6 +114,11 @@ public:
         WiFi.mode(WIFI_STA);
         esp_wifi_set_channel(_channel, WIFI_SECOND_CHAN_NONE);
 
+        // El nodo descarta un comando con la misma secuencia que el último:
+        // tras reiniciar el Edge se parte de un valor al azar (con la radio
+        // ya encendida), no de 1, para no repetir la de antes del reinicio
+        _nextSeq = (uint16_t)esp_random();
+
         if (esp_now_init() != ESP_OK) {
             Serial.println("❌ Error al iniciar ESP-NOW");
             return;
@@ -32,18 +126,12 @@ public:
 
         esp_now_register_send_cb([](const uint8_t *mac_addr, esp_now_send_status_t status) {
             Serial.print("📤 Estado del envío de actuadores: ");
-            if (status == ESP_NOW_SEND_SUCCESS) {
-                Serial.println("Éxito");
-                _peerConnected = true;  // Actualiza estado
-            } else {
-                Serial.println("Fallido");
-                _peerConnected = false;
-            }
+            Serial.println(status == ESP_NOW_SEND_SUCCESS ? "Éxito" : "Fallido");
         });
 
         esp_now_peer_info_t peerInfo = {};
         memcpy(peerInfo.peer_addr, _peerAddress, 6);
-        peerInfo.channel = _channel;
+        peerInfo.channel = 0;  // canal actual: sigue al AP si cambia
         peerInfo.encrypt = false;
         peerInfo.ifidx = WIFI_IF_STA;
 
@@ -57,24 +145,113 @@ public:
         Serial.println("✅ ESP-NOW Emisor de actuadores listo");
     }
 
-    void sendData(const ActuatorState& state) {
-        esp_err_t result = esp_now_send(_peerAddress, (uint8_t *)&state, sizeof(state));
-        if (result == ESP_OK) {
-            Serial.println("📨 Estado de actuadores enviado correctamente");
-        } else {
-            Serial.print("⚠️ Error al enviar estado: ");
-            Serial.println(esp_err_to_name(result));
-            _peerConnected = false;
+    // Declara un canal del nodo (id local de su tabla)
+    bool addChannel(uint8_t id) {
+        if (_count >= ACTUATOR_MAX_CHANNELS || indexOf(id) >= 0) return false;
+        _ids[_count++] = id;
+        return true;
+    }
+
+    // Fija el valor deseado de un canal; no transmite hasta flush()
+    void setChannel(uint8_t id, uint8_t value) {
+        int i = indexOf(id);
+        if (i < 0) return;
+        portENTER_CRITICAL(&_mux);
+        _desired[i] = value;
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    // Envía los canales que difieren de lo confirmado; true si hubo transmisión
+    bool flush() {
+        return sendPending(false);
+    }
+
+    // Retransmisiones pendientes y latido; llamar periódicamente desde una tarea
+    void update() {
+        portENTER_CRITICAL(&_mux);
+        unsigned long now = millis();
+        bool resend = false;
+        bool heartbeat = !_hasPending && _commands > 0 && now - _lastTxAt >= HEARTBEAT_MS;
+        ActuatorCommand cmd = _pending;
+        if (_hasPending && (long)(now - _nextRetryAt) >= 0) {
+            if (_attempts >= MAX_ATTEMPTS) {
+                _hasPending = false;
+                _timeouts++;
+                _peerConnected = false;
+            } else {
+                _nextRetryAt = now + (RETRY_BASE_MS << _attempts);
+                _attempts++;
+                _retries++;
+                resend = true;
+            }
+        }
+        portEXIT_CRITICAL(&_mux);
+
+        if (resend) transmit(cmd);
+        else if (heartbeat) sendPending(true);
+    }
+
+    // Procesa una trama entrante; devuelve true si era un ACK de este nodo
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        if (memcmp(mac, _peerAddress, 6) != 0) return false;
+
+        ActuatorAck ack;
+        if (!decodeChannelFrame(data, len, ACTUATOR_FRAME_ACK, ack)) return false;
+
+        portENTER_CRITICAL(&_mux);
+        for (uint8_t k = 0; k < ack.count; k++) {
+            int i = indexOf(ack.values[k].channel);
+            if (i < 0) continue;
+            _applied[i] = ack.values[k].value;
+            _known[i] = true;
+        }
+        if (_hasPending && ack.seq == _pending.seq) {
+            _hasPending = false;
+            _lastLatencyUs = micros() - _firstSentUs;
+            _avgLatencyUs = _avgLatencyUs == 0.0f ? _lastLatencyUs : 0.9f * _avgLatencyUs + 0.1f * _lastLatencyUs;
+
+            // El nodo puede leer un nivel distinto (p. ej. PWM cuantizado): basta con ON/OFF
+            bool match = true;
+            for (uint8_t k = 0; k < _pending.count; k++) {
+                int i = indexOf(_pending.values[k].channel);
+                if (i >= 0 && (_applied[i] != 0) != (_pending.values[k].value != 0)) match = false;
+            }
+            _peerConnected = match;
         }
+        portEXIT_CRITICAL(&_mux);
+        return true;
     }
 
-    // Nuevo método para consultar el estado de conexión del peer
     bool isPeerConnected() const {
         return _peerConnected;
     }
-};
 
-// Definición del atributo estático
-bool ESPNowActuatorSender::_peerConnected = false;
+    bool isAckPending() const { return _hasPending; }
+    const uint8_t* getPeerAddress() const { return _peerAddress; }
+
+    // Último valor confirmado de un canal (-1 si aún no se conoce)
+    int getAppliedValue(uint8_t id) const {
+        int i = indexOf(id);
+        return i >= 0 && _known[i] ? _applied[i] : -1;
+    }
+
+    int getDesiredValue(uint8_t id) const {
+        int i = indexOf(id);
+        return i >= 0 ? _desired[i] : -1;
+    }
+
+    unsigned long getCommands() const { return _commands; }
+    unsigned long getRetries() const { return _retries; }
+    unsigned long getTimeouts() const { return _timeouts; }
+    unsigned long getSuppressed() const { return _suppressed; }
+    float getAvgLatencyMs() const { return _avgLatencyUs / 1000.0f; }
+
+    String getLinkStats() const {
+        String s = "⏱️ Latencia: " + String(_lastLatencyUs / 1000.0f, 2) + " ms (media " + String(_avgLatencyUs / 1000.0f, 2) + " ms)\n";
+        s += "🔁 Comandos: " + String(_commands) + ", reintentos: " + String(_retries) + ", sin ACK: " + String(_timeouts) + "\n";
+        s += "🔇 Sin cambios (no enviados): " + String(_suppressed);
+        return s;
+    }
+};
 
 #endif
@@ -0,0 +1,399 @@
+#ifndef FIRMWARE_DISTRIBUTOR_H
+#define FIRMWARE_DISTRIBUTOR_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include "FirmwareTransfer.h"
+#include "SensorRelay.h"
+
+static_assert(OTA_DATA_HEADER + OTA_CHUNK_SIZE <= RELAY_DOWN_MAX_PAYLOAD, "un bloque no cabe en el sobre de bajada");
+
+// Reparto de una imagen de firmware de la SD a una lista de nodos (ver
+// FirmwareTransfer.h), de uno en uno para no repartir el aire entre
+// varias transferencias. Por nodo:
+//   OFERTA    hasta que el nodo responde (si ya corre esa versión, se salta)
+//   DATOS     ventana deslizante: bloques sin marcar en el último mapa y
+//             enviados hace más de RTO_MS; si el nodo calla, se le sondea
+//   COMMIT    el nodo verifica el CRC y activa la imagen (o se repite)
+//   ARRANQUE  el nodo reinicia; responde con la versión nueva o, si no se
+//             dio por buena, revierte y responde con la anterior
+// Un nodo que deja de responder se da por fallido y se pasa al siguiente;
+// repetir /ota con la misma imagen reanuda donde se quedó.
+//
+// start() y cancel() desde la tarea de Telegram, update() desde OtaTask y
+// handleFrame() desde el callback de ESP-NOW.
+class FirmwareDistributor {
+public:
+    static constexpr uint8_t MAX_TARGETS = 8;
+    static constexpr unsigned long RTO_MS = 80;            // reenvío de un bloque sin confirmar
+    static constexpr unsigned long POLL_MS = 250;          // sin noticias del nodo: sondeo (OFFER)
+    static constexpr uint8_t MAX_POLLS = 20;               // ≈ 5 s callado: fallido
+    static constexpr unsigned long BOOT_POLL_MS = 1000;
+    static constexpr unsigned long BOOT_WAIT_MS = 90000;   // reinicio y verificación del nodo
+    static constexpr uint8_t BURST = 8;                    // tramas como mucho por update()
+    static constexpr uint8_t MAX_CRC_RETRIES = 2;
+
+    // Empieza a repartir `path` (en la SD) a los nodos; false con el motivo
+    bool start(const String& path, const String& version, uint8_t kind, const uint8_t (*macs)[6], uint8_t count,
+               String& error) {
+        if (active()) return fail(error, "ya hay un reparto en curso (/ota cancelar)");
+        if (count == 0) return fail(error, "ningún nodo de ese tipo");
+        if (version.isEmpty() || version.length() >= OTA_VERSION_LEN) return fail(error, "versión vacía o demasiado larga");
+        if (_file) _file.close();
+        _file = SD.open(path, FILE_READ);
+        if (!_file || _file.size() == 0) return fail(error, "no se pudo abrir " + path);
+
+        // Tamaño y CRC de la imagen (una lectura completa)
+        uint32_t crc = 0xFFFFFFFF;
+        uint8_t buf[256];
+        size_t n;
+        while ((n = _file.read(buf, sizeof(buf))) > 0) crc = otaCrc32Update(crc, buf, n);
+
+        portENTER_CRITICAL(&_mux);
+        _offer = OtaOffer();
+        _offer.kind = kind;
+        _offer.size = _file.size();
+        _offer.crc = ~crc;
+        _offer.session = otaSessionId(_offer.crc, _offer.size);
+        strncpy(_offer.version, version.c_str(), OTA_VERSION_LEN - 1);
+        _chunks = otaChunkCount(_offer.size);
+        _count = count < MAX_TARGETS ? count : MAX_TARGETS;
+        for (uint8_t i = 0; i < _count; i++) {
+            _targets[i] = Target();
+            memcpy(_targets[i].mac, macs[i], 6);
+        }
+        _current = 0;
+        _reported = false;
+        _cancel = false;
+        _bytesDone = 0;
+        _transferMs = 0;
+        _active = true;
+        portEXIT_CRITICAL(&_mux);
+
+        for (uint8_t i = 0; i < _count; i++) addPeer(_targets[i].mac);
+        _path = path;
+        _startedMs = millis();
+        beginTarget();
+        return true;
+    }
+
+    // Lo aplica la próxima llamada a update()
+    void cancel() {
+        if (_active) _cancel = true;
+    }
+
+    bool active() const { return _active; }
+
+    // Avanza el nodo en curso; llamar a menudo mientras active()
+    void update() {
+        if (!_active) return;
+        if (_cancel) {
+            for (uint8_t i = _current; i < _count; i++) finish(_targets[i], PHASE_FAILED, "cancelado");
+            _current = _count;
+            _finishedMs = millis();
+        }
+        if (_current >= _count) {
+            if (_file) _file.close();
+            _active = false;
+            return;
+        }
+
+        unsigned long now = millis();
+        portENTER_CRITICAL(&_mux);
+        Target& t = _targets[_current];
+        Target snapshot = t;
+        t.fresh = false;
+        portEXIT_CRITICAL(&_mux);
+
+        if (snapshot.fresh) onStatus(t, snapshot, now);
+        if (finished(t)) {
+            nextTarget();
+            return;
+        }
+
+        switch (t.phase) {
+            case PHASE_OFFER:
+                if (pollDue(t, now, POLL_MS)) send(t.mac, (const uint8_t*)&_offer, sizeof(_offer));
+                break;
+            case PHASE_DATA:
+                sendWindow(t, now);
+                if (pollDue(t, now, POLL_MS)) send(t.mac, (const uint8_t*)&_offer, sizeof(_offer));
+                break;
+            case PHASE_COMMIT:
+                if (pollDue(t, now, POLL_MS)) {
+                    OtaCommit commit;
+                    commit.session = _offer.session;
+                    send(t.mac, (const uint8_t*)&commit, sizeof(commit));
+                }
+                break;
+            case PHASE_BOOT:
+                if (now - t.phaseSince >= BOOT_WAIT_MS) {
+                    finish(t, PHASE_FAILED, "no volvió tras reiniciar");
+                } else if (now - t.lastPollMs >= BOOT_POLL_MS) {
+                    t.lastPollMs = now;
+                    send(t.mac, (const uint8_t*)&_offer, sizeof(_offer));
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Procesa una trama entrante; true si era un STATUS de actualización
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        OtaStatus status;
+        if (!decodeOtaFrame(data, len, OTA_FRAME_STATUS, status)) return false;
+        portENTER_CRITICAL(&_mux);
+        if (_active && _current < _count && memcmp(_targets[_current].mac, mac, 6) == 0) {
+            Target& t = _targets[_current];
+            t.status = status;
+            t.fresh = true;
+            t.lastStatusMs = millis();
+            _statusFrames++;
+        }
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    String formatStatus() {
+        if (_count == 0) return "📦 Sin repartos de firmware (usa /ota sensores|actuadores <archivo> <versión>).";
+        portENTER_CRITICAL(&_mux);
+        uint8_t count = _count;
+        Target targets[MAX_TARGETS];
+        memcpy(targets, _targets, sizeof(targets));
+        portEXIT_CRITICAL(&_mux);
+
+        String s = "📦 Firmware " + String(_offer.version) + " (" + _path + ", " + String(_offer.size) + " bytes)" +
+                   (_active ? " en curso" : "") + ":\n";
+        for (uint8_t i = 0; i < count; i++) s += formatTarget(targets[i]) + "\n";
+        s += "📡 Bloques: " + String(_chunkFrames) + " enviados, " + String(_retransmits) + " reenviados";
+        return s;
+    }
+
+    // Resumen final para Telegram (una vez, al terminar el reparto)
+    String takeReport() {
+        if (_active || _reported || _count == 0) return "";
+        _reported = true;
+        String s = formatStatus();
+        if (_transferMs > 0) {
+            s += "\n⏱️ " + String(_bytesDone * 1000.0f / 1024.0f / _transferMs, 1) + " KB/s en " +
+                 String((_finishedMs - _startedMs) / 1000) + " s";
+        }
+        return s;
+    }
+
+    // Envío hacia el nodo (p. ej. por su ruta de relevos, ver
+    // ESPNowReceiver::sendDown); sin él, directo
+    void setTransport(bool (*send)(const uint8_t* mac, const uint8_t* data, int len)) { _transport = send; }
+
+    unsigned long getChunkFrames() const { return _chunkFrames; }
+    unsigned long getRetransmits() const { return _retransmits; }
+    unsigned long getBytesDone() const { return _bytesDone; }
+    unsigned long getTransferMs() const { return _transferMs; }
+
+private:
+    enum Phase : uint8_t { PHASE_OFFER, PHASE_DATA, PHASE_COMMIT, PHASE_BOOT, PHASE_DONE, PHASE_SKIPPED, PHASE_FAILED };
+
+    struct Target {
+        uint8_t mac[6] = {0};
+        Phase phase = PHASE_OFFER;
+        const char* reason = "";
+        OtaStatus status;            // último recibido
+        bool fresh = false;
+        unsigned long lastStatusMs = 0;
+        unsigned long lastPollMs = 0;
+        unsigned long phaseSince = 0;
+        unsigned long dataSince = 0;   // primer bloque enviado
+        uint8_t polls = 0;
+        uint8_t crcRetries = 0;
+        uint32_t base = 0;
+        uint32_t bitmap = 0;
+        uint32_t sentIndex[OTA_WINDOW];
+        unsigned long sentAt[OTA_WINDOW];
+        char runningVersion[OTA_VERSION_LEN] = {0};
+    };
+
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    File _file;
+    String _path;
+    OtaOffer _offer;
+    uint32_t _chunks = 0;
+    Target _targets[MAX_TARGETS];
+    uint8_t _count = 0;
+    uint8_t _current = 0;
+    volatile bool _active = false;
+    volatile bool _cancel = false;
+    bool _reported = true;
+    unsigned long _startedMs = 0;
+    unsigned long _finishedMs = 0;
+    unsigned long _chunkFrames = 0;
+    unsigned long _retransmits = 0;
+    unsigned long _statusFrames = 0;
+    unsigned long _bytesDone = 0;    // bytes de imágenes transferidas y verificadas
+    unsigned long _transferMs = 0;   // tiempo que llevó transferirlas
+    bool (*_transport)(const uint8_t* mac, const uint8_t* data, int len) = nullptr;
+
+    static bool fail(String& error, const String& reason) {
+        error = reason;
+        return false;
+    }
+
+    static bool finished(const Target& t) { return t.phase >= PHASE_DONE; }
+
+    static void finish(Target& t, Phase phase, const char* reason) {
+        t.phase = phase;
+        t.reason = reason;
+    }
+
+    static void addPeer(const uint8_t* mac) {
+        if (esp_now_is_peer_exist(mac)) return;
+        esp_now_peer_info_t peerInfo = {};
+        memcpy(peerInfo.peer_addr, mac, 6);
+        peerInfo.channel = 0;   // canal actual
+        peerInfo.encrypt = false;
+        peerInfo.ifidx = WIFI_IF_STA;
+        esp_now_add_peer(&peerInfo);
+    }
+
+    bool send(const uint8_t* mac, const uint8_t* data, int len) {
+        return _transport ? _transport(mac, data, len) : esp_now_send(mac, data, len) == ESP_OK;
+    }
+
+    void beginTarget() {
+        Target& t = _targets[_current];
+        for (uint8_t i = 0; i < OTA_WINDOW; i++) t.sentIndex[i] = UINT32_MAX;
+        setPhase(t, PHASE_OFFER, millis());
+    }
+
+    void nextTarget() {
+        _current++;
+        _finishedMs = millis();
+        if (_current < _count) beginTarget();
+    }
+
+    void setPhase(Target& t, Phase phase, unsigned long now) {
+        t.phase = phase;
+        t.phaseSince = now;
+        t.polls = 0;
+        t.lastPollMs = 0;
+    }
+
+    // Oferta/commit al entrar en la fase y cada `period` sin respuesta (en
+    // DATOS solo si el nodo calla); fallido tras MAX_POLLS seguidos
+    bool pollDue(Target& t, unsigned long now, unsigned long period) {
+        if (t.lastPollMs != 0 || t.phase == PHASE_DATA) {
+            unsigned long last = t.phaseSince;
+            if ((long)(t.lastPollMs - last) > 0) last = t.lastPollMs;
+            if ((long)(t.lastStatusMs - last) > 0) last = t.lastStatusMs;
+            if (now - last < period) return false;
+        }
+        if (++t.polls > MAX_POLLS) {
+            finish(t, PHASE_FAILED, t.phase == PHASE_DATA ? "sin respuesta (repite /ota para reanudar)" : "sin respuesta");
+            return false;
+        }
+        t.lastPollMs = now;
+        return true;
+    }
+
+    void onStatus(Target& t, const Target& s, unsigned long now) {
+        const OtaStatus& st = s.status;
+        t.polls = 0;
+        memcpy(t.runningVersion, st.version, OTA_VERSION_LEN);
+        bool sameVersion = strncmp(st.version, _offer.version, OTA_VERSION_LEN) == 0;
+
+        if (t.phase == PHASE_BOOT) {
+            if (st.state == OTA_READY) return;   // aún no ha reiniciado
+            if (sameVersion) finish(t, PHASE_DONE, "actualizado");
+            else finish(t, PHASE_FAILED, "revertido a la versión anterior");
+            return;
+        }
+        if (st.state == OTA_IDLE && sameVersion) {
+            finish(t, PHASE_SKIPPED, "ya tenía esa versión");
+            return;
+        }
+        if (st.session != _offer.session) return;   // respuesta a otra cosa
+
+        switch (st.state) {
+            case OTA_RECEIVING:
+                t.base = st.base;
+                t.bitmap = st.bitmap;
+                if (t.phase == PHASE_OFFER || t.phase == PHASE_COMMIT) setPhase(t, PHASE_DATA, now);
+                if (t.base >= _chunks) setPhase(t, PHASE_COMMIT, now);
+                break;
+            case OTA_READY:
+                if (t.dataSince != 0) {
+                    _bytesDone += _offer.size;
+                    _transferMs += now - t.dataSince;
+                }
+                setPhase(t, PHASE_BOOT, now);
+                t.lastPollMs = now;
+                break;
+            case OTA_ERROR_CRC:
+                if (++t.crcRetries > MAX_CRC_RETRIES) {
+                    finish(t, PHASE_FAILED, "la imagen no pasa la verificación");
+                } else {
+                    for (uint8_t i = 0; i < OTA_WINDOW; i++) t.sentIndex[i] = UINT32_MAX;
+                    setPhase(t, PHASE_OFFER, now);   // desde el principio
+                }
+                break;
+            case OTA_ERROR_STORAGE:
+                finish(t, PHASE_FAILED, "error al escribir la flash del nodo");
+                break;
+            case OTA_REJECTED:
+                finish(t, PHASE_FAILED, "rechazada (otro tipo de nodo o sin espacio)");
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Bloques de la ventana que faltan y no están ya en vuelo
+    void sendWindow(Target& t, unsigned long now) {
+        uint8_t sent = 0;
+        for (uint32_t i = 0; i < OTA_WINDOW && sent < BURST; i++) {
+            uint32_t index = t.base + i;
+            if (index >= _chunks) break;
+            if (t.bitmap >> i & 1) continue;
+            uint8_t slot = index % OTA_WINDOW;
+            bool resend = t.sentIndex[slot] == index;
+            if (resend && now - t.sentAt[slot] < RTO_MS) continue;
+
+            OtaData frame;
+            frame.session = _offer.session;
+            frame.index = index;
+            uint32_t offset = index * OTA_CHUNK_SIZE;
+            uint16_t len = (uint16_t)(_offer.size - offset < OTA_CHUNK_SIZE ? _offer.size - offset : OTA_CHUNK_SIZE);
+            if (!_file.seek(offset) || _file.read(frame.payload, len) != len) {
+                finish(t, PHASE_FAILED, "error al leer la imagen de la SD");
+                return;
+            }
+            if (!send(t.mac, (const uint8_t*)&frame, OTA_DATA_HEADER + len)) break;   // cola de la radio llena
+            t.sentIndex[slot] = index;
+            t.sentAt[slot] = now;
+            if (t.dataSince == 0) t.dataSince = now;
+            _chunkFrames++;
+            if (resend) _retransmits++;
+            sent++;
+        }
+    }
+
+    String formatTarget(const Target& t) const {
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", t.mac[0], t.mac[1], t.mac[2], t.mac[3], t.mac[4],
+                 t.mac[5]);
+        String s = String(mac) + ": ";
+        switch (t.phase) {
+            case PHASE_OFFER: return "⏳ " + s + "ofreciendo";
+            case PHASE_DATA: return "📤 " + s + String(_chunks ? t.base * 100 / _chunks : 0) + " %";
+            case PHASE_COMMIT: return "🔎 " + s + "verificando";
+            case PHASE_BOOT: return "🔄 " + s + "reiniciando";
+            case PHASE_DONE: return "✅ " + s + t.reason;
+            case PHASE_SKIPPED: return "➖ " + s + t.reason;
+            default: return "❌ " + s + t.reason + (t.runningVersion[0] ? " (corre " + String(t.runningVersion) + ")" : "");
+        }
+    }
+};
+
+#endif
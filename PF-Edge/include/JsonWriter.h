@@ -0,0 +1,167 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+#include <math.h>
+
+// Serializador JSON en streaming: escribe en un búfer fijo y lo vuelca a
+// `Out` (cualquier clase con write(const uint8_t*, size_t)) cuando se
+// llena, sin construir String intermedios. Las comas las pone solo.
+//
+//   JsonWriter<WiFiClient> json(client);
+//   json.beginObject().field("temp", 23.46f, 1).beginArray("zonas").value(0).endArray().endObject();
+//   json.flush();
+//
+// Anidamiento máximo MAX_DEPTH; los float NaN/inf salen como null.
+template <typename Out>
+class JsonWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 256;
+    static constexpr uint8_t MAX_DEPTH = 8;
+
+    explicit JsonWriter(Out& out) : _out(out) {}
+
+    JsonWriter& beginObject() { return open('{'); }
+    JsonWriter& beginObject(const char* k) { return key(k).open('{'); }
+    JsonWriter& endObject() { return close('}'); }
+    JsonWriter& beginArray() { return open('['); }
+    JsonWriter& beginArray(const char* k) { return key(k).open('['); }
+    JsonWriter& endArray() { return close(']'); }
+
+    JsonWriter& key(const char* k) {
+        separator();
+        quoted(k, strlen(k));
+        put(':');
+        _afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& value(const char* s) {
+        separator();
+        if (!s) return append("null", 4);
+        quoted(s, strlen(s));
+        return *this;
+    }
+    JsonWriter& value(const char* s, size_t len) {
+        separator();
+        quoted(s, len);
+        return *this;
+    }
+    JsonWriter& value(bool b) {
+        separator();
+        return b ? append("true", 4) : append("false", 5);
+    }
+    JsonWriter& value(int v) { return number("%d", v); }
+    JsonWriter& value(unsigned int v) { return number("%u", v); }
+    JsonWriter& value(long v) { return number("%ld", v); }
+    JsonWriter& value(unsigned long v) { return number("%lu", v); }
+    JsonWriter& value(double v, uint8_t decimals = 2) {
+        separator();
+        if (isnan(v) || isinf(v)) return append("null", 4);
+        char buf[24];
+        int n = snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        return append(buf, n > 0 ? (size_t)n : 0);
+    }
+    JsonWriter& null() {
+        separator();
+        return append("null", 4);
+    }
+
+    // Texto ya válido como valor JSON (p. ej. un número leído de un CSV)
+    JsonWriter& raw(const char* s, size_t len) {
+        separator();
+        return append(s, len);
+    }
+
+    template <typename T>
+    JsonWriter& field(const char* k, T v) {
+        key(k);
+        return value(v);
+    }
+    JsonWriter& field(const char* k, double v, uint8_t decimals) {
+        key(k);
+        return value(v, decimals);
+    }
+
+    void flush() {
+        if (_len == 0) return;
+        _out.write((const uint8_t*)_buf, _len);
+        _len = 0;
+    }
+
+    // Bytes generados hasta ahora (volcados o no)
+    size_t bytes() const { return _total; }
+
+private:
+    Out& _out;
+    char _buf[BUFFER_SIZE];
+    size_t _len = 0;
+    size_t _total = 0;
+    bool _first[MAX_DEPTH];
+    uint8_t _depth = 0;
+    bool _afterKey = false;
+
+    JsonWriter& open(char c) {
+        separator();
+        put(c);
+        if (_depth < MAX_DEPTH) _first[_depth] = true;
+        _depth++;
+        return *this;
+    }
+
+    JsonWriter& close(char c) {
+        if (_depth > 0) _depth--;
+        put(c);
+        return *this;
+    }
+
+    // Coma antes de cada elemento salvo el primero (y nunca tras una clave)
+    void separator() {
+        if (_afterKey) {
+            _afterKey = false;
+            return;
+        }
+        if (_depth == 0 || _depth > MAX_DEPTH) return;
+        if (!_first[_depth - 1]) put(',');
+        _first[_depth - 1] = false;
+    }
+
+    template <typename T>
+    JsonWriter& number(const char* fmt, T v) {
+        separator();
+        char buf[24];
+        int n = snprintf(buf, sizeof(buf), fmt, v);
+        return append(buf, n > 0 ? (size_t)n : 0);
+    }
+
+    void quoted(const char* s, size_t len) {
+        put('"');
+        for (size_t i = 0; i < len; i++) {
+            char c = s[i];
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if ((uint8_t)c < 0x20) {
+                char esc[7];
+                snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)(uint8_t)c);
+                append(esc, 6);
+            } else {
+                put(c);
+            }
+        }
+        put('"');
+    }
+
+    void put(char c) {
+        if (_len == BUFFER_SIZE) flush();
+        _buf[_len++] = c;
+        _total++;
+    }
+
+    JsonWriter& append(const char* s, size_t len) {
+        for (size_t i = 0; i < len; i++) put(s[i]);
+        return *this;
+    }
+};
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef LINK_MONITOR_H
+#define LINK_MONITOR_H
+
+#include <WiFi.h>
+#include <esp_now.h>
+#include "LinkQuality.h"
+
+// Calidad del enlace directo con cada nodo (ver LinkQuality.h): con los
+// totales que se le pasan (tramas esperadas y perdidas) forma ventanas de
+// al menos REPORT_MIN_SAMPLES, o de REPORT_MAX_MS si el nodo habla poco, y
+// al cerrar cada una envía al nodo su LinkReport. Guarda la potencia que
+// el nodo dice usar.
+//
+// update() se llama desde ReceiveDataTask, handleFrame() desde el callback
+// de ESP-NOW.
+class LinkMonitor {
+public:
+    static constexpr uint8_t MAX_PEERS = 12;
+    static constexpr uint16_t REPORT_MIN_SAMPLES = 10;
+    static constexpr unsigned long REPORT_MIN_MS = 5000;
+    static constexpr unsigned long REPORT_MAX_MS = 30000;
+
+    enum Kind : uint8_t { SENSOR = 0, ACTUATOR = 1 };
+
+    struct Peer {
+        uint8_t mac[6];
+        Kind kind;
+        unsigned long baseSamples;    // totales al cerrar la última ventana
+        unsigned long baseLost;
+        unsigned long lastReportMs;
+        int8_t rssi;                  // el del último informe (0: sin medida)
+        uint16_t samples;             // de la última ventana cerrada
+        uint16_t lossPermille;
+        int8_t txPowerQdbm;           // del LinkStatus del nodo (0: aún no)
+        unsigned long reports;
+    };
+
+    // Totales acumulados del nodo y su RSSI actual; envía el informe si
+    // toca. true si lo envió.
+    bool update(const uint8_t* mac, Kind kind, unsigned long samples, unsigned long lost, int8_t rssi,
+                unsigned long now) {
+        portENTER_CRITICAL(&_mux);
+        Peer& p = peerFor(mac, kind, samples, lost, now);
+        unsigned long windowSamples = samples - p.baseSamples;
+        unsigned long windowLost = lost - p.baseLost;
+        unsigned long age = now - p.lastReportMs;
+        bool due = age >= REPORT_MIN_MS && (windowSamples >= REPORT_MIN_SAMPLES ||
+                                            (age >= REPORT_MAX_MS && (windowSamples > 0 || rssi != 0)));
+        LinkReport report;
+        if (due) {
+            if (windowLost > windowSamples) windowLost = windowSamples;
+            report.rssi = rssi;
+            report.samples = windowSamples > 0xFFFF ? 0xFFFF : (uint16_t)windowSamples;
+            report.lossPermille = windowSamples ? (uint16_t)(1000 * windowLost / windowSamples) : 0;
+            p.baseSamples = samples;
+            p.baseLost = lost;
+            p.lastReportMs = now;
+            p.rssi = rssi;
+            p.samples = report.samples;
+            p.lossPermille = report.lossPermille;
+            p.reports++;
+            _reports++;
+        }
+        portEXIT_CRITICAL(&_mux);
+        if (due) send(mac, report);
+        return due;
+    }
+
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        LinkStatus status;
+        if (!decodeLinkStatus(data, len, status)) return false;
+        portENTER_CRITICAL(&_mux);
+        for (uint8_t i = 0; i < _count; i++) {
+            if (memcmp(_peers[i].mac, mac, 6) == 0) _peers[i].txPowerQdbm = status.txPowerQdbm;
+        }
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    // Copia del estado de un nodo; false si aún no se le midió
+    bool get(const uint8_t* mac, Peer& out) {
+        portENTER_CRITICAL(&_mux);
+        bool found = false;
+        for (uint8_t i = 0; i < _count && !found; i++) {
+            if (memcmp(_peers[i].mac, mac, 6) == 0) {
+                out = _peers[i];
+                found = true;
+            }
+        }
+        portEXIT_CRITICAL(&_mux);
+        return found;
+    }
+
+    // Para Telegram: un nodo por línea
+    String format() {
+        Peer peers[MAX_PEERS];
+        portENTER_CRITICAL(&_mux);
+        uint8_t count = _count;
+        memcpy(peers, _peers, sizeof(peers));
+        portEXIT_CRITICAL(&_mux);
+        if (count == 0) return "📶 Aún no hay medidas de enlace con los nodos.";
+        String s = "📶 Enlaces ESP-NOW (última ventana):\n";
+        for (uint8_t i = 0; i < count; i++) {
+            const Peer& p = peers[i];
+            char mac[18];
+            snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", p.mac[0], p.mac[1], p.mac[2], p.mac[3],
+                     p.mac[4], p.mac[5]);
+            s += String(p.kind == ACTUATOR ? "🎛️ " : "🌱 ") + mac + ": ";
+            s += p.rssi ? String(p.rssi) + " dBm" : String("RSSI ?");
+            s += ", " + String(p.lossPermille / 10.0f, 1) + " % de " + String(p.samples);
+            s += p.txPowerQdbm ? ", emite a " + String(p.txPowerQdbm / 4.0f, 1) + " dBm\n" : String(", potencia ?\n");
+        }
+        s += "📨 " + String(_reports) + " informes enviados";
+        return s;
+    }
+
+    // Envío hacia el nodo (p. ej. por su ruta de relevos, ver
+    // ESPNowReceiver::sendDown); sin él, directo
+    void setTransport(bool (*send)(const uint8_t* mac, const uint8_t* data, int len)) { _transport = send; }
+
+    unsigned long getReports() const { return _reports; }
+
+private:
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    Peer _peers[MAX_PEERS];
+    uint8_t _count = 0;
+    unsigned long _reports = 0;
+    bool (*_transport)(const uint8_t* mac, const uint8_t* data, int len) = nullptr;
+
+    // Llena, se reutiliza la que lleva más sin informe; la primera vez la
+    // ventana empieza en los totales actuales
+    Peer& peerFor(const uint8_t* mac, Kind kind, unsigned long samples, unsigned long lost, unsigned long now) {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (memcmp(_peers[i].mac, mac, 6) == 0) return _peers[i];
+        }
+        Peer* p = &_peers[0];
+        if (_count < MAX_PEERS) {
+            p = &_peers[_count++];
+        } else {
+            for (uint8_t i = 1; i < _count; i++) {
+                if (now - _peers[i].lastReportMs > now - p->lastReportMs) p = &_peers[i];
+            }
+        }
+        memset(p, 0, sizeof(*p));
+        memcpy(p->mac, mac, 6);
+        p->kind = kind;
+        p->baseSamples = samples;
+        p->baseLost = lost;
+        p->lastReportMs = now;
+        return *p;
+    }
+
+    void send(const uint8_t* mac, const LinkReport& report) {
+        if (!esp_now_is_peer_exist(mac)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, mac, 6);
+            peerInfo.channel = 0;   // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            if (esp_now_add_peer(&peerInfo) != ESP_OK) return;
+        }
+        if (_transport) _transport(mac, (const uint8_t*)&report, sizeof(report));
+        else esp_now_send(mac, (const uint8_t*)&report, sizeof(report));
+    }
+};
+
+#endif
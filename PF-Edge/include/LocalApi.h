@@ -0,0 +1,276 @@
+#ifndef LOCAL_API_H
+#define LOCAL_API_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "JsonWriter.h"
+
+// Petición HTTP ya separada: método, ruta y query string (sin decodificar
+// %xx: los parámetros de la API son fechas y números)
+struct ApiRequest {
+    char method[8];
+    char path[48];
+    char query[96];
+
+    // Copia el parámetro `name` de la query string en `out`; false si no está
+    bool param(const char* name, char* out, size_t size) const {
+        size_t nameLen = strlen(name);
+        const char* p = query;
+        while (*p) {
+            const char* end = strchr(p, '&');
+            if (!end) end = p + strlen(p);
+            if ((size_t)(end - p) > nameLen && strncmp(p, name, nameLen) == 0 && p[nameLen] == '=') {
+                size_t len = end - p - nameLen - 1;
+                if (len >= size) len = size - 1;
+                memcpy(out, p + nameLen + 1, len);
+                out[len] = '\0';
+                return true;
+            }
+            p = *end ? end + 1 : end;
+        }
+        return false;
+    }
+
+    long paramInt(const char* name, long fallback) const {
+        char buf[16];
+        return param(name, buf, sizeof(buf)) ? strtol(buf, nullptr, 10) : fallback;
+    }
+};
+
+// Respuesta JSON: la cabecera sale con el primer volcado del cuerpo, así
+// el manejador puede elegir el código (setStatus/error) antes de escribir
+class ApiResponse {
+public:
+    explicit ApiResponse(WiFiClient& client) : json(*this), _client(client) {}
+
+    JsonWriter<ApiResponse> json;
+
+    void setStatus(int status) { _status = status; }
+
+    void error(int status, const char* message) {
+        _status = status;
+        json.beginObject().field("error", message).endObject();
+    }
+
+    // Usado por JsonWriter
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!_headerSent) sendHeader();
+        return _client.write(buf, len);
+    }
+
+    void finish() {
+        json.flush();
+        if (!_headerSent) sendHeader();
+    }
+
+    int status() const { return _status; }
+
+private:
+    WiFiClient& _client;
+    int _status = 200;
+    bool _headerSent = false;
+
+    void sendHeader() {
+        _headerSent = true;
+        const char* reason = _status == 200 ? "OK" : _status == 400 ? "Bad Request" : _status == 404 ? "Not Found"
+                           : _status == 405 ? "Method Not Allowed" : _status == 503 ? "Service Unavailable" : "Error";
+        char header[192];
+        int n = snprintf(header, sizeof(header),
+                         "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nCache-Control: no-store\r\n"
+                         "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n",
+                         _status, reason);
+        _client.write((const uint8_t*)header, n);
+    }
+};
+
+// API HTTP/JSON local del Edge, alternativa al sondeo de Telegram: solo
+// lectura (GET) y sin depender de internet.
+//
+// Servidor sin bloqueo sobre WiFiServer: update() (desde una tarea) acepta
+// conexiones en un grupo fijo de MAX_CLIENTS huecos, lee las peticiones a
+// trozos según llegan y, completa la cabecera, responde y cierra. Sin hueco
+// libre se contesta 503; una petición que no se completa en
+// REQUEST_TIMEOUT_MS se descarta. Los manejadores escriben el JSON
+// directamente en el socket (ApiResponse::json).
+//
+// En el host, el puerto 80 se sirve en 127.0.0.1:8080 (ver WiFiServer.h):
+//   curl http://127.0.0.1:8080/api/nodos
+class LocalApi {
+public:
+    static constexpr uint8_t MAX_CLIENTS = 4;
+    static constexpr uint8_t MAX_ROUTES = 10;
+    static constexpr size_t REQUEST_SIZE = 384;
+    static constexpr unsigned long REQUEST_TIMEOUT_MS = 2000;
+
+    typedef void (*Handler)(const ApiRequest& request, ApiResponse& response);
+    // Se queda con la conexión (p. ej. un flujo SSE); false: sin hueco (503)
+    typedef bool (*StreamHandler)(const ApiRequest& request, WiFiClient& client);
+
+    explicit LocalApi(uint16_t port = 80) : _server(port, MAX_CLIENTS) {}
+
+    bool on(const char* path, Handler handler) {
+        if (_routeCount >= MAX_ROUTES) return false;
+        _routes[_routeCount++] = {path, handler, nullptr};
+        return true;
+    }
+
+    bool onStream(const char* path, StreamHandler handler) {
+        if (_routeCount >= MAX_ROUTES) return false;
+        _routes[_routeCount++] = {path, nullptr, handler};
+        return true;
+    }
+
+    void begin() {
+        _server.begin();
+        _server.setNoDelay(true);
+        _started = true;
+    }
+
+    void update() {
+        if (!_started) return;
+        acceptClients();
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            if (_slots[i].busy) serviceSlot(_slots[i]);
+        }
+    }
+
+    bool isStarted() const { return _started; }
+    unsigned long requests() const { return _requests; }
+    unsigned long rejected() const { return _rejected; }
+    uint8_t activeClients() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) n += _slots[i].busy ? 1 : 0;
+        return n;
+    }
+
+private:
+    struct Route {
+        const char* path;
+        Handler handler;
+        StreamHandler stream;
+    };
+
+    struct Slot {
+        WiFiClient client;
+        char buf[REQUEST_SIZE];
+        uint16_t len;
+        unsigned long openedAt;
+        bool busy;
+    };
+
+    WiFiServer _server;
+    Route _routes[MAX_ROUTES];
+    uint8_t _routeCount = 0;
+    Slot _slots[MAX_CLIENTS] = {};
+    bool _started = false;
+    unsigned long _requests = 0;
+    unsigned long _rejected = 0;
+
+    void acceptClients() {
+        while (true) {
+            WiFiClient client = _server.available();
+            if (!client) return;
+            Slot* slot = nullptr;
+            for (uint8_t i = 0; i < MAX_CLIENTS && !slot; i++) {
+                if (!_slots[i].busy) slot = &_slots[i];
+            }
+            if (!slot) {
+                _rejected++;
+                ApiResponse response(client);
+                response.error(503, "sin conexiones libres");
+                response.finish();
+                client.stop();
+                continue;
+            }
+            slot->client = client;
+            slot->len = 0;
+            slot->buf[0] = '\0';
+            slot->openedAt = millis();
+            slot->busy = true;
+        }
+    }
+
+    void serviceSlot(Slot& s) {
+        int n = s.client.available();
+        if (n > 0) {
+            size_t room = REQUEST_SIZE - 1 - s.len;
+            int got = s.client.read((uint8_t*)s.buf + s.len, (size_t)n < room ? (size_t)n : room);
+            if (got > 0) s.len += got;
+            s.buf[s.len] = '\0';
+        }
+
+        bool complete = strstr(s.buf, "\r\n\r\n") || strstr(s.buf, "\n\n");
+        if (complete) {
+            if (respond(s)) {   // la conexión pasó a un flujo: no se cierra
+                s.client = WiFiClient();
+                s.busy = false;
+                return;
+            }
+        } else if (s.len >= REQUEST_SIZE - 1) {
+            ApiResponse response(s.client);
+            response.error(400, "cabecera demasiado larga");
+            response.finish();
+        } else if (millis() - s.openedAt < REQUEST_TIMEOUT_MS && s.client.connected()) {
+            return;   // aún llegando
+        }
+        s.client.stop();
+        s.busy = false;
+    }
+
+    // Devuelve true si un StreamHandler se quedó con la conexión
+    bool respond(Slot& s) {
+        _requests++;
+        ApiRequest request;
+        ApiResponse response(s.client);
+        if (!parseRequestLine(s.buf, request)) {
+            response.error(400, "petición no válida");
+        } else if (strcmp(request.method, "GET") != 0) {
+            response.error(405, "solo GET");
+        } else if (strcmp(request.path, "/") == 0 || strcmp(request.path, "/api") == 0) {
+            response.json.beginObject().beginArray("rutas");
+            for (uint8_t i = 0; i < _routeCount; i++) response.json.value(_routes[i].path);
+            response.json.endArray().endObject();
+        } else {
+            const Route* route = nullptr;
+            for (uint8_t i = 0; i < _routeCount && !route; i++) {
+                if (strcmp(_routes[i].path, request.path) == 0) route = &_routes[i];
+            }
+            if (!route) {
+                response.error(404, "ruta no encontrada");
+            } else if (route->handler) {
+                route->handler(request, response);
+            } else if (route->stream(request, s.client)) {
+                return true;
+            } else {
+                _rejected++;
+                response.error(503, "sin conexiones libres");
+            }
+        }
+        response.finish();
+        return false;
+    }
+
+    // "GET /api/historial?hora=10 HTTP/1.1"
+    static bool parseRequestLine(const char* line, ApiRequest& out) {
+        const char* sp1 = strchr(line, ' ');
+        if (!sp1 || sp1 - line >= (int)sizeof(out.method)) return false;
+        const char* target = sp1 + 1;
+        const char* sp2 = target;
+        while (*sp2 && *sp2 != ' ' && *sp2 != '\r' && *sp2 != '\n') sp2++;
+        const char* q = (const char*)memchr(target, '?', sp2 - target);
+        const char* pathEnd = q ? q : sp2;
+        if (pathEnd == target || pathEnd - target >= (int)sizeof(out.path)) return false;
+
+        memcpy(out.method, line, sp1 - line);
+        out.method[sp1 - line] = '\0';
+        memcpy(out.path, target, pathEnd - target);
+        out.path[pathEnd - target] = '\0';
+        size_t queryLen = q ? sp2 - q - 1 : 0;
+        if (queryLen >= sizeof(out.query)) queryLen = sizeof(out.query) - 1;
+        if (q) memcpy(out.query, q + 1, queryLen);
+        out.query[queryLen] = '\0';
+        return true;
+    }
+};
+
+#endif
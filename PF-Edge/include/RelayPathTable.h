@@ -0,0 +1,183 @@
+#ifndef RELAY_PATH_TABLE_H
+#define RELAY_PATH_TABLE_H
+
+#include <Arduino.h>
+#include "SensorRelay.h"
+
+// Caminos por los que llegan los nodos sensores (SensorRelay.h): por cada
+// origen y último salto (el propio nodo si llega directo), tramas, pérdidas
+// (huecos en la secuencia del origen) y latencia media desde que salió del
+// origen; por origen, el último padre que anunció, para la ruta de bajada.
+// POD: el dueño la protege y la copia entera para leerla.
+class RelayPathTable {
+public:
+    static constexpr uint8_t MAX_PATHS = 16;
+    static constexpr uint8_t MAX_ORIGINS = 8;
+    static constexpr uint16_t MAX_GAP = 1000;          // más: el origen reinició
+    static constexpr unsigned long MAX_LATENCY_MS = 60000;
+
+    struct Path {
+        uint8_t origin[6];
+        uint8_t via[6];
+        uint8_t hops;
+        unsigned long frames;
+        unsigned long lost;
+        float latencyMs;          // media móvil
+        unsigned long lastMs;
+    };
+
+    // Trama recibida de `via`; false si es un duplicado (se descarta)
+    bool record(const uint8_t* via, const RelayHeader& header, unsigned long now) {
+        if (_duplicateFilter.seen(header.origin, header.seq)) {
+            _duplicates++;
+            return false;
+        }
+        _frames++;
+        if (header.hops > 0) _relayed++;
+
+        Origin& o = originFor(header.origin, now);
+        unsigned long lost = 0;
+        int16_t ahead = (int16_t)(header.seq - o.lastSeq);
+        if (o.known && ahead > 1 && ahead <= (int16_t)MAX_GAP) lost = ahead - 1;
+        if (!o.known || ahead > 0 || ahead < -(int16_t)MAX_GAP) o.lastSeq = header.seq;
+        o.known = true;
+        o.lastMs = now;
+        memcpy(o.parent, header.parent, 6);
+
+        Path& p = pathFor(header.origin, via, header.hops, now);
+        p.frames++;
+        p.lost += lost;
+        p.lastMs = now;
+        long latency = (long)(now - header.sentMs);
+        if (header.sentMs != 0 && latency >= 0 && latency < (long)MAX_LATENCY_MS) {
+            p.latencyMs = p.frames == 1 ? latency : p.latencyMs + 0.1f * (latency - p.latencyMs);
+        }
+        return true;
+    }
+
+    uint8_t count() const { return _count; }
+    const Path& get(uint8_t i) const { return _paths[i]; }
+
+    // Camino más reciente del origen; nullptr si aún no llegó nada suyo
+    const Path* current(const uint8_t* origin) const {
+        const Path* best = nullptr;
+        for (uint8_t i = 0; i < _count; i++) {
+            if (memcmp(_paths[i].origin, origin, 6) != 0) continue;
+            if (!best || (long)(_paths[i].lastMs - best->lastMs) > 0) best = &_paths[i];
+        }
+        return best;
+    }
+
+    // Ruta de bajada hacia target siguiendo los padres anunciados: los
+    // relevos desde el Edge y el destino al final. 1 si va directo (o no se
+    // sabe nada de él), 0 si el árbol está incompleto o hace un bucle.
+    uint8_t route(const uint8_t* target, const uint8_t* edgeMac, uint8_t (*out)[6]) const {
+        uint8_t chain[RELAY_MAX_HOPS][6];
+        uint8_t count = 0;
+        const uint8_t* node = target;
+        while (true) {
+            if (count == RELAY_MAX_HOPS) return 0;
+            memcpy(chain[count++], node, 6);
+            const Origin* o = findOrigin(node);
+            if (!o) return count == 1 ? 1 : 0;
+            if (memcmp(o->parent, edgeMac, 6) == 0) break;
+            node = o->parent;
+        }
+        for (uint8_t i = 0; i < count; i++) memcpy(out[i], chain[count - 1 - i], 6);
+        return count;
+    }
+
+    // Para Telegram: un camino por línea, del más reciente de cada nodo
+    String format() const {
+        if (_count == 0) return "📡 Aún no ha llegado ningún nodo con secuencia (firmware anterior al relevo).";
+        String s = "📡 Caminos de los nodos sensores:\n";
+        for (uint8_t i = 0; i < _count; i++) {
+            const Path& p = _paths[i];
+            s += (current(p.origin) == &p ? "▶️ " : "▫️ ") + formatMac(p.origin);
+            s += p.hops == 0 ? String(" directo") : " vía " + formatMac(p.via) + " (" + String(p.hops) + " saltos)";
+            unsigned long expected = p.frames + p.lost;
+            s += ": " + String(p.frames) + " tramas, " + String(p.lost) + " perdidas (" +
+                 String(expected ? 100.0f * p.lost / expected : 0.0f, 1) + " %), " + String(lroundf(p.latencyMs)) + " ms\n";
+        }
+        s += "🔁 " + String(_relayed) + " por relevo, " + String(_duplicates) + " duplicadas descartadas";
+        return s;
+    }
+
+    static String formatMac(const uint8_t* m) {
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+        return mac;
+    }
+
+    unsigned long frames() const { return _frames; }
+    unsigned long relayed() const { return _relayed; }
+    unsigned long duplicates() const { return _duplicates; }
+
+private:
+    struct Origin {
+        uint8_t mac[6];
+        uint16_t lastSeq;
+        bool known;
+        unsigned long lastMs;
+        uint8_t parent[6];
+    };
+
+    Path _paths[MAX_PATHS];
+    uint8_t _count = 0;
+    Origin _origins[MAX_ORIGINS];
+    uint8_t _originCount = 0;
+    RelayDuplicateFilter _duplicateFilter;
+    unsigned long _frames = 0;
+    unsigned long _relayed = 0;
+    unsigned long _duplicates = 0;
+
+    const Origin* findOrigin(const uint8_t* mac) const {
+        for (uint8_t i = 0; i < _originCount; i++) {
+            if (memcmp(_origins[i].mac, mac, 6) == 0) return &_origins[i];
+        }
+        return nullptr;
+    }
+
+    // Llena, se reutiliza la entrada más antigua (como SensorNodeTable)
+    Origin& originFor(const uint8_t* mac, unsigned long now) {
+        for (uint8_t i = 0; i < _originCount; i++) {
+            if (memcmp(_origins[i].mac, mac, 6) == 0) return _origins[i];
+        }
+        Origin* o = &_origins[0];
+        if (_originCount < MAX_ORIGINS) {
+            o = &_origins[_originCount++];
+        } else {
+            for (uint8_t i = 1; i < _originCount; i++) {
+                if (now - _origins[i].lastMs > now - o->lastMs) o = &_origins[i];
+            }
+        }
+        memcpy(o->mac, mac, 6);
+        o->known = false;
+        o->lastSeq = 0;
+        return *o;
+    }
+
+    Path& pathFor(const uint8_t* origin, const uint8_t* via, uint8_t hops, unsigned long now) {
+        for (uint8_t i = 0; i < _count; i++) {
+            Path& p = _paths[i];
+            if (p.hops == hops && memcmp(p.origin, origin, 6) == 0 && memcmp(p.via, via, 6) == 0) return p;
+        }
+        Path* p = &_paths[0];
+        if (_count < MAX_PATHS) {
+            p = &_paths[_count++];
+        } else {
+            for (uint8_t i = 1; i < _count; i++) {
+                if (now - _paths[i].lastMs > now - p->lastMs) p = &_paths[i];
+            }
+        }
+        memcpy(p->origin, origin, 6);
+        memcpy(p->via, via, 6);
+        p->hops = hops;
+        p->frames = 0;
+        p->lost = 0;
+        p->latencyMs = 0;
+        return *p;
+    }
+};
+
+#endif
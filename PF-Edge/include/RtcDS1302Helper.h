@@ -24,6 +24,7 @@ public:
         if (!_rtc.IsDateTimeValid()) {
             updateFromCompileTime();
         }
+        refreshCache();
     }
 
     // Functions to get separate values
@@ -69,6 +70,28 @@ public:
     void updateFromNTP(int year, int month, int day, int hour, int minute, int second) {
         RtcDateTime dt(year, month, day, hour, minute, second);
         _rtc.SetDateTime(dt);
+        refreshCache();
+    }
+
+    uint32_t getUnixTime() {
+        return _rtc.GetDateTime().Unix32Time();
+    }
+
+    // Hora Unix sin tocar el bus del DS1302: última lectura + millis().
+    // Para callbacks y tareas de control; refreshCache() la corrige.
+    uint32_t getCachedUnixTime() {
+        portENTER_CRITICAL(&_cacheMux);
+        uint32_t t = _cachedUnix + (millis() - _cachedAtMillis) / 1000;
+        portEXIT_CRITICAL(&_cacheMux);
+        return t;
+    }
+
+    void refreshCache() {
+        uint32_t t = getUnixTime();
+        portENTER_CRITICAL(&_cacheMux);
+        _cachedUnix = t;
+        _cachedAtMillis = millis();
+        portEXIT_CRITICAL(&_cacheMux);
     }
 
     String getTimestamp() {
@@ -76,6 +99,19 @@ public:
         return getDate() + " " + getTime();
     }
 
+    // "AAAA-MM-DD HH:MM:SS" del instante `ms` (en millis()) según la hora
+    // en caché: p. ej. la adquisición de una muestra, anterior a ahora
+    String getTimestampAt(unsigned long ms) {
+        portENTER_CRITICAL(&_cacheMux);
+        long offsetMs = (long)(ms - _cachedAtMillis);
+        uint32_t unixTime = _cachedUnix + (offsetMs >= 0 ? offsetMs / 1000 : -((999 - offsetMs) / 1000));
+        portEXIT_CRITICAL(&_cacheMux);
+        RtcDateTime t;
+        t.InitWithUnix32Time(unixTime);
+        return String(t.Year()) + "-" + padZero(t.Month()) + "-" + padZero(t.Day()) + " " +
+               padZero(t.Hour()) + ":" + padZero(t.Minute()) + ":" + padZero(t.Second());
+    }
+
     String getDate() {
         RtcDateTime now = _rtc.GetDateTime();
         return String(now.Year()) + "-" + padZero(now.Month()) + "-" + padZero(now.Day());
@@ -89,6 +125,9 @@ public:
 private:
     ThreeWire _wire;
     RtcDS1302<ThreeWire> _rtc;
+    uint32_t _cachedUnix = 0;
+    unsigned long _cachedAtMillis = 0;
+    portMUX_TYPE _cacheMux = portMUX_INITIALIZER_UNLOCKED;
 
     String padZero(int number) {
         return (number < 10 ? "0" : "") + String(number);
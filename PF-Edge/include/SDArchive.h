@@ -0,0 +1,412 @@
+#ifndef SD_ARCHIVE_H
+#define SD_ARCHIVE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include "SDLogger.h"
+
+// Archivo diario de la SD: las 24 carpetas /AAAA-MM-DD/HH/data.csv de un
+// día cerrado pasan a /archivo/AAAA-MM-DD.bin (registros binarios de
+// tamaño fijo, unas tres veces menos que el CSV) y /archivo/AAAA-MM-DD.idx
+// (resumen en texto: nodos y, por hora, posición en el .bin, filas y
+// mínimo/media/máximo de cada canal).
+//
+// DayArchiver convierte una hora por step() para no retener la tarjeta; el
+// .bin se escribe como .tmp y solo al terminar se renombra y se borran las
+// carpetas, así que un reinicio a mitad solo repite ese día.
+// ArchiveHourReader devuelve una hora archivada como líneas del CSV
+// original (ver /api/historial). La traza del día, si la hay, pasa sin
+// tocar a /archivo/AAAA-MM-DD.trace.
+#define ARCHIVE_DIR "/archivo"
+#define ARCHIVE_CSV_HEADER "timestamp,nodeId,rssi" SENSOR_CSV_COLUMNS ",state,calidad"
+
+#pragma pack(push, 1)
+struct ArchiveHeader {
+    char magic[4] = {'V', 'V', 'A', '1'};
+    uint8_t channels = SENSOR_CHANNEL_COUNT;
+    uint8_t recordSize = 0;
+};
+
+struct ArchiveRecord {
+    uint16_t second;     // dentro de la hora
+    uint8_t node;        // índice en la línea "nodos" del .idx
+    int8_t rssi;
+    SensorData data;     // punto fijo, como en la trama
+    uint8_t state;
+    uint16_t quality;
+};
+#pragma pack(pop)
+
+class DayArchiver {
+public:
+    static constexpr uint8_t MAX_NODES = 8;
+    static constexpr size_t MAX_NODE_ID = 16;
+
+    // Empieza a archivar el día `date` (AAAA-MM-DD); false si no se pudo
+    // crear el archivo
+    bool begin(const String& date) {
+        _date = date;
+        _hour = 0;
+        _nodeCount = 0;
+        _rows = 0;
+        _csvBytes = 0;
+        _failed = false;
+        memset(_hours, 0, sizeof(_hours));
+        SD.mkdir(ARCHIVE_DIR);
+        _out = SD.open(tmpPath(), FILE_WRITE);
+        if (!_out) return false;
+        ArchiveHeader header;
+        header.recordSize = sizeof(ArchiveRecord);
+        _out.write((const uint8_t*)&header, sizeof(header));
+        _offset = sizeof(header);
+        _active = true;
+        return true;
+    }
+
+    bool active() const { return _active; }
+    const String& date() const { return _date; }
+
+    // Convierte la siguiente hora. Devuelve false cuando el día terminó
+    // (ok() dice si bien: si una hora no se puede leer, el día se deja
+    // como estaba).
+    bool step() {
+        if (!_active) return false;
+        if (_hour < 24) {
+            if (!archiveHour(_hour)) fail();
+            else _hour++;
+            return _active;
+        }
+        finish();
+        return false;
+    }
+
+    bool ok() const { return !_failed; }
+    unsigned long rows() const { return _rows; }
+    uint32_t csvBytes() const { return _csvBytes; }
+    uint32_t archiveBytes() const { return _offset; }
+
+    static String binPath(const String& date) { return String(ARCHIVE_DIR) + "/" + date + ".bin"; }
+    static String idxPath(const String& date) { return String(ARCHIVE_DIR) + "/" + date + ".idx"; }
+
+    // Línea "23.45" -> 2345 con la resolución del canal; vacío = sin lectura
+    static bool parseSensorValue(const char* s, size_t len, const SensorChannel& ch, int32_t& raw) {
+        if (len == 0) {
+            raw = ch.noReading;
+            return true;
+        }
+        bool negative = s[0] == '-';
+        size_t i = negative ? 1 : 0;
+        int64_t value = 0;
+        uint8_t decimals = 0;
+        bool point = false;
+        bool digits = false;
+        for (; i < len; i++) {
+            if (s[i] == '.' && !point) {
+                point = true;
+            } else if (isdigit((unsigned char)s[i])) {
+                digits = true;
+                if (point && decimals >= ch.resolution) continue;   // más decimales de los que caben
+                value = value * 10 + (s[i] - '0');
+                if (point) decimals++;
+                if (value > 0x7FFFFFFFLL) return false;
+            } else {
+                return false;
+            }
+        }
+        for (; decimals < ch.resolution; decimals++) value *= 10;
+        raw = (int32_t)(negative ? -value : value);
+        return digits;
+    }
+
+    static String tracePath(const String& date) { return String(ARCHIVE_DIR) + "/" + date + ".trace"; }
+
+    // Nombre sin carpeta (el core 1.x de ESP32 da la ruta entera)
+    static String fileName(File& f) {
+        String name = f.name();
+        int slash = name.lastIndexOf('/');
+        return slash >= 0 ? name.substring(slash + 1) : name;
+    }
+
+    // Borra la carpeta de un día con todo lo que tenga
+    static bool removeDay(const String& date) { return removeDir("/" + date, 1); }
+
+    // Vacía y borra una carpeta (con hasta `depth` niveles de subcarpetas)
+    // de una entrada en una, reabriéndola: borrar mientras se recorre no es
+    // seguro en FAT
+    static bool removeDir(const String& dir, uint8_t depth) {
+        while (true) {
+            File folder = SD.open(dir, FILE_READ);
+            if (!folder) return false;
+            File f = folder.openNextFile();
+            if (!f) {
+                folder.close();
+                break;
+            }
+            String path = dir + "/" + fileName(f);
+            bool isDir = f.isDirectory();
+            f.close();
+            folder.close();
+            bool ok = isDir ? depth > 0 && removeDir(path, depth - 1) : SD.remove(path);
+            if (!ok) return false;
+        }
+        return SD.rmdir(dir);
+    }
+
+private:
+    struct HourSummary {
+        uint32_t offset;
+        uint32_t rows;
+        int32_t min[SENSOR_CHANNEL_COUNT];
+        int32_t max[SENSOR_CHANNEL_COUNT];
+        int64_t sum[SENSOR_CHANNEL_COUNT];
+        uint32_t count[SENSOR_CHANNEL_COUNT];
+    };
+
+    String _date;
+    File _out;
+    bool _active = false;
+    bool _failed = false;
+    uint8_t _hour = 0;
+    uint32_t _offset = 0;
+    unsigned long _rows = 0;
+    uint32_t _csvBytes = 0;
+    char _nodes[MAX_NODES][MAX_NODE_ID];
+    uint8_t _nodeCount = 0;
+    HourSummary _hours[24];
+
+    String tmpPath() const { return String(ARCHIVE_DIR) + "/" + _date + ".tmp"; }
+
+    static String hourPath(const String& date, uint8_t hour) {
+        char path[32];
+        snprintf(path, sizeof(path), "/%s/%02u/data.csv", date.c_str(), hour);
+        return path;
+    }
+
+    // Sin carpeta de esa hora no hay nada que hacer; una cabecera de otro
+    // formato de CSV no se sabe convertir
+    bool archiveHour(uint8_t hour) {
+        HourSummary& h = _hours[hour];
+        h.offset = _offset;
+        for (uint8_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+            h.min[c] = INT32_MAX;
+            h.max[c] = INT32_MIN;
+        }
+        File in = SD.open(hourPath(_date, hour), FILE_READ);
+        if (!in) return true;
+        _csvBytes += in.size();
+
+        char line[160];
+        int len = SDLogger::readLine(in, line, sizeof(line));
+        bool withQuality = len >= 0 && strcmp(line, ARCHIVE_CSV_HEADER) == 0;
+        bool legacy = len >= 0 && strcmp(line, "timestamp,nodeId,rssi" SENSOR_CSV_COLUMNS ",state") == 0;
+        if (len > 0 && !withQuality && !legacy) {
+            Serial.println("⚠️ " + hourPath(_date, hour) + ": columnas desconocidas, no se archiva el día");
+            in.close();
+            return false;
+        }
+        while ((len = SDLogger::readLine(in, line, sizeof(line))) >= 0) {
+            ArchiveRecord record;
+            if (len == 0 || !parseLine(line, record)) continue;   // línea cortada por un corte de luz
+            _out.write((const uint8_t*)&record, sizeof(record));
+            _offset += sizeof(record);
+            h.rows++;
+            _rows++;
+            uint8_t c = 0;
+            visitSensorChannels(record.data, [&](const SensorChannel& ch, int32_t raw) {
+                if (raw != ch.noReading) {
+                    if (raw < h.min[c]) h.min[c] = raw;
+                    if (raw > h.max[c]) h.max[c] = raw;
+                    h.sum[c] += raw;
+                    h.count[c]++;
+                }
+                c++;
+            });
+        }
+        in.close();
+        return true;
+    }
+
+    // "AAAA-MM-DD HH:MM:SS,nodo,rssi,<canales>,estado[,calidad]"
+    bool parseLine(const char* line, ArchiveRecord& out) {
+        const char* fields[3 + SENSOR_CHANNEL_COUNT + 2];
+        size_t lens[3 + SENSOR_CHANNEL_COUNT + 2];
+        uint8_t n = 0;
+        const char* p = line;
+        while (n < sizeof(fields) / sizeof(fields[0])) {
+            const char* end = strchr(p, ',');
+            fields[n] = p;
+            lens[n++] = end ? (size_t)(end - p) : strlen(p);
+            if (!end) break;
+            p = end + 1;
+        }
+        if (n < 3 + SENSOR_CHANNEL_COUNT + 1 || lens[0] != 19) return false;
+
+        int minute = atoi(fields[0] + 14);
+        int second = atoi(fields[0] + 17);
+        out.second = (uint16_t)(minute * 60 + second);
+        out.node = nodeIndex(fields[1], lens[1]);
+        out.rssi = (int8_t)constrain(atoi(fields[2]), -128, 127);
+        int32_t raw[SENSOR_CHANNEL_COUNT];
+        for (uint8_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+            if (!parseSensorValue(fields[3 + c], lens[3 + c], SENSOR_CHANNEL_TABLE[c], raw[c])) return false;
+        }
+        fillSensorChannels(out.data, [&](SensorChannelId id) { return raw[id]; });
+        out.state = (uint8_t)atoi(fields[3 + SENSOR_CHANNEL_COUNT]);
+        out.quality = n > 3 + SENSOR_CHANNEL_COUNT + 1 ? (uint16_t)atoi(fields[3 + SENSOR_CHANNEL_COUNT + 1]) : 0;
+        return true;
+    }
+
+    // Más de MAX_NODES nodos distintos en un día: el resto comparte el último
+    uint8_t nodeIndex(const char* id, size_t len) {
+        if (len >= MAX_NODE_ID) len = MAX_NODE_ID - 1;
+        for (uint8_t i = 0; i < _nodeCount; i++) {
+            if (strlen(_nodes[i]) == len && strncmp(_nodes[i], id, len) == 0) return i;
+        }
+        if (_nodeCount == MAX_NODES) return MAX_NODES - 1;
+        memcpy(_nodes[_nodeCount], id, len);
+        _nodes[_nodeCount][len] = '\0';
+        return _nodeCount++;
+    }
+
+    void fail() {
+        _out.close();
+        SD.remove(tmpPath());
+        _failed = true;
+        _active = false;
+    }
+
+    void finish() {
+        _out.close();
+        File idx = SD.open(idxPath(_date), FILE_WRITE);
+        if (!idx) {
+            fail();
+            return;
+        }
+        String nodes = "nodos";
+        for (uint8_t i = 0; i < _nodeCount; i++) nodes += "," + String(_nodes[i]);
+        idx.println(nodes);
+        String header = "hora,offset,filas";
+        for (uint8_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+            String key = SENSOR_CHANNEL_TABLE[c].key;
+            header += "," + key + "_min," + key + "_media," + key + "_max";
+        }
+        idx.println(header);
+        char value[16];
+        for (uint8_t hour = 0; hour < 24; hour++) {
+            const HourSummary& h = _hours[hour];
+            if (h.rows == 0) continue;
+            char start[32];
+            snprintf(start, sizeof(start), "%02u,%lu,%lu", hour, (unsigned long)h.offset, (unsigned long)h.rows);
+            String row = start;
+            for (uint8_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+                const SensorChannel& ch = SENSOR_CHANNEL_TABLE[c];
+                if (h.count[c] == 0) {
+                    row += ",,,";
+                    continue;
+                }
+                int32_t mean = (int32_t)((h.sum[c] + (h.sum[c] >= 0 ? 1 : -1) * (int64_t)(h.count[c] / 2)) / h.count[c]);
+                int32_t stats[3] = {h.min[c], mean, h.max[c]};
+                for (int32_t raw : stats) {
+                    formatSensorValue(value, sizeof(value), ch, raw, ch.resolution);
+                    row += "," + String(value);
+                }
+            }
+            idx.println(row);
+        }
+        idx.close();
+
+        if (!SD.rename(tmpPath(), binPath(_date))) {   // el .bin solo existe completo
+            SD.remove(idxPath(_date));
+            fail();
+            return;
+        }
+        // La traza del día (si se grabó) se guarda aparte, tal cual
+        SD.rename("/" + _date + "/trace.bin", tracePath(_date));
+        removeDay(_date);
+        _active = false;
+        Serial.println("🗜️ " + _date + " archivado: " + String(_rows) + " filas, " + String(_csvBytes / 1024) +
+                       " KB de CSV -> " + String(_offset / 1024) + " KB");
+    }
+};
+
+// Una hora archivada como líneas del CSV (la primera, la cabecera)
+class ArchiveHourReader {
+public:
+    bool open(const char* date, const char* hour) {
+        _date = date;
+        _hour = hour;
+        File idx = SD.open(DayArchiver::idxPath(date), FILE_READ);
+        if (!idx) return false;
+        char line[256];
+        int len = SDLogger::readLine(idx, line, sizeof(line));
+        _nodes = len > 6 ? String(line + 6) + "," : String();   // tras "nodos,"
+        bool found = false;
+        while (!found && (len = SDLogger::readLine(idx, line, sizeof(line))) >= 0) {
+            if (len > 3 && strncmp(line, hour, 2) == 0 && line[2] == ',') {
+                _offset = strtoul(line + 3, nullptr, 10);
+                const char* rows = strchr(line + 3, ',');
+                _remaining = rows ? strtoul(rows + 1, nullptr, 10) : 0;
+                found = true;
+            }
+        }
+        idx.close();
+        if (!found) return false;
+
+        _bin = SD.open(DayArchiver::binPath(date), FILE_READ);
+        ArchiveHeader header;
+        if (!_bin || _bin.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, "VVA1", 4) != 0 || header.recordSize != sizeof(ArchiveRecord) ||
+            header.channels != SENSOR_CHANNEL_COUNT || !_bin.seek(_offset)) {
+            _bin.close();
+            return false;
+        }
+        _headerSent = false;
+        return true;
+    }
+
+    // Como SDLogger::readLine: longitud de la línea o -1 al final
+    int readLine(char* buf, size_t size) {
+        if (!_headerSent) {
+            _headerSent = true;
+            return copy(buf, size, ARCHIVE_CSV_HEADER);
+        }
+        ArchiveRecord r;
+        if (_remaining == 0 || _bin.read((uint8_t*)&r, sizeof(r)) != sizeof(r)) return -1;
+        _remaining--;
+        char timestamp[20];
+        snprintf(timestamp, sizeof(timestamp), "%s %s:%02u:%02u", _date.c_str(), _hour.c_str(), r.second / 60, r.second % 60);
+        return copy(buf, size, SDLogger::formatCsvLine(timestamp, nodeName(r.node), r.rssi, r.data, r.state, r.quality).c_str());
+    }
+
+    void close() { _bin.close(); }
+
+private:
+    String _date;
+    String _hour;
+    String _nodes;   // "NODE_1,NODE_2,"
+    File _bin;
+    uint32_t _offset = 0;
+    unsigned long _remaining = 0;
+    bool _headerSent = false;
+
+    String nodeName(uint8_t index) const {
+        int from = 0;
+        for (uint8_t i = 0; i < index && from >= 0; i++) {
+            from = _nodes.indexOf(',', from);
+            if (from >= 0) from++;
+        }
+        int end = from >= 0 ? _nodes.indexOf(',', from) : -1;
+        return end > from ? _nodes.substring(from, end) : String("?");
+    }
+
+    static int copy(char* buf, size_t size, const char* text) {
+        size_t len = strlen(text);
+        if (len > size - 1) len = size - 1;
+        memcpy(buf, text, len);
+        buf[len] = '\0';
+        return (int)len;
+    }
+};
+
+#endif
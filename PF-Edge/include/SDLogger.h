@@ -14,7 +14,8 @@ public:
         return SD.begin(_csPin);
     }
 
-    bool logSensorData(const String& timestamp, const String& nodeId, int rssi, const SensorData& data, int systemState) {
+    // quality: canales marcados por SensorQuality (bit = SensorChannelId)
+    bool logSensorData(const String& timestamp, const String& nodeId, int rssi, const SensorData& data, int systemState, uint16_t quality = 0) {
         String folderPath = getFolderPath(timestamp);
         String filePath = getFilePath(timestamp);
 
@@ -28,23 +29,39 @@ public:
 
         // Si el archivo estaba vacío, escribe encabezados
         if (file.size() == 0) {
-            file.println("timestamp,nodeId,rssi,temp,hum,light,co2ppm,soilMoisture,voltage,state");
+            file.println("timestamp,nodeId,rssi" SENSOR_CSV_COLUMNS ",state,calidad");
         }
 
-        String csvLine = timestamp + "," + nodeId + "," + String(rssi) + "," +
-                         String(data.temperature, 2) + "," +
-                         String(data.humidity, 2) + "," +
-                         String(data.light) + "," +
-                         String(data.co2ppm) + "," +
-                         String(data.soilMoisture) + "," +
-                         String(data.voltage, 2) + "," +
-                         String(systemState);
-
-        file.println(csvLine);
+        file.println(formatCsvLine(timestamp, nodeId, rssi, data, systemState, quality));
         file.close();
         return true;
     }
 
+    // Lee una línea del CSV en `buf` (sin el fin de línea; las demasiado
+    // largas se cortan). Devuelve su longitud o -1 al final del archivo.
+    static int readLine(File& file, char* buf, size_t size) {
+        size_t len = 0;
+        int c;
+        while ((c = file.read()) >= 0 && c != '\n') {
+            if (c != '\r' && len < size - 1) buf[len++] = (char)c;
+        }
+        buf[len] = '\0';
+        return c < 0 && len == 0 ? -1 : (int)len;
+    }
+
+    static String formatCsvLine(const String& timestamp, const String& nodeId, int rssi, const SensorData& data, int systemState, uint16_t quality = 0) {
+        // Cada canal con todos sus decimales (sin pasar por float); vacío si no hubo lectura
+        String line = timestamp + "," + nodeId + "," + String(rssi);
+        char value[16];
+        visitSensorChannels(data, [&](const SensorChannel& ch, int32_t raw) {
+            line += ",";
+            if (raw == ch.noReading) return;
+            formatSensorValue(value, sizeof(value), ch, raw, ch.resolution);
+            line += value;
+        });
+        return line + "," + String(systemState) + "," + String(quality);
+    }
+
 private:
     int _csPin;
 
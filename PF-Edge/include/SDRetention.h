@@ -0,0 +1,244 @@
+#ifndef SD_RETENTION_H
+#define SD_RETENTION_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include "SDArchive.h"
+
+// Mantenimiento de la SD en segundo plano (tarea de prioridad 0):
+//  - cada día cerrado (pasadas las 00:10 del siguiente) se archiva con
+//    DayArchiver, una hora por llamada;
+//  - si los datos (carpetas de días y /archivo) pasan de budgetMb, o el
+//    espacio libre baja de minFreeMb, se borra el día más antiguo, nunca el
+//    de hoy ni uno posterior (un RTC sin hora no borra nada).
+//
+// update() devuelve cuánto esperar hasta la siguiente llamada: poco
+// mientras haya trabajo, CHECK_PERIOD_MS si no.
+class SDRetention {
+public:
+    static constexpr unsigned long CHECK_PERIOD_MS = 600000;
+    static constexpr unsigned long STEP_PAUSE_MS = 200;
+    static constexpr uint8_t MAX_FAILED = 4;
+
+    struct Status {
+        uint64_t totalBytes;
+        uint64_t freeBytes;
+        uint64_t dataBytes;       // carpetas de días + /archivo
+        uint16_t days;            // sin archivar
+        uint16_t archivedDays;
+        char oldest[11];          // día más antiguo guardado ("" si ninguno)
+        char archiving[11];       // día en curso ("" si ninguno)
+        unsigned long daysArchived;
+        unsigned long daysDeleted;
+        uint64_t bytesSaved;      // CSV archivado - archivo resultante
+        bool checked;
+    };
+
+    // MB; budget 0 = sin límite
+    void setLimits(uint16_t budgetMb, uint16_t minFreeMb) {
+        _budgetBytes = (uint64_t)budgetMb * 1024 * 1024;
+        _minFreeBytes = (uint64_t)minFreeMb * 1024 * 1024;
+    }
+
+    // now: "AAAA-MM-DD HH:MM:SS" del RTC
+    unsigned long update(const String& now) {
+        if (_archiver.active()) {
+            if (_archiver.step()) return STEP_PAUSE_MS;
+            portENTER_CRITICAL(&_mux);
+            if (_archiver.ok()) {
+                _status.daysArchived++;
+                if (_archiver.csvBytes() > _archiver.archiveBytes()) {
+                    _status.bytesSaved += _archiver.csvBytes() - _archiver.archiveBytes();
+                }
+            }
+            _status.archiving[0] = '\0';
+            portEXIT_CRITICAL(&_mux);
+            if (!_archiver.ok()) markFailed(_archiver.date());
+            return STEP_PAUSE_MS;
+        }
+
+        String today = now.substring(0, 10);
+        bool afterMidnight = now.length() >= 16 && strncmp(now.c_str() + 11, "00:10", 5) >= 0;
+        Scan scan;
+        this->scan(today, scan);
+
+        bool overBudget = _budgetBytes > 0 && scan.dataBytes > _budgetBytes;
+        bool lowSpace = scan.totalBytes > 0 && scan.freeBytes < _minFreeBytes;
+        if ((overBudget || lowSpace) && scan.oldest.length() > 0) {
+            String reason = overBudget ? "más de " + String((unsigned long)(_budgetBytes >> 20)) + " MB de datos"
+                                       : "menos de " + String((unsigned long)(_minFreeBytes >> 20)) + " MB libres";
+            if (deleteDay(scan.oldest)) {
+                Serial.println("🧹 SD: borrado " + scan.oldest + " (" + reason + ")");
+                portENTER_CRITICAL(&_mux);
+                _status.daysDeleted++;
+                portEXIT_CRITICAL(&_mux);
+                return STEP_PAUSE_MS;
+            }
+            Serial.println("⚠️ SD: no se pudo borrar " + scan.oldest);
+            return CHECK_PERIOD_MS;
+        }
+
+        if (scan.toArchive.length() > 0 && afterMidnight) {
+            if (_archiver.begin(scan.toArchive)) {
+                portENTER_CRITICAL(&_mux);
+                strncpy(_status.archiving, scan.toArchive.c_str(), sizeof(_status.archiving) - 1);
+                portEXIT_CRITICAL(&_mux);
+                return STEP_PAUSE_MS;
+            }
+            markFailed(scan.toArchive);
+        }
+        return CHECK_PERIOD_MS;
+    }
+
+    Status status() {
+        portENTER_CRITICAL(&_mux);
+        Status s = _status;
+        portEXIT_CRITICAL(&_mux);
+        return s;
+    }
+
+    // Para Telegram
+    String formatStatus() {
+        Status s = status();
+        if (!s.checked) return "💾 SD: aún sin revisar.";
+        String text = "💾 SD: " + String((unsigned long)(s.freeBytes >> 20)) + " MB libres de " +
+                      String((unsigned long)(s.totalBytes >> 20)) + " MB\n";
+        text += "📂 Datos: " + String((unsigned long)(s.dataBytes >> 10)) + " KB (" + String(s.days) + " días en CSV, " +
+                String(s.archivedDays) + " archivados)";
+        text += _budgetBytes ? ", límite " + String((unsigned long)(_budgetBytes >> 20)) + " MB\n" : String(", sin límite\n");
+        if (s.oldest[0]) text += "📅 Desde el " + String(s.oldest) + "\n";
+        if (s.archiving[0]) text += "🗜️ Archivando " + String(s.archiving) + "\n";
+        text += "🗜️ " + String(s.daysArchived) + " días archivados (" + String((unsigned long)(s.bytesSaved >> 10)) +
+                " KB ahorrados), 🧹 " + String(s.daysDeleted) + " borrados";
+        return text;
+    }
+
+private:
+    struct Scan {
+        uint64_t totalBytes = 0;
+        uint64_t freeBytes = 0;
+        uint64_t dataBytes = 0;
+        String oldest;          // día más antiguo borrable
+        String toArchive;       // día sin archivar más antiguo, anterior a hoy
+    };
+
+    DayArchiver _archiver;
+    uint64_t _budgetBytes = 0;
+    uint64_t _minFreeBytes = 0;
+    char _failed[MAX_FAILED][11] = {};
+    uint8_t _failedNext = 0;
+    Status _status = {};
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    static bool isDate(const char* name) {
+        if (strlen(name) < 10) return false;
+        for (uint8_t i = 0; i < 10; i++) {
+            bool dash = i == 4 || i == 7;
+            if (dash ? name[i] != '-' : !isdigit((unsigned char)name[i])) return false;
+        }
+        return true;
+    }
+
+    bool failed(const String& date) const {
+        for (uint8_t i = 0; i < MAX_FAILED; i++) {
+            if (date == _failed[i]) return true;
+        }
+        return false;
+    }
+
+    // Un día que no se pudo archivar se queda en CSV (hasta reiniciar)
+    void markFailed(const String& date) {
+        strncpy(_failed[_failedNext], date.c_str(), 10);
+        _failed[_failedNext][10] = '\0';
+        _failedNext = (_failedNext + 1) % MAX_FAILED;
+    }
+
+    static uint64_t folderBytes(File& folder, uint8_t depth) {
+        uint64_t bytes = 0;
+        for (File f = folder.openNextFile(); f; f = folder.openNextFile()) {
+            bytes += f.isDirectory() ? (depth > 0 ? folderBytes(f, depth - 1) : 0) : f.size();
+            f.close();
+        }
+        return bytes;
+    }
+
+    // Una pasada por la raíz y por /archivo: tamaños y candidatos
+    void scan(const String& today, Scan& out) {
+        out.totalBytes = SD.totalBytes();
+        uint64_t used = SD.usedBytes();
+        out.freeBytes = out.totalBytes > used ? out.totalBytes - used : 0;
+        uint16_t days = 0, archived = 0;
+        String oldestAny;
+
+        // Solo quedan en CSV hoy, ayer y los que no se pudieron archivar:
+        // recorrerlos es barato
+        File root = SD.open("/", FILE_READ);
+        for (File f = root ? root.openNextFile() : File(); f; f = root.openNextFile()) {
+            String name = DayArchiver::fileName(f);
+            if (f.isDirectory() && name.length() == 10 && isDate(name.c_str())) {
+                days++;
+                out.dataBytes += folderBytes(f, 1);
+                if (oldestAny.length() == 0 || name < oldestAny) oldestAny = name;
+                if (name < today && (out.oldest.length() == 0 || name < out.oldest)) out.oldest = name;
+                if (name < today && !failed(name) && (out.toArchive.length() == 0 || name < out.toArchive)) {
+                    out.toArchive = name;
+                }
+            }
+            f.close();
+        }
+        if (root) root.close();
+
+        // Un .tmp es un archivado cortado por un reinicio: se rehace
+        String lastArchived;
+        File dir = SD.open(ARCHIVE_DIR, FILE_READ);
+        for (File f = dir ? dir.openNextFile() : File(); f; f = dir.openNextFile()) {
+            String name = DayArchiver::fileName(f);
+            size_t size = f.size();
+            f.close();
+            if (!isDate(name.c_str())) continue;
+            if (name.endsWith(".tmp")) {
+                SD.remove(String(ARCHIVE_DIR) + "/" + name);
+                continue;
+            }
+            out.dataBytes += size;
+            String date = name.substring(0, 10);
+            if (date != lastArchived) {
+                lastArchived = date;
+                archived++;
+            }
+            if (oldestAny.length() == 0 || date < oldestAny) oldestAny = date;
+            if (date < today && (out.oldest.length() == 0 || date < out.oldest)) out.oldest = date;
+            // Archivo completo y carpeta aún presente: reinicio antes de borrarla
+            if (date == out.toArchive && name.endsWith(".bin")) {
+                DayArchiver::removeDay(date);
+                out.toArchive = "";
+            }
+        }
+        if (dir) dir.close();
+
+        portENTER_CRITICAL(&_mux);
+        _status.totalBytes = out.totalBytes;
+        _status.freeBytes = out.freeBytes;
+        _status.dataBytes = out.dataBytes;
+        _status.days = days;
+        _status.archivedDays = archived;
+        strncpy(_status.oldest, oldestAny.c_str(), sizeof(_status.oldest) - 1);
+        _status.oldest[sizeof(_status.oldest) - 1] = '\0';
+        _status.checked = true;
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    // Archivo y/o carpeta del día
+    bool deleteDay(const String& date) {
+        bool ok = true;
+        if (SD.exists("/" + date)) ok = DayArchiver::removeDay(date);
+        const String paths[] = {DayArchiver::binPath(date), DayArchiver::idxPath(date), DayArchiver::tracePath(date)};
+        for (const String& path : paths) {
+            if (SD.exists(path)) ok = SD.remove(path) && ok;
+        }
+        return ok;
+    }
+};
+
+#endif
@@ -0,0 +1,418 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "dataActuator.h"
+
+// Horarios de actuación sobre la hora local del RTC (segundos Unix).
+//
+// - Fotoperiodo (SCHEDULE_LIGHT) y riego (SCHEDULE_IRRIGATION): ventanas
+//   diarias por zona. Si una zona tiene ventanas de un tipo, fuera de ellas
+//   ese actuador queda apagado aunque las reglas lo pidan; dentro deciden
+//   las reglas (o el PID). Una ventana puede cruzar la medianoche.
+// - Temporizadores de una sola vez: fuerzan una función de una zona a un
+//   nivel durante un tiempo y se borran al terminar.
+//
+// Las fronteras de las ventanas (segundo del día) y los temporizadores
+// (hora de inicio) se guardan ordenados: el próximo evento sale de una
+// búsqueda binaria. Entre eventos el estado de cada zona queda en máscaras
+// de bits, así gate() por muestra es O(1) y solo se recalcula al cruzar
+// un evento o al cambiar la tabla.
+enum ScheduleKind : uint8_t {
+    SCHEDULE_LIGHT = 0,
+    SCHEDULE_IRRIGATION = 1,
+    SCHEDULE_TIMER = 2
+};
+
+// Una ventana tal como se guarda en NVS (ver ConfigStore), a minutos
+struct ScheduleWindow {
+    uint8_t id;
+    uint8_t kind;            // SCHEDULE_LIGHT o SCHEDULE_IRRIGATION
+    uint8_t zone;
+    uint8_t reserved;
+    uint16_t startMin;       // minuto del día
+    uint16_t durationMin;
+};
+
+// Una orden de Telegram ya interpretada (Scheduler::parseCommand)
+struct ScheduleCommand {
+    enum Op : uint8_t { ADD_WINDOW, ADD_TIMER, REMOVE } op;
+    ScheduleKind kind;
+    uint8_t zone;
+    ActuatorRole role;
+    uint8_t value;
+    uint8_t id;              // REMOVE
+    uint32_t start;          // ventana: segundo del día
+    uint32_t duration;       // segundos
+};
+
+struct ScheduleEntry {
+    uint8_t id;
+    ScheduleKind kind;
+    uint8_t zone;
+    ActuatorRole role;       // solo temporizadores
+    uint8_t value;           // solo temporizadores
+    uint32_t start;          // ventanas: segundo del día; temporizadores: hora Unix
+    uint32_t duration;       // segundos
+};
+
+class Scheduler {
+public:
+    static constexpr uint8_t MAX_ENTRIES = 24;
+    static constexpr uint32_t DAY = 86400;
+    static constexpr uint8_t MAX_ZONES = 8;   // una máscara de 8 bits por tipo
+
+    // Devuelve el id de la ventana o -1 (tabla llena o datos no válidos)
+    int addWindow(ScheduleKind kind, uint8_t zone, uint32_t startOfDay, uint32_t duration) {
+        if (kind == SCHEDULE_TIMER || startOfDay >= DAY || duration == 0 || duration > DAY) return -1;
+        ScheduleEntry e = {0, kind, zone, ROLE_OTHER, 0, startOfDay, duration};
+        return insert(_windows, _windowCount, e);
+    }
+
+    int addTimer(uint8_t zone, ActuatorRole role, uint8_t value, uint32_t startUnix, uint32_t duration) {
+        if (duration == 0) return -1;
+        ScheduleEntry e = {0, SCHEDULE_TIMER, zone, role, value, startUnix, duration};
+        return insert(_timers, _timerCount, e);
+    }
+
+    bool remove(uint8_t id) {
+        bool removed = removeFrom(_windows, _windowCount, id) || removeFrom(_timers, _timerCount, id);
+        if (removed) _dirty = true;
+        return removed;
+    }
+
+    // Aplica los horarios a la decisión de una zona
+    void gate(uint8_t zone, uint32_t now, ActuatorState& state) {
+        update(now);
+        uint8_t bit = zone < MAX_ZONES ? (1 << zone) : 0;
+        if ((_lightDefined & bit) && !(_lightActive & bit)) state.leds = 0;
+        if ((_irrigationDefined & bit) && !(_irrigationActive & bit)) state.waterPump = 0;
+
+        for (uint8_t i = 0; i < _timerCount && _timers[i].start <= now; i++) {
+            const ScheduleEntry& t = _timers[i];
+            if (t.zone != zone) continue;
+            if (t.role == ROLE_PUMP) state.waterPump = t.value;
+            else if (t.role == ROLE_FAN) state.fan = t.value;
+            else if (t.role == ROLE_LIGHT) state.leds = t.value;
+        }
+    }
+
+    // Recalcula solo si se ha cruzado el próximo evento o cambió la tabla.
+    // true si recalculó (las zonas deben volver a pasar por gate())
+    bool update(uint32_t now) {
+        if (!_dirty && now < _nextEventAt) return false;
+        recompute(now);
+        return true;
+    }
+
+    uint32_t nextEventAt() const { return _nextEventAt; }
+
+    // Ventanas para guardar en NVS; devuelve cuántas (los temporizadores son
+    // de una sola vez y no se guardan)
+    uint8_t exportWindows(ScheduleWindow* out) const {
+        for (uint8_t i = 0; i < _windowCount; i++) {
+            const ScheduleEntry& e = _windows[i];
+            out[i] = {e.id, (uint8_t)e.kind, e.zone, 0, (uint16_t)(e.start / 60), (uint16_t)(e.duration / 60)};
+        }
+        return _windowCount;
+    }
+
+    // Al arrancar, las ventanas guardadas (con sus ids)
+    void importWindows(const ScheduleWindow* windows, uint8_t count) {
+        _windowCount = 0;
+        for (uint8_t i = 0; i < count && _windowCount < MAX_ENTRIES; i++) {
+            const ScheduleWindow& w = windows[i];
+            uint32_t start = (uint32_t)w.startMin * 60, duration = (uint32_t)w.durationMin * 60;
+            if (w.kind > SCHEDULE_IRRIGATION || w.zone >= MAX_ZONES || w.id == 0 || idInUse(w.id) ||
+                start >= DAY || duration == 0 || duration > DAY) continue;
+            ScheduleEntry e = {w.id, (ScheduleKind)w.kind, w.zone, ROLE_OTHER, 0, start, duration};
+            uint8_t pos = upperBound(_windows, _windowCount, e.start);
+            memmove(&_windows[pos + 1], &_windows[pos], (_windowCount - pos) * sizeof(ScheduleEntry));
+            _windows[pos] = e;
+            _windowCount++;
+            if (w.id >= _nextId) _nextId = w.id == 255 ? 1 : w.id + 1;
+        }
+        _dirty = true;
+    }
+
+    // Comandos de Telegram:
+    //   /horario luz|riego HH:MM-HH:MM [zona]
+    //   /horario borrar <id>
+    //   /temporizador bomba|ventilador|luces <minutos> [nivel 0-255] [zona]
+    // Se interpretan con parseCommand() (String, sin tocar la tabla) y se
+    // aplican con apply(), que es lo único que necesita la sección crítica.
+    // Si no se entiende, false y el uso (o la zona no válida) en `error`.
+    static bool parseCommand(const String& cmd, ScheduleCommand& out, String& error) {
+        String args[5];
+        int n = splitArgs(cmd, args, 5);
+        out = ScheduleCommand();
+
+        if (cmd.startsWith("/horario ")) {
+            if (n >= 2 && args[0] == "borrar") {
+                out.op = ScheduleCommand::REMOVE;
+                out.id = (uint8_t)args[1].toInt();
+                return true;
+            }
+            uint32_t from, to;
+            if (n < 2 || (args[0] != "luz" && args[0] != "riego") || !parseRange(args[1], from, to)) {
+                error = "⚠️ Uso: /horario luz|riego HH:MM-HH:MM [zona] o /horario borrar <id>";
+                return false;
+            }
+            out.op = ScheduleCommand::ADD_WINDOW;
+            out.kind = args[0] == "luz" ? SCHEDULE_LIGHT : SCHEDULE_IRRIGATION;
+            if (n >= 3 && !parseZone(args[2], out.zone, error)) return false;
+            out.start = from;
+            out.duration = to > from ? to - from : to + DAY - from;
+            return true;
+        }
+
+        if (cmd.startsWith("/temporizador ")) {
+            error = "⚠️ Uso: /temporizador bomba|ventilador|luces <minutos> [nivel] [zona]";
+            if (args[0] == "bomba") out.role = ROLE_PUMP;
+            else if (args[0] == "ventilador") out.role = ROLE_FAN;
+            else if (args[0] == "luces") out.role = ROLE_LIGHT;
+            else return false;
+
+            long minutes = n >= 2 ? args[1].toInt() : 0;
+            long value = n >= 3 ? args[2].toInt() : ACTUATOR_VALUE_ON;
+            if (minutes <= 0 || value < 0 || value > 255) return false;
+            out.op = ScheduleCommand::ADD_TIMER;
+            out.kind = SCHEDULE_TIMER;
+            out.value = (uint8_t)value;
+            if (n >= 4 && !parseZone(args[3], out.zone, error)) return false;
+            out.duration = (uint32_t)minutes * 60;
+            return true;
+        }
+        error = "";
+        return false;
+    }
+
+    // Id añadido, 1/0 si se borró o no (REMOVE), -1 si no cabe (tabla
+    // llena o los 255 ids en uso)
+    int apply(const ScheduleCommand& c, uint32_t now) {
+        if (c.op == ScheduleCommand::REMOVE) return remove(c.id) ? 1 : 0;
+        if (c.op == ScheduleCommand::ADD_WINDOW) return addWindow(c.kind, c.zone, c.start, c.duration);
+        return addTimer(c.zone, c.role, c.value, now, c.duration);
+    }
+
+    // Respuesta para Telegram al resultado de apply()
+    static String describeResult(const ScheduleCommand& c, int result) {
+        if (c.op == ScheduleCommand::REMOVE) return result > 0 ? "✅ Horario borrado." : "⚠️ No existe ese horario.";
+        if (result < 0) return "⚠️ No se pudo añadir (tabla llena).";
+        if (c.op == ScheduleCommand::ADD_WINDOW) return "✅ Horario #" + String(result) + " añadido.";
+        return "✅ Temporizador #" + String(result) + " activo.";
+    }
+
+    // Sobre una copia (ver main.cpp): crea String y no debe correr con la tabla bloqueada
+    String format(uint32_t now) {
+        update(now);
+        static const char* kinds[] = {"💡 Luz", "💧 Riego"};
+        static const char* roles[] = {"bomba", "ventilador", "luces", "válvula", "otro"};
+        String s = "🗓️ Horarios:\n";
+        for (uint8_t i = 0; i < _windowCount; i++) {
+            const ScheduleEntry& e = _windows[i];
+            s += "#" + String(e.id) + " " + kinds[e.kind] + " Z" + String(e.zone) + " " +
+                 formatClock(e.start) + "-" + formatClock((e.start + e.duration) % DAY) + "\n";
+        }
+        for (uint8_t i = 0; i < _timerCount; i++) {
+            const ScheduleEntry& t = _timers[i];
+            long left = (long)(t.start + t.duration) - (long)now;
+            s += "#" + String(t.id) + " ⏲️ " + roles[t.role] + " Z" + String(t.zone) + " nivel " +
+                 String(t.value) + ", quedan " + String(left / 60) + " min\n";
+        }
+        if (_windowCount == 0 && _timerCount == 0) s += "(sin horarios)\n";
+        if (_nextEventAt != UINT32_MAX) s += "⏭️ Próximo evento: " + formatClock(_nextEventAt % DAY);
+        return s;
+    }
+
+    // "HH:MM" de un segundo del día
+    static String formatClock(uint32_t secondOfDay) {
+        uint32_t h = secondOfDay / 3600, m = (secondOfDay / 60) % 60;
+        return String(h < 10 ? "0" : "") + String(h) + ":" + (m < 10 ? "0" : "") + String(m);
+    }
+
+private:
+    ScheduleEntry _windows[MAX_ENTRIES];   // ordenadas por inicio (segundo del día)
+    uint8_t _windowCount = 0;
+    ScheduleEntry _timers[MAX_ENTRIES];    // ordenados por inicio (Unix)
+    uint8_t _timerCount = 0;
+    uint32_t _bounds[2 * MAX_ENTRIES];     // inicios y finales de ventanas, ordenados
+    uint8_t _boundCount = 0;
+    uint8_t _nextId = 1;
+
+    uint8_t _lightDefined = 0, _lightActive = 0;          // bit por zona
+    uint8_t _irrigationDefined = 0, _irrigationActive = 0;
+    uint32_t _nextEventAt = 0;
+    bool _dirty = true;
+
+    // Inserción ordenada por inicio
+    int insert(ScheduleEntry* table, uint8_t& count, ScheduleEntry e) {
+        if (count >= MAX_ENTRIES || e.zone >= MAX_ZONES) return -1;
+        int id = allocateId();
+        if (id < 0) return -1;
+        e.id = (uint8_t)id;
+        uint8_t pos = upperBound(table, count, e.start);
+        memmove(&table[pos + 1], &table[pos], (count - pos) * sizeof(ScheduleEntry));
+        table[pos] = e;
+        count++;
+        _dirty = true;
+        return e.id;
+    }
+
+    bool idInUse(uint8_t id) const {
+        for (uint8_t i = 0; i < _windowCount; i++) {
+            if (_windows[i].id == id) return true;
+        }
+        for (uint8_t i = 0; i < _timerCount; i++) {
+            if (_timers[i].id == id) return true;
+        }
+        return false;
+    }
+
+    // Siguiente id libre a partir de _nextId (1..255, sin el 0); al dar la
+    // vuelta se saltan los que siguen en uso, también los cargados de NVS
+    int allocateId() {
+        for (uint16_t tries = 0; tries < 255; tries++) {
+            uint8_t id = _nextId;
+            _nextId = _nextId == 255 ? 1 : _nextId + 1;
+            if (!idInUse(id)) return id;
+        }
+        return -1;
+    }
+
+    static bool removeFrom(ScheduleEntry* table, uint8_t& count, uint8_t id) {
+        for (uint8_t i = 0; i < count; i++) {
+            if (table[i].id != id) continue;
+            memmove(&table[i], &table[i + 1], (count - i - 1) * sizeof(ScheduleEntry));
+            count--;
+            return true;
+        }
+        return false;
+    }
+
+    // Primer índice con inicio > value
+    static uint8_t upperBound(const ScheduleEntry* table, uint8_t count, uint32_t value) {
+        uint8_t lo = 0, hi = count;
+        while (lo < hi) {
+            uint8_t mid = (lo + hi) / 2;
+            if (table[mid].start <= value) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    static uint8_t upperBound(const uint32_t* values, uint8_t count, uint32_t value) {
+        uint8_t lo = 0, hi = count;
+        while (lo < hi) {
+            uint8_t mid = (lo + hi) / 2;
+            if (values[mid] <= value) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    void rebuildBounds() {
+        _boundCount = 0;
+        for (uint8_t i = 0; i < _windowCount; i++) {
+            uint32_t b[2] = {_windows[i].start, (_windows[i].start + _windows[i].duration) % DAY};
+            for (uint32_t v : b) {
+                uint8_t pos = upperBound(_bounds, _boundCount, v);
+                memmove(&_bounds[pos + 1], &_bounds[pos], (_boundCount - pos) * sizeof(uint32_t));
+                _bounds[pos] = v;
+                _boundCount++;
+            }
+        }
+    }
+
+    static bool inWindow(const ScheduleEntry& w, uint32_t secondOfDay) {
+        uint32_t offset = (secondOfDay + DAY - w.start) % DAY;
+        return offset < w.duration;
+    }
+
+    void recompute(uint32_t now) {
+        if (_dirty) rebuildBounds();
+        _dirty = false;
+
+        // Temporizadores vencidos fuera (están ordenados por inicio, no por fin)
+        for (uint8_t i = 0; i < _timerCount;) {
+            if (_timers[i].start + _timers[i].duration <= now) {
+                memmove(&_timers[i], &_timers[i + 1], (_timerCount - i - 1) * sizeof(ScheduleEntry));
+                _timerCount--;
+            } else {
+                i++;
+            }
+        }
+
+        uint32_t sod = now % DAY;
+        _lightDefined = _lightActive = _irrigationDefined = _irrigationActive = 0;
+        for (uint8_t i = 0; i < _windowCount; i++) {
+            const ScheduleEntry& w = _windows[i];
+            uint8_t bit = 1 << w.zone;
+            bool active = inWindow(w, sod);
+            if (w.kind == SCHEDULE_LIGHT) {
+                _lightDefined |= bit;
+                if (active) _lightActive |= bit;
+            } else {
+                _irrigationDefined |= bit;
+                if (active) _irrigationActive |= bit;
+            }
+        }
+
+        // Próximo evento: frontera de ventana, inicio o fin de temporizador
+        uint32_t next = UINT32_MAX;
+        if (_boundCount > 0) {
+            uint8_t k = upperBound(_bounds, _boundCount, sod);
+            uint32_t dayStart = now - sod;
+            next = k < _boundCount ? dayStart + _bounds[k] : dayStart + DAY + _bounds[0];
+        }
+        uint8_t t = upperBound(_timers, _timerCount, now);
+        if (t < _timerCount && _timers[t].start < next) next = _timers[t].start;
+        for (uint8_t i = 0; i < t; i++) {
+            uint32_t end = _timers[i].start + _timers[i].duration;
+            if (end < next) next = end;
+        }
+        _nextEventAt = next;
+    }
+
+    static int splitArgs(const String& cmd, String* out, int max) {
+        int n = 0;
+        int from = cmd.indexOf(' ');
+        while (from > 0 && n < max) {
+            int to = cmd.indexOf(' ', from + 1);
+            out[n] = to > 0 ? cmd.substring(from + 1, to) : cmd.substring(from + 1);
+            if (!out[n].isEmpty()) n++;
+            from = to;
+        }
+        return n;
+    }
+
+    static bool parseZone(const String& s, uint8_t& zone, String& error) {
+        bool digits = s.length() > 0 && s.length() <= 3;
+        for (unsigned i = 0; digits && i < s.length(); i++) digits = s.charAt(i) >= '0' && s.charAt(i) <= '9';
+        if (!digits || s.toInt() >= MAX_ZONES) {
+            error = "⚠️ Zona no válida: " + s + " (0-" + String(MAX_ZONES - 1) + ")";
+            return false;
+        }
+        zone = (uint8_t)s.toInt();
+        return true;
+    }
+
+    // "07:00-19:30" -> segundos del día
+    static bool parseRange(const String& s, uint32_t& from, uint32_t& to) {
+        int dash = s.indexOf('-');
+        return dash > 0 && parseClock(s.substring(0, dash), from) && parseClock(s.substring(dash + 1), to) && from != to;
+    }
+
+    static bool parseClock(const String& s, uint32_t& out) {
+        int colon = s.indexOf(':');
+        if (colon <= 0) return false;
+        long h = s.substring(0, colon).toInt();
+        long m = s.substring(colon + 1).toInt();
+        if (h < 0 || h > 23 || m < 0 || m > 59) return false;
+        out = (uint32_t)(h * 3600 + m * 60);
+        return true;
+    }
+
+};
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef SENSOR_CONFIG_SENDER_H
+#define SENSOR_CONFIG_SENDER_H
+
+#include <WiFi.h>
+#include <esp_now.h>
+#include "SensorSettings.h"
+
+// Configuración remota de los nodos sensores (ver SensorSettings.h): una
+// petición por nodo con número de secuencia, retransmitida con backoff
+// hasta su ACK, como los comandos de actuadores. Las peticiones lanzadas
+// juntas (/nodo todos ...) forman una tanda y takeReport() devuelve un
+// único mensaje cuando han terminado todas.
+//
+// push() se llama desde la tarea de Telegram, update() desde
+// ReceiveDataTask y handleFrame() desde el callback de ESP-NOW.
+class SensorConfigSender {
+public:
+    static constexpr uint8_t MAX_NODES = 8;
+    static constexpr unsigned long RETRY_BASE_MS = 250;   // el nodo responde desde su loop()
+    static constexpr uint8_t MAX_ATTEMPTS = 5;            // 250+500+1000+2000 ms ≈ 3.8 s
+
+    // Añade a la tanda una petición para el nodo (count 0: solo consulta).
+    // false si el nodo ya tiene una en curso o no hay hueco.
+    bool push(const uint8_t mac[6], const SettingValue* items, uint8_t count) {
+        if (count > SENSOR_CONFIG_MAX_ITEMS) return false;
+        if (!esp_now_is_peer_exist(mac)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, mac, 6);
+            peerInfo.channel = 0;   // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            if (esp_now_add_peer(&peerInfo) != ESP_OK) return false;
+        }
+
+        portENTER_CRITICAL(&_mux);
+        Job* job = slotFor(mac);
+        if (!job || job->pending) {
+            portEXIT_CRITICAL(&_mux);
+            return false;
+        }
+        job->frame = SensorConfigFrame();
+        job->frame.seq = _nextSeq++;
+        job->frame.count = count;
+        memcpy(job->frame.items, items, sizeof(SettingValue) * count);
+        job->pending = true;
+        job->answered = false;
+        job->inBatch = true;
+        job->attempts = 1;
+        job->nextRetryAt = millis() + RETRY_BASE_MS;
+        SensorConfigFrame frame = job->frame;
+        _requests++;
+        portEXIT_CRITICAL(&_mux);
+
+        transmit(mac, (const uint8_t*)&frame, frame.frameLength());
+        return true;
+    }
+
+    // Retransmisiones pendientes; llamar periódicamente desde una tarea
+    void update() {
+        for (uint8_t i = 0; i < _count; i++) {
+            portENTER_CRITICAL(&_mux);
+            Job& job = _jobs[i];
+            unsigned long now = millis();
+            bool resend = false;
+            if (job.pending && (long)(now - job.nextRetryAt) >= 0) {
+                if (job.attempts >= MAX_ATTEMPTS) {
+                    job.pending = false;
+                    _timeouts++;
+                } else {
+                    job.nextRetryAt = now + (RETRY_BASE_MS << job.attempts);
+                    job.attempts++;
+                    _retries++;
+                    resend = true;
+                }
+            }
+            SensorConfigFrame frame = job.frame;
+            uint8_t mac[6];
+            memcpy(mac, job.mac, 6);
+            portEXIT_CRITICAL(&_mux);
+
+            if (resend) transmit(mac, (const uint8_t*)&frame, frame.frameLength());
+        }
+    }
+
+    // Procesa una trama entrante; true si era un ACK de configuración
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        SensorConfigFrame ack;
+        if (!decodeSensorConfig(data, len, SENSOR_CONFIG_ACK, ack)) return false;
+
+        portENTER_CRITICAL(&_mux);
+        Job* job = find(mac);
+        if (job && job->pending && ack.seq == job->frame.seq) {
+            for (uint8_t k = 0; k < ack.count; k++) {
+                if (ack.items[k].id < SENSOR_SETTING_COUNT) job->values[ack.items[k].id] = ack.items[k].value;
+            }
+            job->known = true;
+            job->pending = false;
+            job->answered = true;
+            job->ackFlags = ack.flags;
+        }
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    // Resultado de la tanda para Telegram; vacío si aún hay peticiones en
+    // curso o nada que contar
+    String takeReport() {
+        Job done[MAX_NODES];
+        uint8_t n = 0;
+        portENTER_CRITICAL(&_mux);
+        bool busy = false;
+        for (uint8_t i = 0; i < _count; i++) busy |= _jobs[i].inBatch && _jobs[i].pending;
+        for (uint8_t i = 0; i < _count && !busy; i++) {
+            if (!_jobs[i].inBatch) continue;
+            _jobs[i].inBatch = false;
+            done[n++] = _jobs[i];
+        }
+        portEXIT_CRITICAL(&_mux);
+        if (n == 0) return "";
+
+        String s = "⚙️ Configuración de nodos:\n";
+        for (uint8_t i = 0; i < n; i++) s += formatResult(done[i]) + "\n";
+        return s;
+    }
+
+    // Últimos valores confirmados por el nodo; false si aún no respondió
+    bool getSettings(const uint8_t mac[6], int32_t* out) {
+        portENTER_CRITICAL(&_mux);
+        Job* job = find(mac);
+        bool known = job && job->known;
+        if (known) memcpy(out, job->values, sizeof(job->values));
+        portEXIT_CRITICAL(&_mux);
+        return known;
+    }
+
+    // Envío hacia el nodo (p. ej. por su ruta de relevos, ver
+    // ESPNowReceiver::sendDown); sin él, directo
+    void setTransport(bool (*send)(const uint8_t* mac, const uint8_t* data, int len)) { _transport = send; }
+
+    unsigned long getRequests() const { return _requests; }
+    unsigned long getRetries() const { return _retries; }
+    unsigned long getTimeouts() const { return _timeouts; }
+
+    static String formatValue(uint8_t id, int32_t value) {
+        uint32_t scale = SENSOR_SETTING_TABLE[id].scale;
+        return scale == 1 ? String(value) : String((float)value / scale, (unsigned int)scaleDecimals(scale));
+    }
+
+private:
+    struct Job {
+        uint8_t mac[6];
+        SensorConfigFrame frame;
+        bool pending;
+        bool answered;
+        bool inBatch;
+        bool known;
+        uint8_t attempts;
+        uint8_t ackFlags;
+        unsigned long nextRetryAt;
+        int32_t values[SENSOR_SETTING_COUNT];
+    };
+
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    Job _jobs[MAX_NODES];
+    uint8_t _count = 0;
+    uint16_t _nextSeq = 1;
+    unsigned long _requests = 0;
+    unsigned long _retries = 0;
+    unsigned long _timeouts = 0;
+    bool (*_transport)(const uint8_t* mac, const uint8_t* data, int len) = nullptr;
+
+    bool transmit(const uint8_t* mac, const uint8_t* data, int len) {
+        return _transport ? _transport(mac, data, len) : esp_now_send(mac, data, len) == ESP_OK;
+    }
+
+    Job* find(const uint8_t* mac) {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (memcmp(_jobs[i].mac, mac, 6) == 0) return &_jobs[i];
+        }
+        return nullptr;
+    }
+
+    // Hueco del nodo; llena, se reutiliza uno que no esté en la tanda
+    Job* slotFor(const uint8_t* mac) {
+        Job* job = find(mac);
+        if (job) return job;
+        if (_count < MAX_NODES) {
+            job = &_jobs[_count++];
+        } else {
+            for (uint8_t i = 0; i < _count && !job; i++) {
+                if (!_jobs[i].pending && !_jobs[i].inBatch) job = &_jobs[i];
+            }
+            if (!job) return nullptr;
+        }
+        *job = Job();
+        memcpy(job->mac, mac, 6);
+        return job;
+    }
+
+    static String formatResult(const Job& job) {
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", job.mac[0], job.mac[1], job.mac[2], job.mac[3],
+                 job.mac[4], job.mac[5]);
+        if (!job.answered) return "❌ " + String(mac) + ": sin respuesta";
+
+        String s;
+        if (job.frame.count == 0) {   // consulta: todos los valores
+            s = "📋 " + String(mac) + ":";
+            for (uint8_t id = 0; id < SENSOR_SETTING_COUNT; id++) {
+                s += " " + String(SENSOR_SETTING_TABLE[id].key) + "=" + formatValue(id, job.values[id]);
+            }
+            return s;
+        }
+
+        String applied;
+        String rejected;
+        for (uint8_t k = 0; k < job.frame.count; k++) {
+            const SettingValue& item = job.frame.items[k];
+            String& list = job.values[item.id] == item.value ? applied : rejected;
+            list += " " + String(SENSOR_SETTING_TABLE[item.id].key) + "=" + formatValue(item.id, item.value);
+        }
+        s = (rejected.isEmpty() ? "✅ " : "⚠️ ") + String(mac) + ":";
+        if (!applied.isEmpty()) s += applied;
+        if (!rejected.isEmpty()) s += " | rechazado:" + rejected;
+        if (job.ackFlags & SENSOR_CONFIG_SAVE_FAILED) s += " | sin guardar en NVS";
+        return s;
+    }
+};
+
+#endif
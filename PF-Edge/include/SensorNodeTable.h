@@ -0,0 +1,65 @@
+#ifndef SENSOR_NODE_TABLE_H
+#define SENSOR_NODE_TABLE_H
+
+#include <Arduino.h>
+#include "dataSensor.h"
+#include "SensorQuality.h"
+
+// Último estado conocido de cada nodo sensor (por MAC). POD: se actualiza
+// y se copia entera dentro de dataMux. Llena, un nodo nuevo sustituye al
+// que lleva más tiempo sin transmitir.
+class SensorNodeTable {
+public:
+    static constexpr uint8_t MAX_NODES = 8;
+
+    struct Node {
+        uint8_t mac[6];
+        uint8_t zone;
+        SensorData data;
+        unsigned long lastMs;   // millis() de la última trama
+        unsigned long sampleMs; // adquisición de su muestra (base de tiempo del Edge)
+        unsigned long frames;
+        SampleQuality quality;  // de la última muestra
+    };
+
+    void record(const uint8_t* mac, uint8_t zone, const SensorData& data, const SampleQuality& quality,
+                unsigned long sampleMs, unsigned long now) {
+        Node* node = nullptr;
+        for (uint8_t i = 0; i < _count && !node; i++) {
+            if (memcmp(_nodes[i].mac, mac, 6) == 0) node = &_nodes[i];
+        }
+        if (!node) {
+            if (_count < MAX_NODES) {
+                node = &_nodes[_count++];
+            } else {
+                node = &_nodes[0];
+                for (uint8_t i = 1; i < _count; i++) {
+                    if (now - _nodes[i].lastMs > now - node->lastMs) node = &_nodes[i];
+                }
+            }
+            memcpy(node->mac, mac, 6);
+            node->frames = 0;
+        }
+        node->zone = zone;
+        node->data = data;
+        node->quality = quality;
+        node->lastMs = now;
+        node->sampleMs = sampleMs;
+        node->frames++;
+    }
+
+    uint8_t count() const { return _count; }
+    const Node& get(uint8_t i) const { return _nodes[i]; }
+
+    unsigned long totalFrames() const {
+        unsigned long n = 0;
+        for (uint8_t i = 0; i < _count; i++) n += _nodes[i].frames;
+        return n;
+    }
+
+private:
+    Node _nodes[MAX_NODES];
+    uint8_t _count = 0;
+};
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef SENSOR_QUALITY_H
+#define SENSOR_QUALITY_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "dataSensor.h"
+
+// Marcas de calidad de un canal en una muestra
+enum QualityFlag : uint8_t {
+    QUALITY_NO_READING = 1 << 0,   // el nodo no pudo leer el sensor
+    QUALITY_RANGE = 1 << 1,        // fuera del rango físico del canal
+    QUALITY_STUCK = 1 << 2,        // el mismo valor exacto demasiadas muestras
+    QUALITY_SATURATED = 1 << 3,    // pegado a un extremo (ADC o calibración)
+    QUALITY_RATE = 1 << 4,         // salto imposible respecto a la anterior
+    QUALITY_OUTLIER = 1 << 5       // lejos de la media (más de k desviaciones)
+};
+static constexpr uint8_t QUALITY_FLAG_COUNT = 6;
+
+inline const char* qualityFlagName(uint8_t bit) {
+    static const char* const names[QUALITY_FLAG_COUNT] = {
+        "sin_lectura", "fuera_de_rango", "atascado", "saturado", "salto", "atipico"};
+    return bit < QUALITY_FLAG_COUNT ? names[bit] : "";
+}
+
+// Calidad de una muestra: marcas por canal, canales que no deben usarse
+// para actuar (bit = SensorChannelId) y canales del nodo en fallo
+struct SampleQuality {
+    uint8_t flags[SENSOR_CHANNEL_COUNT];
+    uint16_t unusable;
+    uint16_t faults;
+};
+
+// Límites de plausibilidad de cada canal, en su punto fijo. Un extremo de
+// saturación NO_RAIL no se vigila; stuckRun 0 desactiva la detección de
+// valor atascado (canales que pueden estar quietos de verdad).
+struct ChannelQualityLimits {
+    int32_t min;
+    int32_t max;
+    int32_t maxRatePerS;     // cambio máximo creíble por segundo...
+    int32_t noise;           // ...más el ruido (o el paso) de una lectura a otra
+    int32_t lowRail;
+    int32_t highRail;
+    uint16_t stuckRun;       // muestras seguidas con el mismo valor
+    int32_t minDeviation;    // por debajo no es atípico aunque la varianza sea mínima
+};
+
+static constexpr int32_t NO_RAIL = INT32_MIN;
+
+// Mismo orden que SENSOR_CHANNELS
+static constexpr ChannelQualityLimits QUALITY_LIMITS[SENSOR_CHANNEL_COUNT] = {
+    {-2000, 6000, 100, 100, NO_RAIL, NO_RAIL, 0, 300},      // temp: -20..60 °C, DHT11 con pasos de 1 °C (quieto horas)
+    {0, 10000, 500, 500, 0, NO_RAIL, 0, 1000},              // hum %: DHT11 en pasos de 1 %, 100 % es real
+    {0, 4095, 2000, 100, NO_RAIL, 4095, 0, 300},            // luz: 0 de noche es real
+    {0, 4095, 500, 50, 0, 4095, 200, 300},                  // co2 (ADC)
+    {0, 10000, 300, 300, 0, 10000, 600, 1000},              // suelo: sonda suelta = 0 % fijo
+    {1000, 30000, 2000, 200, 0, NO_RAIL, 0, 1500},          // voltaje mV
+};
+
+// Etapa de calidad del Edge: por nodo (MAC) y canal, estadística en línea
+// en O(1) por muestra (media y varianza de Welford con la n limitada a
+// WINDOW, que olvida lo antiguo; rachas de valor repetido y de extremo; y
+// ritmo de cambio respecto a la última lectura aceptada, así un salto sigue
+// marcado hasta que el tiempo transcurrido lo hace creíble).
+//
+// Una muestra marcada no se usa para actuar en ese canal. Si un canal
+// acumula FAULT_RUN muestras marcadas seguidas queda en fallo (alerta
+// sensor_falla) hasta que da CLEAR_RUN muestras limpias seguidas: un fallo
+// suelto del DHT o un pico no alertan. POD: se usa dentro de dataMux.
+class SensorQuality {
+public:
+    static constexpr uint8_t MAX_NODES = 8;
+    static constexpr uint16_t WINDOW = 256;
+    static constexpr uint8_t WARMUP = 32;        // muestras antes de juzgar atípicos
+    static constexpr float OUTLIER_SIGMAS = 6.0f;
+    static constexpr uint8_t RAIL_RUN = 5;
+    static constexpr uint8_t FAULT_RUN = 3;
+    static constexpr uint8_t CLEAR_RUN = 3;
+
+    // now: instante de adquisición de la muestra (millis() del Edge)
+    SampleQuality check(const uint8_t* mac, const SensorData& data, unsigned long now) {
+        Node& node = nodeFor(mac, now);
+        node.lastMs = now;
+
+        SampleQuality q;
+        q.unusable = 0;
+        q.faults = 0;
+        uint8_t ch = 0;
+        visitSensorChannels(data, [&](const SensorChannel& channel, int32_t value) {
+            Stats& s = node.stats[ch];
+            uint8_t flags = value == channel.noReading ? (uint8_t)QUALITY_NO_READING : assess(s, QUALITY_LIMITS[ch], value, now);
+            track(s, flags);
+            q.flags[ch] = flags;
+            if (flags) {
+                q.unusable |= (uint16_t)(1u << ch);
+                _flagged++;
+            }
+            if (s.fault) q.faults |= (uint16_t)(1u << ch);
+            ch++;
+        });
+        node.faults = q.faults;
+        return q;
+    }
+
+    // Canales en fallo en cualquier nodo, con las marcas que lo causan
+    uint16_t faultChannels(uint8_t* flagsOut = nullptr) const {
+        uint16_t mask = 0;
+        if (flagsOut) memset(flagsOut, 0, SENSOR_CHANNEL_COUNT);
+        for (uint8_t n = 0; n < _count; n++) {
+            mask |= _nodes[n].faults;
+            for (uint8_t ch = 0; flagsOut && ch < SENSOR_CHANNEL_COUNT; ch++) {
+                if (_nodes[n].stats[ch].fault) flagsOut[ch] |= _nodes[n].stats[ch].faultFlags;
+            }
+        }
+        return mask;
+    }
+
+    unsigned long flagged() const { return _flagged; }
+
+private:
+    struct Stats {
+        float mean;
+        float var;
+        int32_t prev;         // lectura anterior (valor atascado)
+        int32_t last;         // última lectura sin salto, y cuándo llegó
+        unsigned long lastMs;
+        uint16_t n;
+        uint16_t sameRun;
+        uint8_t railRun;
+        uint8_t badRun;
+        uint8_t goodRun;
+        uint8_t faultFlags;   // marcas de la racha que llevó al fallo
+        bool fault;
+    };
+
+    struct Node {
+        uint8_t mac[6];
+        unsigned long lastMs;
+        uint16_t faults;
+        Stats stats[SENSOR_CHANNEL_COUNT];
+    };
+
+    Node _nodes[MAX_NODES];
+    uint8_t _count = 0;
+    unsigned long _flagged = 0;
+
+    Node& nodeFor(const uint8_t* mac, unsigned long now) {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (memcmp(_nodes[i].mac, mac, 6) == 0) return _nodes[i];
+        }
+        // Nuevo (lleno: sustituye al que lleva más tiempo callado)
+        Node* node = &_nodes[0];
+        if (_count < MAX_NODES) {
+            node = &_nodes[_count++];
+        } else {
+            for (uint8_t i = 1; i < _count; i++) {
+                if (now - _nodes[i].lastMs > now - node->lastMs) node = &_nodes[i];
+            }
+        }
+        memset(node, 0, sizeof(Node));
+        memcpy(node->mac, mac, 6);
+        return *node;
+    }
+
+    // Marcas de una lectura válida; actualiza las estadísticas del canal
+    static uint8_t assess(Stats& s, const ChannelQualityLimits& lim, int32_t value, unsigned long now) {
+        uint8_t flags = 0;
+        if (value < lim.min || value > lim.max) flags |= QUALITY_RANGE;
+
+        bool atRail = value == lim.lowRail || value == lim.highRail;
+        s.railRun = atRail ? (s.railRun < 255 ? s.railRun + 1 : 255) : 0;
+        if (s.railRun >= RAIL_RUN) flags |= QUALITY_SATURATED;
+
+        if (s.n > 0) {
+            s.sameRun = value == s.prev ? (s.sameRun < 65535 ? s.sameRun + 1 : 65535) : 0;
+            if (lim.stuckRun > 0 && s.sameRun >= lim.stuckRun) flags |= QUALITY_STUCK;
+            long dtMs = (long)(now - s.lastMs);   // muestras fuera de orden: sin margen de tiempo
+            float dtS = dtMs > 0 ? dtMs / 1000.0f : 0;
+            if (fabsf((float)(value - s.last)) > lim.maxRatePerS * dtS + lim.noise) flags |= QUALITY_RATE;
+        }
+        s.prev = value;
+        if (s.n == 0 || !(flags & QUALITY_RATE)) {
+            s.last = value;
+            s.lastMs = now;
+        }
+        if (flags & QUALITY_RANGE) return flags;   // no entra en la estadística
+
+        // Atípico respecto a la media móvil (antes de incluir la muestra)
+        float d = (float)value - s.mean;
+        if (s.n >= WARMUP && fabsf(d) > lim.minDeviation && d * d > OUTLIER_SIGMAS * OUTLIER_SIGMAS * s.var) {
+            flags |= QUALITY_OUTLIER;
+        }
+
+        // Welford con n limitada: var += (d * (x - media nueva) - var) / n
+        if (s.n < WINDOW) s.n++;
+        if (s.n == 1) {
+            s.mean = (float)value;
+            s.var = 0;
+        } else {
+            s.mean += d / s.n;
+            s.var += (d * ((float)value - s.mean) - s.var) / s.n;
+        }
+        return flags;
+    }
+
+    // Histéresis del fallo: FAULT_RUN muestras marcadas seguidas lo abren,
+    // CLEAR_RUN limpias seguidas lo cierran
+    static void track(Stats& s, uint8_t flags) {
+        if (flags) {
+            s.goodRun = 0;
+            if (s.badRun < 255) s.badRun++;
+            if (s.badRun >= FAULT_RUN && !s.fault) {
+                s.fault = true;
+                s.faultFlags = 0;
+            }
+            if (s.fault) s.faultFlags |= flags;
+        } else {
+            s.badRun = 0;
+            if (s.goodRun < 255) s.goodRun++;
+            if (s.fault && s.goodRun >= CLEAR_RUN) s.fault = false;
+        }
+    }
+};
+
+#endif
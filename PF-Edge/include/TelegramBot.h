@@ -14,6 +14,11 @@ public:
     TelegramBot(const String& token, const String& chat_id)
         : botToken(token), chatId(chat_id) {}
 
+    void setCredentials(const String& token, const String& chat_id) {
+        botToken = token;
+        chatId = chat_id;
+    }
+
     // Solo se encarga de enviar mensaje
     bool sendMessage(const String& message) {
         if (WiFi.status() != WL_CONNECTED) return false;
@@ -56,6 +61,11 @@ public:
         String response = https.getString();
         https.end();
 
+        return parseUpdate(response, lastUpdateId);
+    }
+
+    // Extrae el texto del primer update nuevo de una respuesta de getUpdates
+    static String parseUpdate(const String& response, int &lastUpdateId) {
         int updateIdIndex = response.indexOf("\"update_id\":");
         if (updateIdIndex == -1) return "";
 
@@ -77,9 +87,8 @@ public:
         return text;
     }
 
-private:
     // Función básica de urlencode para textos simples
-    String urlencode(const String& str) {
+    static String urlencode(const String& str) {
         String encoded = "";
         char c;
         char code0;
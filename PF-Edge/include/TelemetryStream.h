@@ -0,0 +1,321 @@
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <errno.h>
+#ifndef VERDEVITAL_HOST
+#include <lwip/sockets.h>
+#endif
+#include "JsonWriter.h"
+#include "dataSensor.h"
+#include "dataActuator.h"
+#include "ThresholdsController.h"
+
+// Campos de una muestra y de los niveles de una zona: los mismos nombres
+// en la API (/api/nodos, /api/actuadores) y en el flujo de eventos. Los de
+// la muestra son las claves del registro de canales, con todos sus
+// decimales (el punto fijo se escribe como número sin pasar por float);
+// null si el nodo no tuvo lectura.
+template <typename Out>
+void writeSensorFields(JsonWriter<Out>& json, const SensorData& d) {
+    char value[16];
+    visitSensorChannels(d, [&](const SensorChannel& ch, int32_t raw) {
+        if (raw == ch.noReading) json.key(ch.key).raw("null", 4);
+        else json.key(ch.key).raw(value, formatSensorValue(value, sizeof(value), ch, raw, ch.resolution));
+    });
+}
+
+// Marcas de calidad por canal ({"suelo":["saturado"],...}), solo los marcados
+template <typename Out>
+void writeQualityFields(JsonWriter<Out>& json, const uint8_t* flags) {
+    for (uint8_t ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        if (!flags[ch]) continue;
+        json.beginArray(SENSOR_CHANNEL_TABLE[ch].key);
+        for (uint8_t bit = 0; bit < QUALITY_FLAG_COUNT; bit++) {
+            if (flags[ch] >> bit & 1) json.value(qualityFlagName(bit));
+        }
+        json.endArray();
+    }
+}
+
+template <typename Out>
+void writeLevelFields(JsonWriter<Out>& json, const ActuatorState& s) {
+    json.field("bomba", s.waterPump).field("ventilador", s.fan).field("luces", s.leds);
+}
+
+enum TelemetryEventType : uint8_t {
+    TELEMETRY_SAMPLE = 0,
+    TELEMETRY_ACTUATORS = 1,
+    TELEMETRY_ALERTS = 2
+};
+
+// Evento tal como sale del camino de control (POD, se copia en la cola)
+struct TelemetryEvent {
+    TelemetryEventType type;
+    uint8_t zone;
+    uint8_t mac[6];
+    uint16_t alertMask;
+    uint16_t unusable;      // canales marcados por SensorQuality
+    uint32_t ms;
+    SensorData sample;
+    ActuatorState state;
+};
+
+// Telemetría en vivo por server-sent events (GET /api/eventos): cada
+// muestra recibida, cada cambio de actuadores y cada cambio de alertas.
+//
+// publish*() se llama desde el camino de control (callback ESP-NOW): copia
+// el evento en una cola fija bajo un portMUX y vuelve; sin clientes no
+// hace nada. update(), desde la tarea de la API, serializa cada evento una
+// sola vez a texto SSE en un historial circular de BACKLOG eventos y lo
+// reparte a los clientes con send() sin bloqueo.
+//
+// Cada cliente recorre el historial a su ritmo, con el evento en curso
+// copiado en su propio búfer (un evento a medio enviar no se corrompe). Un
+// cliente lento que se queda más de BACKLOG eventos atrás pierde los más
+// antiguos (se cuentan) en lugar de frenar a los demás o crecer en memoria.
+class TelemetryStream {
+public:
+    static constexpr uint8_t MAX_CLIENTS = 3;
+    static constexpr uint8_t QUEUE_SIZE = 16;
+    static constexpr uint8_t BACKLOG = 16;
+    static constexpr size_t EVENT_SIZE = 256;
+    static constexpr unsigned long KEEPALIVE_MS = 15000;
+
+    // --- Productores (cualquier tarea o callback) ---
+
+    // sampleMs: adquisición de la muestra (millis() del Edge)
+    void publishSample(const uint8_t* mac, uint8_t zone, const SensorData& data, uint16_t unusable, uint32_t sampleMs) {
+        if (!_subscribers) return;
+        TelemetryEvent e = make(TELEMETRY_SAMPLE, zone);
+        e.ms = sampleMs;
+        memcpy(e.mac, mac, 6);
+        e.sample = data;
+        e.unusable = unusable;
+        push(e);
+    }
+
+    void publishActuators(uint8_t zone, const ActuatorState& state) {
+        if (!_subscribers) return;
+        TelemetryEvent e = make(TELEMETRY_ACTUATORS, zone);
+        e.state = state;
+        push(e);
+    }
+
+    // mask: las alertas de valor de la zona y las globales
+    void publishAlerts(uint8_t zone, uint16_t mask) {
+        if (!_subscribers) return;
+        TelemetryEvent e = make(TELEMETRY_ALERTS, zone);
+        e.alertMask = mask;
+        push(e);
+    }
+
+    // --- Tarea de la API ---
+
+    // Se queda con la conexión (ver LocalApi::onStream); false si no hay hueco
+    bool attach(WiFiClient& client) {
+        Subscriber* c = nullptr;
+        for (uint8_t i = 0; i < MAX_CLIENTS && !c; i++) {
+            if (!_clients[i].busy) c = &_clients[i];
+        }
+        if (!c) return false;
+
+        static const char header[] =
+            "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-store\r\n"
+            "Access-Control-Allow-Origin: *\r\nConnection: keep-alive\r\n\r\nretry: 3000\n\n";
+        client.write((const uint8_t*)header, sizeof(header) - 1);
+        c->client = client;
+        c->next = _nextSeq;   // solo eventos nuevos
+        c->len = c->sent = 0;
+        c->lastWrite = millis();
+        c->busy = true;
+        _subscribers = true;
+        return true;
+    }
+
+    void update() {
+        TelemetryEvent e;
+        while (pop(e)) serialize(e);
+
+        bool any = false;
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            if (_clients[i].busy) service(_clients[i]);
+            any |= _clients[i].busy;
+        }
+        _subscribers = any;
+    }
+
+    uint8_t clients() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) n += _clients[i].busy ? 1 : 0;
+        return n;
+    }
+    unsigned long published() const { return _nextSeq; }
+    unsigned long delivered() const { return _delivered; }
+    unsigned long dropped() const { return _dropped; }        // clientes lentos
+    unsigned long queueDropped() const { return _queueDropped; }
+
+private:
+    struct Event {
+        uint16_t len;
+        char text[EVENT_SIZE];
+    };
+
+    struct Subscriber {
+        WiFiClient client;
+        uint32_t next;            // siguiente evento del historial
+        char buf[EVENT_SIZE];     // evento en curso
+        uint16_t len;
+        uint16_t sent;
+        unsigned long lastWrite;
+        bool busy;
+    };
+
+    // Escribe en un Event sin pasarse, dejando sitio al "\n\n" final (lo usa JsonWriter)
+    struct EventOut {
+        Event& event;
+        size_t write(const uint8_t* buf, size_t len) {
+            size_t room = EVENT_SIZE - 2 - event.len;
+            if (len > room) len = room;
+            memcpy(event.text + event.len, buf, len);
+            event.len += len;
+            return len;
+        }
+    };
+
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    TelemetryEvent _queue[QUEUE_SIZE];
+    uint8_t _queueHead = 0;
+    uint8_t _queued = 0;
+    unsigned long _queueDropped = 0;
+    volatile bool _subscribers = false;
+
+    Event _backlog[BACKLOG];
+    uint32_t _nextSeq = 0;
+    Subscriber _clients[MAX_CLIENTS] = {};
+    unsigned long _delivered = 0;
+    unsigned long _dropped = 0;
+
+    static TelemetryEvent make(TelemetryEventType type, uint8_t zone) {
+        TelemetryEvent e = TelemetryEvent();
+        e.type = type;
+        e.zone = zone;
+        e.ms = millis();
+        return e;
+    }
+
+    void push(const TelemetryEvent& e) {
+        portENTER_CRITICAL(&_mux);
+        if (_queued == QUEUE_SIZE) {   // la tarea de la API va atrasada: fuera el más antiguo
+            _queueHead = (_queueHead + 1) % QUEUE_SIZE;
+            _queued--;
+            _queueDropped++;
+        }
+        _queue[(_queueHead + _queued) % QUEUE_SIZE] = e;
+        _queued++;
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    bool pop(TelemetryEvent& out) {
+        portENTER_CRITICAL(&_mux);
+        bool ok = _queued > 0;
+        if (ok) {
+            out = _queue[_queueHead];
+            _queueHead = (_queueHead + 1) % QUEUE_SIZE;
+            _queued--;
+        }
+        portEXIT_CRITICAL(&_mux);
+        return ok;
+    }
+
+    void serialize(const TelemetryEvent& e) {
+        static const char* const names[] = {"muestra", "actuadores", "alertas"};
+        Event& ev = _backlog[_nextSeq % BACKLOG];
+        int n = snprintf(ev.text, EVENT_SIZE, "id: %lu\nevent: %s\ndata: ", (unsigned long)_nextSeq, names[e.type]);
+        ev.len = n > 0 ? (uint16_t)n : 0;
+
+        EventOut out = {ev};
+        JsonWriter<EventOut> json(out);
+        json.beginObject().field("ms", (unsigned long)e.ms).field("zona", e.zone);
+        if (e.type == TELEMETRY_SAMPLE) {
+            char mac[18];
+            snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", e.mac[0], e.mac[1], e.mac[2], e.mac[3], e.mac[4], e.mac[5]);
+            json.field("mac", mac);
+            writeSensorFields(json, e.sample);
+            json.field("calidad", (unsigned int)e.unusable);
+        } else if (e.type == TELEMETRY_ACTUATORS) {
+            writeLevelFields(json, e.state);
+        } else {
+            json.field("mascara", (unsigned int)e.alertMask).beginArray("activas");
+            for (uint8_t i = 0; i < Thresholds::ALERT_COUNT; i++) {
+                if (e.alertMask >> i & 1) json.value(Thresholds::alertName(i));
+            }
+            json.endArray();
+        }
+        json.endObject();
+        json.flush();
+        memcpy(ev.text + ev.len, "\n\n", 2);
+        ev.len += 2;
+        _nextSeq++;
+    }
+
+    void service(Subscriber& c) {
+        if (!c.client.connected()) {
+            close(c);
+            return;
+        }
+        unsigned long now = millis();
+        while (true) {
+            if (c.sent == c.len) {   // nada en curso: siguiente evento
+                if (c.next == _nextSeq) break;
+                uint32_t oldest = _nextSeq > BACKLOG ? _nextSeq - BACKLOG : 0;
+                if (c.next < oldest) {
+                    _dropped += oldest - c.next;
+                    c.next = oldest;
+                }
+                const Event& ev = _backlog[c.next % BACKLOG];
+                memcpy(c.buf, ev.text, ev.len);
+                c.len = ev.len;
+                c.sent = 0;
+                c.next++;
+            }
+            int n = sendNow(c.client, c.buf + c.sent, c.len - c.sent);
+            if (n < 0) {
+                close(c);
+                return;
+            }
+            if (n == 0) return;   // socket lleno: se sigue en la próxima vuelta
+            c.sent += n;
+            c.lastWrite = now;
+            if (c.sent == c.len) _delivered++;
+        }
+
+        // Comentario SSE para detectar clientes caídos en los ratos sin eventos
+        if (now - c.lastWrite >= KEEPALIVE_MS) {
+            memcpy(c.buf, ": ping\n\n", 8);
+            c.len = 8;
+            c.sent = 0;
+            c.lastWrite = now;
+        }
+    }
+
+    void close(Subscriber& c) {
+        c.client.stop();
+        c.client = WiFiClient();
+        c.busy = false;
+    }
+
+    // Envío sin bloqueo: bytes aceptados, 0 si el socket está lleno, -1 si falló
+    static int sendNow(WiFiClient& client, const char* data, size_t len) {
+        int flags = MSG_DONTWAIT;
+#ifdef MSG_NOSIGNAL
+        flags |= MSG_NOSIGNAL;
+#endif
+        int n = send(client.fd(), data, len, flags);
+        if (n >= 0) return n;
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+};
+
+#endif
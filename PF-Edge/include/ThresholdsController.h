@@ -3,8 +3,59 @@
 
 #include "dataSensor.h"
 #include "dataActuator.h"
+#include "SensorQuality.h"
 #include <Arduino.h>
 
+// Parámetros ajustables por nombre (/umbral y configuración persistente).
+// Los ligados a un canal del registro (SensorChannels.h) se comparan con la
+// muestra en el punto fijo del canal; su clave empieza por la del canal (se
+// comprueba al compilar) y su línea en /umbrales sale de la etiqueta, la
+// unidad y los decimales del canal.
+enum ThresholdIndex : uint8_t {
+    TH_SOIL_MIN, TH_SOIL_MAX, TH_TEMP_MIN, TH_TEMP_MAX, TH_CO2_MAX, TH_LIGHT_MIN,
+    TH_VOLTAGE_MIN, TH_RSSI_MIN, TH_TEMP_BAND, TH_CO2_BAND, TH_LIGHT_BAND,
+    THRESHOLD_VALUE_COUNT
+};
+
+enum ThresholdKind : uint8_t { THRESHOLD_MIN, THRESHOLD_MAX, THRESHOLD_BAND, THRESHOLD_OTHER };
+
+constexpr uint8_t NO_SENSOR_CHANNEL = 0xFF;
+
+struct ThresholdParam {
+    const char* key;
+    uint8_t channel;    // SensorChannelId o NO_SENSOR_CHANNEL
+    ThresholdKind kind;
+};
+
+constexpr ThresholdParam THRESHOLD_PARAMS[THRESHOLD_VALUE_COUNT] = {
+    {"suelo_min", SENSOR_SOIL, THRESHOLD_MIN},        {"suelo_max", SENSOR_SOIL, THRESHOLD_MAX},
+    {"temp_min", SENSOR_TEMPERATURE, THRESHOLD_MIN},  {"temp_max", SENSOR_TEMPERATURE, THRESHOLD_MAX},
+    {"co2_max", SENSOR_CO2, THRESHOLD_MAX},           {"luz_min", SENSOR_LIGHT, THRESHOLD_MIN},
+    {"voltaje_min", SENSOR_VOLTAGE, THRESHOLD_MIN},   {"rssi_min", NO_SENSOR_CHANNEL, THRESHOLD_OTHER},
+    {"temp_banda", SENSOR_TEMPERATURE, THRESHOLD_BAND}, {"co2_banda", SENSOR_CO2, THRESHOLD_BAND},
+    {"luz_banda", SENSOR_LIGHT, THRESHOLD_BAND}};
+
+constexpr bool isKeyOfChannel(const char* key, const char* channel) {
+    return *channel ? *key == *channel && isKeyOfChannel(key + 1, channel + 1) : *key == '_';
+}
+
+constexpr bool thresholdParamsValid(uint8_t i = 0) {
+    return i == THRESHOLD_VALUE_COUNT ||
+           ((THRESHOLD_PARAMS[i].channel == NO_SENSOR_CHANNEL ||
+             (THRESHOLD_PARAMS[i].channel < SENSOR_CHANNEL_COUNT &&
+              isKeyOfChannel(THRESHOLD_PARAMS[i].key, SENSOR_CHANNEL_TABLE[THRESHOLD_PARAMS[i].channel].key))) &&
+            thresholdParamsValid(i + 1));
+}
+
+static_assert(thresholdParamsValid(), "THRESHOLD_PARAMS no coincide con el registro de canales");
+
+// Bits de alertMask(); los de valor (hasta ALERT_VOLTAGE) son de una zona
+enum AlertBit : uint8_t {
+    ALERT_SOIL_LOW, ALERT_SOIL_HIGH, ALERT_TEMP_LOW, ALERT_TEMP_HIGH, ALERT_CO2, ALERT_LIGHT,
+    ALERT_VOLTAGE, ALERT_WIFI, ALERT_ESP_SENSOR, ALERT_ESP_ACTUATOR, ALERT_SENSOR_FAULT
+};
+constexpr uint16_t ZONE_ALERTS = (1u << (ALERT_VOLTAGE + 1)) - 1;
+
 class Thresholds {
 private:
     float minSoilMoisture = 45.0;
@@ -16,8 +67,96 @@ private:
     float minVoltage = 6.0;
     int minRSSI = -70;
 
+    // Control proporcional: el ciclo de trabajo crece desde un mínimo (para
+    // que el ventilador arranque y los LEDs se noten) hasta 255 a lo largo
+    // de la banda por encima/debajo del umbral.
+    float fanTempBand = 4.0;      // °C sobre temp_max para ventilador al 100 %
+    float fanCO2Band = 400.0;     // ppm sobre co2_max para ventilador al 100 %
+    int lightBand = 300;          // unidades bajo luz_min para LEDs al 100 %
+    uint8_t minFanDuty = 80;
+    uint8_t minLedDuty = 40;
+
+    // Cada parámetro en el punto fijo de su canal (se recalcula en setValue)
+    int32_t _fixed[THRESHOLD_VALUE_COUNT];
+
+    static int32_t toFixed(uint8_t i, float valor) {
+        uint8_t ch = THRESHOLD_PARAMS[i].channel;
+        return ch == NO_SENSOR_CHANNEL ? (int32_t)lroundf(valor) : sensorFromFloat((SensorChannelId)ch, valor);
+    }
+
 public:
-    Thresholds() {}
+    Thresholds() {
+        for (uint8_t i = 0; i < VALUE_COUNT; i++) _fixed[i] = toFixed(i, getValue(i));
+    }
+
+    static constexpr uint8_t VALUE_COUNT = THRESHOLD_VALUE_COUNT;
+    static const char* key(uint8_t i) {
+        return i < VALUE_COUNT ? THRESHOLD_PARAMS[i].key : "";
+    }
+
+    // Valor en el punto fijo del canal (el de la muestra)
+    int32_t fixedValue(uint8_t i) const { return i < VALUE_COUNT ? _fixed[i] : 0; }
+
+    static int keyIndex(const String& name) {
+        for (uint8_t i = 0; i < VALUE_COUNT; i++) {
+            if (name == key(i)) return i;
+        }
+        return -1;
+    }
+
+    float getValue(uint8_t i) const {
+        switch (i) {
+            case TH_SOIL_MIN: return minSoilMoisture;
+            case TH_SOIL_MAX: return maxSoilMoisture;
+            case TH_TEMP_MIN: return minTemperature;
+            case TH_TEMP_MAX: return maxTemperature;
+            case TH_CO2_MAX: return maxCO2;
+            case TH_LIGHT_MIN: return minLight;
+            case TH_VOLTAGE_MIN: return minVoltage;
+            case TH_RSSI_MIN: return minRSSI;
+            case TH_TEMP_BAND: return fanTempBand;
+            case TH_CO2_BAND: return fanCO2Band;
+            case TH_LIGHT_BAND: return lightBand;
+            default: return 0;
+        }
+    }
+
+    void setValue(uint8_t i, float valor) {
+        switch (i) {
+            case TH_SOIL_MIN: minSoilMoisture = valor; break;
+            case TH_SOIL_MAX: maxSoilMoisture = valor; break;
+            case TH_TEMP_MIN: minTemperature = valor; break;
+            case TH_TEMP_MAX: maxTemperature = valor; break;
+            case TH_CO2_MAX: maxCO2 = valor; break;
+            case TH_LIGHT_MIN: minLight = (int)valor; break;
+            case TH_VOLTAGE_MIN: minVoltage = valor; break;
+            case TH_RSSI_MIN: minRSSI = (int)valor; break;
+            case TH_TEMP_BAND: fanTempBand = valor; break;
+            case TH_CO2_BAND: fanCO2Band = valor; break;
+            case TH_LIGHT_BAND: lightBand = (int)valor; break;
+        }
+        if (i < VALUE_COUNT) _fixed[i] = toFixed(i, getValue(i));
+    }
+
+    // Ciclo de trabajo para un exceso sobre el umbral (0 si no lo hay).
+    // Se cuantiza en pasos de 16 para que el ruido del sensor no genere
+    // un comando nuevo en cada muestra.
+    // Exceso y banda en el mismo punto fijo.
+    static uint8_t proportionalDuty(int32_t excess, int32_t band, uint8_t minDuty) {
+        if (excess <= 0) return 0;
+        if (band <= 0 || excess >= band) return 255;
+        int duty = minDuty + (int)((255 - minDuty) * (int64_t)excess / band);
+        duty = duty / 16 * 16;
+        return (uint8_t)(duty < minDuty ? minDuty : duty);
+    }
+
+    // Nivel 0-255 como texto: OFF, ON o porcentaje
+    static String formatLevel(uint8_t level) {
+        if (level == 0) return "OFF";
+        if (level == 255) return "ON";
+        return String((level * 100 + 127) / 255) + " %";
+    }
+
     // RSSI Sensor y WiFi
     int RSSIWiFi = 0; // Valor por defecto para RSSI del WiFi
 
@@ -32,6 +171,12 @@ public:
     bool alertESPSensor = false;
     bool alertESPActuator = false; 
     bool alertWifi = false; 
+    bool alertSensorFault = false;
+
+    // Canales en fallo (bit = SensorChannelId) y las marcas de calidad de
+    // cada uno, según SensorQuality
+    uint16_t sensorFaultMask = 0;
+    uint8_t sensorFaultFlags[SENSOR_CHANNEL_COUNT] = {};
 
     // Guarda los valores anteriores de los flags de alerta
     bool prevAlertLowSoilMoisture = false;
@@ -44,6 +189,7 @@ public:
     bool prevAlertESPSensor = false;
     bool prevAlertESPActuator = false;
     bool prevAlertWifi = false;
+    uint16_t prevSensorFaultMask = 0;
 
     // Llama esta función después de evaluar los sensores para detectar cambios en los flags
     bool hasAlertChanged() {
@@ -57,7 +203,8 @@ public:
             (alertVoltage != prevAlertVoltage) ||
             (alertESPSensor != prevAlertESPSensor) ||
             (alertESPActuator != prevAlertESPActuator) ||
-            (alertWifi != prevAlertWifi);
+            (alertWifi != prevAlertWifi) ||
+            (sensorFaultMask != prevSensorFaultMask);
 
         // Actualiza los valores previos
         prevAlertLowSoilMoisture = alertLowSoilMoisture;
@@ -70,10 +217,42 @@ public:
         prevAlertESPSensor = alertESPSensor;
         prevAlertESPActuator = alertESPActuator;
         prevAlertWifi = alertWifi;
+        prevSensorFaultMask = sensorFaultMask;
 
         return changed;
     }
 
+    // Alertas como bits (para comparar y publicar el conjunto de golpe)
+    static constexpr uint8_t ALERT_COUNT = 11;
+    static const char* alertName(uint8_t bit) {
+        static const char* const names[ALERT_COUNT] = {
+            "suelo_bajo", "suelo_alto", "temp_baja", "temp_alta", "co2", "luz",
+            "voltaje", "wifi", "nodo_sensor", "nodo_actuador", "sensor_falla"};
+        return bit < ALERT_COUNT ? names[bit] : "";
+    }
+
+    uint16_t alertMask() const {
+        const bool flags[ALERT_COUNT] = {
+            alertLowSoilMoisture, alertHighSoilMoisture, alertLowTemperature, alertHighTemperature,
+            alertCO2, alertLight, alertVoltage, alertWifi, alertESPSensor, alertESPActuator, alertSensorFault};
+        uint16_t mask = 0;
+        for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+            if (flags[i]) mask |= (uint16_t)(1u << i);
+        }
+        return mask;
+    }
+
+    // Alertas de valor agregadas de todas las zonas (OR de sus máscaras)
+    void setZoneAlerts(uint16_t mask) {
+        alertLowSoilMoisture = mask >> ALERT_SOIL_LOW & 1;
+        alertHighSoilMoisture = mask >> ALERT_SOIL_HIGH & 1;
+        alertLowTemperature = mask >> ALERT_TEMP_LOW & 1;
+        alertHighTemperature = mask >> ALERT_TEMP_HIGH & 1;
+        alertCO2 = mask >> ALERT_CO2 & 1;
+        alertLight = mask >> ALERT_LIGHT & 1;
+        alertVoltage = mask >> ALERT_VOLTAGE & 1;
+    }
+
     bool anySensorAlertActive() const {
         return alertLowSoilMoisture ||
                alertHighSoilMoisture ||
@@ -81,7 +260,14 @@ public:
                alertHighTemperature ||
                alertCO2 ||
                alertLight ||
-               alertVoltage;
+               alertVoltage ||
+               alertSensorFault;
+    }
+
+    void setSensorFaults(uint16_t mask, const uint8_t* flags) {
+        sensorFaultMask = mask;
+        alertSensorFault = mask != 0;
+        memcpy(sensorFaultFlags, flags, SENSOR_CHANNEL_COUNT);
     }
 
     bool hasCriticalFailure() const {
@@ -89,75 +275,72 @@ public:
         return alertESPSensor || alertESPActuator || alertVoltage;
     }
 
-    ActuatorState evaluate(const SensorData& data) {
+    // unusable: canales de esta muestra marcados por SensorQuality (bit =
+    // SensorChannelId). No se actúa ni se alerta con ellos: su actuador
+    // queda apagado y sus alertas de valor se retiran.
+    // alerts: las alertas de valor de la muestra (bits ZONE_ALERTS); cada
+    // zona guarda las suyas (ver setZoneAlerts para el agregado)
+    ActuatorState evaluate(const SensorData& data, uint16_t unusable, uint16_t& alerts) const {
         ActuatorState state;
         state.waterPump = 0;
         state.fan = 0;
         state.leds = 0;
+        alerts = 0;
+        const bool soilOk = !(unusable >> SENSOR_SOIL & 1);
+        const bool tempOk = !(unusable >> SENSOR_TEMPERATURE & 1);
+        const bool co2Ok = !(unusable >> SENSOR_CO2 & 1);
+        const bool lightOk = !(unusable >> SENSOR_LIGHT & 1);
+        const bool voltageOk = !(unusable >> SENSOR_VOLTAGE & 1);
 
-        // Evaluar humedad del suelo
-        if (data.soilMoisture < minSoilMoisture) {
-            state.waterPump = 1;
-            alertLowSoilMoisture = true;
-        } else { 
-            alertLowSoilMoisture = false;
-        }
+        // Todas las comparaciones en el punto fijo de cada canal
 
-        if (data.soilMoisture > maxSoilMoisture) {
-            alertHighSoilMoisture = true;
-        } else {
-            alertHighSoilMoisture = false;
+        // Evaluar humedad del suelo
+        if (soilOk && data.soilMoisture < _fixed[TH_SOIL_MIN]) {
+            state.waterPump = 255;
+            alerts |= 1u << ALERT_SOIL_LOW;
         }
+        if (soilOk && data.soilMoisture > _fixed[TH_SOIL_MAX]) alerts |= 1u << ALERT_SOIL_HIGH;
 
         // Evaluar temperatura
-        if (data.temperature < minTemperature) {
-            alertLowTemperature = true;
-        } else {
-            alertLowTemperature = false;
-        }
-
-        if (data.temperature > maxTemperature) {
-            alertHighTemperature = true;
-            state.fan = 1;
-        } else {
-            alertHighTemperature = false;
+        if (tempOk && data.temperature < _fixed[TH_TEMP_MIN]) alerts |= 1u << ALERT_TEMP_LOW;
+        if (tempOk && data.temperature > _fixed[TH_TEMP_MAX]) {
+            alerts |= 1u << ALERT_TEMP_HIGH;
+            state.fan = proportionalDuty(data.temperature - _fixed[TH_TEMP_MAX], _fixed[TH_TEMP_BAND], minFanDuty);
         }
 
         // Evaluar CO2
-        if (data.co2ppm > maxCO2) {
-            alertCO2 = true;
-            state.fan = 1;
-        } else {
-            alertCO2 = false;
+        if (co2Ok && data.co2ppm > _fixed[TH_CO2_MAX]) {
+            alerts |= 1u << ALERT_CO2;
+            uint8_t co2Duty = proportionalDuty(data.co2ppm - _fixed[TH_CO2_MAX], _fixed[TH_CO2_BAND], minFanDuty);
+            if (co2Duty > state.fan) state.fan = co2Duty;
         }
 
         // Evaluar luz
-        if (data.light < minLight) {
-            alertLight = true;
-            state.leds = 1;
-        } else {
-            alertLight = false;
+        if (lightOk && data.light < _fixed[TH_LIGHT_MIN]) {
+            alerts |= 1u << ALERT_LIGHT;
+            state.leds = proportionalDuty(_fixed[TH_LIGHT_MIN] - data.light, _fixed[TH_LIGHT_BAND], minLedDuty);
         }
 
         // Evaluar voltaje
-        if (data.voltage < minVoltage) {
-            alertVoltage = true;
-        } else {
-            alertVoltage = false;
-        }
+        if (voltageOk && data.voltage < _fixed[TH_VOLTAGE_MIN]) alerts |= 1u << ALERT_VOLTAGE;
         return state;
+    }
 
-        // Evaluar conexión wiFi (opcional)
-        if (RSSIWiFi < minRSSI) {
-            alertWifi = true;
-        } else {
-            alertWifi = false;
-        }
+    // Una sola zona: sus alertas son las globales
+    ActuatorState evaluate(const SensorData& data, uint16_t unusable = 0) {
+        uint16_t alerts;
+        ActuatorState state = evaluate(data, unusable, alerts);
+        setZoneAlerts(alerts);
+        return state;
     }
 
-    String returnAlarm(const SensorData& data) {
+    // Alertas globales (enlaces, WiFi, fallos de sensor) y las de valor de
+    // cada zona con datos (bit de zones), con su último agregado. Con más
+    // zonas que la 0, cada línea de valor lleva su zona.
+    String returnAlarm(const SensorData* zoneData, const uint16_t* zoneAlerts, uint16_t zones) const {
         String msg = "";
-        
+        const bool labelled = zones > 1;
+
         if (hasCriticalFailure()) {
             msg += "🚨 ALERTA CRÍTICA DETECTADA:\n";
             if (alertESPSensor) {
@@ -168,8 +351,10 @@ public:
                 msg += "⚠️ Conexión Nodo Actuadores perdida.\n";
                 msg += "🔍 Revisa el actuador o reinicia el dispositivo.\n";
             }
-            if (alertVoltage) {
-                msg += "⚠️ Voltaje bajo (" + String(data.voltage, 2) + " V).\n";
+            for (uint8_t zone = 0; zones >> zone; zone++) {
+                if (!(zones >> zone & 1) || !(zoneAlerts[zone] >> ALERT_VOLTAGE & 1)) continue;
+                msg += "⚠️ Voltaje bajo (" + channelText(SENSOR_VOLTAGE, zoneData[zone].voltage) + ")" +
+                       (labelled ? " en la zona " + String(zone) : String("")) + ".\n";
                 msg += "🔍 Revisa la fuente de alimentación.\n";
             }
             msg += "\n";
@@ -179,90 +364,143 @@ public:
             msg += "ALERTAS DE SENSORES:\n";
         }
 
-        if (alertLowSoilMoisture) {
-            msg += "🌱 Humedad del suelo baja (" + String(data.soilMoisture, 1) + "%).\n";
+        for (uint8_t zone = 0; zones >> zone; zone++) {
+            if (!(zones >> zone & 1)) continue;
+            uint16_t alerts = zoneAlerts[zone] & ZONE_ALERTS & ~(1u << ALERT_VOLTAGE);
+            if (!alerts) continue;
+            if (labelled) msg += "📍 Zona " + String(zone) + ":\n";
+            msg += formatValueAlerts(zoneData[zone], alerts);
+        }
+
+        if (alertWifi) {
+            msg += "📶 Conexión WiFi débil (" + String(RSSIWiFi) + " dBm).\n";
+            msg += "🔍 Revisa la conexión WiFi.\n\n";
+        }
+
+        if (alertSensorFault) {
+            msg += "🩺 Fallo de sensor:";
+            for (uint8_t ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+                if (!(sensorFaultMask >> ch & 1)) continue;
+                msg += String(" ") + SENSOR_CHANNEL_TABLE[ch].label + " (";
+                bool first = true;
+                for (uint8_t bit = 0; bit < QUALITY_FLAG_COUNT; bit++) {
+                    if (!(sensorFaultFlags[ch] >> bit & 1)) continue;
+                    if (!first) msg += ", ";
+                    msg += qualityFlagName(bit);
+                    first = false;
+                }
+                msg += ")";
+            }
+            msg += ".\n🔍 Sus lecturas no se usan para actuar hasta que se recupere.\n\n";
+        }
+
+        return msg; // Si está vacío, todo está normal
+    }
+
+    // Una sola zona, con las alertas globales
+    String returnAlarm(const SensorData& data) const {
+        uint16_t alerts = alertMask() & ZONE_ALERTS;
+        return returnAlarm(&data, &alerts, 1);
+    }
+
+    static String formatValueAlerts(const SensorData& data, uint16_t alerts) {
+        String msg = "";
+        if (alerts >> ALERT_SOIL_LOW & 1) {
+            msg += "🌱 Humedad del suelo baja (" + channelText(SENSOR_SOIL, data.soilMoisture) + ").\n";
             msg += "🔁 Activando bomba de agua.\n\n";
         }
-        
-        if (alertHighSoilMoisture) {
-            msg += "🌱 Humedad del suelo alta (" + String(data.soilMoisture, 1) + "%).\n";
+        if (alerts >> ALERT_SOIL_HIGH & 1) {
+            msg += "🌱 Humedad del suelo alta (" + channelText(SENSOR_SOIL, data.soilMoisture) + ").\n";
             msg += "🔍 Revisa el drenaje.\n\n";
         }
-
-        if (alertLowTemperature) {
-            msg += "🌡️ Temperatura baja (" + String(data.temperature, 1) + "°C).\n";
+        if (alerts >> ALERT_TEMP_LOW & 1) {
+            msg += "🌡️ Temperatura baja (" + channelText(SENSOR_TEMPERATURE, data.temperature) + ").\n";
             msg += "🔍 Revisa el calentador.\n\n";
         }
-
-        if (alertHighTemperature) {
-            msg += "🌡️ Temperatura alta (" + String(data.temperature, 1) + "°C).\n";
+        if (alerts >> ALERT_TEMP_HIGH & 1) {
+            msg += "🌡️ Temperatura alta (" + channelText(SENSOR_TEMPERATURE, data.temperature) + ").\n";
             msg += "🔁 Activando ventilador.\n\n";
         }
-
-        if (alertCO2) {
-            msg += "🫁 CO2 alto (" + String(data.co2ppm) + " ppm).\n";
+        if (alerts >> ALERT_CO2 & 1) {
+            msg += "🫁 CO2 alto (" + channelText(SENSOR_CO2, data.co2ppm) + ").\n";
             msg += "🔁 Activando ventilador.\n\n";
         }
-
-        if (alertLight) {
-            msg += "💡 Luz insuficiente (" + String(data.light) + ").\n";
+        if (alerts >> ALERT_LIGHT & 1) {
+            msg += "💡 Luz insuficiente (" + channelText(SENSOR_LIGHT, data.light) + ").\n";
             msg += "🔁 Encendiendo LEDs.\n\n";
         }
-
-        if (alertWifi) {
-            msg += "📶 Conexión WiFi débil (" + String(RSSIWiFi) + " dBm).\n";
-            msg += "🔍 Revisa la conexión WiFi.\n\n";
-        }
-
-        return msg; // Si está vacío, todo está normal
+        return msg;
     }
 
     String getStatus() const {
         String status = "📐 Umbrales actuales:\n";
-        status += "🌱 Hum. Suelo: " + String(minSoilMoisture) + " % - " + String(maxSoilMoisture) + " %\n";
-        status += "🌡️ Temp.: " + String(minTemperature) + " °C - " + String(maxTemperature) + " °C\n";
-        status += "🫁 CO2 < " + String(maxCO2) + " ppm\n";
-        status += "💡 Luz > " + String(minLight) + "\n";
-        status += "🔋 Voltaje > " + String(minVoltage) + " V\n";
+        for (uint8_t ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) status += formatChannelLimits(ch);
         status += "📶 RSSI > " + String(minRSSI) + " dBm\n";
+        status += "🎚️ Bandas: temp " + String(fanTempBand) + " °C, CO2 " + String(fanCO2Band) + " ppm, luz " + String(lightBand) + "\n";
         return status;
     }
 
-    void updateFromCommand(const String& cmd) {
+    // Devuelve false si el comando no tiene el formato o el tipo no existe
+    bool updateFromCommand(const String& cmd) {
         int firstSpace = cmd.indexOf(' ');
         int secondSpace = cmd.indexOf(' ', firstSpace + 1);
-        if (firstSpace == -1 || secondSpace == -1) return;
-
-        String tipo = cmd.substring(firstSpace + 1, secondSpace);
-        float valor = cmd.substring(secondSpace + 1).toFloat();
-
-        if (tipo == "suelo_min") minSoilMoisture = valor;
-        else if (tipo == "suelo_max") maxSoilMoisture = valor;
-        else if (tipo == "temp_min") minTemperature = valor;
-        else if (tipo == "temp_max") maxTemperature = valor;
-        else if (tipo == "co2_max") maxCO2 = valor;
-        else if (tipo == "luz_min") minLight = (int)valor;
-        else if (tipo == "voltaje_min") minVoltage = valor;
-        else if (tipo == "rssi_min") minRSSI = (int)valor;
+        if (firstSpace == -1 || secondSpace == -1) return false;
+
+        int i = keyIndex(cmd.substring(firstSpace + 1, secondSpace));
+        if (i < 0) return false;
+        setValue(i, cmd.substring(secondSpace + 1).toFloat());
+        return true;
     }
 
     String formatSensorData(const SensorData& d) const {
         String msg = "";
-        msg += "🌡️ Temp: " + String(d.temperature, 1) + " °C\n";
-        msg += "💧 Hum: " + String(d.humidity, 1) + " %\n";
-        msg += "☀️ Luz: " + String(d.light) + "\n";
-        msg += "🫁 CO2: " + String(d.co2ppm) + " ppm\n";
-        msg += "🌱 Suelo: " + String(d.soilMoisture, 1) + " %\n";
-        msg += "🔋 Volt: " + String(d.voltage, 2) + " V\n";
+        visitSensorChannels(d, [&](const SensorChannel& ch, int32_t value) {
+            msg += String(ch.emoji) + " " + ch.label + ": " + formatChannelValue(ch, value) + "\n";
+        });
         msg += "📶 RSSI WiFi: " + String(RSSIWiFi) + " dBm\n";
         return msg;
     }
 
+    // "23.4 °C": valor en punto fijo con los decimales y la unidad del canal
+    static String formatChannelValue(const SensorChannel& ch, int32_t value) {
+        char buf[16];
+        formatSensorValue(buf, sizeof(buf), ch, value, ch.decimals);
+        String s(buf);
+        if (*ch.unit) s += String(" ") + ch.unit;
+        return s;
+    }
+
+    static String channelText(SensorChannelId ch, int32_t value) {
+        return formatChannelValue(SENSOR_CHANNEL_TABLE[ch], value);
+    }
+
+    // "🌱 Suelo: 45.0 % - 70.0 %", "🫁 CO2 < 800 ppm"...; vacío si el canal no tiene límites
+    String formatChannelLimits(uint8_t channel) const {
+        int minIndex = -1, maxIndex = -1;
+        for (uint8_t i = 0; i < VALUE_COUNT; i++) {
+            if (THRESHOLD_PARAMS[i].channel != channel) continue;
+            if (THRESHOLD_PARAMS[i].kind == THRESHOLD_MIN) minIndex = i;
+            if (THRESHOLD_PARAMS[i].kind == THRESHOLD_MAX) maxIndex = i;
+        }
+        if (minIndex < 0 && maxIndex < 0) return "";
+
+        const SensorChannel& ch = SENSOR_CHANNEL_TABLE[channel];
+        String s = String(ch.emoji) + " " + ch.label;
+        if (minIndex >= 0 && maxIndex >= 0) {
+            s += ": " + formatChannelValue(ch, _fixed[minIndex]) + " - " + formatChannelValue(ch, _fixed[maxIndex]);
+        } else if (maxIndex >= 0) {
+            s += " < " + formatChannelValue(ch, _fixed[maxIndex]);
+        } else {
+            s += " > " + formatChannelValue(ch, _fixed[minIndex]);
+        }
+        return s + "\n";
+    }
+
     String formatActuatorState(const ActuatorState& state) const {
         String s = "";
-        s += "💧 Bomba: " + String(state.waterPump ? "ON" : "OFF") + "\n";
-        s += "🌀 Ventilador: " + String(state.fan ? "ON" : "OFF") + "\n";
-        s += "💡 LEDs: " + String(state.leds ? "ON" : "OFF");
+        s += "💧 Bomba: " + formatLevel(state.waterPump) + "\n";
+        s += "🌀 Ventilador: " + formatLevel(state.fan) + "\n";
+        s += "💡 LEDs: " + formatLevel(state.leds);
         return s;
     }
 };
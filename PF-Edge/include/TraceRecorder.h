@@ -0,0 +1,116 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include "dataActuator.h"
+
+// Traza binaria de lo que entra y sale por ESP-NOW, para reproducirla en el
+// host (host/src/replay_main.cpp).
+//
+// Archivo: "VVT1" y después registros de la forma
+//   uint8_t tipo | uint8_t len | uint32_t millis (LE) | payload[len]
+// Tipos:
+//   TRACE_SENSOR_FRAME  payload = MAC origen (6) + trama tal como llegó
+//   TRACE_ACTUATOR_CMD  payload = zona (1) + ActuatorState decidido y enviado
+//   TRACE_CLOCK         payload = uint32_t hora Unix del RTC en ese millis
+//
+// Los callbacks de ESP-NOW solo copian en un buffer en RAM; flush() lo
+// cambia por el otro y lo escribe a SD desde una tarea.
+
+enum TraceRecordType : uint8_t {
+    TRACE_SENSOR_FRAME = 1,
+    TRACE_ACTUATOR_CMD = 2,
+    TRACE_CLOCK = 3
+};
+
+class TraceRecorder {
+public:
+    static constexpr const char* MAGIC = "VVT1";
+    static constexpr size_t BUFFER_SIZE = 8192;
+    static constexpr size_t RECORD_HEADER = 6;
+
+    bool isEnabled() const { return _enabled; }
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    unsigned long droppedRecords() const { return _dropped; }
+
+    void recordSensorFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        if (!_enabled || len < 0 || len > 255 - 6) return;
+        uint8_t payload[255];
+        memcpy(payload, mac, 6);
+        memcpy(payload + 6, data, len);
+        append(TRACE_SENSOR_FRAME, payload, (uint8_t)(len + 6));
+    }
+
+    void recordActuatorCommand(uint8_t zone, const ActuatorState& state) {
+        if (!_enabled) return;
+        uint8_t payload[1 + sizeof(ActuatorState)];
+        payload[0] = zone;
+        memcpy(payload + 1, &state, sizeof(state));
+        append(TRACE_ACTUATOR_CMD, payload, sizeof(payload));
+    }
+
+    // Vuelca el buffer al archivo de traza del día (p. ej. /2025-06-10/trace.bin)
+    bool flush(const String& timestamp, uint32_t unixTime) {
+        if (!_enabled) return true;
+
+        uint8_t clock[4];
+        writeLE32(clock, unixTime);
+        append(TRACE_CLOCK, clock, sizeof(clock));
+
+        // Se cambia de buffer bajo el lock; el lleno se escribe fuera
+        portENTER_CRITICAL(&_mux);
+        uint8_t* pending = _active;
+        size_t len = _used;
+        _active = pending == _buffers[0] ? _buffers[1] : _buffers[0];
+        _used = 0;
+        portEXIT_CRITICAL(&_mux);
+
+        String folder = "/" + timestamp.substring(0, 10);
+        if (!SD.exists(folder)) SD.mkdir(folder);
+
+        File file = SD.open(folder + "/trace.bin", FILE_APPEND);
+        if (!file) return false;
+        if (file.size() == 0) file.write((const uint8_t*)MAGIC, 4);
+        file.write(pending, len);
+        file.close();
+        return true;
+    }
+
+    static void writeLE32(uint8_t* out, uint32_t v) {
+        out[0] = v & 0xFF;
+        out[1] = (v >> 8) & 0xFF;
+        out[2] = (v >> 16) & 0xFF;
+        out[3] = (v >> 24) & 0xFF;
+    }
+
+    static uint32_t readLE32(const uint8_t* in) {
+        return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+    }
+
+private:
+    bool _enabled = false;
+    uint8_t _buffers[2][BUFFER_SIZE];
+    uint8_t* _active = _buffers[0];
+    size_t _used = 0;
+    unsigned long _dropped = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    void append(TraceRecordType type, const uint8_t* payload, uint8_t len) {
+        portENTER_CRITICAL(&_mux);
+        if (_used + RECORD_HEADER + len > BUFFER_SIZE) {
+            _dropped++;
+        } else {
+            uint8_t* p = _active + _used;
+            p[0] = type;
+            p[1] = len;
+            writeLE32(p + 2, (uint32_t)millis());
+            memcpy(p + RECORD_HEADER, payload, len);
+            _used += RECORD_HEADER + len;
+        }
+        portEXIT_CRITICAL(&_mux);
+    }
+};
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef UPLINK_SPOOL_H
+#define UPLINK_SPOOL_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include "dataSensor.h"
+#include "Scheduler.h"
+
+// Cola de salida hacia Telegram para cuando no hay subida (WiFi caído o
+// Telegram inalcanzable). Guarda alertas y resúmenes periódicos en un
+// archivo circular de la SD y los envía al volver la conexión, a ritmo
+// controlado (drain(), un mensaje cada DRAIN_INTERVAL_MS).
+//
+// Las alertas no se encolan una a una: cada una describe el estado
+// completo, así que la nueva sustituye a la anterior y solo se cuenta el
+// cambio. Al reconectar sale un único mensaje con el número de cambios y el
+// último estado, y después los resúmenes en orden.
+//
+// Archivo /spool.bin: cabecera | hueco de la alerta | SLOTS huecos de
+// SLOT_SIZE bytes (anillo; lleno, se pisa el más antiguo). El siguiente
+// mensaje a enviar se guarda en RAM para no releer la SD en cada
+// reintento. Sin SD, el anillo es de RAM_SLOTS huecos en RAM.
+//
+// Solo la usa la tarea de Telegram (el acceso a la SD no va en secciones
+// críticas).
+enum SpoolKind : uint8_t {
+    SPOOL_SUMMARY = 1,
+    SPOOL_MESSAGE = 2,
+    SPOOL_ALERT = 3
+};
+
+class UplinkSpool {
+public:
+    static constexpr const char* PATH = "/spool.bin";
+    static constexpr uint32_t MAGIC = 0x50535656;   // "VVSP"
+    static constexpr uint16_t SLOT_SIZE = 512;
+    static constexpr uint16_t SLOTS = 120;          // ~60 KB
+    static constexpr uint16_t RAM_SLOTS = 4;
+    static constexpr unsigned long DRAIN_INTERVAL_MS = 3000;
+
+    struct Record {
+        uint8_t kind;
+        uint8_t reserved;
+        uint16_t len;
+        uint32_t unixTime;
+        char text[SLOT_SIZE - 8];
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint16_t slotSize;
+        uint16_t slots;
+        uint16_t head;
+        uint16_t count;
+        uint32_t alertChanges;    // alertas compactadas en el hueco de alerta
+        uint32_t alertFirst;      // hora Unix de la primera
+        uint32_t dropped;         // pisadas por anillo lleno
+    };
+
+    UplinkSpool() { resetHeader(RAM_SLOTS); }
+
+    bool begin() {
+        _sdOk = false;
+        File f = SD.open(PATH, FILE_READ);
+        if (f) {
+            bool valid = f.read((uint8_t*)&_header, sizeof(_header)) == sizeof(_header) && _header.magic == MAGIC &&
+                         _header.slotSize == SLOT_SIZE && _header.slots == SLOTS && _header.head < SLOTS &&
+                         _header.count <= SLOTS;
+            if (valid && _header.alertChanges > 0) {
+                valid = f.read((uint8_t*)&_alert, sizeof(_alert)) == sizeof(_alert);
+                _alert.text[sizeof(_alert.text) - 1] = '\0';
+            }
+            f.close();
+            if (valid) {
+                _sdOk = true;
+                if (pending() > 0) Serial.println("📦 Cola de salida: " + String(pending()) + " mensajes pendientes");
+                return true;
+            }
+        }
+
+        // Archivo nuevo (o no válido)
+        resetHeader(SLOTS);
+        File w = SD.open(PATH, FILE_WRITE);
+        if (!w) {
+            resetHeader(RAM_SLOTS);
+            Serial.println("⚠️ Cola de salida solo en RAM (sin SD)");
+            return false;
+        }
+        w.write((const uint8_t*)&_header, sizeof(_header));
+        static const uint8_t zeros[SLOT_SIZE] = {0};
+        for (uint16_t i = 0; i <= SLOTS; i++) w.write(zeros, sizeof(zeros));   // hueco de alerta + anillo
+        w.close();
+        _sdOk = true;
+        return true;
+    }
+
+    // Alerta (estado completo): sustituye a la pendiente y cuenta el cambio
+    void pushAlert(const String& text, uint32_t unixTime) {
+        if (_header.alertChanges == 0) _header.alertFirst = unixTime;
+        _header.alertChanges++;
+        fill(_alert, SPOOL_ALERT, text, unixTime);
+        if (_sdOk) {
+            File f = SD.open(PATH, "r+");
+            if (f) {
+                f.seek(sizeof(Header));
+                f.write((const uint8_t*)&_alert, sizeof(_alert));
+                f.seek(0);
+                f.write((const uint8_t*)&_header, sizeof(_header));
+                f.close();
+            }
+        }
+    }
+
+    // Resumen o mensaje; con el anillo lleno se pierde el más antiguo
+    void push(SpoolKind kind, const String& text, uint32_t unixTime) {
+        uint16_t capacity = _header.slots;
+        if (_header.count == capacity) {
+            popRing();
+            _header.dropped++;
+        }
+        uint16_t slot = (_header.head + _header.count) % capacity;
+        _header.count++;
+
+        static Record record;
+        fill(record, kind, text, unixTime);
+        if (!_sdOk) {
+            _ram[slot] = record;
+            return;
+        }
+        File f = SD.open(PATH, "r+");
+        if (!f) return;
+        f.seek(slotOffset(slot));
+        f.write((const uint8_t*)&record, sizeof(record));
+        f.seek(0);
+        f.write((const uint8_t*)&_header, sizeof(_header));
+        f.close();
+    }
+
+    size_t pending() const { return _header.count + (_header.alertChanges > 0 ? 1 : 0); }
+    bool empty() const { return pending() == 0; }
+    unsigned long dropped() const { return _header.dropped; }
+
+    // Envía el siguiente mensaje si toca; `send` devuelve true si salió.
+    // Devuelve true si se envió algo.
+    bool drain(bool (*send)(const String& message)) {
+        unsigned long now = millis();
+        if (empty() || now - _lastDrain < DRAIN_INTERVAL_MS) return false;
+        _lastDrain = now;
+
+        String message = peek();
+        if (message.isEmpty()) {   // hueco ilegible: se descarta
+            pop();
+            return false;
+        }
+        if (!send(message)) return false;
+        pop();
+        return true;
+    }
+
+    // Siguiente mensaje a enviar, ya formateado (la alerta compactada primero)
+    String peek() {
+        if (_header.alertChanges > 0) {
+            String s;
+            // (primera hora posterior: el RTC se ajustó por NTP entre medias)
+            if (_header.alertChanges == 1 || _header.alertFirst > _alert.unixTime) {
+                s = "📦 " + String(_header.alertChanges) + (_header.alertChanges == 1 ? " alerta" : " cambios de alerta") +
+                    " durante la desconexión (" + formatTime(_alert.unixTime) + "):\n";
+            } else {
+                s = "📦 " + String(_header.alertChanges) + " cambios de alerta durante la desconexión (" +
+                    formatTime(_header.alertFirst) + " - " + formatTime(_alert.unixTime) + "). Último estado:\n";
+            }
+            return s + String(_alert.text);
+        }
+        if (_header.count == 0) return String();
+
+        if (!_headCached) {
+            if (!readSlot(_header.head, _headRecord)) return String();
+            _headCached = true;
+        }
+        if (_headRecord.kind == SPOOL_SUMMARY) return String(_headRecord.text);
+        return "📦 (" + formatTime(_headRecord.unixTime) + ") " + String(_headRecord.text);
+    }
+
+    void pop() {
+        if (_header.alertChanges > 0) {
+            _header.alertChanges = 0;
+        } else if (_header.count > 0) {
+            popRing();
+        }
+        writeHeader();
+    }
+
+    static String formatTime(uint32_t unixTime) {
+        return Scheduler::formatClock(unixTime % 86400);
+    }
+
+private:
+    Header _header;
+    Record _alert;
+    Record _headRecord;            // siguiente del anillo, ya leído de la SD
+    bool _headCached = false;
+    Record _ram[RAM_SLOTS];        // anillo sin SD
+    bool _sdOk = false;
+    unsigned long _lastDrain = 0;
+
+    void resetHeader(uint16_t slots) {
+        memset(&_header, 0, sizeof(_header));
+        _header.magic = MAGIC;
+        _header.slotSize = SLOT_SIZE;
+        _header.slots = slots;
+        _headCached = false;
+    }
+
+    void popRing() {
+        _header.head = (_header.head + 1) % _header.slots;
+        _header.count--;
+        _headCached = false;
+    }
+
+    static uint32_t slotOffset(uint16_t slot) {
+        return sizeof(Header) + sizeof(Record) * (1 + (uint32_t)slot);
+    }
+
+    bool readSlot(uint16_t slot, Record& out) {
+        if (!_sdOk) {
+            out = _ram[slot];
+            return true;
+        }
+        File f = SD.open(PATH, FILE_READ);
+        if (!f) return false;
+        bool ok = f.seek(slotOffset(slot)) && f.read((uint8_t*)&out, sizeof(out)) == sizeof(out);
+        f.close();
+        if (!ok || out.len >= sizeof(out.text)) return false;
+        out.text[out.len] = '\0';
+        return true;
+    }
+
+    void writeHeader() {
+        if (!_sdOk) return;
+        File f = SD.open(PATH, "r+");
+        if (!f) return;
+        f.write((const uint8_t*)&_header, sizeof(_header));
+        f.close();
+    }
+
+    // Copia el texto cortando en un límite de carácter UTF-8
+    static void fill(Record& r, SpoolKind kind, const String& text, uint32_t unixTime) {
+        size_t len = text.length();
+        if (len > sizeof(r.text) - 1) {
+            len = sizeof(r.text) - 1;
+            while (len > 0 && ((uint8_t)text.c_str()[len] & 0xC0) == 0x80) len--;
+        }
+        memset(&r, 0, sizeof(r));
+        r.kind = kind;
+        r.len = (uint16_t)len;
+        r.unixTime = unixTime;
+        memcpy(r.text, text.c_str(), len);
+    }
+};
+
+// Resumen de las lecturas de un periodo (mín/media/máx); se encola si no
+// hay subida. POD: se actualiza dentro de dataMux. En el punto
+// fijo de cada canal.
+struct UplinkSummary {
+    static constexpr unsigned long PERIOD_MS = 15UL * 60UL * 1000UL;
+
+    uint32_t samples = 0;
+    uint32_t startTime = 0;
+    int32_t minTemp = 0, maxTemp = 0;
+    int64_t sumTemp = 0;
+    int32_t minSoil = 0, maxSoil = 0;
+    int64_t sumSoil = 0;
+    int32_t maxCO2 = 0;
+    int32_t minLight = 0;
+
+    void add(const SensorData& d, uint32_t unixTime) {
+        if (samples == 0) {
+            startTime = unixTime;
+            minTemp = maxTemp = d.temperature;
+            minSoil = maxSoil = d.soilMoisture;
+            maxCO2 = d.co2ppm;
+            minLight = d.light;
+        }
+        samples++;
+        sumTemp += d.temperature;
+        sumSoil += d.soilMoisture;
+        if (d.temperature < minTemp) minTemp = d.temperature;
+        if (d.temperature > maxTemp) maxTemp = d.temperature;
+        if (d.soilMoisture < minSoil) minSoil = d.soilMoisture;
+        if (d.soilMoisture > maxSoil) maxSoil = d.soilMoisture;
+        if (d.co2ppm > maxCO2) maxCO2 = d.co2ppm;
+        if (d.light < minLight) minLight = d.light;
+    }
+
+    String format(uint32_t endTime) const {
+        String s = "📦 Resumen " + UplinkSpool::formatTime(startTime) + " - " + UplinkSpool::formatTime(endTime) +
+                   " (" + String(samples) + " lecturas):\n";
+        s += "🌡️ Temp: " + value(SENSOR_TEMPERATURE, minTemp) + " / " + value(SENSOR_TEMPERATURE, mean(sumTemp)) +
+             " / " + value(SENSOR_TEMPERATURE, maxTemp) + " °C\n";
+        s += "🌱 Suelo: " + value(SENSOR_SOIL, minSoil) + " / " + value(SENSOR_SOIL, mean(sumSoil)) + " / " +
+             value(SENSOR_SOIL, maxSoil) + " %\n";
+        s += "🫁 CO2 máx: " + value(SENSOR_CO2, maxCO2) + " ppm\n";
+        s += "☀️ Luz mín: " + value(SENSOR_LIGHT, minLight);
+        return s;
+    }
+
+    int32_t mean(int64_t sum) const {
+        return (int32_t)((sum + (sum < 0 ? -1 : 1) * (int64_t)(samples / 2)) / samples);
+    }
+
+    static String value(SensorChannelId ch, int32_t raw) {
+        char buf[16];
+        formatSensorValue(buf, sizeof(buf), SENSOR_CHANNEL_TABLE[ch], raw, SENSOR_CHANNEL_TABLE[ch].decimals);
+        return String(buf);
+    }
+};
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef WIFI_CONNECTOR_H
+#define WIFI_CONNECTOR_H
+
+#include <WiFi.h>
+#include <esp_wifi.h>
+
+// Estados de la conexión WiFi (ver WiFiConnector)
+enum WiFiLinkState : uint8_t {
+    WIFI_LINK_IDLE = 0,
+    WIFI_LINK_CONNECTING,
+    WIFI_LINK_CONNECTED,
+    WIFI_LINK_BACKOFF      // esperando para reintentar
+};
+
+// Conexión WiFi sin bloquear: una máquina de estados que avanzan los
+// eventos del WiFi y update(), llamado desde su propia tarea. Nadie espera
+// al AP: el control local por ESP-NOW y la SD siguen a ritmo normal y la
+// subida (Telegram, NTP) consulta isConnected().
+//
+// Los reintentos esperan con backoff exponencial (1 s, 2 s, 4 s ... hasta
+// 60 s, con algo de azar) para no ocupar la radio, que comparte canal con
+// ESP-NOW. Los primeros intentos van al canal conocido del AP, que evita
+// el escaneo de todos los canales; si fallan, se escanea, como mucho
+// MAX_SCANS por SCAN_WINDOW_MS (un escaneo saca a la radio del canal de
+// ESP-NOW hasta CONNECT_TIMEOUT_MS y las tramas de los nodos se pierden);
+// el resto de intentos vuelven al canal conocido. Tras cada intento
+// fallido la radio vuelve al canal de ESP-NOW (setRadioChannel).
+class WiFiConnector {
+public:
+    static constexpr unsigned long CONNECT_TIMEOUT_MS = 10000;
+    static constexpr unsigned long BACKOFF_MIN_MS = 1000;
+    static constexpr unsigned long BACKOFF_MAX_MS = 60000;
+    static constexpr uint8_t HINT_ATTEMPTS = 2;
+    static constexpr uint8_t MAX_SCANS = 4;
+    static constexpr unsigned long SCAN_WINDOW_MS = 3600000;
+
+private:
+    const char* _ssid;
+    const char* _password;
+    uint8_t _channelHint = 0;
+    uint8_t (*_radioChannel)() = nullptr;
+    unsigned long _scanWindowStart = 0;
+    uint8_t _scans = 0;                  // escaneos en la ventana en curso
+
+    volatile WiFiLinkState _state = WIFI_LINK_IDLE;
+    volatile bool _gotIp = false;        // eventos, se atienden en update()
+    volatile bool _linkLost = false;
+    unsigned long _stateSince = 0;
+    unsigned long _backoffMs = 0;
+    uint8_t _failures = 0;               // intentos fallidos seguidos
+    unsigned long _connects = 0;
+    unsigned long _disconnects = 0;
+    unsigned long _connectedSince = 0;
+
+    // Instancia que recibe los eventos (estático local: el .h se puede
+    // incluir en varias unidades de compilación)
+    static WiFiConnector*& instance() {
+        static WiFiConnector* current = nullptr;
+        return current;
+    }
+
+    static void onWiFiEvent(arduino_event_id_t event) {
+        WiFiConnector* self = instance();
+        if (!self) return;
+        if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) self->_gotIp = true;
+        else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) self->_linkLost = true;
+    }
+
+    void setState(WiFiLinkState state, unsigned long now) {
+        _state = state;
+        _stateSince = now;
+    }
+
+    // Cuenta el escaneo si cabe en la ventana
+    bool takeScan(unsigned long now) {
+        if (_scans == 0 || now - _scanWindowStart >= SCAN_WINDOW_MS) {
+            _scanWindowStart = now;
+            _scans = 0;
+        }
+        if (_scans >= MAX_SCANS) return false;
+        _scans++;
+        return true;
+    }
+
+    void startAttempt(unsigned long now) {
+        uint8_t channel = _failures < HINT_ATTEMPTS ? _channelHint : 0;
+        if (channel == 0 && !takeScan(now)) {
+            channel = _channelHint ? _channelHint : (_radioChannel ? _radioChannel() : 0);
+        }
+        _linkLost = false;
+        WiFi.begin(_ssid, _password, channel);
+        setState(WIFI_LINK_CONNECTING, now);
+    }
+
+    void enterBackoff(unsigned long now) {
+        WiFi.disconnect();   // que la estación no siga escaneando por su cuenta
+        uint8_t radio = _radioChannel ? _radioChannel() : 0;
+        if (radio >= 1 && radio <= 14) esp_wifi_set_channel(radio, WIFI_SECOND_CHAN_NONE);
+        uint8_t shift = _failures < 6 ? _failures : 6;
+        _backoffMs = BACKOFF_MIN_MS << shift;
+        if (_backoffMs > BACKOFF_MAX_MS) _backoffMs = BACKOFF_MAX_MS;
+        _backoffMs += random(0, _backoffMs / 4 + 1);
+        _failures++;
+        setState(WIFI_LINK_BACKOFF, now);
+        Serial.println("⏳ WiFi: reintento en " + String(_backoffMs / 1000.0, 1) + " s");
+    }
+
+public:
+    WiFiConnector(const char* ssid, const char* password)
+        : _ssid(ssid), _password(password) {}
+
+    // Credenciales guardadas en NVS; se usan en el próximo intento
+    void setCredentials(const char* ssid, const char* password) {
+        _ssid = ssid;
+        _password = password;
+    }
+
+    // Canal conocido del AP (0 = escanear siempre)
+    void setChannelHint(uint8_t channel) { _channelHint = channel; }
+
+    // Canal de ESP-NOW, al que vuelve la radio tras cada intento fallido
+    void setRadioChannel(uint8_t (*channel)()) { _radioChannel = channel; }
+
+    // Arranca el primer intento y vuelve enseguida
+    void begin() {
+        Serial.println("🔌 Iniciando conexión WiFi...");
+        instance() = this;
+        WiFi.mode(WIFI_STA);  // Modo estación
+        WiFi.setAutoReconnect(false);  // los reintentos los lleva update()
+        WiFi.onEvent(onWiFiEvent);
+        startAttempt(millis());
+    }
+
+    // Avanza la máquina de estados; llamar periódicamente (p. ej. cada 100 ms)
+    void update() {
+        unsigned long now = millis();
+
+        if (_gotIp) {
+            _gotIp = false;
+            if (_state != WIFI_LINK_CONNECTED) {
+                setState(WIFI_LINK_CONNECTED, now);
+                _failures = 0;
+                _connects++;
+                _connectedSince = now;
+                _channelHint = (uint8_t)WiFi.channel();
+                Serial.println("✅ Conectado a WiFi");
+                Serial.print("📶 SSID: "); Serial.println(WiFi.SSID());
+                Serial.print("📡 Canal: "); Serial.println(WiFi.channel());
+                Serial.print("🧠 IP local: "); Serial.println(WiFi.localIP());
+            }
+        }
+
+        if (_linkLost) {
+            _linkLost = false;
+            if (_state == WIFI_LINK_CONNECTED) {
+                _disconnects++;
+                Serial.println("⚠️ WiFi perdido, reintentando...");
+                _failures = 0;
+                enterBackoff(now);
+            } else if (_state == WIFI_LINK_CONNECTING) {
+                enterBackoff(now);
+            }
+        }
+
+        switch (_state) {
+            case WIFI_LINK_CONNECTING:
+                if (now - _stateSince > CONNECT_TIMEOUT_MS) {
+                    Serial.println("❌ Error: No se pudo conectar al WiFi");
+                    enterBackoff(now);
+                }
+                break;
+            case WIFI_LINK_BACKOFF:
+                if (now - _stateSince >= _backoffMs) startAttempt(now);
+                break;
+            case WIFI_LINK_CONNECTED:
+                // Por si se perdió el evento de desconexión
+                if (WiFi.status() != WL_CONNECTED) _linkLost = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    bool isConnected() const {
+        return _state == WIFI_LINK_CONNECTED;
+    }
+
+    WiFiLinkState getState() const {
+        return _state;
+    }
+
+    static const char* stateName(WiFiLinkState state) {
+        static const char* names[] = {"inactivo", "conectando", "conectado", "en espera"};
+        return names[state];
+    }
+
+    String formatStatus() {
+        unsigned long now = millis();
+        String s = "📶 WiFi: " + String(stateName(_state));
+        if (_state == WIFI_LINK_CONNECTED) {
+            s += " a " + WiFi.SSID() + " (canal " + String(WiFi.channel()) + ", " + String(WiFi.RSSI()) +
+                 " dBm) desde hace " + String((now - _connectedSince) / 1000) + " s";
+        } else if (_state == WIFI_LINK_BACKOFF) {
+            unsigned long elapsed = now - _stateSince;
+            s += ", reintento en " + String(elapsed < _backoffMs ? (_backoffMs - elapsed) / 1000 : 0) + " s";
+        }
+        s += "\n🔁 Conexiones: " + String(_connects) + ", caídas: " + String(_disconnects) +
+             ", fallos seguidos: " + String(_failures);
+        return s;
+    }
+
+    int getChannel() {
+        return WiFi.channel();
+    }
+
+    IPAddress getIP() {
+        return WiFi.localIP();
+    }
+
+    String getSSID() {
+        return WiFi.SSID();
+    }
+
+    int getRSSI() {
+        return WiFi.RSSI();
+    }
+
+    unsigned long getConnects() const {
+        return _connects;
+    }
+};
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef ZONE_FUSION_H
+#define ZONE_FUSION_H
+
+#include <Arduino.h>
+#include "dataSensor.h"
+
+// Fusión por zona: la última muestra de cada nodo sensor (por MAC) se
+// guarda al llegar, y en cada tick de control la zona se decide una sola
+// vez sobre un valor agregado por canal en lugar de seguir al último
+// paquete que llegó.
+//
+// El agregado es la mediana ponderada de los nodos frescos que tienen el
+// canal utilizable (sin marcas de SensorQuality): con tres o más nodos un
+// nodo descalibrado o averiado no mueve la decisión. Con dos es la media
+// ponderada. El peso de un nodo es el configurado (sensorZones) por un
+// factor de frescura que cae linealmente hasta 0 en staleMs: un nodo que
+// deja de transmitir pierde peso y al final sale del agregado.
+//
+// POD: update() y fuse() se llaman dentro de dataMux.
+class ZoneFusion {
+public:
+    static constexpr uint8_t MAX_NODES = 8;
+    static constexpr uint8_t MAX_ZONES = 8;
+
+    unsigned long staleMs = 30000;
+
+    // Guarda la muestra del nodo y marca su zona para el próximo tick.
+    // now: instante de adquisición (millis() del Edge, no posterior a
+    // ahora); una muestra más antigua que la guardada del nodo (llegada
+    // fuera de orden) no la sustituye.
+    void update(const uint8_t* mac, uint8_t zone, uint8_t weight, const SensorData& data, uint16_t unusable,
+                unsigned long now) {
+        if (zone >= MAX_ZONES) return;
+        Node* node = nullptr;
+        for (uint8_t i = 0; i < _count && !node; i++) {
+            if (memcmp(_nodes[i].mac, mac, 6) == 0) node = &_nodes[i];
+        }
+        if (node && (long)(now - node->lastMs) < 0) {
+            _outOfOrder++;
+            return;
+        }
+        if (!node) {
+            if (_count < MAX_NODES) {
+                node = &_nodes[_count++];
+            } else {   // llena: sustituye al que lleva más tiempo callado
+                node = &_nodes[0];
+                for (uint8_t i = 1; i < _count; i++) {
+                    if (now - _nodes[i].lastMs > now - node->lastMs) node = &_nodes[i];
+                }
+            }
+            memcpy(node->mac, mac, 6);
+        }
+        node->zone = zone;
+        node->weight = weight > 0 ? weight : 1;
+        node->data = data;
+        node->unusable = unusable;
+        node->lastMs = now;
+        _pending |= (uint16_t)(1u << zone);
+        _updates++;
+    }
+
+    // Zonas con muestras nuevas desde el último tick (y las olvida)
+    uint16_t takePending() {
+        uint16_t pending = _pending;
+        _pending = 0;
+        return pending;
+    }
+
+    // Zonas de `zones` sin ningún nodo fresco: si todos sus nodos callan no
+    // llega nada que la marque pendiente, y hay que decidirla igualmente
+    // (fuse() la deja sin canales utilizables)
+    uint16_t staleZones(uint16_t zones, unsigned long now) const {
+        uint16_t fresh = 0;
+        for (uint8_t i = 0; i < _count; i++) {
+            if (now - _nodes[i].lastMs < staleMs) fresh |= (uint16_t)(1u << _nodes[i].zone);
+        }
+        return zones & ~fresh;
+    }
+
+    // Agregado de la zona. unusable: canales sin ningún nodo fresco y
+    // utilizable (su valor queda como "sin lectura"); sampleMs: adquisición
+    // de la muestra más reciente que entra. Devuelve el número de nodos
+    // frescos de la zona.
+    uint8_t fuse(uint8_t zone, unsigned long now, SensorData& out, uint16_t& unusable, unsigned long* sampleMs = nullptr) {
+        Entry entries[MAX_NODES];
+        uint8_t fresh = 0;
+        unsigned long newest = 0;
+        unusable = 0;
+        _fusions++;
+        fillSensorChannels(out, [&](SensorChannelId ch) {
+            uint8_t n = 0;
+            fresh = 0;
+            for (uint8_t i = 0; i < _count; i++) {
+                const Node& node = _nodes[i];
+                unsigned long age = now - node.lastMs;
+                if (node.zone != zone || age >= staleMs) continue;
+                fresh++;
+                if (newest == 0 || (long)(node.lastMs - newest) > 0) newest = node.lastMs;
+                if (node.unusable >> ch & 1) continue;
+                // Peso * frescura, en enteros (frescura en 1/256)
+                uint32_t freshness = 256 - (uint32_t)((uint64_t)age * 256 / staleMs);
+                entries[n++] = {channelValue(node.data, ch), node.weight * freshness};
+            }
+            if (n == 0) {
+                unusable |= (uint16_t)(1u << ch);
+                return SENSOR_CHANNEL_TABLE[ch].noReading;
+            }
+            if (n < fresh) _rejected++;
+            return weightedMedian(entries, n);
+        });
+        if (sampleMs) *sampleMs = newest ? newest : now;
+        return fresh;
+    }
+
+    unsigned long updates() const { return _updates; }
+    unsigned long fusions() const { return _fusions; }
+    unsigned long rejected() const { return _rejected; }   // canales de nodos frescos descartados por calidad
+    unsigned long outOfOrder() const { return _outOfOrder; }
+
+private:
+    struct Node {
+        uint8_t mac[6];
+        uint8_t zone;
+        uint8_t weight;
+        SensorData data;
+        uint16_t unusable;
+        unsigned long lastMs;
+    };
+
+    struct Entry {
+        int32_t value;
+        uint32_t weight;
+    };
+
+    Node _nodes[MAX_NODES];
+    uint8_t _count = 0;
+    uint16_t _pending = 0;
+    unsigned long _updates = 0;
+    unsigned long _fusions = 0;
+    unsigned long _rejected = 0;
+    unsigned long _outOfOrder = 0;
+
+    static int32_t channelValue(const SensorData& d, SensorChannelId ch) {
+        int32_t value = 0;
+        uint8_t i = 0;
+        visitSensorChannels(d, [&](const SensorChannel&, int32_t raw) {
+            if (i++ == ch) value = raw;
+        });
+        return value;
+    }
+
+    // Mediana ponderada (n <= MAX_NODES: inserción). Si el peso acumulado
+    // cae justo en la mitad, media ponderada de los dos valores centrales;
+    // con dos nodos queda la media ponderada.
+    static int32_t weightedMedian(Entry* e, uint8_t n) {
+        for (uint8_t i = 1; i < n; i++) {
+            Entry x = e[i];
+            uint8_t j = i;
+            for (; j > 0 && e[j - 1].value > x.value; j--) e[j] = e[j - 1];
+            e[j] = x;
+        }
+        if (n == 2) return weightedMean(e[0], e[1]);
+
+        uint64_t total = 0;
+        for (uint8_t i = 0; i < n; i++) total += e[i].weight;
+        uint64_t acc = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            acc += e[i].weight;
+            if (acc * 2 == total && i + 1 < n) return weightedMean(e[i], e[i + 1]);
+            if (acc * 2 > total) return e[i].value;
+        }
+        return e[n - 1].value;
+    }
+
+    static int32_t weightedMean(const Entry& a, const Entry& b) {
+        uint64_t w = (uint64_t)a.weight + b.weight;
+        if (w == 0) return a.value;
+        int64_t sum = (int64_t)a.value * a.weight + (int64_t)b.value * b.weight;
+        return (int32_t)((sum + (sum < 0 ? -1 : 1) * (int64_t)(w / 2)) / (int64_t)w);
+    }
+};
+
+#endif
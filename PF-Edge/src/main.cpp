@@ -1,17 +1,33 @@
 #include <Arduino.h>
 #include "WiFiConnector.h"
 #include "ESPNowReceiver.h"
-#include "ESPNowSender.h"
+#include "ActuatorNetwork.h"
 #include "TelegramBot.h"
 #include "ThresholdsController.h"
+#include "ControlLoop.h"
+#include "Scheduler.h"
 #include "dataSensor.h"
 #include "dataActuator.h"
 #include "SDLogger.h"
+#include "SDRetention.h"
 #include "RtcDS1302Helper.h"
 #include "DisplayManager.h"
+#include "TraceRecorder.h"
+#include "ConfigStore.h"
+#include "ChannelBeacon.h"
+#include "UplinkSpool.h"
+#include "SensorNodeTable.h"
+#include "SensorQuality.h"
+#include "ZoneFusion.h"
+#include "SensorConfigSender.h"
+#include "FirmwareDistributor.h"
+#include "LinkRssi.h"
+#include "LinkMonitor.h"
+#include "LocalApi.h"
+#include "TelemetryStream.h"
 #include <time.h>
 
-// 📡 WiFi
+// 📡 WiFi (valores de fábrica: si hay configuración en NVS, manda esa)
 const char* ssid = "Jose";
 const char* password = "Viani1992";
 WiFiConnector wifi(ssid, password);
@@ -27,19 +43,83 @@ RtcDS1302Helper rtc(15, 14, 2);
 SDLogger logger(5);
 
 // 🌡️ Datos compartidos
-SensorData lastReceivedData;
-ActuatorState actuatorState;
-bool hasData = false;
+// Último agregado decidido de una zona, con sus alertas de valor
+struct ZoneSample {
+    SensorData data;
+    uint16_t unusable;        // canales marcados por SensorQuality
+    unsigned long sampleMs;   // adquisición (millis())
+    uint16_t alerts;          // bits ZONE_ALERTS (ver Thresholds::evaluate)
+};
+ZoneSample zoneSamples[ActuatorNetwork::MAX_ZONES];
+ActuatorState zoneStates[ActuatorNetwork::MAX_ZONES];  // última decisión por zona
+ActuatorState zoneDecisions[ActuatorNetwork::MAX_ZONES];  // la misma antes de los horarios
+uint16_t decidedZones = 0;                                // bit por zona con muestra y decisión (dataMux)
+bool zoneAlertsChanged = false;                           // alguna zona cambió de alertas (dataMux)
+ControlLoops controlLoops[ActuatorNetwork::MAX_ZONES];  // lazos PID por zona
+Scheduler scheduler;                                    // fotoperiodo, riego y temporizadores
+SensorNodeTable sensorNodes;                            // último estado por nodo sensor
+SensorQuality sensorQuality;                            // estadística y fallos por nodo y canal
+ZoneFusion zoneFusion;                                  // últimas muestras por zona, agregadas en cada tick
+const unsigned long CONTROL_TICK_MS = 1000;             // como mucho una decisión por zona y tick
+static_assert(ZoneFusion::MAX_ZONES == ActuatorNetwork::MAX_ZONES, "zonas de fusión y de actuadores");
 
 // Protecciones contra acceso concurrente
 portMUX_TYPE dataMux = portMUX_INITIALIZER_UNLOCKED;
 
 // 📥 ESP-NOW
-ESPNowReceiver receiver(2);
+const uint8_t ESPNOW_CHANNEL = 2;
+ESPNowReceiver receiver(ESPNOW_CHANNEL);
+ChannelBeacon beacon;   // anuncia el canal a los nodos
 
-// 🟢 Actuadores
+// 🟢 Actuadores: nodos y tabla de canales (id local, tipo, zona, función).
+// Debe coincidir con la tabla de canales de cada nodo PF-Actuadores.
 const uint8_t actuatorMAC[] = {0xEC, 0xE3, 0x34, 0x8A, 0x55, 0xA0};
-ESPNowActuatorSender actuatorSender(actuatorMAC, 2);
+ActuatorNetwork actuators(ESPNOW_CHANNEL);
+
+// Un nodo por MAC configurada; el nodo N atiende la zona N
+void setupActuatorTable(const EdgeConfig& cfg) {
+    for (uint8_t i = 0; i < cfg.actuatorCount; i++) {
+        int node = actuators.addNode(cfg.actuatorMacs[i]);
+        if (node < 0) break;
+        actuators.addChannel(node, 0, CHANNEL_RELAY, i, ROLE_PUMP);
+        actuators.addChannel(node, 1, CHANNEL_PWM, i, ROLE_FAN);
+        for (uint8_t id = 2; id <= 5; id++) {
+            actuators.addChannel(node, id, CHANNEL_LED, i, ROLE_LIGHT);   // 4 tiras LED
+        }
+    }
+}
+
+// 🗺️ Zona de cada nodo sensor y su peso en el agregado de la zona (los no
+// listados van a la zona 0 con peso 1)
+struct SensorZone {
+    uint8_t mac[6];
+    uint8_t zone;
+    uint8_t weight;
+};
+const SensorZone sensorZones[] = {
+    {{0xCC, 0xDB, 0xA7, 0x00, 0x00, 0x01}, 0, 1},
+};
+
+SensorZone zoneForSensor(const uint8_t* mac) {
+    for (const SensorZone& s : sensorZones) {
+        if (memcmp(s.mac, mac, 6) == 0) return s;
+    }
+    SensorZone unlisted = {{0}, 0, 1};
+    return unlisted;
+}
+
+// ⚙️ Configuración remota de nodos sensores (calibración, periodo, envío)
+SensorConfigSender sensorConfig;
+
+// 📦 Actualización de firmware de los nodos desde la SD (/ota)
+FirmwareDistributor firmware;
+#define OTA_DIR "/ota/"
+
+// 📶 Calidad de los enlaces ESP-NOW; se devuelve a los nodos para que
+// ajusten su potencia
+LinkRssi linkRssi;
+LinkMonitor links;
+const unsigned long LINK_CHECK_MS = 1000;
 
 // Control de pantalla OLED
 #define BUTTON_PIN 27
@@ -48,8 +128,45 @@ DisplayManager display(false);
 // 🔢 Umbrales
 Thresholds thresholds;
 
+// 🎞️ Traza de tramas y comandos (se activa con /traza on)
+TraceRecorder trace;
+
+// 💾 Configuración persistente (NVS)
+ConfigStore config;
+
+// 📦 Cola de salida para cuando no hay subida (alertas y resúmenes)
+UplinkSpool spool;
+UplinkSummary offlineSummary;   // lecturas del periodo en curso (dataMux)
+
+// 🗜️ Archivo diario y límite de espacio en la SD (tarea de prioridad 0)
+SDRetention retention;
+
+// 🌐 API HTTP local (solo lectura, ver LocalApi) y eventos en vivo (SSE)
+LocalApi api(80);
+TelemetryStream telemetry;
+uint16_t lastAlertMask[ActuatorNetwork::MAX_ZONES] = {};   // último conjunto publicado por zona (dataMux)
+
+// Envía por Telegram si hay WiFi; false si no salió
+bool sendUplink(const String& message) {
+    return wifi.isConnected() && bot.sendMessage(message);
+}
+
+// Tramas del Edge a un nodo: por su ruta de relevos si llega así, si no
+// directa (actuadores incluidos)
+bool sendToNode(const uint8_t* mac, const uint8_t* data, int len) {
+    return receiver.sendDown(mac, data, len) == ESP_OK;
+}
+
+// Las alertas salen directas si no hay nada pendiente; si no, a la cola
+// (que las compacta) para respetar el orden
+void sendAlert(const String& message) {
+    if (spool.empty() && sendUplink(message)) return;
+    spool.pushAlert(message, rtc.getCachedUnixTime());
+}
+
 // ⏰ NTP
-void syncRtcWithNTP() {
+bool syncRtcWithNTP() {
+    if (!wifi.isConnected()) return false;
     configTime(-5 * 3600, 0, "pool.ntp.org");
     struct tm timeinfo;
     if (getLocalTime(&timeinfo)) {
@@ -57,16 +174,34 @@ void syncRtcWithNTP() {
                           timeinfo.tm_mday, timeinfo.tm_hour,
                           timeinfo.tm_min, timeinfo.tm_sec);
         Serial.println("✅ RTC sincronizado con NTP");
+        return true;
     } else {
         Serial.println("⚠️ No se pudo sincronizar RTC con NTP"); 
+        return false;
     }
 }
 
-// Actualiza la pantalla OLED con los datos actuales
+// Alertas de cada zona con datos, sobre una copia de sus últimos agregados
+String currentAlarm() {
+    SensorData data[ActuatorNetwork::MAX_ZONES];
+    uint16_t alerts[ActuatorNetwork::MAX_ZONES];
+    portENTER_CRITICAL(&dataMux);
+    uint16_t zones = decidedZones;
+    for (uint8_t zone = 0; zone < ActuatorNetwork::MAX_ZONES; zone++) {
+        data[zone] = zoneSamples[zone].data;
+        alerts[zone] = zoneSamples[zone].alerts;
+    }
+    portEXIT_CRITICAL(&dataMux);
+    return thresholds.returnAlarm(data, alerts, zones);
+}
+
+// Actualiza la pantalla OLED con los datos actuales (la primera zona con datos)
 void actualizarDisplay() {
     portENTER_CRITICAL(&dataMux);
-    SensorData copy = lastReceivedData;
-    ActuatorState state = actuatorState;
+    uint8_t zone = 0;
+    while (decidedZones && !(decidedZones >> zone & 1)) zone++;
+    SensorData copy = zoneSamples[zone].data;
+    ActuatorState state = zoneStates[zone];
     portEXIT_CRITICAL(&dataMux);
 
     display.setAlerta(
@@ -80,68 +215,639 @@ void actualizarDisplay() {
         thresholds.alertVoltage,
         thresholds.alertWifi,
         thresholds.alertESPSensor,
-        thresholds.alertESPActuator
+        thresholds.alertESPActuator,
+        thresholds.alertSensorFault
     );
 
     display.setHora(rtc.getTime());
     display.setFecha(rtc.getDate());
     display.setWifiStatus(WiFi.status() == WL_CONNECTED ? "OK" : "FAIL");
     display.setSensorData(copy, String(thresholds.RSSIWiFi));
-    display.setActuadorEstado(actuatorState);
+    display.setActuadorEstado(state);
 }
 
 // 🔁 Callback al recibir datos
-void onSensorDataReceived(const SensorData& data) {
+// sampleMs: instante de adquisición en millis() del Edge (ver ESPNowReceiver)
+void onSensorDataReceived(const uint8_t* mac, const SensorData& data, unsigned long sampleMs) {
+    SensorZone assigned = zoneForSensor(mac);
+    uint8_t zone = assigned.zone;
+
+    unsigned long now = millis();
+
+    // Calidad y fusión (con el instante de adquisición): la decisión de la
+    // zona se toma en controlTick()
     portENTER_CRITICAL(&dataMux);
-    lastReceivedData = data;
-    hasData = true;
-    actuatorState = thresholds.evaluate(data);
+    SampleQuality quality = sensorQuality.check(mac, data, sampleMs);
+    uint8_t faultFlags[SENSOR_CHANNEL_COUNT];
+    uint16_t faults = sensorQuality.faultChannels(faultFlags);
+    thresholds.setSensorFaults(faults, faultFlags);
+    zoneFusion.update(mac, zone, assigned.weight, data, quality.unusable, sampleMs);
+    sensorNodes.record(mac, zone, data, quality, sampleMs, now);
     portEXIT_CRITICAL(&dataMux);
 
-    actuatorSender.sendData(actuatorState);
-    thresholds.alertESPActuator = !actuatorSender.isPeerConnected();
+    // Flujo en vivo: solo una copia a la cola, se serializa en la tarea de la API
+    telemetry.publishSample(mac, zone, data, quality.unusable, sampleMs);
 
     Serial.println("📥 Datos recibidos:");
     Serial.println(thresholds.formatSensorData(data));
+    for (uint8_t ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        if (!quality.flags[ch]) continue;
+        Serial.print("🩺 ");
+        Serial.print(SENSOR_CHANNEL_TABLE[ch].label);
+        for (uint8_t bit = 0; bit < QUALITY_FLAG_COUNT; bit++) {
+            if (quality.flags[ch] >> bit & 1) {
+                Serial.print(" ");
+                Serial.print(qualityFlagName(bit));
+            }
+        }
+        Serial.println(" (descartado)");
+    }
+}
+
+bool zoneHasChannels(uint8_t zone) {
+    for (uint8_t i = 0; i < actuators.getChannelCount(); i++) {
+        if (actuators.getEntry(i).channel.zone == zone) return true;
+    }
+    return false;
+}
+
+// ⏱️ Tick de control: cada zona con muestras nuevas se decide una sola vez,
+// sobre el agregado de sus nodos (ver ZoneFusion), por muchos nodos que
+// compartan la zona o muestras que hayan llegado desde el tick anterior.
+// Una zona decidida cuyos nodos llevan staleMs callados se decide otra vez
+// sin canales utilizables (todo apagado) y deja de contar como decidida.
+// Los horarios se evalúan en cada tick: al abrirse o cerrarse una ventana
+// o un temporizador, las zonas se vuelven a filtrar sin esperar a la
+// siguiente muestra. Una zona con actuadores pero sin decisión (sin
+// sensores o callados) parte de todo apagado, así sus temporizadores y
+// ventanas se aplican igual.
+void controlTick() {
+    portENTER_CRITICAL(&dataMux);
+    uint16_t pending = zoneFusion.takePending();
+    bool scheduleChanged = scheduler.update(rtc.getCachedUnixTime());
+    uint16_t decided = decidedZones;
+    pending |= zoneFusion.staleZones(decided, millis());
+    portEXIT_CRITICAL(&dataMux);
+
+    for (uint8_t zone = 0; zone < ZoneFusion::MAX_ZONES; zone++) {
+        if (!(pending >> zone & 1)) {
+            if (!scheduleChanged) continue;
+            bool hasDecision = decided >> zone & 1;
+            if (!hasDecision && !zoneHasChannels(zone)) continue;
+            portENTER_CRITICAL(&dataMux);
+            ActuatorState state = hasDecision ? zoneDecisions[zone] : ActuatorState();
+            scheduler.gate(zone, rtc.getCachedUnixTime(), state);
+            zoneStates[zone] = state;
+            portEXIT_CRITICAL(&dataMux);
+            if (actuators.applyZoneState(zone, state)) {
+                trace.recordActuatorCommand(zone, state);
+                telemetry.publishActuators(zone, state);
+            }
+            continue;
+        }
+        unsigned long now = millis();
+        SensorData fused;
+        uint16_t unusable;
+        unsigned long sampleMs;
+
+        // Alertas de valor por zona: el agregado global (pantalla, API) es
+        // el OR de todas, así una zona no retira las de otra
+        portENTER_CRITICAL(&dataMux);
+        uint8_t fresh = zoneFusion.fuse(zone, now, fused, unusable, &sampleMs);
+        uint16_t zoneAlerts;
+        ActuatorState state = thresholds.evaluate(fused, unusable, zoneAlerts);
+        if (zoneAlerts != zoneSamples[zone].alerts) zoneAlertsChanged = true;
+        zoneSamples[zone] = {fused, unusable, sampleMs, zoneAlerts};
+        if (fresh) decidedZones |= 1 << zone;
+        else decidedZones &= ~(1 << zone);
+        uint16_t anyZone = 0;
+        for (uint8_t z = 0; z < ActuatorNetwork::MAX_ZONES; z++) anyZone |= zoneSamples[z].alerts;
+        thresholds.setZoneAlerts(anyZone);
+        controlLoops[zone].apply(fused, now, state, unusable);
+        zoneDecisions[zone] = state;
+        scheduler.gate(zone, rtc.getCachedUnixTime(), state);
+        zoneStates[zone] = state;
+        uint16_t alerts = zoneAlerts | (thresholds.alertMask() & ~ZONE_ALERTS);
+        bool alertsChanged = alerts != lastAlertMask[zone];
+        lastAlertMask[zone] = alerts;
+        portEXIT_CRITICAL(&dataMux);
+
+        // Solo se transmite cuando cambia algún canal de la zona
+        if (actuators.applyZoneState(zone, state)) {
+            trace.recordActuatorCommand(zone, state);
+            telemetry.publishActuators(zone, state);
+        }
+        if (alertsChanged) telemetry.publishAlerts(zone, alerts);
+    }
+}
+
+// "/activar bomba 2" -> función y zona (0 si no se indica)
+bool parseActuatorCommand(const String& cmd, ActuatorRole& role, uint8_t& zone) {
+    int firstSpace = cmd.indexOf(' ');
+    int secondSpace = cmd.indexOf(' ', firstSpace + 1);
+    String name = secondSpace > 0 ? cmd.substring(firstSpace + 1, secondSpace) : cmd.substring(firstSpace + 1);
+    zone = secondSpace > 0 ? (uint8_t)cmd.substring(secondSpace + 1).toInt() : 0;
+    if (zone >= ActuatorNetwork::MAX_ZONES) return false;
+
+    if (name == "bomba") role = ROLE_PUMP;
+    else if (name == "ventilador") role = ROLE_FAN;
+    else if (name == "luces") role = ROLE_LIGHT;
+    else return false;
+    return true;
+}
+
+// /nodo <n|MAC|todos> leer | /nodo <n|MAC|todos> <clave> <valor> [<clave> <valor>...]
+// Los nodos son los de /api/nodos (n: su posición). Devuelve la respuesta
+// inmediata; el resultado llega después con sensorConfig.takeReport().
+String handleNodeConfigCommand(const String& cmd) {
+    String args[1 + 2 * SENSOR_CONFIG_MAX_ITEMS];
+    int n = 0;
+    int from = cmd.indexOf(' ');
+    while (from > 0 && n < (int)(sizeof(args) / sizeof(args[0]))) {
+        int to = cmd.indexOf(' ', from + 1);
+        args[n] = to > 0 ? cmd.substring(from + 1, to) : cmd.substring(from + 1);
+        if (!args[n].isEmpty()) n++;
+        from = to;
+    }
+
+    portENTER_CRITICAL(&dataMux);
+    SensorNodeTable nodes = sensorNodes;
+    portEXIT_CRITICAL(&dataMux);
+
+    if (n < 2 || (n > 2 && n % 2 == 0) || (n == 2 && args[1] != "leer")) {
+        String s = "⚠️ Uso: /nodo <n|MAC|todos> leer | /nodo <n|MAC|todos> <clave> <valor> ...\nClaves:";
+        for (uint8_t id = 0; id < SENSOR_SETTING_COUNT; id++) s += " " + String(SENSOR_SETTING_TABLE[id].key);
+        s += "\nNodos:";
+        for (uint8_t i = 0; i < nodes.count(); i++) {
+            const uint8_t* m = nodes.get(i).mac;
+            char mac[18];
+            snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+            s += "\n#" + String(i) + " " + mac + " (zona " + String(nodes.get(i).zone) + ")";
+        }
+        return s;
+    }
+
+    SettingValue items[SENSOR_CONFIG_MAX_ITEMS];
+    uint8_t count = 0;
+    for (int k = 1; k + 1 < n; k += 2) {
+        int id = sensorSettingIndex(args[k].c_str());
+        if (id < 0) return "⚠️ Clave desconocida: " + args[k];
+        items[count].id = (uint8_t)id;
+        items[count].value = (int32_t)lroundf(args[k + 1].toFloat() * SENSOR_SETTING_TABLE[id].scale);
+        count++;
+    }
+
+    uint8_t targets[SensorNodeTable::MAX_NODES][6];
+    uint8_t targetCount = 0;
+    unsigned int b[6];
+    if (args[0] == "todos") {
+        for (uint8_t i = 0; i < nodes.count(); i++) memcpy(targets[targetCount++], nodes.get(i).mac, 6);
+    } else if (sscanf(args[0].c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) == 6) {
+        for (int i = 0; i < 6; i++) targets[0][i] = (uint8_t)b[i];
+        targetCount = 1;
+    } else if (args[0].charAt(0) >= '0' && args[0].charAt(0) <= '9' && args[0].toInt() < nodes.count()) {
+        memcpy(targets[targetCount++], nodes.get(args[0].toInt()).mac, 6);
+    }
+    if (targetCount == 0) return "⚠️ Ningún nodo con ese nombre (ver /nodo).";
+
+    uint8_t sent = 0;
+    for (uint8_t i = 0; i < targetCount; i++) sent += sensorConfig.push(targets[i], items, count) ? 1 : 0;
+    if (sent == 0) return "⚠️ Hay una configuración en curso; espera su resultado.";
+    return "⚙️ Enviado a " + String(sent) + " de " + String(targetCount) + " nodos; espera la confirmación.";
+}
+
+// /ota | /ota cancelar | /ota <sensores|actuadores> <archivo> <versión> [n|MAC]
+// La imagen es <archivo> en /ota/ de la SD; sin nodo, se actualizan todos
+// los de ese tipo (sensores: los de /api/nodos, actuadores: los de la tabla).
+String handleOtaCommand(const String& cmd) {
+    String args[4];
+    int n = 0;
+    int from = cmd.indexOf(' ');
+    while (from > 0 && n < 4) {
+        int to = cmd.indexOf(' ', from + 1);
+        args[n] = to > 0 ? cmd.substring(from + 1, to) : cmd.substring(from + 1);
+        if (!args[n].isEmpty()) n++;
+        from = to;
+    }
+
+    if (n == 0) return firmware.formatStatus();
+    if (n == 1 && args[0] == "cancelar") {
+        if (!firmware.active()) return "📦 No hay ningún reparto en curso.";
+        firmware.cancel();
+        return "🛑 Reparto cancelado; repetir /ota con la misma imagen lo reanuda.";
+    }
+    if (n < 3 || (args[0] != "sensores" && args[0] != "actuadores")) {
+        return "⚠️ Uso: /ota <sensores|actuadores> <archivo> <versión> [n|MAC] (imagen en " OTA_DIR " de la SD)";
+    }
+
+    bool sensors = args[0] == "sensores";
+    uint8_t macs[FirmwareDistributor::MAX_TARGETS][6];
+    uint8_t count = 0;
+    if (sensors) {
+        portENTER_CRITICAL(&dataMux);
+        SensorNodeTable nodes = sensorNodes;
+        portEXIT_CRITICAL(&dataMux);
+        for (uint8_t i = 0; i < nodes.count() && count < FirmwareDistributor::MAX_TARGETS; i++) {
+            memcpy(macs[count++], nodes.get(i).mac, 6);
+        }
+    } else {
+        for (uint8_t i = 0; i < actuators.getNodeCount() && count < FirmwareDistributor::MAX_TARGETS; i++) {
+            memcpy(macs[count++], actuators.getNode(i).getPeerAddress(), 6);
+        }
+    }
+
+    if (n == 4) {   // un solo nodo: posición en la lista o MAC
+        unsigned int b[6];
+        if (sscanf(args[3].c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) == 6) {
+            for (int i = 0; i < 6; i++) macs[0][i] = (uint8_t)b[i];
+            count = 1;
+        } else if (args[3].charAt(0) >= '0' && args[3].charAt(0) <= '9' && args[3].toInt() < count) {
+            memcpy(macs[0], macs[args[3].toInt()], 6);
+            count = 1;
+        } else {
+            return "⚠️ Ningún nodo con ese nombre (ver /nodo o /canales).";
+        }
+    }
+
+    String error;
+    if (!firmware.start(String(OTA_DIR) + args[1], args[2], sensors ? OTA_KIND_SENSOR : OTA_KIND_ACTUATOR, macs, count, error)) {
+        return "⚠️ " + error;
+    }
+    return "📦 Repartiendo " + args[2] + " a " + String(count) + " nodos; /ota muestra el progreso.";
+}
+
+typedef JsonWriter<ApiResponse> ApiJson;
+
+// Enlace de un nodo (última ventana de LinkMonitor); null lo aún no medido
+void writeLinkFields(ApiJson& json, const LinkMonitor::Peer& link) {
+    json.beginObject("enlace");
+    if (link.rssi) json.field("rssi", link.rssi);
+    else json.key("rssi").null();
+    json.field("muestras", link.samples).field("perdidas_pct", link.lossPermille / 10.0, 1);
+    if (link.txPowerQdbm) json.field("potencia_dbm", link.txPowerQdbm / 4.0, 2);
+    else json.key("potencia_dbm").null();
+    json.field("informes", link.reports).endObject();
+}
+
+// GET /api/nodos: último dato de cada nodo sensor
+void apiNodes(const ApiRequest&, ApiResponse& res) {
+    portENTER_CRITICAL(&dataMux);
+    SensorNodeTable nodes = sensorNodes;
+    portEXIT_CRITICAL(&dataMux);
+    RelayPathTable paths = receiver.getPaths();
+
+    unsigned long now = millis();
+    ApiJson& json = res.json;
+    json.beginObject().field("conectado", receiver.isConnected()).beginArray("nodos");
+    for (uint8_t i = 0; i < nodes.count(); i++) {
+        const SensorNodeTable::Node& n = nodes.get(i);
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", n.mac[0], n.mac[1], n.mac[2], n.mac[3], n.mac[4], n.mac[5]);
+        json.beginObject().field("mac", mac).field("zona", n.zone).field("edad_ms", now - n.lastMs)
+            .field("edad_muestra_ms", now - n.sampleMs).field("tramas", n.frames);
+        writeSensorFields(json, n.data);
+        json.beginObject("calidad");
+        writeQualityFields(json, n.quality.flags);
+        json.endObject().beginArray("fallos");
+        for (uint8_t ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+            if (n.quality.faults >> ch & 1) json.value(SENSOR_CHANNEL_TABLE[ch].key);
+        }
+        json.endArray();
+        const RelayPathTable::Path* path = paths.current(n.mac);
+        if (path) {   // directo (saltos 0) o por relevo
+            json.beginObject("ruta").field("saltos", path->hops).field("via", RelayPathTable::formatMac(path->via).c_str())
+                .field("tramas", path->frames).field("perdidas", path->lost)
+                .field("latencia_ms", (double)path->latencyMs, 1).endObject();
+        }
+        LinkMonitor::Peer link;
+        if (links.get(n.mac, link)) writeLinkFields(json, link);
+        int32_t settings[SENSOR_SETTING_COUNT];
+        if (sensorConfig.getSettings(n.mac, settings)) {   // confirmada en el último /nodo
+            json.beginObject("config");
+            for (uint8_t id = 0; id < SENSOR_SETTING_COUNT; id++) {
+                const SensorSetting& s = SENSOR_SETTING_TABLE[id];
+                if (s.scale == 1) json.field(s.key, (long)settings[id]);
+                else json.field(s.key, (double)settings[id] / s.scale, scaleDecimals(s.scale));
+            }
+            json.endObject();
+        }
+        json.endObject();
+    }
+    json.endArray().endObject();
+}
+
+// GET /api/actuadores: decisión y estado confirmado por zona, enlace por nodo
+void apiActuators(const ApiRequest&, ApiResponse& res) {
+    ApiJson& json = res.json;
+    json.beginObject().beginArray("zonas");
+    for (uint8_t zone = 0; zone < ActuatorNetwork::MAX_ZONES; zone++) {
+        if (!zoneHasChannels(zone)) continue;
+        portENTER_CRITICAL(&dataMux);
+        ActuatorState state = zoneStates[zone];
+        portEXIT_CRITICAL(&dataMux);
+        json.beginObject().field("zona", zone).beginObject("deseado");
+        writeLevelFields(json, state);
+        json.endObject().beginObject("aplicado");
+        writeLevelFields(json, actuators.getZoneApplied(zone));
+        json.endObject().endObject();
+    }
+    json.endArray().beginArray("nodos");
+    for (uint8_t i = 0; i < actuators.getNodeCount(); i++) {
+        ESPNowActuatorSender& node = actuators.getNode(i);
+        json.beginObject().field("nodo", i).field("conectado", node.isPeerConnected())
+            .field("ack_pendiente", node.isAckPending()).field("comandos", node.getCommands())
+            .field("reintentos", node.getRetries()).field("sin_ack", node.getTimeouts())
+            .field("sin_cambios", node.getSuppressed()).field("latencia_ms", node.getAvgLatencyMs(), 2);
+        LinkMonitor::Peer link;
+        if (links.get(node.getPeerAddress(), link)) writeLinkFields(json, link);
+        json.endObject();
+    }
+    json.endArray().endObject();
+}
+
+// GET /api/umbrales: umbrales (mismos nombres que /umbral) y alertas activas
+void apiThresholds(const ApiRequest&, ApiResponse& res) {
+    ApiJson& json = res.json;
+    json.beginObject().beginObject("umbrales");
+    for (uint8_t i = 0; i < Thresholds::VALUE_COUNT; i++) json.field(Thresholds::key(i), thresholds.getValue(i), 2);
+    json.endObject().beginObject("alertas");
+    uint16_t mask = thresholds.alertMask();
+    for (uint8_t i = 0; i < Thresholds::ALERT_COUNT; i++) json.field(Thresholds::alertName(i), (mask >> i & 1) != 0);
+    json.endObject().endObject();
+}
+
+// GET /api/metricas: enlaces, cola de salida, NVS y la propia API
+void apiMetrics(const ApiRequest&, ApiResponse& res) {
+    portENTER_CRITICAL(&dataMux);
+    unsigned long frames = sensorNodes.totalFrames();
+    unsigned long flagged = sensorQuality.flagged();
+    uint16_t faults = sensorQuality.faultChannels();
+    unsigned long fusionUpdates = zoneFusion.updates();
+    unsigned long fusions = zoneFusion.fusions();
+    unsigned long fusionRejected = zoneFusion.rejected();
+    unsigned long outOfOrder = zoneFusion.outOfOrder();
+    portEXIT_CRITICAL(&dataMux);
+    RelayPathTable paths = receiver.getPaths();
+    SDRetention::Status sd = retention.status();
+
+    res.json.beginObject().field("uptime_ms", millis())
+        .beginObject("wifi").field("estado", WiFiConnector::stateName(wifi.getState()))
+        .field("rssi", wifi.getRSSI()).field("conexiones", wifi.getConnects()).endObject()
+        .beginObject("espnow").field("canal", beacon.getChannel()).field("tramas_sensores", frames)
+        .field("tramas_incompatibles", receiver.getLayoutMismatches())
+        .field("balizas", beacon.getSent()).field("sincronizaciones", beacon.getTimeSyncs())
+        .field("peticiones_emparejamiento", beacon.getRequests())
+        .field("actuadores_ok", actuators.allConnected()).field("informes_enlace", links.getReports()).endObject()
+        .beginObject("relevo").field("tramas", paths.frames()).field("por_relevo", paths.relayed())
+        .field("duplicadas", paths.duplicates()).field("caminos", paths.count()).endObject()
+        .beginObject("config_nodos").field("peticiones", sensorConfig.getRequests())
+        .field("reintentos", sensorConfig.getRetries()).field("sin_respuesta", sensorConfig.getTimeouts()).endObject()
+        .beginObject("ota").field("activa", firmware.active()).field("bloques", firmware.getChunkFrames())
+        .field("reenviados", firmware.getRetransmits()).field("bytes_verificados", firmware.getBytesDone())
+        .field("ms_transferencia", firmware.getTransferMs()).endObject()
+        .beginObject("calidad").field("lecturas_descartadas", flagged).field("canales_en_fallo", (unsigned int)faults).endObject()
+        .beginObject("fusion").field("muestras", fusionUpdates).field("decisiones", fusions)
+        .field("canales_descartados", fusionRejected).field("fuera_de_orden", outOfOrder).endObject()
+        .beginObject("cola").field("pendientes", spool.pending()).field("descartados", spool.dropped()).endObject()
+        .field("escrituras_nvs", config.writes())
+        .beginObject("sd").field("libre_kb", (unsigned long)(sd.freeBytes >> 10))
+        .field("datos_kb", (unsigned long)(sd.dataBytes >> 10)).field("dias_csv", (unsigned int)sd.days)
+        .field("dias_archivados", (unsigned int)sd.archivedDays).field("archivados", sd.daysArchived)
+        .field("borrados", sd.daysDeleted).endObject()
+        .beginObject("api").field("peticiones", api.requests()).field("rechazadas", api.rejected())
+        .field("clientes", api.activeClients()).endObject()
+        .beginObject("eventos").field("clientes", telemetry.clients()).field("publicados", telemetry.published())
+        .field("entregados", telemetry.delivered()).field("descartados", telemetry.dropped())
+        .field("descartados_cola", telemetry.queueDropped()).endObject()
+        .endObject();
+}
+
+// Campo numérico del CSV que puede ir tal cual al JSON
+bool isJsonNumber(const char* s, size_t len) {
+    if (len == 0) return false;
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        if (!isdigit((unsigned char)c) && c != '-' && c != '.') return false;
+    }
+    return isdigit((unsigned char)s[len - 1]);
+}
+
+// Una línea del CSV como array JSON (números sin comillas, vacío = null)
+void writeCsvRow(ApiJson& json, const char* line) {
+    json.beginArray();
+    const char* p = line;
+    while (true) {
+        const char* end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len == 0) json.raw("null", 4);
+        else if (isJsonNumber(p, len)) json.raw(p, len);
+        else json.value(p, len);
+        if (!end) break;
+        p = end + 1;
+    }
+    json.endArray();
+}
+
+// GET /api/historial?fecha=AAAA-MM-DD&hora=HH[&desde=N][&limite=N]: filas
+// del data.csv de esa hora (por defecto la actual), leídas línea a línea;
+// si el día ya se archivó, del archivo diario (ver SDArchive)
+void apiHistory(const ApiRequest& req, ApiResponse& res) {
+    static const long MAX_ROWS = 2000;
+    char date[11];
+    char hour[3];
+    if (!req.param("fecha", date, sizeof(date)) || !req.param("hora", hour, sizeof(hour))) {
+        String ts = rtc.getTimestamp();   // "AAAA-MM-DD HH:MM:SS"
+        snprintf(date, sizeof(date), "%s", ts.substring(0, 10).c_str());
+        snprintf(hour, sizeof(hour), "%s", ts.substring(11, 13).c_str());
+    }
+    bool valid = strlen(date) == 10 && strlen(hour) == 2 && date[4] == '-' && date[7] == '-';
+    for (uint8_t i = 0; valid && i < 10; i++) valid = i == 4 || i == 7 || isdigit((unsigned char)date[i]);
+    valid = valid && isdigit((unsigned char)hour[0]) && isdigit((unsigned char)hour[1]);
+    if (!valid) {
+        res.error(400, "uso: /api/historial?fecha=AAAA-MM-DD&hora=HH[&desde=N][&limite=N]");
+        return;
+    }
+    long from = req.paramInt("desde", 0);
+    long limit = req.paramInt("limite", 500);
+    if (from < 0) from = 0;
+    if (limit < 1 || limit > MAX_ROWS) limit = MAX_ROWS;
+
+    char path[32];
+    snprintf(path, sizeof(path), "/%s/%s/data.csv", date, hour);
+    File file = SD.open(path, FILE_READ);
+    ArchiveHourReader archive;
+    bool archived = !file && archive.open(date, hour);
+    if (!file && !archived) {
+        res.error(404, "sin datos para esa hora");
+        return;
+    }
+    if (archived) snprintf(path, sizeof(path), "%s", DayArchiver::binPath(date).c_str());
+
+    ApiJson& json = res.json;
+    char line[160];
+    auto next = [&]() { return archived ? archive.readLine(line, sizeof(line)) : SDLogger::readLine(file, line, sizeof(line)); };
+    int len = next();
+    bool header = len > 0 && strncmp(line, "timestamp,", 10) == 0;
+    json.beginObject().field("archivo", path).beginArray("columnas");
+    if (header) {
+        const char* p = line;
+        while (true) {
+            const char* end = strchr(p, ',');
+            json.value(p, end ? (size_t)(end - p) : strlen(p));
+            if (!end) break;
+            p = end + 1;
+        }
+        len = next();
+    }
+    json.endArray().beginArray("filas");
+    long row = 0;
+    long sent = 0;
+    for (; len >= 0 && sent < limit; len = next()) {
+        if (len == 0 || row++ < from) continue;
+        writeCsvRow(json, line);
+        sent++;
+    }
+    bool more = len >= 0;
+    file.close();
+    archive.close();
+    json.endArray().field("desde", from).field("filas_enviadas", sent).field("hay_mas", more).endObject();
+}
+
+// Tarea 0: conexión WiFi (reintentos con backoff, ver WiFiConnector)
+void WiFiTask(void* pvParameters) {
+    bool wasConnected = false;
+    while (true) {
+        wifi.update();
+        bool connected = wifi.isConnected();
+        if (connected && !wasConnected) thresholds.RSSIWiFi = wifi.getRSSI();
+        wasConnected = connected;
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+    }
+}
+
+// Informe de enlace a cada nodo que el Edge oye directamente: sensores por
+// los huecos de su secuencia, actuadores por los reintentos de comandos
+void reportLinks() {
+    unsigned long now = millis();
+    RelayPathTable paths = receiver.getPaths();
+    for (uint8_t i = 0; i < paths.count(); i++) {
+        const RelayPathTable::Path& p = paths.get(i);
+        if (p.hops != 0 || paths.current(p.origin) != &p) continue;   // los de relevo no oyen al Edge
+        links.update(p.origin, LinkMonitor::SENSOR, p.frames + p.lost, p.lost, linkRssi.get(p.origin), now);
+    }
+    for (uint8_t i = 0; i < actuators.getNodeCount(); i++) {
+        ESPNowActuatorSender& node = actuators.getNode(i);
+        const uint8_t* mac = node.getPeerAddress();
+        links.update(mac, LinkMonitor::ACTUATOR, node.getCommands() + node.getRetries(),
+                     node.getRetries() + node.getTimeouts(), linkRssi.get(mac), now);
+    }
 }
 
 // Tarea 1: recibir datos de sensores
 void ReceiveDataTask(void* pvParameters) {
+    receiver.onRawFrame([](const uint8_t* mac, const uint8_t* data, int len) {
+        trace.recordSensorFrame(mac, data, len);
+        if (beacon.handleFrame(mac, data, len)) return;
+        if (links.handleFrame(mac, data, len) || actuators.handleFrame(mac, data, len)) return;
+        if (!sensorConfig.handleFrame(mac, data, len)) firmware.handleFrame(mac, data, len);
+    });
     receiver.onReceive(onSensorDataReceived);
+    beacon.onChannelChange([](uint8_t channel) {
+        config.set("canal", String(channel));   // canal de arranque si no hay WiFi
+    });
 
+    unsigned long lastTick = millis();
+    unsigned long lastLinkCheck = millis();
     while (true) {
-        vTaskDelay(100 / portTICK_PERIOD_MS);
+        beacon.update();
+        sensorConfig.update();   // reintentos de /nodo
+        if (millis() - lastLinkCheck >= LINK_CHECK_MS) {
+            lastLinkCheck = millis();
+            reportLinks();
+        }
+
+        // Decisión por zona a ritmo fijo, no por paquete
+        if (millis() - lastTick >= CONTROL_TICK_MS) {
+            lastTick = millis();
+            controlTick();
+        }
+
+        // Retransmite comandos sin ACK y refleja la salud del enlace
+        actuators.update();
+        thresholds.alertESPActuator = !actuators.allConnected();
+        vTaskDelay(20 / portTICK_PERIOD_MS);
     }
 }
 
 // Tarea 2: comandos Telegram
 void TelegramReceiverTask(void* pvParameters) {
-    // Mostrar mensaje de inicio
-    bot.sendMessage("✅ Bot de Telegram iniciado. Usa /guia para ver comandos disponibles.");
+    bool greeted = false;
+    unsigned long summaryStart = millis();
 
     while (true) {
+        // Mostrar mensaje de inicio (en cuanto haya WiFi)
+        if (!greeted && wifi.isConnected()) {
+            greeted = bot.sendMessage("✅ Bot de Telegram iniciado. Usa /guia para ver comandos disponibles.");
+        }
+
         String cmd = bot.getNextMessage(lastUpdateId);
 
-        if (thresholds.hasAlertChanged()) {
-            String alertMsg = thresholds.returnAlarm(lastReceivedData);
+        // Cambios en las alertas globales o en las de alguna zona
+        portENTER_CRITICAL(&dataMux);
+        bool zonesChanged = zoneAlertsChanged;
+        zoneAlertsChanged = false;
+        portEXIT_CRITICAL(&dataMux);
+        if (thresholds.hasAlertChanged() || zonesChanged) {
+            String alertMsg = currentAlarm();
             if (!alertMsg.isEmpty()) {
-                bot.sendMessage(alertMsg);
+                sendAlert(alertMsg);
             } else {
-                bot.sendMessage("✅ Sistema funcionando correctamente.");
+                sendAlert("✅ Sistema funcionando correctamente.");
+            }
+        }
+
+        // Resumen del periodo: sale directo si no hay nada pendiente; si no
+        // hay subida o el envío falla, a la cola
+        if (millis() - summaryStart >= UplinkSummary::PERIOD_MS) {
+            portENTER_CRITICAL(&dataMux);
+            UplinkSummary period = offlineSummary;
+            offlineSummary = UplinkSummary();
+            portEXIT_CRITICAL(&dataMux);
+            if (period.samples > 0) {
+                uint32_t now = rtc.getCachedUnixTime();
+                String summary = period.format(now);
+                if (!spool.empty() || !sendUplink(summary)) spool.push(SPOOL_SUMMARY, summary, now);
             }
+            summaryStart = millis();
         }
 
+        // Vaciar la cola a ritmo controlado
+        if (wifi.isConnected()) spool.drain(sendUplink);
+
+        // Resultado de /nodo cuando han respondido (o agotado) todos los nodos
+        String configReport = sensorConfig.takeReport();
+        if (!configReport.isEmpty()) bot.sendMessage(configReport);
+
+        // Resultado de /ota al terminar con todos los nodos
+        String otaReport = firmware.takeReport();
+        if (!otaReport.isEmpty()) bot.sendMessage(otaReport);
+
         if (cmd == "/datos") {
             display.setTelegramCmd(cmd);
+            SensorData copy[ActuatorNetwork::MAX_ZONES];
             portENTER_CRITICAL(&dataMux);
-            bool available = hasData;
-            SensorData copy = lastReceivedData;
+            uint16_t zones = decidedZones;
+            for (uint8_t zone = 0; zone < ActuatorNetwork::MAX_ZONES; zone++) copy[zone] = zoneSamples[zone].data;
             portEXIT_CRITICAL(&dataMux);
 
-            if (available) {
+            if (zones) {
                 String msg = "📊 Últimos datos:\n";
                 msg += "🕒 " + rtc.getTimestamp() + "\n";
-                msg += thresholds.formatSensorData(copy);
+                for (uint8_t zone = 0; zones >> zone; zone++) {
+                    if (!(zones >> zone & 1)) continue;
+                    if (zones > 1) msg += "📍 Zona " + String(zone) + ":\n";
+                    msg += thresholds.formatSensorData(copy[zone]);
+                }
                 bot.sendMessage(msg);
             } else {
                 bot.sendMessage("⏳ Aún no hay datos.");
@@ -149,7 +855,7 @@ void TelegramReceiverTask(void* pvParameters) {
 
         } else if (cmd == "/estado") {
             display.setTelegramCmd(cmd);
-            String alertMsg = thresholds.returnAlarm(lastReceivedData);
+            String alertMsg = currentAlarm();
             if (!alertMsg.isEmpty()) {
                 bot.sendMessage(alertMsg);
             } else {
@@ -158,8 +864,113 @@ void TelegramReceiverTask(void* pvParameters) {
         
         } else if (cmd.startsWith("/umbral ")) {
             display.setTelegramCmd(cmd);
-            thresholds.updateFromCommand(cmd);
-            bot.sendMessage("✅ Umbrales actualizados.");
+            if (thresholds.updateFromCommand(cmd)) {
+                config.captureThresholds(thresholds);
+                bot.sendMessage("✅ Umbrales actualizados.");
+            } else {
+                bot.sendMessage("⚠️ Umbral no reconocido. Usa /umbrales para ver los nombres.");
+            }
+
+        } else if (cmd == "/config" || cmd.startsWith("/config ")) {
+            display.setTelegramCmd(cmd);
+            // /config [exportar [todo] | importar <k=v;...> | guardar | <clave> <valor>]
+            String args = cmd.length() > 8 ? cmd.substring(8) : String();
+            args.trim();
+            int space = args.indexOf(' ');
+            String sub = space > 0 ? args.substring(0, space) : args;
+            String rest = space > 0 ? args.substring(space + 1) : String();
+            rest.trim();
+
+            if (sub.isEmpty() || sub == "exportar") {
+                String msg = "💾 Configuración" + String(config.isDirty() ? " (pendiente de guardar)" : "") + ":\n";
+                bot.sendMessage(msg + config.exportText(rest == "todo"));
+            } else if (sub == "importar") {
+                String rejected;
+                int applied = config.importText(rest, rejected);
+                config.applyThresholds(thresholds);
+                String msg = "📥 " + String(applied) + " parámetros importados.";
+                if (!rejected.isEmpty()) msg += "\n⚠️ Ignorados: " + rejected;
+                msg += "\nℹ️ Canal, WiFi, token y actuadores se aplican al reiniciar.";
+                bot.sendMessage(msg);
+            } else if (sub == "guardar") {
+                bot.sendMessage(config.commitNow() ? "💾 Configuración guardada." : "⚠️ No se pudo escribir en NVS.");
+            } else if (!rest.isEmpty() && config.set(sub, rest)) {
+                config.applyThresholds(thresholds);
+                bool live = Thresholds::keyIndex(sub) >= 0 || sub.startsWith("sd_");
+                bot.sendMessage(live ? "✅ Parámetro actualizado." : "✅ Parámetro actualizado; se aplica al reiniciar.");
+            } else {
+                bot.sendMessage("⚠️ Uso: /config [exportar [todo]] | /config importar k=v;k=v | /config <clave> <valor> | /config guardar");
+            }
+
+        } else if (cmd == "/pid" || cmd.startsWith("/pid ")) {
+            display.setTelegramCmd(cmd);
+            // /pid <lazo> <param> [valor] [zona]
+            String args[4];
+            int n = 0;
+            int from = cmd.indexOf(' ');
+            while (from > 0 && n < 4) {
+                int to = cmd.indexOf(' ', from + 1);
+                args[n++] = to > 0 ? cmd.substring(from + 1, to) : cmd.substring(from + 1);
+                from = to;
+            }
+            bool onOff = args[1] == "on" || args[1] == "off";
+            bool listOne = n == 1 && isdigit((unsigned char)args[0].charAt(0));  // /pid <zona>
+            String zoneArg = listOne ? args[0] : onOff ? args[2] : args[3];
+            uint8_t zone = zoneArg.isEmpty() ? 0 : (uint8_t)zoneArg.toInt();
+
+            if (zone >= ActuatorNetwork::MAX_ZONES) {
+                bot.sendMessage("⚠️ Zona no válida.");
+            } else if (n == 0 || listOne) {
+                // Todas las zonas con actuadores (la 0 siempre) o solo la pedida
+                String msg = "";
+                for (uint8_t z = 0; z < ActuatorNetwork::MAX_ZONES; z++) {
+                    if (listOne ? z != zone : z > 0 && !zoneHasChannels(z)) continue;
+                    portENTER_CRITICAL(&dataMux);
+                    ControlLoops loops = controlLoops[z];
+                    portEXIT_CRITICAL(&dataMux);
+                    msg += "📍 Zona " + String(z) + " - " + loops.getStatus() + "\n";
+                }
+                bot.sendMessage(msg);
+            } else {
+                float value = args[2].toFloat();
+                portENTER_CRITICAL(&dataMux);
+                bool ok = (onOff || n >= 3) && controlLoops[zone].updateFromCommand(args[0], args[1], value);
+                ControlLoops loops = controlLoops[zone];
+                portEXIT_CRITICAL(&dataMux);
+                if (ok) config.capturePid(zone, loops);
+                bot.sendMessage(ok ? loops.getStatus()
+                                   : String("⚠️ Uso: /pid <temp|suelo|luz> <sp|kp|ki|kd|min|max|ts> <valor> [zona] o /pid <lazo> on|off [zona]"));
+            }
+
+        } else if (cmd.startsWith("/horario ") || cmd.startsWith("/temporizador ")) {
+            display.setTelegramCmd(cmd);
+            // Se interpreta y se responde fuera de la sección crítica; dentro
+            // solo se modifica la tabla y se copian las ventanas
+            ScheduleCommand command;
+            String reply;
+            if (!Scheduler::parseCommand(cmd, command, reply)) {
+                // reply ya trae el uso o el error
+            } else if (command.op != ScheduleCommand::REMOVE && !zoneHasChannels(command.zone)) {
+                // Un horario en una zona sin actuadores no haría nada
+                reply = "⚠️ La zona " + String(command.zone) + " no tiene actuadores; no se añadió.";
+            } else {
+                ScheduleWindow windows[Scheduler::MAX_ENTRIES];
+                portENTER_CRITICAL(&dataMux);
+                int result = scheduler.apply(command, rtc.getCachedUnixTime());
+                uint8_t count = scheduler.exportWindows(windows);
+                portEXIT_CRITICAL(&dataMux);
+                if (command.op != ScheduleCommand::ADD_TIMER && result > 0) config.captureSchedule(windows, count);
+                reply = Scheduler::describeResult(command, result);
+            }
+            bot.sendMessage(reply);
+
+        } else if (cmd == "/horarios") {
+            display.setTelegramCmd(cmd);
+            static Scheduler snapshot;   // solo la usa esta tarea
+            portENTER_CRITICAL(&dataMux);
+            snapshot = scheduler;
+            portEXIT_CRITICAL(&dataMux);
+            bot.sendMessage(snapshot.format(rtc.getCachedUnixTime()));
 
         } else if (cmd == "/umbrales") {
             display.setTelegramCmd(cmd);
@@ -167,20 +978,89 @@ void TelegramReceiverTask(void* pvParameters) {
 
         } else if (cmd.startsWith("/activar ") || cmd.startsWith("/desactivar ")) {
             display.setTelegramCmd(cmd);
-            portENTER_CRITICAL(&dataMux);
-            if (cmd.endsWith("bomba")) actuatorState.waterPump = cmd.startsWith("/activar ") ? 1 : 0;
-            else if (cmd.endsWith("ventilador")) actuatorState.fan = cmd.startsWith("/activar ") ? 1 : 0;
-            else if (cmd.endsWith("luces")) actuatorState.leds = cmd.startsWith("/activar ") ? 1 : 0;
-            actuatorSender.sendData(actuatorState);
-            portEXIT_CRITICAL(&dataMux);
-            bot.sendMessage("✅ Actuador actualizado.");
+            ActuatorRole role;
+            uint8_t zone;
+            if (parseActuatorCommand(cmd, role, zone)) {
+                uint8_t level = cmd.startsWith("/activar ") ? ACTUATOR_VALUE_ON : 0;
+                portENTER_CRITICAL(&dataMux);
+                if (role == ROLE_PUMP) zoneStates[zone].waterPump = level;
+                else if (role == ROLE_FAN) zoneStates[zone].fan = level;
+                else if (role == ROLE_LIGHT) zoneStates[zone].leds = level;
+                ActuatorState state = zoneStates[zone];
+                portEXIT_CRITICAL(&dataMux);
+                actuators.setRole(zone, role, level);
+                actuators.flush();
+                trace.recordActuatorCommand(zone, state);
+                telemetry.publishActuators(zone, state);
+                bot.sendMessage("✅ Actuador actualizado.");
+            } else {
+                bot.sendMessage("⚠️ Uso: /activar <bomba|ventilador|luces> [zona]");
+            }
+
+        } else if (cmd.startsWith("/canal ")) {
+            display.setTelegramCmd(cmd);
+            int firstSpace = cmd.indexOf(' ');
+            int secondSpace = cmd.indexOf(' ', firstSpace + 1);
+            int value = secondSpace > 0 ? cmd.substring(secondSpace + 1).toInt() : -1;
+            if (value >= 0 && value <= 255 &&
+                actuators.setChannel(cmd.substring(firstSpace + 1, secondSpace).toInt(), value)) {
+                actuators.flush();
+                bot.sendMessage("✅ Canal actualizado.");
+            } else {
+                bot.sendMessage("⚠️ Uso: /canal <n> <0-255> (ver /canales)");
+            }
+
+        } else if (cmd == "/nodo" || cmd.startsWith("/nodo ")) {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage(handleNodeConfigCommand(cmd));
+
+        } else if (cmd == "/ota" || cmd.startsWith("/ota ")) {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage(handleOtaCommand(cmd));
+
+        } else if (cmd == "/cola") {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage("📦 Cola de salida: " + String(spool.pending()) + " mensajes pendientes, " +
+                            String(spool.dropped()) + " descartados por cola llena.");
+
+        } else if (cmd == "/rutas") {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage(receiver.getPaths().format());
+
+        } else if (cmd == "/enlaces") {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage(links.format());
+
+        } else if (cmd == "/sd") {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage(retention.formatStatus());
+
+        } else if (cmd == "/wifi") {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage(wifi.formatStatus());
+
+        } else if (cmd == "/canales") {
+            display.setTelegramCmd(cmd);
+            bot.sendMessage(actuators.formatChannels());
+
+        } else if (cmd == "/traza on" || cmd == "/traza off") {
+            display.setTelegramCmd(cmd);
+            trace.setEnabled(cmd.endsWith("on"));
+            bot.sendMessage(trace.isEnabled() ? "🎞️ Grabación de traza activada." : "🎞️ Grabación de traza detenida.");
 
         } else if (cmd == "/actuadores") {
             display.setTelegramCmd(cmd);
-            portENTER_CRITICAL(&dataMux);
-            ActuatorState state = actuatorState; 
-            portEXIT_CRITICAL(&dataMux);
-            bot.sendMessage("🔌 Estado:\n" + thresholds.formatActuatorState(state));
+            String msg = "";
+            for (uint8_t zone = 0; zone < ActuatorNetwork::MAX_ZONES; zone++) {
+                if (!zoneHasChannels(zone)) continue;
+                portENTER_CRITICAL(&dataMux);
+                ActuatorState state = zoneStates[zone];
+                portEXIT_CRITICAL(&dataMux);
+                msg += "🔌 Zona " + String(zone) + ":\n" + thresholds.formatActuatorState(state) + "\n";
+                msg += "✅ Aplicado:\n" + thresholds.formatActuatorState(actuators.getZoneApplied(zone)) + "\n\n";
+            }
+            msg += actuators.getLinkStats();
+            bot.sendMessage(msg);
 
         } else if (cmd == "/guia"){
             display.setTelegramCmd(cmd);
@@ -188,10 +1068,34 @@ void TelegramReceiverTask(void* pvParameters) {
             guide += "/datos - Obtener últimos datos de sensores.\n";
             guide += "/estado - Ver estado del sistema y alertas.\n";
             guide += "/umbral <tipo> <valor> - Actualizar umbrales (ej: /umbral suelo_min 40.0).\n";
+            guide += "/umbral temp_banda|co2_banda|luz_banda <valor> - Banda del control proporcional.\n";
             guide += "/umbrales - Mostrar umbrales actuales.\n";
-            guide += "/activar <actuador> - Activar un actuador (bomba, ventilador, luces).\n";
-            guide += "/desactivar <actuador> - Desactivar un actuador (bomba, ventilador, luces).\n";
-            guide += "/actuadores - Mostrar estado de los actuadores.\n";
+            guide += "/config - Ver la configuración guardada (exportar todo: incluye claves).\n";
+            guide += "/config <clave> <valor> - Cambiar un parámetro (umbral, canal, actuador0, ssid, clave_wifi, token, chat, sd_max_mb, sd_libre_mb).\n";
+            guide += "/config importar k=v;k=v - Importar una configuración exportada.\n";
+            guide += "/horarios - Ver fotoperiodo, ventanas de riego y temporizadores.\n";
+            guide += "/horario luz|riego HH:MM-HH:MM [zona] - Añadir una ventana diaria.\n";
+            guide += "/horario borrar <id> - Borrar un horario.\n";
+            guide += "/temporizador <actuador> <minutos> [nivel] [zona] - Forzar un actuador un tiempo.\n";
+            guide += "/pid [zona] - Estado de los lazos PID (temp, suelo, luz) de cada zona o de una.\n";
+            guide += "/pid <lazo> <sp|kp|ki|kd|min|max|ts> <valor> [zona] - Ajustar un lazo.\n";
+            guide += "/pid <lazo> on|off [zona] - Activar el PID en lugar del control por umbrales.\n";
+            guide += "/activar <actuador> [zona] - Activar un actuador (bomba, ventilador, luces).\n";
+            guide += "/desactivar <actuador> [zona] - Desactivar un actuador (bomba, ventilador, luces).\n";
+            guide += "/actuadores - Mostrar estado de los actuadores por zona.\n";
+            guide += "/canales - Tabla de canales de los nodos actuadores.\n";
+            guide += "/canal <n> <0-255> - Fijar un canal concreto.\n";
+            guide += "/nodo - Nodos sensores y parámetros que se pueden cambiar a distancia.\n";
+            guide += "/nodo <n|MAC|todos> <clave> <valor> ... - Calibración, periodo y envío (ej: /nodo todos periodo 5000).\n";
+            guide += "/nodo <n|MAC|todos> leer - Configuración actual de los nodos.\n";
+            guide += "/ota <sensores|actuadores> <archivo> <versión> [n|MAC] - Actualizar el firmware de los nodos con una imagen de /ota/ en la SD.\n";
+            guide += "/ota - Progreso de la actualización; /ota cancelar - Detenerla.\n";
+            guide += "/rutas - Camino de cada nodo sensor (directo o por relevo), pérdidas y latencia.\n";
+            guide += "/enlaces - RSSI, pérdidas y potencia de emisión de cada nodo.\n";
+            guide += "/wifi - Estado de la conexión WiFi y reconexiones.\n";
+            guide += "/cola - Alertas y resúmenes pendientes de enviar tras una desconexión.\n";
+            guide += "/sd - Espacio en la SD, días archivados y borrados.\n";
+            guide += "/traza on|off - Grabar tramas y comandos en la SD.\n";
             bot.sendMessage(guide);
 
         } else{
@@ -208,10 +1112,12 @@ void TelegramReceiverTask(void* pvParameters) {
 // Tarea 3: guardar en SD
 void SDLoggerTask(void* pvParameters) {
     int systemState = 0; // Estado del sistema (0: Todo OK, 1: Fallo conectividad, 2: Sensor desbordado, 3: Falla crítica)
+    unsigned long loggedMs[ActuatorNetwork::MAX_ZONES] = {};   // adquisición de la última fila de cada zona
     while (true) {
+        ZoneSample samples[ActuatorNetwork::MAX_ZONES];
         portENTER_CRITICAL(&dataMux);
-        bool available = hasData;
-        SensorData copy = lastReceivedData;
+        uint16_t zones = decidedZones;
+        memcpy(samples, zoneSamples, sizeof(samples));
         portEXIT_CRITICAL(&dataMux);
 
         if (thresholds.alertESPActuator || thresholds.alertWifi || thresholds.alertESPSensor) {
@@ -223,10 +1129,21 @@ void SDLoggerTask(void* pvParameters) {
         } else {
             systemState = 0; // Todo OK
         }
- 
-        if (available) {
-            String timestamp = rtc.getTimestamp();
-            logger.logSensorData(timestamp, "NODE_1", wifi.getRSSI(), copy, systemState);
+
+        // Una fila por zona y muestra, con su hora de adquisición
+        for (uint8_t zone = 0; zones >> zone; zone++) {
+            const ZoneSample& sample = samples[zone];
+            if (!(zones >> zone & 1) || sample.sampleMs == loggedMs[zone]) continue;
+            loggedMs[zone] = sample.sampleMs;
+            uint32_t now = rtc.getCachedUnixTime();
+            if (!sample.unusable) {   // el resumen solo con muestras limpias
+                portENTER_CRITICAL(&dataMux);
+                offlineSummary.add(sample.data, now);
+                portEXIT_CRITICAL(&dataMux);
+            }
+
+            String timestamp = rtc.getTimestampAt(sample.sampleMs);
+            logger.logSensorData(timestamp, "ZONA_" + String(zone), wifi.getRSSI(), sample.data, systemState, sample.unusable);
         }
 
         vTaskDelay(10000 / portTICK_PERIOD_MS);
@@ -237,11 +1154,60 @@ void SDLoggerTask(void* pvParameters) {
     }
 }
 
-// Tarea 4: actualizar RTC
+// Tarea 3b: volcar la traza a la SD (el buffer en RAM cubre unos segundos)
+void TraceFlushTask(void* pvParameters) {
+    while (true) {
+        if (trace.isEnabled()) {
+            trace.flush(rtc.getTimestamp(), rtc.getUnixTime());
+        }
+        vTaskDelay(2000 / portTICK_PERIOD_MS);
+    }
+}
+
+// Tarea 3c: escribir a NVS la configuración modificada (con retardo, ver
+// ConfigStore). Aparte de la traza, para que una SD lenta no la retrase, y
+// del control, para que la escritura a flash no retrase el tick
+void ConfigCommitTask(void* pvParameters) {
+    while (true) {
+        config.update();
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+    }
+}
+
+// Tarea: mantenimiento de la SD. Prioridad 0 (por debajo de todas): el
+// registro nunca espera por ella; los límites se leen en cada pasada para
+// que /config sd_max_mb se aplique sin reiniciar
+void RetentionTask(void* pvParameters) {
+    vTaskDelay(30000 / portTICK_PERIOD_MS);   // que el RTC tenga hora
+    while (true) {
+        const EdgeConfig& cfg = config.get();
+        retention.setLimits(cfg.sdBudgetMb, cfg.sdMinFreeMb);
+        vTaskDelay(retention.update(rtc.getTimestamp()) / portTICK_PERIOD_MS);
+    }
+}
+
+// Tarea: reparto de firmware; solo trabaja (y a ritmo de la radio) durante /ota
+void OtaTask(void* pvParameters) {
+    while (true) {
+        firmware.update();
+        vTaskDelay((firmware.active() ? 2 : 250) / portTICK_PERIOD_MS);
+    }
+}
+
+// Tarea 4: actualizar RTC (en cuanto hay WiFi y luego cada 30 min; si
+// falla, se reintenta al minuto)
 void RTCUpdateTask(void* pvParameters) {
+    bool synced = false;
+    unsigned long lastAttempt = 0;
+    bool attempted = false;
     while (true) {
-        syncRtcWithNTP();
-        vTaskDelay(1800000 / portTICK_PERIOD_MS);
+        unsigned long wait = synced ? 1800000UL : 60000UL;
+        if (wifi.isConnected() && (!attempted || millis() - lastAttempt >= wait)) {
+            synced = syncRtcWithNTP();
+            lastAttempt = millis();
+            attempted = true;
+        }
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
     }
 }
 
@@ -261,11 +1227,22 @@ void checkRtcTime(void* pvParameters) {
             Serial.println("⏰ Hora RTC inválida, sincronizando con NTP...");
             syncRtcWithNTP();
         }
+        rtc.refreshCache();  // hora usada por los horarios
 
         vTaskDelay(60000 / portTICK_PERIOD_MS); // Verificar cada minuto
     }
 }
 
+// Tarea 7: API HTTP local y flujo de eventos; arranca en cuanto hay WiFi
+void LocalApiTask(void* pvParameters) {
+    while (true) {
+        if (!api.isStarted() && wifi.isConnected()) api.begin();
+        api.update();
+        telemetry.update();
+        vTaskDelay(20 / portTICK_PERIOD_MS);
+    }
+}
+
 // Tarea 6: actualizar pantalla OLED
 void DisplayTask(void* pvParameters) {
     pinMode(BUTTON_PIN, INPUT_PULLUP);
@@ -288,32 +1265,68 @@ void setup() {
     Serial.begin(115200);
     delay(1000);
 
-    if (!wifi.connect()) {
-        Serial.println("🚫 WiFi no disponible.");
-        while (true);
-    }
+    EdgeConfig defaults = ConfigStore::makeDefaults(thresholds, ESPNOW_CHANNEL, ssid, password, botToken, chatId);
+    memcpy(defaults.actuatorMacs[0], actuatorMAC, 6);
+    defaults.actuatorCount = 1;
+    config.begin(defaults);
+
+    const EdgeConfig& cfg = config.get();
+    config.applyThresholds(thresholds);
+    config.applyPid(controlLoops, ActuatorNetwork::MAX_ZONES);
+    config.applySchedule(scheduler);
+    wifi.setCredentials(cfg.wifiSsid, cfg.wifiPassword);
+    bot.setCredentials(cfg.botToken, cfg.chatId);
+
+    // El WiFi conecta en segundo plano (WiFiTask): el control local no
+    // espera al AP. ESP-NOW arranca en el último canal conocido del AP y
+    // la baliza lo corrige si al conectar resulta ser otro.
+    wifi.setChannelHint(cfg.espNowChannel);
+    wifi.setRadioChannel([]() { return beacon.getChannel(); });
+    wifi.begin();
+    uint8_t espNowChannel = cfg.espNowChannel;
+    receiver.setChannel(espNowChannel);
+    actuators.setEspNowChannel(espNowChannel);
 
-    thresholds.RSSIWiFi = wifi.getRSSI();
- 
     rtc.begin();
-    syncRtcWithNTP();
 
     if (!logger.begin()) {
         Serial.println("⚠️ Error al iniciar SD");
     }
+    spool.begin();
 
     receiver.begin();
-    actuatorSender.begin();
+    sensorConfig.setTransport(sendToNode);
+    firmware.setTransport(sendToNode);
+    links.setTransport(sendToNode);
+    linkRssi.begin();
+    setupActuatorTable(cfg);
+    actuators.begin();
+    beacon.begin(espNowChannel);
 
     display.begin();
     display.mostrarPagina(); 
 
+    api.on("/api/nodos", apiNodes);
+    api.on("/api/actuadores", apiActuators);
+    api.on("/api/umbrales", apiThresholds);
+    api.on("/api/metricas", apiMetrics);
+    api.on("/api/historial", apiHistory);
+    api.onStream("/api/eventos", [](const ApiRequest&, WiFiClient& client) { return telemetry.attach(client); });
+
+    xTaskCreatePinnedToCore(WiFiTask, "WiFi", 3072, NULL, 1, NULL, 1);
     xTaskCreatePinnedToCore(ReceiveDataTask, "ReceiveData", 4096, NULL, 1, NULL, 0);
     xTaskCreatePinnedToCore(TelegramReceiverTask, "Telegram", 4096, NULL, 1, NULL, 1);
     xTaskCreatePinnedToCore(SDLoggerTask, "SDLogger", 4096, NULL, 1, NULL, 0);
+    xTaskCreatePinnedToCore(TraceFlushTask, "TraceFlush", 3072, NULL, 1, NULL, 0);
+    xTaskCreatePinnedToCore(ConfigCommitTask, "ConfigCommit", 3072, NULL, 1, NULL, 0);
     xTaskCreatePinnedToCore(RTCUpdateTask, "RTCUpdate", 4096, NULL, 1, NULL, 1);
     xTaskCreatePinnedToCore(checkRtcTime, "CheckRTC", 2048, NULL, 1, NULL, 1);
     xTaskCreatePinnedToCore(DisplayTask, "Display", 4096, NULL, 1, NULL, 1);
+    xTaskCreatePinnedToCore(OtaTask, "Ota", 4096, NULL, 1, NULL, 0);
+    xTaskCreatePinnedToCore(RetentionTask, "Retencion", 4096, NULL, 0, NULL, 0);
+    if (cfg.apiEnabled) {
+        xTaskCreatePinnedToCore(LocalApiTask, "LocalApi", 4096, NULL, 1, NULL, 0);
+    }
 
     Serial.println("✅ Sistema iniciado.");
 }
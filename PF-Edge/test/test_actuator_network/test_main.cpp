@@ -0,0 +1,156 @@
+// Tabla de actuadores del Edge (ActuatorNetwork.h): la decisión de una
+// zona se reparte por la tabla de canales a cada nodo (relé solo ON/OFF),
+// los ACK se entregan al nodo de su MAC y el estado confirmado de la zona
+// sale de los valores aplicados. Los comandos salen por el aire simulado
+// del host (HostRadio); los ACK se entregan a mano.
+//   pio test -e native -f test_actuator_network
+#include <unity.h>
+#include <map>
+#include <vector>
+#include "ActuatorNetwork.h"
+
+static const uint8_t NODE_A[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xA1};
+static const uint8_t NODE_B[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xB1};
+
+static std::mutex sentMutex;
+static std::map<HostRadio::Mac, std::vector<ActuatorCommand>> sent;
+static ActuatorNetwork* network = nullptr;
+
+static void listen(const uint8_t* mac) {
+    HostRadio::Mac to = HostRadio::toMac(mac);
+    HostRadio::attach(mac, [to](const uint8_t*, const uint8_t* data, int len) {
+        ActuatorCommand cmd;
+        if (!decodeChannelFrame(data, len, ACTUATOR_FRAME_CMD, cmd)) return;
+        std::lock_guard<std::mutex> lock(sentMutex);
+        sent[to].push_back(cmd);
+    });
+}
+
+// Las entregas van por el hilo del aire: espera a que `mac` tenga `count`
+// comandos (o un tiempo máximo)
+static std::vector<ActuatorCommand> waitFor(const uint8_t* mac, size_t count) {
+    std::vector<ActuatorCommand> out;
+    for (int i = 0; i < 100; i++) {
+        delay(5);
+        std::lock_guard<std::mutex> lock(sentMutex);
+        out = sent[HostRadio::toMac(mac)];
+        if (out.size() >= count) break;
+    }
+    return out;
+}
+
+// Valor de un canal en un comando (-1 si no va)
+static int valueOf(const ActuatorCommand& cmd, uint8_t channel) {
+    for (uint8_t k = 0; k < cmd.count; k++) {
+        if (cmd.values[k].channel == channel) return cmd.values[k].value;
+    }
+    return -1;
+}
+
+// El nodo confirma todo lo que se le pidió
+static bool ackAll(const uint8_t* mac, const ActuatorCommand& cmd) {
+    ActuatorAck ack;
+    ack.seq = cmd.seq;
+    ack.count = cmd.count;
+    memcpy(ack.values, cmd.values, sizeof(ChannelValue) * cmd.count);
+    return network->handleFrame(mac, (const uint8_t*)&ack, ack.frameLength());
+}
+
+void setUp() {
+    delay(20);   // lo que quede en el aire de la prueba anterior
+    {
+        std::lock_guard<std::mutex> lock(sentMutex);
+        sent.clear();
+    }
+    network = new ActuatorNetwork(1);
+    network->addNode(NODE_A);
+    network->addNode(NODE_B);
+    network->addChannel(0, 0, CHANNEL_RELAY, 1, ROLE_PUMP);
+    network->addChannel(0, 1, CHANNEL_PWM, 1, ROLE_FAN);
+    network->addChannel(1, 0, CHANNEL_LED, 1, ROLE_LIGHT);
+    network->addChannel(1, 2, CHANNEL_RELAY, 2, ROLE_PUMP);
+    network->begin();
+}
+
+void tearDown() {
+    delete network;
+    network = nullptr;
+}
+
+void test_table_rejects_bad_channels() {
+    TEST_ASSERT_FALSE(network->addChannel(2, 0, CHANNEL_RELAY, 1, ROLE_PUMP));   // nodo inexistente
+    TEST_ASSERT_FALSE(network->addChannel(0, 1, CHANNEL_RELAY, 1, ROLE_PUMP));   // id repetido
+    TEST_ASSERT_FALSE(network->addChannel(0, 5, CHANNEL_RELAY, ActuatorNetwork::MAX_ZONES, ROLE_PUMP));
+    TEST_ASSERT_EQUAL_UINT8(4, network->getChannelCount());
+}
+
+void test_zone_state_is_routed_by_table() {
+    ActuatorState state;
+    state.waterPump = 100;
+    state.fan = 128;
+    state.leds = 60;
+    TEST_ASSERT_TRUE(network->applyZoneState(1, state));
+
+    std::vector<ActuatorCommand> a = waitFor(NODE_A, 1);
+    std::vector<ActuatorCommand> b = waitFor(NODE_B, 1);
+    TEST_ASSERT_EQUAL_UINT(1, a.size());
+    TEST_ASSERT_EQUAL_UINT(1, b.size());
+    TEST_ASSERT_EQUAL_INT(255, valueOf(a[0], 0));   // relé: cualquier nivel es ON
+    TEST_ASSERT_EQUAL_INT(128, valueOf(a[0], 1));
+    TEST_ASSERT_EQUAL_INT(60, valueOf(b[0], 0));
+    TEST_ASSERT_EQUAL_INT(0, valueOf(b[0], 2));     // zona 2: aún sin confirmar, va apagado
+}
+
+void test_acks_go_to_their_node() {
+    ActuatorState state;
+    state.waterPump = 255;
+    state.leds = 255;
+    network->applyZoneState(1, state);
+    std::vector<ActuatorCommand> a = waitFor(NODE_A, 1);
+    std::vector<ActuatorCommand> b = waitFor(NODE_B, 1);
+
+    TEST_ASSERT_TRUE(ackAll(NODE_B, b[0]));
+    TEST_ASSERT_FALSE(network->getNode(1).isAckPending());
+    TEST_ASSERT_TRUE(network->getNode(0).isAckPending());
+    TEST_ASSERT_FALSE(network->allConnected());
+
+    // El mismo ACK desde una MAC que no está en la tabla no es de nadie
+    static const uint8_t STRANGER[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xC1};
+    TEST_ASSERT_FALSE(ackAll(STRANGER, a[0]));
+    TEST_ASSERT_TRUE(network->getNode(0).isAckPending());
+
+    TEST_ASSERT_TRUE(ackAll(NODE_A, a[0]));
+    TEST_ASSERT_TRUE(network->allConnected());
+    ActuatorState applied = network->getZoneApplied(1);
+    TEST_ASSERT_EQUAL_UINT8(255, applied.waterPump);
+    TEST_ASSERT_EQUAL_UINT8(0, applied.fan);
+    TEST_ASSERT_EQUAL_UINT8(255, applied.leds);
+
+    // Solo cambia la luz: a A no le llega nada
+    state.leds = 40;
+    TEST_ASSERT_TRUE(network->applyZoneState(1, state));
+    TEST_ASSERT_EQUAL_UINT(2, waitFor(NODE_B, 2).size());
+    TEST_ASSERT_EQUAL_UINT(1, waitFor(NODE_A, 2).size());
+}
+
+void test_manual_role_and_channel() {
+    network->setRole(2, ROLE_PUMP, 10);
+    TEST_ASSERT_EQUAL_INT(255, network->getNode(1).getDesiredValue(2));
+    TEST_ASSERT_TRUE(network->setChannel(1, 77));   // índice global 1: A/1 (PWM)
+    TEST_ASSERT_EQUAL_INT(77, network->getNode(0).getDesiredValue(1));
+    TEST_ASSERT_FALSE(network->setChannel(4, 1));
+}
+
+int main() {
+    listen(NODE_A);
+    listen(NODE_B);
+    UNITY_BEGIN();
+    RUN_TEST(test_table_rejects_bad_channels);
+    RUN_TEST(test_zone_state_is_routed_by_table);
+    RUN_TEST(test_acks_go_to_their_node);
+    RUN_TEST(test_manual_role_and_channel);
+    int failures = UNITY_END();
+    fflush(stdout);
+    // El hilo del aire no termina: salir sin destructores
+    std::_Exit(failures);
+}
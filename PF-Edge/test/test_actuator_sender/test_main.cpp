@@ -0,0 +1,202 @@
+// Envío fiable a un nodo actuador (ESPNowSender.h): secuencia y ACK,
+// reintentos con backoff exponencial hasta rendirse y enlace caído sin
+// ACK, envío solo de cambios y latido, y salud del enlace a partir de los
+// valores confirmados. Los comandos salen por el aire simulado del host
+// (HostRadio); los ACK se entregan a mano.
+//   pio test -e native -f test_actuator_sender
+#include <unity.h>
+#include <vector>
+#include "ESPNowSender.h"
+
+static const uint8_t NODE[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xA1};
+static const uint8_t OTHER[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xA2};
+
+static std::mutex sentMutex;
+static std::vector<ActuatorCommand> sent;
+static ESPNowActuatorSender* sender = nullptr;
+
+static void listen() {
+    HostRadio::attach(NODE, [](const uint8_t*, const uint8_t* data, int len) {
+        ActuatorCommand cmd;
+        if (!decodeChannelFrame(data, len, ACTUATOR_FRAME_CMD, cmd)) return;
+        std::lock_guard<std::mutex> lock(sentMutex);
+        sent.push_back(cmd);
+    });
+}
+
+// Las entregas van por el hilo del aire: espera a que haya `count` comandos
+// (o un tiempo máximo)
+static std::vector<ActuatorCommand> waitFor(size_t count) {
+    std::vector<ActuatorCommand> out;
+    for (int i = 0; i < 100; i++) {
+        delay(5);
+        std::lock_guard<std::mutex> lock(sentMutex);
+        out = sent;
+        if (out.size() >= count) break;
+    }
+    return out;
+}
+
+static bool ack(uint16_t seq, std::initializer_list<ChannelValue> values, const uint8_t* mac = NODE) {
+    ActuatorAck a;
+    a.seq = seq;
+    for (const ChannelValue& v : values) a.values[a.count++] = v;
+    return sender->handleFrame(mac, (const uint8_t*)&a, a.frameLength());
+}
+
+void setUp() {
+    delay(20);   // lo que quede en el aire de la prueba anterior
+    {
+        std::lock_guard<std::mutex> lock(sentMutex);
+        sent.clear();
+    }
+    sender = new ESPNowActuatorSender();
+    sender->setPeer(NODE, 1);
+    sender->begin();
+    sender->addChannel(0);
+    sender->addChannel(3);
+}
+
+void tearDown() {
+    delete sender;
+    sender = nullptr;
+}
+
+void test_command_and_ack() {
+    sender->setChannel(0, 255);
+    TEST_ASSERT_TRUE(sender->flush());
+    std::vector<ActuatorCommand> cmds = waitFor(1);
+    TEST_ASSERT_EQUAL_UINT(1, cmds.size());
+    TEST_ASSERT_EQUAL_UINT8(ACTUATOR_FRAME_CMD, cmds[0].type);
+    // Nada confirmado aún: van los dos canales
+    TEST_ASSERT_EQUAL_UINT8(2, cmds[0].count);
+    TEST_ASSERT_TRUE(sender->isAckPending());
+    TEST_ASSERT_FALSE(sender->isPeerConnected());
+
+    TEST_ASSERT_TRUE(ack(cmds[0].seq, {{0, 255}, {3, 0}}));
+    TEST_ASSERT_FALSE(sender->isAckPending());
+    TEST_ASSERT_TRUE(sender->isPeerConnected());
+    TEST_ASSERT_EQUAL_INT(255, sender->getAppliedValue(0));
+    TEST_ASSERT_EQUAL_INT(0, sender->getAppliedValue(3));
+
+    // El siguiente lleva la secuencia siguiente y solo el canal que cambia
+    sender->setChannel(3, 128);
+    TEST_ASSERT_TRUE(sender->flush());
+    cmds = waitFor(2);
+    TEST_ASSERT_EQUAL_UINT(2, cmds.size());
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(cmds[0].seq + 1), cmds[1].seq);
+    TEST_ASSERT_EQUAL_UINT8(1, cmds[1].count);
+    TEST_ASSERT_EQUAL_UINT8(3, cmds[1].values[0].channel);
+    TEST_ASSERT_EQUAL_UINT8(128, cmds[1].values[0].value);
+}
+
+void test_retries_back_off_then_give_up() {
+    sender->setChannel(0, 255);
+    sender->flush();
+    sender->update();   // antes de RETRY_BASE_MS: nada
+    TEST_ASSERT_EQUAL_UINT32(0, sender->getRetries());
+
+    // 60, 120, 240, 480 y 960 ms entre intentos
+    unsigned long gap = 60;
+    for (int retry = 1; retry <= 5; retry++) {
+        HostClock::advance(gap / 2);
+        sender->update();
+        TEST_ASSERT_EQUAL_UINT32(retry - 1, sender->getRetries());
+        HostClock::advance(gap - gap / 2);
+        sender->update();
+        TEST_ASSERT_EQUAL_UINT32(retry, sender->getRetries());
+        gap *= 2;
+    }
+    std::vector<ActuatorCommand> cmds = waitFor(6);
+    TEST_ASSERT_EQUAL_UINT(6, cmds.size());
+    for (const ActuatorCommand& c : cmds) TEST_ASSERT_EQUAL_UINT16(cmds[0].seq, c.seq);
+
+    // Tras el sexto intento sin ACK se rinde y el enlace cae
+    TEST_ASSERT_TRUE(sender->isAckPending());
+    HostClock::advance(gap);
+    sender->update();
+    TEST_ASSERT_FALSE(sender->isAckPending());
+    TEST_ASSERT_EQUAL_UINT32(1, sender->getTimeouts());
+    TEST_ASSERT_FALSE(sender->isPeerConnected());
+    TEST_ASSERT_EQUAL_UINT(6, waitFor(7).size());
+}
+
+void test_ack_for_other_seq_or_node() {
+    sender->setChannel(0, 255);
+    sender->flush();
+    std::vector<ActuatorCommand> cmds = waitFor(1);
+    TEST_ASSERT_FALSE(ack(cmds[0].seq, {{0, 255}}, OTHER));
+    TEST_ASSERT_TRUE(sender->isAckPending());
+
+    // Un ACK atrasado informa de los valores pero no cierra el comando
+    TEST_ASSERT_TRUE(ack((uint16_t)(cmds[0].seq - 1), {{0, 0}}));
+    TEST_ASSERT_TRUE(sender->isAckPending());
+    TEST_ASSERT_EQUAL_INT(0, sender->getAppliedValue(0));
+}
+
+void test_unchanged_state_is_not_sent() {
+    sender->setChannel(0, 255);
+    sender->flush();
+    std::vector<ActuatorCommand> cmds = waitFor(1);
+    // El mismo comando aún sin ACK no se vuelve a mandar
+    TEST_ASSERT_FALSE(sender->flush());
+    ack(cmds[0].seq, {{0, 255}, {3, 0}});
+
+    sender->setChannel(0, 255);
+    TEST_ASSERT_FALSE(sender->flush());
+    TEST_ASSERT_EQUAL_UINT32(2, sender->getSuppressed());
+    TEST_ASSERT_EQUAL_UINT32(1, sender->getCommands());
+    TEST_ASSERT_EQUAL_UINT(1, waitFor(2).size());
+}
+
+void test_heartbeat_resends_all_channels() {
+    sender->setChannel(0, 255);
+    sender->flush();
+    std::vector<ActuatorCommand> cmds = waitFor(1);
+    ack(cmds[0].seq, {{0, 255}, {3, 0}});
+
+    HostClock::advance(20000);
+    sender->update();
+    TEST_ASSERT_EQUAL_UINT(1, waitFor(2).size());
+
+    HostClock::advance(10000);
+    sender->update();
+    cmds = waitFor(2);
+    TEST_ASSERT_EQUAL_UINT(2, cmds.size());
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(cmds[0].seq + 1), cmds[1].seq);
+    TEST_ASSERT_EQUAL_UINT8(2, cmds[1].count);   // también los ya confirmados
+    TEST_ASSERT_TRUE(sender->isAckPending());
+}
+
+void test_link_health_follows_applied_values() {
+    sender->setChannel(0, 255);
+    sender->setChannel(3, 200);
+    sender->flush();
+    std::vector<ActuatorCommand> cmds = waitFor(1);
+    // PWM cuantizado en el nodo: basta con que coincida ON/OFF
+    ack(cmds[0].seq, {{0, 255}, {3, 198}});
+    TEST_ASSERT_TRUE(sender->isPeerConnected());
+
+    // El nodo confirma pero no aplicó (canal apagado): enlace no sano
+    sender->setChannel(3, 0);
+    sender->setChannel(0, 0);
+    sender->flush();
+    cmds = waitFor(2);
+    ack(cmds[1].seq, {{0, 255}, {3, 0}});
+    TEST_ASSERT_FALSE(sender->isPeerConnected());
+}
+
+int main() {
+    listen();
+    UNITY_BEGIN();
+    RUN_TEST(test_command_and_ack);
+    RUN_TEST(test_retries_back_off_then_give_up);
+    RUN_TEST(test_ack_for_other_seq_or_node);
+    RUN_TEST(test_unchanged_state_is_not_sent);
+    RUN_TEST(test_heartbeat_resends_all_channels);
+    RUN_TEST(test_link_health_follows_applied_values);
+    int failures = UNITY_END();
+    fflush(stdout);
+    // El hilo del aire no termina: salir sin destructores
+    std::_Exit(failures);
+}
@@ -0,0 +1,164 @@
+// Configuración en NVS (ConfigBlob.h, ConfigStore.h): migración de los
+// bloques v1..v4 sobre los valores de fábrica (con el relleno final de v1
+// donde cae apiEnabled), el bloque actual tal cual y rechazo por CRC.
+//   pio test -e native -f test_config_blob
+#include <unity.h>
+#include <cstddef>
+#include "ConfigStore.h"
+
+typedef ConfigBlob<EdgeConfig> Blob;
+
+static EdgeConfig defaults;
+
+// Tamaño del struct de una versión: hasta su último campo, alineado como EdgeConfig
+static size_t layoutSize(size_t end) { return (end + alignof(EdgeConfig) - 1) & ~(alignof(EdgeConfig) - 1); }
+
+static const size_t V1_SIZE = layoutSize(offsetof(EdgeConfig, apiEnabled));
+static const size_t V2_SIZE = layoutSize(offsetof(EdgeConfig, apiEnabled) + 1);
+static const size_t V3_SIZE = layoutSize(offsetof(EdgeConfig, sdMinFreeMb) + 2);
+static const size_t V4_SIZE = layoutSize(offsetof(EdgeConfig, windows));
+
+// Escribe en NVS un bloque de `version` con los primeros `size` bytes de `c`
+static void writeBlob(const EdgeConfig& c, uint16_t version, size_t size) {
+    uint8_t buf[sizeof(Blob::Header) + sizeof(EdgeConfig)];
+    Blob::Header h = {Blob::MAGIC, version, (uint16_t)size, Blob::crc32((const uint8_t*)&c, size)};
+    memcpy(buf, &h, sizeof(h));
+    memcpy(buf + sizeof(h), &c, size);
+    Preferences prefs;
+    prefs.begin("verdevital", false);
+    prefs.putBytes("cfg", buf, sizeof(h) + size);
+    prefs.end();
+}
+
+// Un bloque guardado distinto de los valores de fábrica en todos los campos
+static EdgeConfig saved() {
+    EdgeConfig c = defaults;
+    for (uint8_t i = 0; i < Thresholds::VALUE_COUNT; i++) c.thresholds[i] = defaults.thresholds[i] + 1;
+    c.espNowChannel = 11;
+    strcpy(c.wifiSsid, "invernadero");
+    c.apiEnabled = 0;
+    c.sdBudgetMb = 500;
+    c.sdMinFreeMb = 10;
+    c.pid[2][0].kp = 9.5f;
+    c.windows[0] = {3, SCHEDULE_LIGHT, 1, 0, 7 * 60, 600};
+    c.windowCount = 1;
+    return c;
+}
+
+void setUp() {
+    HostNvs::dir() = "test_nvs";
+    std::filesystem::remove_all("test_nvs");
+    Thresholds t;
+    defaults = ConfigStore::makeDefaults(t, 1, "fabrica", "clave", "token", "chat");
+}
+
+void tearDown() { std::filesystem::remove_all("test_nvs"); }
+
+void test_no_blob_keeps_defaults() {
+    ConfigStore store;
+    TEST_ASSERT_FALSE(store.begin(defaults));
+    TEST_ASSERT_EQUAL_MEMORY(&defaults, &store.get(), sizeof(EdgeConfig));
+    TEST_ASSERT_FALSE(store.isDirty());
+}
+
+void test_v1_takes_defaults_for_new_fields() {
+    EdgeConfig old = saved();
+    old.thresholdCount = 7;      // v1 guardaba menos umbrales
+    old.apiEnabled = 0;          // relleno final de v1 (el CRC lo cubre)
+    writeBlob(old, 1, V1_SIZE);
+
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.begin(defaults));
+    const EdgeConfig& c = store.get();
+    TEST_ASSERT_EQUAL_UINT8(11, c.espNowChannel);
+    TEST_ASSERT_EQUAL_STRING("invernadero", c.wifiSsid);
+    TEST_ASSERT_TRUE(c.thresholds[6] == old.thresholds[6]);
+    TEST_ASSERT_TRUE(c.thresholds[7] == defaults.thresholds[7]);
+    TEST_ASSERT_EQUAL_UINT8(Thresholds::VALUE_COUNT, c.thresholdCount);
+    TEST_ASSERT_EQUAL_UINT8(1, c.apiEnabled);
+    TEST_ASSERT_EQUAL_UINT16(defaults.sdMinFreeMb, c.sdMinFreeMb);
+    TEST_ASSERT_TRUE(c.pid[2][0].kp == defaults.pid[2][0].kp);
+    TEST_ASSERT_EQUAL_UINT8(0, c.windowCount);
+    TEST_ASSERT_TRUE(store.isDirty());   // se reescribe con el esquema actual
+}
+
+void test_v2_keeps_api_flag() {
+    writeBlob(saved(), 2, V2_SIZE);
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.begin(defaults));
+    TEST_ASSERT_EQUAL_UINT8(0, store.get().apiEnabled);
+    TEST_ASSERT_EQUAL_UINT16(defaults.sdBudgetMb, store.get().sdBudgetMb);
+    TEST_ASSERT_EQUAL_UINT16(defaults.sdMinFreeMb, store.get().sdMinFreeMb);
+}
+
+void test_v3_keeps_sd_limits() {
+    writeBlob(saved(), 3, V3_SIZE);
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.begin(defaults));
+    TEST_ASSERT_EQUAL_UINT16(500, store.get().sdBudgetMb);
+    TEST_ASSERT_EQUAL_UINT16(10, store.get().sdMinFreeMb);
+    TEST_ASSERT_TRUE(store.get().pid[2][0].kp == defaults.pid[2][0].kp);
+}
+
+void test_v4_keeps_pid_without_windows() {
+    writeBlob(saved(), 4, V4_SIZE);
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.begin(defaults));
+    TEST_ASSERT_TRUE(store.get().pid[2][0].kp == 9.5f);
+    TEST_ASSERT_EQUAL_UINT8(0, store.get().windowCount);
+}
+
+void test_current_blob_loads_as_is() {
+    EdgeConfig current = saved();
+    writeBlob(current, ConfigStore::CONFIG_VERSION, sizeof(EdgeConfig));
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.begin(defaults));
+    TEST_ASSERT_EQUAL_MEMORY(&current, &store.get(), sizeof(EdgeConfig));
+    TEST_ASSERT_FALSE(store.isDirty());
+
+    // El mismo contenido no vuelve a escribirse
+    unsigned long writes = HostNvs::writes();
+    TEST_ASSERT_TRUE(store.commitNow());
+    TEST_ASSERT_EQUAL_UINT32(writes, HostNvs::writes());
+}
+
+void test_corrupted_blob_is_rejected() {
+    writeBlob(saved(), ConfigStore::CONFIG_VERSION, sizeof(EdgeConfig));
+    Preferences prefs;
+    prefs.begin("verdevital", false);
+    uint8_t buf[sizeof(Blob::Header) + sizeof(EdgeConfig)];
+    size_t len = prefs.getBytes("cfg", buf, sizeof(buf));
+    buf[sizeof(Blob::Header) + 40] ^= 0x01;
+    prefs.putBytes("cfg", buf, len);
+    prefs.end();
+
+    ConfigStore store;
+    TEST_ASSERT_FALSE(store.begin(defaults));
+    TEST_ASSERT_EQUAL_MEMORY(&defaults, &store.get(), sizeof(EdgeConfig));
+}
+
+void test_truncated_blob_is_rejected() {
+    writeBlob(saved(), ConfigStore::CONFIG_VERSION, sizeof(EdgeConfig));
+    Preferences prefs;
+    prefs.begin("verdevital", false);
+    uint8_t buf[sizeof(Blob::Header) + sizeof(EdgeConfig)];
+    size_t len = prefs.getBytes("cfg", buf, sizeof(buf));
+    prefs.putBytes("cfg", buf, len - 4);   // la cabecera dice más bytes de los que hay
+    prefs.end();
+
+    ConfigStore store;
+    TEST_ASSERT_FALSE(store.begin(defaults));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_blob_keeps_defaults);
+    RUN_TEST(test_v1_takes_defaults_for_new_fields);
+    RUN_TEST(test_v2_keeps_api_flag);
+    RUN_TEST(test_v3_keeps_sd_limits);
+    RUN_TEST(test_v4_keeps_pid_without_windows);
+    RUN_TEST(test_current_blob_loads_as_is);
+    RUN_TEST(test_corrupted_blob_is_rejected);
+    RUN_TEST(test_truncated_blob_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,193 @@
+// Receptor de OTA (FirmwareTransfer.h): ventana deslizante, mapa de bits,
+// duplicados, reanudación y verificación del CRC.
+//   pio test -e native -f test_firmware_transfer
+#include <unity.h>
+#include <vector>
+#include "FirmwareTransfer.h"
+
+// Partición en memoria
+struct MemoryStorage {
+    std::vector<uint8_t> image;
+    uint32_t progressSession = 0;
+    uint32_t progressBytes = 0;
+    bool activated = false;
+
+    bool begin(uint32_t session, uint32_t size, uint32_t& resumeBytes) {
+        resumeBytes = session == progressSession ? progressBytes : 0;
+        image.resize(size);
+        return true;
+    }
+    bool write(uint32_t offset, const uint8_t* data, uint16_t len) {
+        if (offset + len > image.size()) return false;
+        memcpy(image.data() + offset, data, len);
+        return true;
+    }
+    bool read(uint32_t offset, uint8_t* data, uint16_t len) {
+        if (offset + len > image.size()) return false;
+        memcpy(data, image.data() + offset, len);
+        return true;
+    }
+    void saveProgress(uint32_t session, uint32_t bytes) {
+        progressSession = session;
+        progressBytes = bytes;
+    }
+    bool activate() { return activated = true; }
+};
+
+static const uint32_t IMAGE_SIZE = 40 * OTA_CHUNK_SIZE + 77;   // último bloque corto
+static std::vector<uint8_t> image;
+static OtaOffer offer;
+static MemoryStorage storage;
+static OtaStatus status;
+
+static OtaReceiver<MemoryStorage>* receiver = nullptr;
+
+static bool sendOffer() {
+    return receiver->handle((const uint8_t*)&offer, sizeof(offer), status);
+}
+
+static bool sendChunk(uint32_t index) {
+    OtaData frame;
+    frame.session = offer.session;
+    frame.index = index;
+    uint32_t offset = index * OTA_CHUNK_SIZE;
+    uint32_t len = offer.size - offset < OTA_CHUNK_SIZE ? offer.size - offset : OTA_CHUNK_SIZE;
+    memcpy(frame.payload, image.data() + offset, len);
+    return receiver->handle((const uint8_t*)&frame, OTA_DATA_HEADER + len, status);
+}
+
+static bool sendCommit() {
+    OtaCommit commit;
+    commit.session = offer.session;
+    return receiver->handle((const uint8_t*)&commit, sizeof(commit), status);
+}
+
+static void makeImage(uint32_t size) {
+    image.resize(size);
+    for (uint32_t i = 0; i < size; i++) image[i] = (uint8_t)(i * 31 + (i >> 8));
+    offer.size = size;
+    offer.crc = ~otaCrc32Update(0xFFFFFFFF, image.data(), size);
+    offer.session = otaSessionId(offer.crc, offer.size);
+}
+
+void setUp() {
+    offer = OtaOffer();
+    offer.kind = OTA_KIND_SENSOR;
+    strncpy(offer.version, "2.0.0", OTA_VERSION_LEN - 1);
+    makeImage(IMAGE_SIZE);
+    storage = MemoryStorage();
+    receiver = new OtaReceiver<MemoryStorage>(storage, OTA_KIND_SENSOR, "1.0.0", 1 << 20);
+}
+
+void tearDown() {
+    delete receiver;
+    receiver = nullptr;
+}
+
+void test_in_order_transfer_activates() {
+    TEST_ASSERT_TRUE(sendOffer());
+    TEST_ASSERT_EQUAL_UINT8(OTA_RECEIVING, status.state);
+    uint32_t chunks = otaChunkCount(IMAGE_SIZE);
+    uint32_t acks = 0;
+    for (uint32_t i = 0; i < chunks; i++) acks += sendChunk(i);
+    TEST_ASSERT_EQUAL_UINT32(chunks, status.base);
+    TEST_ASSERT_EQUAL_UINT32(chunks / OTA_ACK_EVERY + 1, acks);   // cada OTA_ACK_EVERY y el último
+    TEST_ASSERT_TRUE(sendCommit());
+    TEST_ASSERT_EQUAL_UINT8(OTA_READY, status.state);
+    TEST_ASSERT_TRUE(storage.activated);
+    TEST_ASSERT_EQUAL_MEMORY(image.data(), storage.image.data(), IMAGE_SIZE);
+}
+
+void test_gap_is_reported_in_bitmap() {
+    sendOffer();
+    sendChunk(0);
+    TEST_ASSERT_TRUE(sendChunk(2));   // adelantado: se responde enseguida
+    TEST_ASSERT_EQUAL_UINT32(1, status.base);
+    TEST_ASSERT_EQUAL_HEX32(1u << 1, status.bitmap);
+    sendChunk(3);
+    TEST_ASSERT_EQUAL_HEX32((1u << 1) | (1u << 2), status.bitmap);
+    // El que faltaba arrastra los adelantados (la oferta repetida sondea)
+    sendChunk(1);
+    TEST_ASSERT_TRUE(sendOffer());
+    TEST_ASSERT_EQUAL_UINT32(4, status.base);
+    TEST_ASSERT_EQUAL_HEX32(0, status.bitmap);
+}
+
+void test_outside_window_is_ignored() {
+    sendOffer();
+    TEST_ASSERT_FALSE(sendChunk(OTA_WINDOW));
+    TEST_ASSERT_TRUE(sendChunk(OTA_WINDOW - 1));
+    TEST_ASSERT_EQUAL_HEX32(1u << (OTA_WINDOW - 1), status.bitmap);
+}
+
+void test_duplicates_repeat_status() {
+    sendOffer();
+    sendChunk(0);
+    sendChunk(2);
+    TEST_ASSERT_TRUE(sendChunk(0));   // el ACK se perdió
+    TEST_ASSERT_TRUE(sendChunk(2));
+    TEST_ASSERT_EQUAL_UINT32(2, receiver->duplicates());
+    TEST_ASSERT_EQUAL_UINT32(1, status.base);
+}
+
+void test_wrong_session_is_ignored() {
+    sendOffer();
+    offer.session ^= 2;
+    TEST_ASSERT_FALSE(sendChunk(0));
+    TEST_ASSERT_FALSE(sendCommit());
+}
+
+void test_bad_crc_restarts() {
+    offer.crc ^= 1;
+    sendOffer();
+    for (uint32_t i = 0; i < otaChunkCount(IMAGE_SIZE); i++) sendChunk(i);
+    sendCommit();
+    TEST_ASSERT_EQUAL_UINT8(OTA_ERROR_CRC, status.state);
+    TEST_ASSERT_FALSE(storage.activated);
+    sendOffer();   // la misma oferta vuelve a empezar desde 0
+    TEST_ASSERT_EQUAL_UINT8(OTA_RECEIVING, status.state);
+    TEST_ASSERT_EQUAL_UINT32(0, status.base);
+}
+
+void test_resume_after_reboot() {
+    // Hasta pasar el primer guardado del progreso
+    const uint32_t every = OtaReceiver<MemoryStorage>::PROGRESS_EVERY;
+    makeImage(2 * every * OTA_CHUNK_SIZE + 77);
+    sendOffer();
+    for (uint32_t i = 0; i < every + 5; i++) sendChunk(i);
+    TEST_ASSERT_EQUAL_UINT32(every * OTA_CHUNK_SIZE, storage.progressBytes);
+
+    // Reinicio: receptor nuevo sobre la misma partición
+    delete receiver;
+    receiver = new OtaReceiver<MemoryStorage>(storage, OTA_KIND_SENSOR, "1.0.0", 1 << 20);
+    sendOffer();
+    TEST_ASSERT_EQUAL_UINT32(every, status.base);
+    for (uint32_t i = every; i < otaChunkCount(offer.size); i++) sendChunk(i);
+    sendCommit();
+    TEST_ASSERT_EQUAL_UINT8(OTA_READY, status.state);   // el CRC incluye lo anterior al reinicio
+}
+
+void test_rejects_other_kind_and_same_version() {
+    offer.kind = OTA_KIND_ACTUATOR;
+    sendOffer();
+    TEST_ASSERT_EQUAL_UINT8(OTA_REJECTED, status.state);
+
+    offer.kind = OTA_KIND_SENSOR;
+    strncpy(offer.version, "1.0.0", OTA_VERSION_LEN - 1);
+    offer.session ^= 2;
+    sendOffer();
+    TEST_ASSERT_EQUAL_UINT8(OTA_IDLE, status.state);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_in_order_transfer_activates);
+    RUN_TEST(test_gap_is_reported_in_bitmap);
+    RUN_TEST(test_outside_window_is_ignored);
+    RUN_TEST(test_duplicates_repeat_status);
+    RUN_TEST(test_wrong_session_is_ignored);
+    RUN_TEST(test_bad_crc_restarts);
+    RUN_TEST(test_resume_after_reboot);
+    RUN_TEST(test_rejects_other_kind_and_same_version);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+// Potencia de emisión de los nodos (LinkQuality.h): TxPowerControl y las
+// tramas LinkReport.
+//   pio test -e native -f test_link_quality
+#include <unity.h>
+#include "LinkQuality.h"
+
+static TxPowerControl power;
+
+static LinkReport report(int8_t rssi, uint16_t samples, uint16_t lossPermille) {
+    LinkReport r;
+    r.rssi = rssi;
+    r.samples = samples;
+    r.lossPermille = lossPermille;
+    return r;
+}
+
+void setUp() { power = TxPowerControl(); }
+void tearDown() {}
+
+void test_starts_at_max() {
+    TEST_ASSERT_EQUAL_INT(TxPowerControl::MAX_QDBM, power.qdbm());
+}
+
+void test_strong_clean_link_steps_down_to_min() {
+    unsigned long now = 0;
+    TEST_ASSERT_TRUE(power.onReport(report(-50, 20, 0), now += 1000));
+    TEST_ASSERT_EQUAL_INT(TxPowerControl::MAX_QDBM - TxPowerControl::STEP_DOWN, power.qdbm());
+    for (int i = 0; i < 40; i++) power.onReport(report(-50, 20, 0), now += 1000);
+    TEST_ASSERT_EQUAL_INT(TxPowerControl::MIN_QDBM, power.qdbm());
+    TEST_ASSERT_FALSE(power.onReport(report(-50, 20, 0), now += 1000));
+}
+
+void test_margin_band_holds() {
+    // Entre TARGET_RSSI y TARGET_RSSI + MARGIN_DB no se toca
+    TEST_ASSERT_FALSE(power.onReport(report(TxPowerControl::TARGET_RSSI + TxPowerControl::MARGIN_DB, 20, 0), 1000));
+    TEST_ASSERT_FALSE(power.onReport(report(TxPowerControl::TARGET_RSSI, 20, 0), 2000));
+    TEST_ASSERT_EQUAL_INT(TxPowerControl::MAX_QDBM, power.qdbm());
+}
+
+void test_loss_raises_fast() {
+    for (int i = 0; i < 6; i++) power.onReport(report(-50, 20, 0), 1000 + i);
+    int8_t low = power.qdbm();
+    TEST_ASSERT_TRUE(power.onReport(report(-50, 20, TxPowerControl::RAISE_LOSS_PERMILLE + 1), 2000));
+    TEST_ASSERT_EQUAL_INT(low + TxPowerControl::STEP_UP, power.qdbm());
+}
+
+void test_loss_with_few_samples_is_ignored() {
+    power.onReport(report(-50, 20, 0), 1000);
+    int8_t before = power.qdbm();
+    // Pocas muestras: la pérdida no cuenta, pero tampoco deja bajar
+    TEST_ASSERT_FALSE(power.onReport(report(-50, TxPowerControl::MIN_SAMPLES - 1, 500), 2000));
+    TEST_ASSERT_EQUAL_INT(before, power.qdbm());
+}
+
+void test_weak_rssi_raises_until_max() {
+    for (int i = 0; i < 10; i++) power.onReport(report(-50, 20, 0), 1000 + i);
+    for (int i = 0; i < 20; i++) power.onReport(report(-90, 20, 0), 2000 + i);
+    TEST_ASSERT_EQUAL_INT(TxPowerControl::MAX_QDBM, power.qdbm());
+}
+
+void test_timeout_returns_to_max() {
+    power.onReport(report(-50, 20, 0), 1000);
+    TEST_ASSERT_FALSE(power.checkTimeout(1000 + TxPowerControl::REPORT_TIMEOUT_MS - 1));
+    TEST_ASSERT_TRUE(power.checkTimeout(1000 + TxPowerControl::REPORT_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL_INT(TxPowerControl::MAX_QDBM, power.qdbm());
+    TEST_ASSERT_FALSE(power.checkTimeout(1000 + 2 * TxPowerControl::REPORT_TIMEOUT_MS));
+}
+
+void test_report_decoding() {
+    LinkReport r = report(-60, 10, 250);
+    LinkReport out;
+    TEST_ASSERT_TRUE(decodeLinkReport((const uint8_t*)&r, sizeof(r), out));
+    TEST_ASSERT_EQUAL_INT(-60, out.rssi);
+    TEST_ASSERT_EQUAL_UINT16(250, out.lossPermille);
+    TEST_ASSERT_FALSE(decodeLinkReport((const uint8_t*)&r, sizeof(r) - 1, out));
+    r.lossPermille = 1001;
+    TEST_ASSERT_FALSE(decodeLinkReport((const uint8_t*)&r, sizeof(r), out));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_at_max);
+    RUN_TEST(test_strong_clean_link_steps_down_to_min);
+    RUN_TEST(test_margin_band_holds);
+    RUN_TEST(test_loss_raises_fast);
+    RUN_TEST(test_loss_with_few_samples_is_ignored);
+    RUN_TEST(test_weak_rssi_raises_until_max);
+    RUN_TEST(test_timeout_returns_to_max);
+    RUN_TEST(test_report_decoding);
+    return UNITY_END();
+}
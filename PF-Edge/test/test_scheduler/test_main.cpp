@@ -0,0 +1,169 @@
+// Horarios (Scheduler.h): ventanas que cruzan la medianoche, próximo evento
+// por búsqueda binaria, temporizadores que vencen, reparto de ids y
+// órdenes de Telegram mal formadas.
+//   pio test -e native -f test_scheduler
+#include <unity.h>
+#include "Scheduler.h"
+
+static const uint32_t DAY0 = 1700000000 - 1700000000 % Scheduler::DAY;   // medianoche
+
+static uint32_t at(uint8_t h, uint8_t m) { return DAY0 + h * 3600 + m * 60; }
+
+static ActuatorState allOn() {
+    ActuatorState s;
+    s.waterPump = s.fan = s.leds = ACTUATOR_VALUE_ON;
+    return s;
+}
+
+static Scheduler scheduler;
+
+void setUp() { scheduler = Scheduler(); }
+void tearDown() {}
+
+void test_window_across_midnight() {
+    TEST_ASSERT_TRUE(scheduler.addWindow(SCHEDULE_LIGHT, 1, 22 * 3600, 8 * 3600) > 0);
+    ActuatorState s = allOn();
+    scheduler.gate(1, at(23, 30), s);
+    TEST_ASSERT_EQUAL_UINT8(ACTUATOR_VALUE_ON, s.leds);
+    s = allOn();
+    scheduler.gate(1, at(5, 59) + Scheduler::DAY, s);
+    TEST_ASSERT_EQUAL_UINT8(ACTUATOR_VALUE_ON, s.leds);
+    s = allOn();
+    scheduler.gate(1, at(6, 0) + Scheduler::DAY, s);
+    TEST_ASSERT_EQUAL_UINT8(0, s.leds);
+    TEST_ASSERT_EQUAL_UINT8(ACTUATOR_VALUE_ON, s.waterPump);   // sin ventanas de riego
+
+    // Otra zona no se ve afectada
+    s = allOn();
+    scheduler.gate(2, at(12, 0) + Scheduler::DAY, s);
+    TEST_ASSERT_EQUAL_UINT8(ACTUATOR_VALUE_ON, s.leds);
+}
+
+void test_next_event_is_next_bound() {
+    scheduler.addWindow(SCHEDULE_LIGHT, 0, 7 * 3600, 12 * 3600);        // 07:00-19:00
+    scheduler.addWindow(SCHEDULE_IRRIGATION, 0, 8 * 3600, 1800);        // 08:00-08:30
+    scheduler.addWindow(SCHEDULE_IRRIGATION, 1, 23 * 3600, 2 * 3600);   // 23:00-01:00
+
+    TEST_ASSERT_TRUE(scheduler.update(at(6, 0)));
+    TEST_ASSERT_EQUAL_UINT32(at(7, 0), scheduler.nextEventAt());
+    TEST_ASSERT_FALSE(scheduler.update(at(6, 59)));   // sin evento, no recalcula
+    TEST_ASSERT_TRUE(scheduler.update(at(7, 0)));
+    TEST_ASSERT_EQUAL_UINT32(at(8, 0), scheduler.nextEventAt());
+    scheduler.update(at(8, 10));
+    TEST_ASSERT_EQUAL_UINT32(at(8, 30), scheduler.nextEventAt());
+    scheduler.update(at(19, 0));
+    TEST_ASSERT_EQUAL_UINT32(at(23, 0), scheduler.nextEventAt());
+    // Tras la última frontera del día, la primera del siguiente
+    scheduler.update(at(23, 30));
+    TEST_ASSERT_EQUAL_UINT32(DAY0 + Scheduler::DAY + 3600, scheduler.nextEventAt());
+}
+
+void test_timer_forces_and_expires() {
+    scheduler.addWindow(SCHEDULE_IRRIGATION, 3, 8 * 3600, 1800);
+    int id = scheduler.addTimer(3, ROLE_PUMP, 128, at(12, 0), 600);
+    TEST_ASSERT_TRUE(id > 0);
+
+    // El temporizador manda sobre la ventana cerrada
+    ActuatorState s;
+    scheduler.gate(3, at(12, 5), s);
+    TEST_ASSERT_EQUAL_UINT8(128, s.waterPump);
+    TEST_ASSERT_EQUAL_UINT32(at(12, 10), scheduler.nextEventAt());
+
+    // Al vencer se borra y la zona vuelve a la ventana
+    TEST_ASSERT_TRUE(scheduler.update(at(12, 10)));
+    s = allOn();
+    scheduler.gate(3, at(12, 10), s);
+    TEST_ASSERT_EQUAL_UINT8(0, s.waterPump);
+    TEST_ASSERT_FALSE(scheduler.remove((uint8_t)id));
+}
+
+void test_ids_skip_those_in_use() {
+    // Una ventana cargada de NVS con el id 2 y el contador a punto de dar la vuelta
+    ScheduleWindow saved[2] = {
+        {2, SCHEDULE_LIGHT, 0, 0, 7 * 60, 60},
+        {254, SCHEDULE_LIGHT, 0, 0, 9 * 60, 60},
+    };
+    scheduler.importWindows(saved, 2);
+    TEST_ASSERT_EQUAL_INT(255, scheduler.addTimer(0, ROLE_FAN, 255, at(1, 0), 60));
+    TEST_ASSERT_EQUAL_INT(1, scheduler.addTimer(0, ROLE_FAN, 255, at(1, 0), 60));
+    TEST_ASSERT_EQUAL_INT(3, scheduler.addTimer(0, ROLE_FAN, 255, at(1, 0), 60));
+}
+
+void test_duplicate_saved_id_is_dropped() {
+    ScheduleWindow saved[2] = {
+        {5, SCHEDULE_LIGHT, 0, 0, 7 * 60, 60},
+        {5, SCHEDULE_IRRIGATION, 1, 0, 9 * 60, 60},
+    };
+    scheduler.importWindows(saved, 2);
+    ScheduleWindow out[Scheduler::MAX_ENTRIES];
+    TEST_ASSERT_EQUAL_UINT8(1, scheduler.exportWindows(out));
+    TEST_ASSERT_EQUAL_UINT8(SCHEDULE_LIGHT, out[0].kind);
+}
+
+void test_table_full() {
+    for (uint8_t i = 0; i < Scheduler::MAX_ENTRIES; i++) {
+        TEST_ASSERT_TRUE(scheduler.addWindow(SCHEDULE_LIGHT, 0, i * 60, 30) > 0);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, scheduler.addWindow(SCHEDULE_LIGHT, 0, 23 * 3600, 30));
+}
+
+void test_parse_window_and_timer() {
+    ScheduleCommand c;
+    String error;
+    TEST_ASSERT_TRUE(Scheduler::parseCommand("/horario riego 22:30-01:00 4", c, error));
+    TEST_ASSERT_EQUAL_UINT8(ScheduleCommand::ADD_WINDOW, c.op);
+    TEST_ASSERT_EQUAL_UINT8(SCHEDULE_IRRIGATION, c.kind);
+    TEST_ASSERT_EQUAL_UINT8(4, c.zone);
+    TEST_ASSERT_EQUAL_UINT32(22 * 3600 + 1800, c.start);
+    TEST_ASSERT_EQUAL_UINT32(2 * 3600 + 1800, c.duration);
+
+    TEST_ASSERT_TRUE(Scheduler::parseCommand("/temporizador luces 15 100", c, error));
+    TEST_ASSERT_EQUAL_UINT8(ScheduleCommand::ADD_TIMER, c.op);
+    TEST_ASSERT_EQUAL_UINT8(ROLE_LIGHT, c.role);
+    TEST_ASSERT_EQUAL_UINT8(100, c.value);
+    TEST_ASSERT_EQUAL_UINT8(0, c.zone);
+    TEST_ASSERT_EQUAL_UINT32(900, c.duration);
+
+    TEST_ASSERT_TRUE(Scheduler::parseCommand("/horario borrar 7", c, error));
+    TEST_ASSERT_EQUAL_UINT8(ScheduleCommand::REMOVE, c.op);
+    TEST_ASSERT_EQUAL_UINT8(7, c.id);
+}
+
+void test_parse_errors() {
+    ScheduleCommand c;
+    String error;
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/horario luz 25:00-08:00", c, error));
+    TEST_ASSERT_TRUE(error.startsWith("⚠️ Uso: /horario"));
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/horario luz 08:00-08:00", c, error));
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/horario nieve 08:00-09:00", c, error));
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/temporizador bomba 0", c, error));
+    TEST_ASSERT_TRUE(error.startsWith("⚠️ Uso: /temporizador"));
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/temporizador bomba 5 300", c, error));
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/temporizador grifo 5", c, error));
+}
+
+void test_parse_rejects_bad_zone() {
+    ScheduleCommand c;
+    String error;
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/horario luz 07:00-19:00 8", c, error));
+    TEST_ASSERT_TRUE(error.startsWith("⚠️ Zona no válida"));
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/temporizador bomba 5 255 x", c, error));
+    TEST_ASSERT_TRUE(error.startsWith("⚠️ Zona no válida"));
+    TEST_ASSERT_FALSE(Scheduler::parseCommand("/temporizador bomba 5 255 -1", c, error));
+    TEST_ASSERT_TRUE(Scheduler::parseCommand("/temporizador bomba 5 255 7", c, error));
+    TEST_ASSERT_EQUAL_UINT8(7, c.zone);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_window_across_midnight);
+    RUN_TEST(test_next_event_is_next_bound);
+    RUN_TEST(test_timer_forces_and_expires);
+    RUN_TEST(test_ids_skip_those_in_use);
+    RUN_TEST(test_duplicate_saved_id_is_dropped);
+    RUN_TEST(test_table_full);
+    RUN_TEST(test_parse_window_and_timer);
+    RUN_TEST(test_parse_errors);
+    RUN_TEST(test_parse_rejects_bad_zone);
+    return UNITY_END();
+}
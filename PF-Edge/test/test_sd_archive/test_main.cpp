@@ -0,0 +1,169 @@
+// Archivo diario de la SD (SDArchive.h) sobre la SD del host (directorio
+// test_sd): del CSV por horas al .bin/.idx y vuelta con ArchiveHourReader.
+//   pio test -e native -f test_sd_archive
+#include <unity.h>
+#include <vector>
+#include "SDArchive.h"
+
+static const char* DATE = "2025-03-14";
+
+static void writeHour(uint8_t hour, const char* header, const std::vector<String>& lines) {
+    char dir[16];
+    snprintf(dir, sizeof(dir), "/%s/%02u", DATE, hour);
+    SD.mkdir(String("/") + DATE);
+    SD.mkdir(dir);
+    File f = SD.open(String(dir) + "/data.csv", FILE_WRITE);
+    f.println(header);
+    for (const String& line : lines) f.println(line);
+    f.close();
+}
+
+static String sampleLine(uint8_t hour, uint8_t minute, const char* node, float temperature, bool noSoil = false) {
+    SensorData d;
+    setSensorValue(d.temperature, SENSOR_TEMPERATURE, temperature);
+    setSensorValue(d.humidity, SENSOR_HUMIDITY, 55.5f);
+    setSensorValue(d.light, SENSOR_LIGHT, 812);
+    setSensorValue(d.co2ppm, SENSOR_CO2, 415);
+    setSensorValue(d.soilMoisture, SENSOR_SOIL, 38.25f);
+    setSensorValue(d.voltage, SENSOR_VOLTAGE, 3.31f);
+    if (noSoil) d.soilMoisture = sensorNoReading<uint16_t>();
+    char timestamp[20];
+    snprintf(timestamp, sizeof(timestamp), "%s %02u:%02u:07", DATE, hour, minute);
+    return SDLogger::formatCsvLine(timestamp, node, -61, d, 2, noSoil ? 1u << SENSOR_SOIL : 0);
+}
+
+static bool archive(DayArchiver& archiver) {
+    if (!archiver.begin(DATE)) return false;
+    while (archiver.step()) {}
+    return archiver.ok();
+}
+
+static std::vector<String> readHour(const char* hour) {
+    std::vector<String> lines;
+    ArchiveHourReader reader;
+    if (!reader.open(DATE, hour)) return lines;
+    char line[256];
+    while (reader.readLine(line, sizeof(line)) >= 0) lines.push_back(line);
+    reader.close();
+    return lines;
+}
+
+void setUp() {
+    std::error_code ec;
+    std::filesystem::remove_all("test_sd", ec);
+    SD.root = "test_sd";
+    SD.begin();
+}
+
+void tearDown() {
+    std::error_code ec;
+    std::filesystem::remove_all("test_sd", ec);
+}
+
+void test_round_trip() {
+    std::vector<String> h9 = {sampleLine(9, 0, "NODE_1", 21.5f), sampleLine(9, 1, "NODE_2", 22.75f, true)};
+    std::vector<String> h23 = {sampleLine(23, 59, "NODE_1", -3.1f)};
+    writeHour(9, ARCHIVE_CSV_HEADER, h9);
+    writeHour(23, ARCHIVE_CSV_HEADER, h23);
+
+    DayArchiver archiver;
+    TEST_ASSERT_TRUE(archive(archiver));
+    TEST_ASSERT_EQUAL_UINT32(3, archiver.rows());
+    TEST_ASSERT_TRUE(archiver.archiveBytes() < archiver.csvBytes());
+    TEST_ASSERT_FALSE(SD.exists(String("/") + DATE));   // la carpeta se borra al terminar
+    TEST_ASSERT_TRUE(SD.exists(DayArchiver::binPath(DATE)));
+
+    std::vector<String> lines = readHour("09");
+    TEST_ASSERT_EQUAL_UINT32(3, lines.size());
+    TEST_ASSERT_EQUAL_STRING(ARCHIVE_CSV_HEADER, lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING(h9[0].c_str(), lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING(h9[1].c_str(), lines[2].c_str());
+    lines = readHour("23");
+    TEST_ASSERT_EQUAL_UINT32(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING(h23[0].c_str(), lines[1].c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, readHour("10").size());   // hora sin datos
+}
+
+void test_index_summary() {
+    writeHour(9, ARCHIVE_CSV_HEADER, {sampleLine(9, 0, "NODE_1", 20.0f), sampleLine(9, 1, "NODE_1", 24.0f)});
+    DayArchiver archiver;
+    TEST_ASSERT_TRUE(archive(archiver));
+
+    File idx = SD.open(DayArchiver::idxPath(DATE), FILE_READ);
+    TEST_ASSERT_TRUE((bool)idx);
+    char line[512];
+    SDLogger::readLine(idx, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("nodos,NODE_1", line);
+    SDLogger::readLine(idx, line, sizeof(line));   // cabecera
+    SDLogger::readLine(idx, line, sizeof(line));
+    idx.close();
+    // hora, offset tras la cabecera del .bin, filas y temp mín/media/máx
+    char expected[64];
+    snprintf(expected, sizeof(expected), "09,%u,2,20.00,22.00,24.00,", (unsigned)sizeof(ArchiveHeader));
+    TEST_ASSERT_EQUAL_INT(0, strncmp(expected, line, strlen(expected)));
+}
+
+void test_legacy_csv_without_quality() {
+    String line = sampleLine(9, 0, "NODE_1", 21.5f);
+    String legacy = line.substring(0, line.lastIndexOf(','));
+    writeHour(9, "timestamp,nodeId,rssi" SENSOR_CSV_COLUMNS ",state", {legacy});
+    DayArchiver archiver;
+    TEST_ASSERT_TRUE(archive(archiver));
+    std::vector<String> lines = readHour("09");
+    TEST_ASSERT_EQUAL_UINT32(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING(line.c_str(), lines[1].c_str());   // calidad 0
+}
+
+void test_cut_line_is_skipped() {
+    String line = sampleLine(9, 0, "NODE_1", 21.5f);
+    writeHour(9, ARCHIVE_CSV_HEADER, {line, line.substring(0, 25)});   // corte de luz a mitad
+    DayArchiver archiver;
+    TEST_ASSERT_TRUE(archive(archiver));
+    TEST_ASSERT_EQUAL_UINT32(1, archiver.rows());
+}
+
+void test_unknown_columns_keep_the_day() {
+    writeHour(9, "timestamp,otra_cosa", {String("2025-03-14 09:00:00,1")});
+    DayArchiver archiver;
+    TEST_ASSERT_FALSE(archive(archiver));
+    TEST_ASSERT_TRUE(SD.exists(String("/") + DATE + "/09/data.csv"));
+    TEST_ASSERT_FALSE(SD.exists(DayArchiver::binPath(DATE)));
+    TEST_ASSERT_FALSE(SD.exists(String(ARCHIVE_DIR) + "/" + DATE + ".tmp"));
+}
+
+void test_trace_is_kept() {
+    writeHour(9, ARCHIVE_CSV_HEADER, {sampleLine(9, 0, "NODE_1", 21.5f)});
+    File trace = SD.open(String("/") + DATE + "/trace.bin", FILE_WRITE);
+    trace.print("traza");
+    trace.close();
+    DayArchiver archiver;
+    TEST_ASSERT_TRUE(archive(archiver));
+    TEST_ASSERT_TRUE(SD.exists(DayArchiver::tracePath(DATE)));
+}
+
+void test_parse_sensor_value() {
+    const SensorChannel& temp = SENSOR_CHANNEL_TABLE[SENSOR_TEMPERATURE];
+    int32_t raw;
+    TEST_ASSERT_TRUE(DayArchiver::parseSensorValue("23.45", 5, temp, raw));
+    TEST_ASSERT_EQUAL_INT32(2345, raw);
+    TEST_ASSERT_TRUE(DayArchiver::parseSensorValue("-3.1", 4, temp, raw));
+    TEST_ASSERT_EQUAL_INT32(-310, raw);
+    TEST_ASSERT_TRUE(DayArchiver::parseSensorValue("7.123", 5, temp, raw));   // sobran decimales
+    TEST_ASSERT_EQUAL_INT32(712, raw);
+    TEST_ASSERT_TRUE(DayArchiver::parseSensorValue("", 0, temp, raw));
+    TEST_ASSERT_EQUAL_INT32(temp.noReading, raw);
+    TEST_ASSERT_FALSE(DayArchiver::parseSensorValue("2x", 2, temp, raw));
+    TEST_ASSERT_FALSE(DayArchiver::parseSensorValue("-", 1, temp, raw));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_index_summary);
+    RUN_TEST(test_legacy_csv_without_quality);
+    RUN_TEST(test_cut_line_is_skipped);
+    RUN_TEST(test_unknown_columns_keep_the_day);
+    RUN_TEST(test_trace_is_kept);
+    RUN_TEST(test_parse_sensor_value);
+    return UNITY_END();
+}
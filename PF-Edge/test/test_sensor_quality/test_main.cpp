@@ -0,0 +1,139 @@
+// Etapa de calidad (SensorQuality.h): marcas por canal e histéresis del fallo.
+//   pio test -e native -f test_sensor_quality
+#include <unity.h>
+#include "SensorQuality.h"
+
+static const uint8_t MAC_A[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+static const uint8_t MAC_B[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02};
+
+static SensorQuality quality;
+
+static SensorData normal() {
+    SensorData d;
+    setSensorValue(d.temperature, SENSOR_TEMPERATURE, 22.0f);
+    setSensorValue(d.humidity, SENSOR_HUMIDITY, 50.0f);
+    setSensorValue(d.light, SENSOR_LIGHT, 1000);
+    setSensorValue(d.co2ppm, SENSOR_CO2, 400);
+    setSensorValue(d.soilMoisture, SENSOR_SOIL, 40.0f);
+    setSensorValue(d.voltage, SENSOR_VOLTAGE, 3.3f);
+    return d;
+}
+
+void setUp() { quality = SensorQuality(); }
+void tearDown() {}
+
+void test_clean_sample_is_usable() {
+    SampleQuality q = quality.check(MAC_A, normal(), 1000);
+    TEST_ASSERT_EQUAL_UINT16(0, q.unusable);
+    TEST_ASSERT_EQUAL_UINT16(0, q.faults);
+    q = quality.check(MAC_A, normal(), 2000);
+    TEST_ASSERT_EQUAL_UINT16(0, q.unusable);
+}
+
+void test_no_reading_opens_and_clears_fault() {
+    SensorData bad = normal();
+    bad.temperature = sensorNoReading<int16_t>();
+    unsigned long now = 0;
+    for (uint8_t i = 1; i <= SensorQuality::FAULT_RUN; i++) {
+        SampleQuality q = quality.check(MAC_A, bad, now += 1000);
+        TEST_ASSERT_EQUAL_UINT8(QUALITY_NO_READING, q.flags[SENSOR_TEMPERATURE]);
+        TEST_ASSERT_TRUE(q.unusable >> SENSOR_TEMPERATURE & 1);
+        TEST_ASSERT_EQUAL(i == SensorQuality::FAULT_RUN, (q.faults >> SENSOR_TEMPERATURE) & 1);
+    }
+    uint8_t flags[SENSOR_CHANNEL_COUNT];
+    TEST_ASSERT_EQUAL_UINT16(1u << SENSOR_TEMPERATURE, quality.faultChannels(flags));
+    TEST_ASSERT_EQUAL_UINT8(QUALITY_NO_READING, flags[SENSOR_TEMPERATURE]);
+
+    // Una muestra limpia no basta: CLEAR_RUN seguidas
+    for (uint8_t i = 1; i <= SensorQuality::CLEAR_RUN; i++) {
+        SampleQuality q = quality.check(MAC_A, normal(), now += 1000);
+        TEST_ASSERT_EQUAL_UINT8(0, q.flags[SENSOR_TEMPERATURE]);
+        TEST_ASSERT_EQUAL(i < SensorQuality::CLEAR_RUN, (q.faults >> SENSOR_TEMPERATURE) & 1);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, quality.faultChannels());
+}
+
+void test_single_glitch_does_not_alert() {
+    SensorData bad = normal();
+    bad.temperature = sensorNoReading<int16_t>();
+    quality.check(MAC_A, normal(), 1000);
+    quality.check(MAC_A, bad, 2000);
+    SampleQuality q = quality.check(MAC_A, normal(), 3000);
+    TEST_ASSERT_EQUAL_UINT16(0, q.faults);
+}
+
+void test_out_of_range() {
+    SensorData d = normal();
+    d.humidity = 12000;   // 120 %
+    SampleQuality q = quality.check(MAC_A, d, 1000);
+    TEST_ASSERT_TRUE(q.flags[SENSOR_HUMIDITY] & QUALITY_RANGE);
+    TEST_ASSERT_EQUAL_UINT16(1u << SENSOR_HUMIDITY, q.unusable);
+}
+
+void test_jump_is_flagged_until_time_makes_it_credible() {
+    quality.check(MAC_A, normal(), 1000);
+    SensorData hot = normal();
+    setSensorValue(hot.temperature, SENSOR_TEMPERATURE, 40.0f);
+    SampleQuality q = quality.check(MAC_A, hot, 2000);
+    TEST_ASSERT_TRUE(q.flags[SENSOR_TEMPERATURE] & QUALITY_RATE);
+    // La referencia sigue en la última aceptada: a los 60 s ya es creíble
+    q = quality.check(MAC_A, hot, 61000);
+    TEST_ASSERT_FALSE(q.flags[SENSOR_TEMPERATURE] & QUALITY_RATE);
+}
+
+void test_nodes_are_independent() {
+    quality.check(MAC_A, normal(), 1000);
+    SensorData hot = normal();
+    setSensorValue(hot.temperature, SENSOR_TEMPERATURE, 40.0f);
+    SampleQuality q = quality.check(MAC_B, hot, 2000);
+    TEST_ASSERT_EQUAL_UINT8(0, q.flags[SENSOR_TEMPERATURE]);
+}
+
+void test_rail_saturates_after_run() {
+    SensorData d = normal();
+    d.co2ppm = 4095;
+    unsigned long now = 0;
+    for (uint8_t i = 1; i <= SensorQuality::RAIL_RUN; i++) {
+        SampleQuality q = quality.check(MAC_A, d, now += 1000);
+        TEST_ASSERT_EQUAL(i == SensorQuality::RAIL_RUN, (q.flags[SENSOR_CO2] & QUALITY_SATURATED) != 0);
+    }
+}
+
+void test_stuck_soil() {
+    const uint16_t run = QUALITY_LIMITS[SENSOR_SOIL].stuckRun;
+    SensorData d = normal();
+    unsigned long now = 0;
+    SampleQuality q;
+    for (uint16_t i = 0; i < run; i++) q = quality.check(MAC_A, d, now += 1000);
+    TEST_ASSERT_FALSE(q.flags[SENSOR_SOIL] & QUALITY_STUCK);
+    q = quality.check(MAC_A, d, now += 1000);
+    TEST_ASSERT_TRUE(q.flags[SENSOR_SOIL] & QUALITY_STUCK);
+    // La temperatura puede estar quieta de verdad (stuckRun 0)
+    TEST_ASSERT_EQUAL_UINT8(0, q.flags[SENSOR_TEMPERATURE]);
+}
+
+void test_outlier_after_warmup() {
+    SensorData d = normal();
+    unsigned long now = 0;
+    for (uint8_t i = 0; i < SensorQuality::WARMUP + 8; i++) {
+        d.temperature = 2200 + (i % 2) * 10;
+        quality.check(MAC_A, d, now += 1000);
+    }
+    d.temperature = 2800;   // +6 °C: creíble en 10 min, pero lejos de la media
+    SampleQuality q = quality.check(MAC_A, d, now += 600000);
+    TEST_ASSERT_EQUAL_UINT8(QUALITY_OUTLIER, q.flags[SENSOR_TEMPERATURE]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_sample_is_usable);
+    RUN_TEST(test_no_reading_opens_and_clears_fault);
+    RUN_TEST(test_single_glitch_does_not_alert);
+    RUN_TEST(test_out_of_range);
+    RUN_TEST(test_jump_is_flagged_until_time_makes_it_credible);
+    RUN_TEST(test_nodes_are_independent);
+    RUN_TEST(test_rail_saturates_after_run);
+    RUN_TEST(test_stuck_soil);
+    RUN_TEST(test_outlier_after_warmup);
+    return UNITY_END();
+}
@@ -0,0 +1,153 @@
+// Cola de salida hacia Telegram (UplinkSpool.h) sobre la SD del host
+// (directorio test_sd): orden, alertas compactadas, anillo lleno,
+// persistencia tras reiniciar y modo solo RAM.
+//   pio test -e native -f test_uplink_spool
+#include <unity.h>
+#include "UplinkSpool.h"
+
+static const uint32_t T0 = 1700000000;
+
+static String sent;
+static bool online = true;
+
+static bool send(const String& message) {
+    if (!online) return false;
+    sent = message;
+    return true;
+}
+
+// drain() respeta DRAIN_INTERVAL_MS: se adelanta el reloj en vez de esperar
+static bool drainNow(UplinkSpool& spool) {
+    HostClock::advance(UplinkSpool::DRAIN_INTERVAL_MS);
+    return spool.drain(send);
+}
+
+void setUp() {
+    std::error_code ec;
+    std::filesystem::remove_all("test_sd", ec);
+    SD.root = "test_sd";
+    SD.begin();
+    sent = "";
+    online = true;
+}
+
+void tearDown() {
+    std::error_code ec;
+    std::filesystem::remove_all("test_sd", ec);
+}
+
+void test_messages_leave_in_order() {
+    UplinkSpool spool;
+    TEST_ASSERT_TRUE(spool.begin());
+    TEST_ASSERT_TRUE(spool.empty());
+    spool.push(SPOOL_SUMMARY, "resumen 1", T0);
+    spool.push(SPOOL_MESSAGE, "mensaje", T0 + 60);
+    spool.push(SPOOL_SUMMARY, "resumen 2", T0 + 120);
+    TEST_ASSERT_EQUAL_UINT32(3, spool.pending());
+
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_EQUAL_STRING("resumen 1", sent.c_str());
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_TRUE(sent.indexOf("mensaje") > 0);   // con la hora delante
+    TEST_ASSERT_TRUE(sent.startsWith("📦 ("));
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_EQUAL_STRING("resumen 2", sent.c_str());
+    TEST_ASSERT_TRUE(spool.empty());
+    TEST_ASSERT_FALSE(drainNow(spool));
+}
+
+void test_failed_send_keeps_message() {
+    UplinkSpool spool;
+    spool.begin();
+    spool.push(SPOOL_SUMMARY, "resumen", T0);
+    online = false;
+    TEST_ASSERT_FALSE(drainNow(spool));
+    TEST_ASSERT_EQUAL_UINT32(1, spool.pending());
+    online = true;
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_EQUAL_STRING("resumen", sent.c_str());
+}
+
+void test_drain_is_paced() {
+    UplinkSpool spool;
+    spool.begin();
+    spool.push(SPOOL_SUMMARY, "a", T0);
+    spool.push(SPOOL_SUMMARY, "b", T0);
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_FALSE(spool.drain(send));   // sin esperar DRAIN_INTERVAL_MS
+    TEST_ASSERT_EQUAL_UINT32(1, spool.pending());
+}
+
+void test_alerts_are_compacted_and_go_first() {
+    UplinkSpool spool;
+    spool.begin();
+    spool.push(SPOOL_SUMMARY, "resumen", T0);
+    spool.pushAlert("alerta 1", T0 + 10);
+    spool.pushAlert("alerta 2", T0 + 20);
+    spool.pushAlert("alerta 3", T0 + 30);
+    TEST_ASSERT_EQUAL_UINT32(2, spool.pending());
+
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_TRUE(sent.startsWith("📦 3 cambios de alerta"));
+    TEST_ASSERT_TRUE(sent.endsWith("alerta 3"));
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_EQUAL_STRING("resumen", sent.c_str());
+}
+
+void test_full_ring_drops_oldest() {
+    UplinkSpool spool;
+    spool.begin();
+    for (uint16_t i = 0; i < UplinkSpool::SLOTS + 2; i++) spool.push(SPOOL_SUMMARY, "r" + String(i), T0 + i);
+    TEST_ASSERT_EQUAL_UINT32(UplinkSpool::SLOTS, spool.pending());
+    TEST_ASSERT_EQUAL_UINT32(2, spool.dropped());
+    TEST_ASSERT_EQUAL_STRING("r2", spool.peek().c_str());
+}
+
+void test_survives_reboot() {
+    {
+        UplinkSpool spool;
+        spool.begin();
+        spool.push(SPOOL_SUMMARY, "antes", T0);
+        spool.push(SPOOL_SUMMARY, "después", T0 + 1);
+        spool.pushAlert("alerta", T0 + 2);
+        drainNow(spool);   // sale la alerta
+    }
+    UplinkSpool spool;
+    TEST_ASSERT_TRUE(spool.begin());
+    TEST_ASSERT_EQUAL_UINT32(2, spool.pending());
+    TEST_ASSERT_EQUAL_STRING("antes", spool.peek().c_str());
+}
+
+void test_long_text_is_cut_on_character_boundary() {
+    UplinkSpool spool;
+    spool.begin();
+    String text;
+    for (int i = 0; i < 400; i++) text += "ñ";   // 2 bytes cada una
+    spool.push(SPOOL_SUMMARY, text, T0);
+    String out = spool.peek();
+    TEST_ASSERT_TRUE(out.length() < UplinkSpool::SLOT_SIZE - 8);
+    TEST_ASSERT_EQUAL_INT(0, (int)(out.length() % 2));
+}
+
+void test_ram_ring_without_sd() {
+    SD.root = "test_sd/sin_tarjeta";   // no existe: no se puede crear el archivo
+    UplinkSpool spool;
+    TEST_ASSERT_FALSE(spool.begin());
+    for (uint16_t i = 0; i < UplinkSpool::RAM_SLOTS + 1; i++) spool.push(SPOOL_SUMMARY, "r" + String(i), T0 + i);
+    TEST_ASSERT_EQUAL_UINT32(UplinkSpool::RAM_SLOTS, spool.pending());
+    TEST_ASSERT_TRUE(drainNow(spool));
+    TEST_ASSERT_EQUAL_STRING("r1", sent.c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_messages_leave_in_order);
+    RUN_TEST(test_failed_send_keeps_message);
+    RUN_TEST(test_drain_is_paced);
+    RUN_TEST(test_alerts_are_compacted_and_go_first);
+    RUN_TEST(test_full_ring_drops_oldest);
+    RUN_TEST(test_survives_reboot);
+    RUN_TEST(test_long_text_is_cut_on_character_boundary);
+    RUN_TEST(test_ram_ring_without_sd);
+    return UNITY_END();
+}
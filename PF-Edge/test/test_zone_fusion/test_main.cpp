@@ -0,0 +1,172 @@
+// Fusión por zona (ZoneFusion.h): mediana y media ponderadas, frescura,
+// descarte por calidad y zonas que se quedan sin nodos.
+//   pio test -e native -f test_zone_fusion
+#include <unity.h>
+#include "ZoneFusion.h"
+#include "ThresholdsController.h"
+
+static const uint8_t MAC[4][6] = {
+    {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01},
+    {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02},
+    {0x24, 0x6F, 0x28, 0x00, 0x00, 0x03},
+    {0x24, 0x6F, 0x28, 0x00, 0x00, 0x04},
+};
+
+static ZoneFusion fusion;
+
+static SensorData withTemperature(int16_t raw) {
+    SensorData d;
+    d.temperature = raw;
+    setSensorValue(d.humidity, SENSOR_HUMIDITY, 50.0f);
+    return d;
+}
+
+void setUp() { fusion = ZoneFusion(); }
+void tearDown() {}
+
+void test_median_ignores_broken_node() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 1, 1, withTemperature(2100), 0, 1000);
+    fusion.update(MAC[2], 1, 1, withTemperature(5000), 0, 1000);
+    SensorData out;
+    uint16_t unusable;
+    TEST_ASSERT_EQUAL_UINT8(3, fusion.fuse(1, 1000, out, unusable));
+    TEST_ASSERT_EQUAL_INT(2100, out.temperature);
+    TEST_ASSERT_EQUAL_UINT16(0, unusable);
+}
+
+void test_two_nodes_weighted_mean() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 1, 2, withTemperature(2300), 0, 1000);
+    SensorData out;
+    uint16_t unusable;
+    fusion.fuse(1, 1000, out, unusable);
+    TEST_ASSERT_EQUAL_INT(2200, out.temperature);
+}
+
+void test_weight_moves_median() {
+    fusion.update(MAC[0], 1, 5, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 1, 1, withTemperature(2100), 0, 1000);
+    fusion.update(MAC[2], 1, 1, withTemperature(2200), 0, 1000);
+    SensorData out;
+    uint16_t unusable;
+    fusion.fuse(1, 1000, out, unusable);
+    TEST_ASSERT_EQUAL_INT(2000, out.temperature);
+}
+
+void test_unusable_channel_is_left_out() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 1, 1, withTemperature(2100), 0, 1000);
+    fusion.update(MAC[2], 1, 1, withTemperature(5000), 1u << SENSOR_TEMPERATURE, 1000);
+    SensorData out;
+    uint16_t unusable;
+    TEST_ASSERT_EQUAL_UINT8(3, fusion.fuse(1, 1000, out, unusable));
+    TEST_ASSERT_EQUAL_INT(2050, out.temperature);
+    TEST_ASSERT_EQUAL_UINT32(1, fusion.rejected());
+}
+
+void test_channel_without_usable_node() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 1u << SENSOR_TEMPERATURE, 1000);
+    SensorData out;
+    uint16_t unusable;
+    fusion.fuse(1, 1000, out, unusable);
+    TEST_ASSERT_EQUAL_UINT16(1u << SENSOR_TEMPERATURE, unusable);
+    TEST_ASSERT_EQUAL_INT(sensorNoReading<int16_t>(), out.temperature);
+    TEST_ASSERT_EQUAL_UINT(5000, out.humidity);
+}
+
+void test_stale_node_leaves_the_aggregate() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 1, 1, withTemperature(3000), 0, 1000 + fusion.staleMs);
+    SensorData out;
+    uint16_t unusable;
+    unsigned long sampleMs = 0;
+    TEST_ASSERT_EQUAL_UINT8(1, fusion.fuse(1, 1000 + fusion.staleMs, out, unusable, &sampleMs));
+    TEST_ASSERT_EQUAL_INT(3000, out.temperature);
+    TEST_ASSERT_EQUAL_UINT32(1000 + fusion.staleMs, sampleMs);
+}
+
+void test_older_node_weighs_less() {
+    // Mismo peso configurado: el más fresco pesa más en la media
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 1, 1, withTemperature(3000), 0, 1000 + fusion.staleMs / 2);
+    SensorData out;
+    uint16_t unusable;
+    fusion.fuse(1, 1000 + fusion.staleMs / 2, out, unusable);
+    TEST_ASSERT_GREATER_THAN(2500, out.temperature);
+    TEST_ASSERT_LESS_THAN(3000, out.temperature);
+}
+
+void test_out_of_order_sample_is_ignored() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 5000);
+    fusion.update(MAC[0], 1, 1, withTemperature(3000), 0, 4000);
+    SensorData out;
+    uint16_t unusable;
+    fusion.fuse(1, 5000, out, unusable);
+    TEST_ASSERT_EQUAL_INT(2000, out.temperature);
+    TEST_ASSERT_EQUAL_UINT32(1, fusion.outOfOrder());
+}
+
+void test_zones_are_separate_and_pending() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 3, 1, withTemperature(3000), 0, 1000);
+    TEST_ASSERT_EQUAL_HEX16((1u << 1) | (1u << 3), fusion.takePending());
+    TEST_ASSERT_EQUAL_HEX16(0, fusion.takePending());
+    SensorData out;
+    uint16_t unusable;
+    TEST_ASSERT_EQUAL_UINT8(1, fusion.fuse(3, 1000, out, unusable));
+    TEST_ASSERT_EQUAL_INT(3000, out.temperature);
+    TEST_ASSERT_EQUAL_UINT8(0, fusion.fuse(2, 1000, out, unusable));
+}
+
+void test_silent_zone_goes_stale() {
+    fusion.update(MAC[0], 1, 1, withTemperature(2000), 0, 1000);
+    fusion.update(MAC[1], 2, 1, withTemperature(2000), 0, 1000);
+    const uint16_t decided = (1u << 1) | (1u << 2);
+    TEST_ASSERT_EQUAL_HEX16(0, fusion.staleZones(decided, 1000 + fusion.staleMs - 1));
+    fusion.update(MAC[1], 2, 1, withTemperature(2000), 0, 1000 + fusion.staleMs);
+    TEST_ASSERT_EQUAL_HEX16(1u << 1, fusion.staleZones(decided, 1000 + fusion.staleMs));
+    TEST_ASSERT_EQUAL_HEX16(0, fusion.staleZones(1u << 2, 1000 + fusion.staleMs));
+}
+
+void test_stale_zone_decides_off() {
+    // Suelo seco y calor: bomba y ventilador encendidos mientras el nodo habla
+    Thresholds thresholds;
+    SensorData dry = withTemperature(4000);
+    setSensorValue(dry.soilMoisture, SENSOR_SOIL, 5.0f);
+    fusion.update(MAC[0], 1, 1, dry, 0, 1000);
+    SensorData out;
+    uint16_t unusable;
+    uint16_t alerts;
+    fusion.fuse(1, 1000, out, unusable);
+    ActuatorState state = thresholds.evaluate(out, unusable, alerts);
+    TEST_ASSERT_EQUAL_UINT8(ACTUATOR_VALUE_ON, state.waterPump);
+    TEST_ASSERT_GREATER_THAN(0, state.fan);
+
+    // El nodo calla: la zona se vuelve a decidir sin canales, todo apagado
+    unsigned long now = 1000 + fusion.staleMs;
+    TEST_ASSERT_EQUAL_HEX16(1u << 1, fusion.staleZones(1u << 1, now));
+    TEST_ASSERT_EQUAL_UINT8(0, fusion.fuse(1, now, out, unusable));
+    TEST_ASSERT_EQUAL_HEX16((1u << SENSOR_CHANNEL_COUNT) - 1, unusable);
+    state = thresholds.evaluate(out, unusable, alerts);
+    TEST_ASSERT_EQUAL_UINT8(0, state.waterPump);
+    TEST_ASSERT_EQUAL_UINT8(0, state.fan);
+    TEST_ASSERT_EQUAL_UINT8(0, state.leds);
+    TEST_ASSERT_EQUAL_HEX16(0, alerts);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_median_ignores_broken_node);
+    RUN_TEST(test_two_nodes_weighted_mean);
+    RUN_TEST(test_weight_moves_median);
+    RUN_TEST(test_unusable_channel_is_left_out);
+    RUN_TEST(test_channel_without_usable_node);
+    RUN_TEST(test_stale_node_leaves_the_aggregate);
+    RUN_TEST(test_older_node_weighs_less);
+    RUN_TEST(test_out_of_order_sample_is_ignored);
+    RUN_TEST(test_zones_are_separate_and_pending);
+    RUN_TEST(test_silent_zone_goes_stale);
+    RUN_TEST(test_stale_zone_decides_off);
+    return UNITY_END();
+}
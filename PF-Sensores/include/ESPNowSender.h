@@ -6,13 +6,40 @@
 #include <esp_wifi.h>
 #include "sensorData.h"  // Incluimos la estructura SensorData
 
-// Estructura que se enviará por ESP-NOW (idéntica a SensorData)
-typedef SensorData struct_message;
-
 class ESPNowSender {
 private:
     uint8_t _peerAddress[6];
     uint8_t _channel;
+    bool _started = false;
+    void (*_onSendStatus)(bool ok) = nullptr;
+    void (*_onReceive)(const uint8_t* mac, const uint8_t* data, int len) = nullptr;
+    int (*_envelope)(const uint8_t* data, int len, uint8_t* out) = nullptr;
+    static ESPNowSender* _instance;
+
+    bool addPeer() {
+        esp_now_peer_info_t peerInfo = {};
+        memcpy(peerInfo.peer_addr, _peerAddress, 6);
+        peerInfo.channel = 0;  // canal actual: el emparejamiento puede cambiarlo
+        peerInfo.encrypt = false;
+        peerInfo.ifidx = WIFI_IF_STA;
+
+        if (!esp_now_is_peer_exist(_peerAddress)) {
+            if (esp_now_add_peer(&peerInfo) != ESP_OK) {
+                Serial.println("❌ Error al añadir el peer");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Todo lo propio sale por aquí, dentro del sobre si lo hay
+    esp_err_t transmit(const uint8_t* data, int len) {
+        if (!_envelope) return esp_now_send(_peerAddress, data, len);
+        uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+        int frameLen = _envelope(data, len, frame);
+        if (frameLen <= 0) return ESP_ERR_INVALID_SIZE;
+        return esp_now_send(_peerAddress, frame, frameLen);
+    }
 
 public:
     ESPNowSender(const uint8_t mac[6], uint8_t channel) {
@@ -20,6 +47,12 @@ public:
         _channel = channel;
     }
 
+    // Destino y canal guardados en NVS; antes de begin()
+    void configure(const uint8_t mac[6], uint8_t channel) {
+        memcpy(_peerAddress, mac, 6);
+        _channel = channel;
+    }
+
     void begin() {
         WiFi.mode(WIFI_STA);
         esp_wifi_set_channel(_channel, WIFI_SECOND_CHAN_NONE);
@@ -29,29 +62,46 @@ public:
             return;
         }
 
+        _instance = this;
         esp_now_register_send_cb([](const uint8_t *mac_addr, esp_now_send_status_t status) {
             Serial.print("📤 Estado del envío: ");
             Serial.println(status == ESP_NOW_SEND_SUCCESS ? "Éxito" : "Fallo");
+            if (_instance && _instance->_onSendStatus) _instance->_onSendStatus(status == ESP_NOW_SEND_SUCCESS);
         });
 
-        esp_now_peer_info_t peerInfo = {};
-        memcpy(peerInfo.peer_addr, _peerAddress, 6);
-        peerInfo.channel = _channel;
-        peerInfo.encrypt = false;
-        peerInfo.ifidx = WIFI_IF_STA;
+        esp_now_register_recv_cb([](const uint8_t *mac, const uint8_t *data, int len) {
+            if (_instance && _instance->_onReceive) _instance->_onReceive(mac, data, len);
+        });
 
-        if (!esp_now_is_peer_exist(_peerAddress)) {
-            if (esp_now_add_peer(&peerInfo) != ESP_OK) {
-                Serial.println("❌ Error al añadir el peer");
-                return;
-            }
-        }
+        if (!addPeer()) return;
+        _started = true;
 
         Serial.println("✅ ESP-NOW Emisor listo");
     }
 
-    void sendData(const SensorData& data) {
-        esp_err_t result = esp_now_send(_peerAddress, (uint8_t *)&data, sizeof(data));
+    // Nuevo destino (Edge emparejado); el canal lo gestiona PairingClient
+    void setPeer(const uint8_t mac[6]) {
+        if (memcmp(mac, _peerAddress, 6) == 0) return;
+        if (_started) esp_now_del_peer(_peerAddress);
+        memcpy(_peerAddress, mac, 6);
+        if (_started) addPeer();
+    }
+
+    // Resultado de cada envío (ACK de la capa MAC)
+    void onSendStatus(void (*callback)(bool ok)) { _onSendStatus = callback; }
+
+    // Envuelve cada trama antes de enviarla (sobre de relevo, ver
+    // RelayRouter); devuelve la longitud escrita en out
+    void setEnvelope(int (*wrap)(const uint8_t* data, int len, uint8_t* out)) { _envelope = wrap; }
+
+    // Tramas recibidas (balizas, sincronizaciones y configuración del Edge)
+    void onReceive(void (*callback)(const uint8_t* mac, const uint8_t* data, int len)) { _onReceive = callback; }
+
+    // Se envía en punto fijo (SensorFrame, ver SensorChannels.h) con la
+    // edad de la lectura; acquiredMs: millis() al leer
+    void sendData(const SensorData& data, unsigned long acquiredMs) {
+        SensorFrame frame = encodeSensorFrame(data, sensorAge(millis() - acquiredMs));
+        esp_err_t result = transmit((const uint8_t *)&frame, sizeof(frame));
         if (result == ESP_OK) {
             Serial.println("📨 Datos enviados correctamente");
         } else {
@@ -59,6 +109,14 @@ public:
             Serial.println(esp_err_to_name(result));
         }
     }
+
+    // Trama propia hacia el Edge (p. ej. el ACK de configuración)
+    bool sendFrame(const uint8_t* data, int len) {
+        return transmit(data, len) == ESP_OK;
+    }
 };
 
+// Definición del puntero estático
+ESPNowSender* ESPNowSender::_instance = nullptr;
+
 #endif
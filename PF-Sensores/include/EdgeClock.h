@@ -0,0 +1,106 @@
+#ifndef EDGE_CLOCK_H
+#define EDGE_CLOCK_H
+
+#include <Arduino.h>
+#include "EdgeBeacon.h"
+
+// Reloj del Edge visto desde el nodo, a partir de EdgeTimeSync. Cada
+// sincronización fija la referencia (millis local al recibirla, millis del
+// Edge) y entre dos se extrapola con la deriva estimada:
+//   edge(t) = edgeRef + (t - localRef) * (1 + deriva)
+// La deriva (ppm) es la pendiente entre una sincronización base y la
+// actual, con al menos MIN_BASELINE_MS entre ellas, suavizada (1/4); la
+// base avanza cada MAX_BASELINE_MS para seguir los cambios de temperatura.
+// Si una sincronización se aleja más de MAX_ERROR_MS de lo previsto (el
+// Edge se reinició) se vuelve a empezar, conservando la deriva, que es del
+// cristal y no del arranque.
+//
+// handleFrame() se llama desde el callback de ESP-NOW; now() desde la
+// tarea de lectura.
+class EdgeClock {
+public:
+    static constexpr unsigned long MIN_BASELINE_MS = 60000;
+    static constexpr unsigned long MAX_BASELINE_MS = 600000;
+    static constexpr long MAX_ERROR_MS = 1000;
+    static constexpr long MAX_DRIFT_PPM = 1000;   // más es una medida errónea
+
+    // Devuelve true si la trama era una sincronización. No se filtra por
+    // MAC: por relevo llega con la del relevo, no la del Edge
+    bool handleFrame(const uint8_t*, const uint8_t* data, int len) {
+        EdgeTimeSync sync;
+        if (!decodeTimeSync(data, len, sync)) return false;
+        unsigned long local = millis();
+        portENTER_CRITICAL(&_mux);
+        apply(local, sync.edgeMs);
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    // millis() del Edge en este momento; 0 si aún no hay sincronización
+    uint32_t now() {
+        unsigned long local = millis();
+        portENTER_CRITICAL(&_mux);
+        uint32_t t = _synced ? predict(local) : 0;
+        portEXIT_CRITICAL(&_mux);
+        return t ? t : (_synced ? 1 : 0);
+    }
+
+    bool isSynced() const { return _synced; }
+    long getDriftPpm() const { return _driftPpm; }
+    long getLastErrorMs() const { return _lastErrorMs; }   // previsto - recibido en la última
+    unsigned long getSyncs() const { return _syncs; }
+    unsigned long getResyncs() const { return _resyncs; }
+
+private:
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    bool _synced = false;
+    bool _hasDrift = false;
+    uint32_t _refLocal = 0;
+    uint32_t _refEdge = 0;
+    uint32_t _baseLocal = 0;
+    uint32_t _baseEdge = 0;
+    long _driftPpm = 0;
+    long _lastErrorMs = 0;
+    unsigned long _syncs = 0;
+    unsigned long _resyncs = 0;
+
+    uint32_t predict(uint32_t local) const {
+        int32_t dt = (int32_t)(local - _refLocal);
+        return _refEdge + dt + (int32_t)((int64_t)dt * _driftPpm / 1000000);
+    }
+
+    void apply(uint32_t local, uint32_t edge) {
+        _syncs++;
+        if (_synced) {
+            _lastErrorMs = (int32_t)(predict(local) - edge);
+            if (_lastErrorMs > MAX_ERROR_MS || _lastErrorMs < -MAX_ERROR_MS) {
+                _synced = false;
+                _resyncs++;
+            }
+        }
+        if (!_synced) {
+            _refLocal = _baseLocal = local;
+            _refEdge = _baseEdge = edge;
+            _synced = true;
+            return;
+        }
+
+        uint32_t baseline = local - _baseLocal;
+        if (baseline >= MIN_BASELINE_MS) {
+            int64_t excess = (int64_t)(int32_t)(edge - _baseEdge) - (int64_t)baseline;
+            long ppm = (long)(excess * 1000000 / (int64_t)baseline);
+            if (ppm <= MAX_DRIFT_PPM && ppm >= -MAX_DRIFT_PPM) {
+                _driftPpm = _hasDrift ? _driftPpm + (ppm - _driftPpm) / 4 : ppm;
+                _hasDrift = true;
+            }
+            if (baseline >= MAX_BASELINE_MS) {
+                _baseLocal = local;
+                _baseEdge = edge;
+            }
+        }
+        _refLocal = local;
+        _refEdge = edge;
+    }
+};
+
+#endif
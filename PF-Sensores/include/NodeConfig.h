@@ -0,0 +1,127 @@
+#ifndef NODE_CONFIG_H
+#define NODE_CONFIG_H
+
+#include <Arduino.h>
+#include "ConfigBlob.h"
+#include "SensorSettings.h"
+
+// Configuración persistente del nodo sensor (NVS). Solo se añaden campos
+// al final; al cambiar el esquema se sube VERSION (ver ConfigBlob).
+struct NodeConfigData {
+    // v1
+    uint8_t edgeMac[6];
+    uint8_t channel;
+    int16_t yl69Dry;     // desde v2 en settings (se migran al cargar)
+    int16_t yl69Wet;
+    // v2
+    int32_t settings[SENSOR_SETTING_COUNT];   // calibración, periodo y envío (SensorSettings.h)
+    // v3
+    uint8_t relay;       // reenvía las tramas de otros nodos hacia el Edge (RelayRouter)
+};
+
+// Se edita por la consola serie (115200):
+//   mostrar | canal <1-14> | edge AA:BB:CC:DD:EE:FF | relevo <0|1> | <parámetro> <valor> | guardar
+// o desde el Edge por ESP-NOW (/nodo, ver RemoteConfig). Los parámetros se
+// aplican en la siguiente lectura; canal, MAC del Edge y relevo al reiniciar
+// (normalmente los aprende solo, de la baliza del Edge).
+class NodeConfig {
+public:
+    static constexpr uint16_t VERSION = 3;
+
+    NodeConfig() : _blob("nodo", VERSION) {}
+
+    void begin(const NodeConfigData& defaults) {
+        memcpy(&_data, &defaults, sizeof(_data));
+        uint16_t version = _blob.load(_data);
+        if (version == 1) {   // la calibración del YL69 pasa a settings
+            _data.settings[SETTING_YL69_DRY] = _data.yl69Dry;
+            _data.settings[SETTING_YL69_WET] = _data.yl69Wet;
+        }
+        if (version > 0) Serial.println("💾 Configuración cargada de NVS (v" + String(version) + ")");
+    }
+
+    NodeConfigData& get() { return _data; }
+
+    bool save() {
+        portENTER_CRITICAL(&_mux);
+        NodeConfigData copy = _data;
+        portEXIT_CRITICAL(&_mux);
+        return _blob.save(copy);
+    }
+
+    // Cambia un parámetro si es válido (ver applySensorSetting)
+    bool setSetting(uint8_t id, int32_t value) {
+        portENTER_CRITICAL(&_mux);
+        bool ok = applySensorSetting(_data.settings, id, value);
+        portEXIT_CRITICAL(&_mux);
+        return ok;
+    }
+
+    // Copia coherente para la tarea de lectura
+    void copySettings(int32_t* out) {
+        portENTER_CRITICAL(&_mux);
+        memcpy(out, _data.settings, sizeof(_data.settings));
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    // Devuelve la respuesta para la consola
+    String handleCommand(String line) {
+        line.trim();
+        int space = line.indexOf(' ');
+        String name = space > 0 ? line.substring(0, space) : line;
+        String value = space > 0 ? line.substring(space + 1) : String();
+        value.trim();
+
+        if (name == "mostrar") return format();
+        if (name == "guardar") return save() ? "💾 Guardado." : "⚠️ No se pudo escribir en NVS.";
+        if (name == "canal" && value.toInt() >= 1 && value.toInt() <= 14) {
+            _data.channel = (uint8_t)value.toInt();
+            return "✅ Canal " + value + " (al reiniciar; usa guardar).";
+        }
+        if (name == "relevo" && (value == "0" || value == "1")) {
+            _data.relay = value == "1";
+            return String(_data.relay ? "🔁 Relevo activado" : "Relevo desactivado") + " (al reiniciar; usa guardar).";
+        }
+        if (name == "edge" && parseMac(value, _data.edgeMac)) return "✅ Edge " + value + " (al reiniciar; usa guardar).";
+        int id = sensorSettingIndex(name.c_str());
+        if (id >= 0 && !value.isEmpty()) {
+            int32_t raw = (int32_t)lroundf(value.toFloat() * SENSOR_SETTING_TABLE[id].scale);
+            if (setSetting((uint8_t)id, raw)) return "✅ " + name + " = " + value + " (usa guardar).";
+            return "⚠️ Valor fuera de rango para " + name + ".";
+        }
+        String usage = "⚠️ Comandos: mostrar | canal <1-14> | edge AA:BB:CC:DD:EE:FF | relevo <0|1> | guardar | <parámetro> <valor>\nParámetros:";
+        for (uint8_t i = 0; i < SENSOR_SETTING_COUNT; i++) usage += " " + String(SENSOR_SETTING_TABLE[i].key);
+        return usage;
+    }
+
+    String format() const {
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", _data.edgeMac[0], _data.edgeMac[1],
+                 _data.edgeMac[2], _data.edgeMac[3], _data.edgeMac[4], _data.edgeMac[5]);
+        String s = "edge=" + String(mac) + "\ncanal=" + String(_data.channel) + "\nrelevo=" + String(_data.relay);
+        for (uint8_t i = 0; i < SENSOR_SETTING_COUNT; i++) {
+            const SensorSetting& setting = SENSOR_SETTING_TABLE[i];
+            s += "\n" + String(setting.key) + "=";
+            s += setting.scale == 1 ? String(_data.settings[i])
+                                    : String((float)_data.settings[i] / setting.scale, (unsigned int)scaleDecimals(setting.scale));
+        }
+        return s;
+    }
+
+private:
+    ConfigBlob<NodeConfigData> _blob;
+    NodeConfigData _data;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;   // settings: loop() escribe, la tarea de lectura copia
+
+    static bool parseMac(const String& text, uint8_t out[6]) {
+        unsigned int b[6];
+        if (sscanf(text.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) return false;
+        for (int i = 0; i < 6; i++) {
+            if (b[i] > 0xFF) return false;
+        }
+        for (int i = 0; i < 6; i++) out[i] = (uint8_t)b[i];
+        return true;
+    }
+};
+
+#endif
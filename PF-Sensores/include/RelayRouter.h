@@ -0,0 +1,338 @@
+#ifndef RELAY_ROUTER_H
+#define RELAY_ROUTER_H
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include "SensorRelay.h"
+#include "PairingClient.h"
+#include "EdgeClock.h"
+#include "LinkRssi.h"
+
+// Camino del nodo hacia el Edge (SensorRelay.h). Candidatos a padre: el
+// Edge (por su baliza) y los relevos que se anuncian con RelayBeacon. Se
+// elige, entre los oídos en PARENT_LOST_MS y con RSSI >= MIN_RSSI (si no
+// hay ninguno así, entre todos), el de menos saltos y, a igualdad, mejor
+// RSSI; un padre de la misma distancia solo se cambia por otro
+// SWITCH_MARGIN_DB mejor, para no oscilar. Sin candidatos se sigue con el
+// último (de fábrica, el Edge guardado en NVS).
+//
+// En modo relevo (consola: relevo 1) el nodo además reenvía a su padre las
+// tramas de sus hijos, y hacia abajo los sobres del Edge en los que es el
+// siguiente de la ruta, y se anuncia cada RELAY_BEACON_PERIOD_MS, junto
+// con su hora del Edge para que los hijos también sellen las muestras; a
+// una PairingRequest responde con la baliza en el siguiente update(). Cada
+// nodo atiende solo las sincronizaciones de su padre.
+//
+// open() y handleFrame() se llaman desde el callback de ESP-NOW y solo
+// encolan; update(), desde loop(), elige padre, reenvía y anuncia.
+class RelayRouter {
+public:
+    static constexpr int8_t MIN_RSSI = -85;
+    static constexpr int8_t SWITCH_MARGIN_DB = 6;
+    static constexpr unsigned long PARENT_LOST_MS = 3 * BEACON_PERIOD_MS;   // tres balizas lentas del Edge
+    static constexpr uint8_t MAX_CANDIDATES = 6;
+    static constexpr uint8_t QUEUE_LEN = 8;
+
+    // Tras iniciar ESP-NOW; edgeMac: padre inicial
+    void begin(const uint8_t edgeMac[6], bool relay) {
+        esp_wifi_get_mac(WIFI_IF_STA, _ownMac);
+        memcpy(_parent, edgeMac, 6);
+        _relay = relay;
+        if (relay && !esp_now_is_peer_exist(BEACON_BROADCAST_MAC)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, BEACON_BROADCAST_MAC, 6);
+            peerInfo.channel = 0;   // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            esp_now_add_peer(&peerInfo);
+        }
+        if (relay) Serial.println("🔁 Modo relevo activo");
+    }
+
+    // Sobre de bajada cuyo destino es este nodo: data y len pasan a la
+    // trama del Edge que lleva dentro. Antes que handleFrame().
+    bool open(const uint8_t*& data, int& len) {
+        RelayDownHeader down;
+        const uint8_t* payload;
+        int payloadLen;
+        if (!decodeRelayDown(data, len, down, payload, payloadLen)) return false;
+        if (down.next + 1 != down.count || memcmp(down.route[down.next], _ownMac, 6) != 0) return false;
+        data = payload;
+        len = payloadLen;
+        return true;
+    }
+
+    // Anota las balizas (sin consumirlas: también son del emparejamiento) y
+    // encola las tramas de otros nodos. true si no debe procesarla nadie más.
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        EdgeBeacon beacon;
+        RelayBeacon relayBeacon;
+        PairingRequest request;
+        RelayHeader header;
+        RelayDownHeader down;
+        const uint8_t* payload;
+        int payloadLen;
+        if (decodeBeacon(data, len, beacon)) {
+            note(mac, 0, nullptr);
+            return false;
+        }
+        if (decodeRelayBeacon(data, len, relayBeacon)) {
+            note(mac, relayBeacon.hops, relayBeacon.parent);
+            return false;
+        }
+        if (decodePairingRequest(data, len, request)) {
+            _beaconDue = _relay;
+            return true;
+        }
+        if (len > 0 && data[0] == PAIRING_FRAME_TIME) {
+            portENTER_CRITICAL(&_mux);
+            bool fromParent = memcmp(mac, _parent, 6) == 0;
+            portEXIT_CRITICAL(&_mux);
+            return !fromParent;   // la de otro relevo o del Edge lejano se ignora
+        }
+        if (decodeRelayDown(data, len, down, payload, payloadLen)) {
+            if (memcmp(down.route[down.next], _ownMac, 6) != 0) return true;   // no pasa por aquí
+        } else if (!decodeRelayFrame(data, len, header, payload, payloadLen)) {
+            return false;
+        }
+        portENTER_CRITICAL(&_mux);
+        if (_relay && _queued < QUEUE_LEN) {
+            Frame& f = _queue[(_head + _queued++) % QUEUE_LEN];
+            memcpy(f.data, data, len);
+            f.len = len;
+        } else {
+            _dropped++;
+        }
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    // Trama propia en sobre de relevo (hops 0); devuelve la longitud en `out`
+    int wrap(const uint8_t* payload, int len, uint32_t sentMs, uint8_t* out) {
+        RelayHeader header;
+        memcpy(header.origin, _ownMac, 6);
+        portENTER_CRITICAL(&_mux);
+        header.seq = _seq++;
+        memcpy(header.parent, _parent, 6);
+        portEXIT_CRITICAL(&_mux);
+        header.sentMs = sentMs;
+        return encodeRelayFrame(header, payload, len, out);
+    }
+
+    // Desde loop(); true si cambió el padre (hay que rehacer el peer del emisor)
+    bool update(LinkRssi& rssi, PairingClient& pairing, EdgeClock& clock) {
+        unsigned long now = millis();
+        bool changed = choose(rssi, pairing, now);
+        forward(now);
+
+        if (_relay && pairing.isPaired() && hasParent(now)) {
+            if (_beaconDue || now - _lastBeaconMs >= RELAY_BEACON_PERIOD_MS) {
+                _beaconDue = false;
+                _lastBeaconMs = now;
+                RelayBeacon beacon;
+                beacon.channel = pairing.getChannel();
+                beacon.hops = _hops + 1;
+                memcpy(beacon.edgeMac, pairing.getEdgeMac(), 6);
+                memcpy(beacon.parent, _parent, 6);
+                if (beacon.hops < RELAY_MAX_HOPS) esp_now_send(BEACON_BROADCAST_MAC, (const uint8_t*)&beacon, sizeof(beacon));
+            }
+            if (clock.isSynced() && now - _lastSyncMs >= TIME_SYNC_PERIOD_MS) {
+                _lastSyncMs = now;
+                EdgeTimeSync sync;
+                sync.seq = _syncSeq++;
+                sync.edgeMs = clock.now();
+                esp_now_send(BEACON_BROADCAST_MAC, (const uint8_t*)&sync, sizeof(sync));
+            }
+        }
+        return changed;
+    }
+
+    const uint8_t* parent() const { return _parent; }
+    uint8_t hops() const { return _hops; }   // relevos hasta el Edge (0: directo)
+    bool isRelay() const { return _relay; }
+    unsigned long getForwarded() const { return _forwarded; }
+    unsigned long getDuplicates() const { return _duplicates; }
+    unsigned long getDropped() const { return _dropped; }
+
+private:
+    struct Candidate {
+        uint8_t mac[6];
+        uint8_t hops;           // del candidato al Edge (0: es el Edge)
+        bool childOfMine;       // su padre soy yo: elegirlo haría un bucle
+        unsigned long lastMs;
+    };
+
+    struct Frame {
+        uint8_t data[ESP_NOW_MAX_DATA_LEN];
+        int len;
+    };
+
+    uint8_t _ownMac[6] = {0};
+    bool _relay = false;
+    uint8_t _parent[6] = {0};
+    uint8_t _hops = 0;
+    uint16_t _seq = 0;
+    uint16_t _syncSeq = 0;
+    unsigned long _lastBeaconMs = 0;
+    volatile bool _beaconDue = false;   // una PairingRequest pide la baliza ya
+    unsigned long _lastSyncMs = 0;
+    RelayDuplicateFilter _duplicateFilter;
+    unsigned long _forwarded = 0;
+    unsigned long _duplicates = 0;
+    unsigned long _dropped = 0;
+
+    // Lo que escribe el callback de ESP-NOW
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    Candidate _candidates[MAX_CANDIDATES];
+    uint8_t _candidateCount = 0;
+    Frame _queue[QUEUE_LEN];
+    uint8_t _head = 0;
+    uint8_t _queued = 0;
+
+    void note(const uint8_t* mac, uint8_t hops, const uint8_t* parentOf) {
+        unsigned long now = millis();
+        portENTER_CRITICAL(&_mux);
+        Candidate* c = nullptr;
+        for (uint8_t i = 0; i < _candidateCount && !c; i++) {
+            if (memcmp(_candidates[i].mac, mac, 6) == 0) c = &_candidates[i];
+        }
+        if (!c) {
+            if (_candidateCount < MAX_CANDIDATES) {
+                c = &_candidates[_candidateCount++];
+            } else {
+                c = &_candidates[0];
+                for (uint8_t i = 1; i < _candidateCount; i++) {
+                    if (now - _candidates[i].lastMs > now - c->lastMs) c = &_candidates[i];
+                }
+            }
+            memcpy(c->mac, mac, 6);
+        }
+        c->hops = hops;
+        c->childOfMine = parentOf && memcmp(parentOf, _ownMac, 6) == 0;
+        c->lastMs = now;
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    bool hasParent(unsigned long now) {
+        portENTER_CRITICAL(&_mux);
+        bool fresh = false;
+        for (uint8_t i = 0; i < _candidateCount; i++) {
+            if (memcmp(_candidates[i].mac, _parent, 6) == 0) fresh = now - _candidates[i].lastMs < PARENT_LOST_MS;
+        }
+        portEXIT_CRITICAL(&_mux);
+        return fresh;
+    }
+
+    // ¿a (con RSSI ra) es mejor padre que b (rb)?
+    static bool better(const Candidate& a, int ra, const Candidate& b, int rb, int margin) {
+        bool weakA = ra < MIN_RSSI, weakB = rb < MIN_RSSI;
+        if (weakA != weakB) return weakB;
+        if (a.hops != b.hops) return a.hops < b.hops;
+        return ra >= rb + margin;
+    }
+
+    bool choose(LinkRssi& rssi, PairingClient& pairing, unsigned long now) {
+        Candidate candidates[MAX_CANDIDATES];
+        portENTER_CRITICAL(&_mux);
+        uint8_t count = _candidateCount;
+        memcpy(candidates, _candidates, sizeof(candidates));
+        portEXIT_CRITICAL(&_mux);
+
+        int best = -1, bestRssi = 0, current = -1, currentRssi = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            const Candidate& c = candidates[i];
+            if (now - c.lastMs >= PARENT_LOST_MS || c.childOfMine) continue;
+            if (c.hops == 0 && memcmp(c.mac, pairing.getEdgeMac(), 6) != 0) continue;   // otro Edge
+            int r = rssi.get(c.mac);
+            if (r == 0) r = MIN_RSSI;   // sin medida aún: apto, pero último
+            if (memcmp(c.mac, _parent, 6) == 0) {
+                current = i;
+                currentRssi = r;
+            }
+            if (best < 0 || better(c, r, candidates[best], bestRssi, 1)) {
+                best = i;
+                bestRssi = r;
+            }
+        }
+        if (best < 0 || best == current) {
+            if (current >= 0) _hops = candidates[current].hops;
+            return false;
+        }
+        if (current >= 0 && !better(candidates[best], bestRssi, candidates[current], currentRssi, SWITCH_MARGIN_DB)) {
+            _hops = candidates[current].hops;
+            return false;
+        }
+
+        portENTER_CRITICAL(&_mux);
+        memcpy(_parent, candidates[best].mac, 6);
+        portEXIT_CRITICAL(&_mux);
+        _hops = candidates[best].hops;
+        Serial.println(_hops == 0 ? String("📡 Envío directo al Edge (") + String(bestRssi) + " dBm)"
+                                  : "🔁 Envío por relevo a " + String(_hops) + " saltos (" + String(bestRssi) + " dBm)");
+        return true;
+    }
+
+    void forward(unsigned long now) {
+        bool parentOk = hasParent(now);
+        while (true) {
+            Frame f;
+            portENTER_CRITICAL(&_mux);
+            bool any = _queued > 0;
+            if (any) {
+                f = _queue[_head];
+                _head = (_head + 1) % QUEUE_LEN;
+                _queued--;
+            }
+            portEXIT_CRITICAL(&_mux);
+            if (!any) return;
+            if (f.data[0] == RELAY_FRAME_DOWN) {
+                forwardDown(f);
+                continue;
+            }
+
+            RelayHeader header;
+            const uint8_t* payload;
+            int payloadLen;
+            if (!decodeRelayFrame(f.data, f.len, header, payload, payloadLen)) continue;
+            if (memcmp(header.origin, _ownMac, 6) == 0 || _duplicateFilter.seen(header.origin, header.seq)) {
+                _duplicates++;   // propia que vuelve (bucle) o ya reenviada
+                continue;
+            }
+            if (!parentOk || header.hops + 1 > RELAY_MAX_HOPS) {
+                _dropped++;
+                continue;
+            }
+            header.hops++;
+            memcpy(f.data, &header, RELAY_HEADER_LEN);
+            if (esp_now_send(_parent, f.data, f.len) == ESP_OK) _forwarded++;
+            else _dropped++;
+        }
+    }
+
+    // Sobre del Edge: al siguiente de la ruta (un hijo)
+    void forwardDown(Frame& f) {
+        RelayDownHeader down;
+        const uint8_t* payload;
+        int payloadLen;
+        if (!decodeRelayDown(f.data, f.len, down, payload, payloadLen) || down.next + 1 >= down.count) {
+            _dropped++;
+            return;
+        }
+        down.next++;
+        memcpy(f.data, &down, RELAY_DOWN_HEADER_LEN);
+        const uint8_t* child = down.route[down.next];
+        if (!esp_now_is_peer_exist(child)) {
+            esp_now_peer_info_t peerInfo = {};
+            memcpy(peerInfo.peer_addr, child, 6);
+            peerInfo.channel = 0;   // canal actual
+            peerInfo.encrypt = false;
+            peerInfo.ifidx = WIFI_IF_STA;
+            esp_now_add_peer(&peerInfo);
+        }
+        if (esp_now_send(child, f.data, f.len) == ESP_OK) _forwarded++;
+        else _dropped++;
+    }
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef REMOTE_CONFIG_H
+#define REMOTE_CONFIG_H
+
+#include <Arduino.h>
+#include "NodeConfig.h"
+
+// Configuración desde el Edge (SensorSettings.h). handleFrame() se llama
+// desde el callback de ESP-NOW y solo guarda la petición; update(), desde
+// loop(), la aplica sobre NodeConfig, la guarda en NVS y prepara el ACK con
+// todos los valores actuales. Una retransmisión del Edge (ACK perdido)
+// vuelve a aplicar lo mismo: no cambia nada ni escribe en la flash.
+class RemoteConfig {
+public:
+    bool handleFrame(const uint8_t* mac, const uint8_t* data, int len) {
+        SensorConfigFrame request;
+        if (!decodeSensorConfig(data, len, SENSOR_CONFIG_SET, request)) return false;
+        portENTER_CRITICAL(&_mux);
+        _request = request;
+        memcpy(_from, mac, 6);
+        _pending = true;
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    // true si hay que enviar `ack` al Edge. Solo atiende al Edge emparejado.
+    bool update(NodeConfig& config, SensorConfigFrame& ack) {
+        portENTER_CRITICAL(&_mux);
+        bool pending = _pending;
+        SensorConfigFrame request = _request;
+        bool fromEdge = memcmp(_from, config.get().edgeMac, 6) == 0;
+        _pending = false;
+        portEXIT_CRITICAL(&_mux);
+        if (!pending || !fromEdge) return false;
+
+        uint8_t rejected = 0;
+        for (uint8_t k = 0; k < request.count; k++) {
+            if (!config.setSetting(request.items[k].id, request.items[k].value)) rejected++;
+        }
+        bool saved = request.count == 0 || config.save();
+        _requests++;
+        if (request.count > 0) {
+            Serial.println("⚙️ Configuración del Edge: " + String(request.count - rejected) + " aplicados, " +
+                           String(rejected) + " rechazados" + (saved ? "" : " (sin guardar en NVS)"));
+        }
+
+        int32_t settings[SENSOR_SETTING_COUNT];
+        config.copySettings(settings);
+        ack = SensorConfigFrame();
+        ack.type = SENSOR_CONFIG_ACK;
+        ack.seq = request.seq;
+        ack.flags = saved ? 0 : SENSOR_CONFIG_SAVE_FAILED;
+        for (uint8_t id = 0; id < SENSOR_SETTING_COUNT; id++) {
+            ack.items[ack.count].id = id;
+            ack.items[ack.count].value = settings[id];
+            ack.count++;
+        }
+        return true;
+    }
+
+    unsigned long getRequests() const { return _requests; }
+
+private:
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    SensorConfigFrame _request;
+    uint8_t _from[6] = {0};
+    bool _pending = false;
+    unsigned long _requests = 0;
+};
+
+#endif
@@ -3,30 +3,32 @@
 
 #include <Arduino.h>
 #include "DHT.h"
+#include "sensorData.h"
 
+// Lecturas en punto fijo: centésimas de °C y de % (el DHT11 da enteros).
+// Si el DHT no responde (NaN) se envía "sin lectura" en lugar de repetir
+// el último valor: el Edge la marca y no actúa con ella.
 class SensorDHT {
 private:
     DHT dht;
-    float lastTemperature;
-    float lastHumidity;
 
 public:
-    SensorDHT(uint8_t pin, uint8_t type) : dht(pin, type), lastTemperature(0.0f), lastHumidity(0.0f) {}
+    SensorDHT(uint8_t pin, uint8_t type) : dht(pin, type) {}
 
     void begin() {
         dht.begin();
     }
 
-    float readTemperature() {
+    int16_t readTemperature() {
         float temp = dht.readTemperature();
-        if (!isnan(temp)) lastTemperature = temp;
-        return lastTemperature;
+        if (isnan(temp)) return sensorNoReading<int16_t>();
+        return (int16_t)lroundf(temp * 100);
     }
 
-    float readHumidity() {
+    uint16_t readHumidity() {
         float hum = dht.readHumidity();
-        if (!isnan(hum)) lastHumidity = hum;
-        return lastHumidity;
+        if (isnan(hum)) return sensorNoReading<uint16_t>();
+        return (uint16_t)lroundf(constrain(hum, 0.0f, 100.0f) * 100);
     }
 };
 
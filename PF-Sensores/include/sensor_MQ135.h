@@ -6,6 +6,8 @@
 class SensorMQ135 {
 private:
     uint8_t _pin;
+    int32_t _gain = 1000;   // en milésimas
+    int32_t _offset = 0;
 
 public:
     SensorMQ135(uint8_t pin) : _pin(pin) {
@@ -16,9 +18,16 @@ public:
         Serial.println("🔧 MQ135 inicializado (modo simple)");
     }
 
-    float readCO2() {
-        int rawValue = analogRead(_pin);
-        return (float)rawValue;  // Se interpreta directamente como valor "ppm"
+    // Ajuste lineal de la lectura: ADC * ganancia / 1000 + offset
+    void setCalibration(int32_t gain, int32_t offset) {
+        _gain = gain;
+        _offset = offset;
+    }
+
+    uint16_t readCO2() {
+        // Se interpreta directamente como valor "ppm" (por defecto, sin ajuste)
+        int32_t v = (int32_t)analogRead(_pin) * _gain / 1000 + _offset;
+        return (uint16_t)constrain(v, 0, 65534);  // 65535 es "sin lectura"
     }
 };
 
@@ -10,18 +10,35 @@ private:
     float _R2; // Resistencia inferior (ohmios)
     float _vRef; // Voltaje de referencia ADC (e.g. 3.3V)
     int _adcMax; // Valor máximo ADC (e.g. 4095 para 12 bits)
+    float _gain = 1.02266f; // Corrección de la referencia del ADC (medida)
+    uint32_t _mvPerCount; // mV por cuenta del ADC, en 1/1024 (se calcula al calibrar)
+
+    void updateScale() {
+        _mvPerCount = (uint32_t)lroundf(_vRef * 1000.0f * (_R1 + _R2) / _R2 * _gain / _adcMax * 1024.0f);
+    }
 
 public:
     VoltageSensor(int adcPin, float R1 = 30000.0f, float R2 = 7500.0f, float vRef = 3.3f, int adcMax = 4095)
     : _adcPin(adcPin), _R1(R1), _R2(R2), _vRef(vRef), _adcMax(adcMax) {
         pinMode(_adcPin, INPUT);
+        updateScale();
+    }
+
+    // Divisor y corrección guardados en NVS (o enviados por el Edge)
+    bool setCalibration(float R1, float R2, float gain) {
+        if (R1 <= 0 || R2 <= 0 || gain <= 0) return false;
+        _R1 = R1;
+        _R2 = R2;
+        _gain = gain;
+        updateScale();
+        return true;
     }
 
-    float readVoltage() {
-        int adcValue = analogRead(_adcPin);
-        float vOut = (adcValue / (float)_adcMax) * _vRef;
-        float vIn = (vOut * (_R1 + _R2) / _R2)*1.02266;
-        return vIn;
+    // Tensión de entrada en mV (solo aritmética entera por lectura)
+    uint16_t readVoltage() {
+        uint32_t adcValue = (uint32_t)analogRead(_adcPin);
+        uint32_t mv = (adcValue * _mvPerCount + 512) >> 10;
+        return mv > 65535 ? 65535 : (uint16_t)mv;
     }
 };
 
@@ -16,14 +16,23 @@ public:
         pinMode(pin, INPUT);
     }
 
-    float readPercentage() {
+    // Calibración guardada en NVS; se ignora si no deja un rango válido
+    bool setCalibration(int seco, int humedo) {
+        if (seco <= humedo) return false;
+        valorSeco = seco;
+        valorHumedo = humedo;
+        return true;
+    }
+
+    // Humedad en centésimas de %: 0 seco, 10000 húmedo
+    uint16_t readPercentage() {
         int lectura = analogRead(pin);
         // Limitar lectura al rango esperado
         lectura = constrain(lectura, valorHumedo, valorSeco);
         
-        // Convertir a porcentaje: 0% seco, 100% húmedo
-        float porcentaje = (float)(valorSeco - lectura) * 100.0 / (valorSeco - valorHumedo);
-        return porcentaje;
+        // Convertir a porcentaje: 0% seco, 100% húmedo (redondeado)
+        uint32_t rango = valorSeco - valorHumedo;
+        return (uint16_t)(((uint32_t)(valorSeco - lectura) * 10000 + rango / 2) / rango);
     }
 };
 
@@ -6,6 +6,17 @@
 #include "sensor_Voltage.h"
 #include "sensorData.h"
 #include "ESPNowSender.h"
+#include "NodeConfig.h"
+#include "PairingClient.h"
+#include "EdgeClock.h"
+#include "RemoteConfig.h"
+#include "OtaUpdater.h"
+#include "LinkRssi.h"
+#include "RelayRouter.h"
+#include "LinkPowerClient.h"
+
+// Versión de este firmware (la que se da a /ota en el Edge)
+#define FIRMWARE_VERSION "1.0"
 
 // Pines
 #define DHT_PIN 4
@@ -15,7 +26,8 @@
 #define YL69_PIN 32
 #define VOLTAGE_PIN 33
 
-// Dirección MAC del receptor 
+// Dirección MAC del receptor y canal (valores de fábrica; si hay
+// configuración en NVS, manda esa)
 uint8_t receiverMac[] = {0xE8, 0x6B, 0xEA, 0xDF, 0x21, 0x0C};
 #define CHANNEL 2
 
@@ -26,12 +38,50 @@ SensorMQ135 mq135Sensor(MQ135_PIN);
 SensorYL69 yl69Sensor(YL69_PIN);
 VoltageSensor voltageSensor(VOLTAGE_PIN);
 ESPNowSender espNowSender(receiverMac, CHANNEL);
+NodeConfig config;
+PairingClient pairing;  // sigue al Edge si cambia de canal
+EdgeClock edgeClock;    // reloj del Edge para sellar la salida de las tramas
+RemoteConfig remoteConfig;  // calibración, periodo y envío desde el Edge (/nodo)
+OtaUpdater ota(OTA_KIND_SENSOR, FIRMWARE_VERSION);  // firmware nuevo desde el Edge (/ota)
+LinkRssi linkRssi;      // RSSI de los vecinos, para elegir padre
+RelayRouter router;     // directo al Edge o por otro nodo (relevo)
+LinkPowerClient txPower;  // potencia según el enlace medido por el Edge
+
+// Las clases de sensores dan ya el punto fijo del registro de canales
+static_assert(SENSOR_CHANNEL_TABLE[SENSOR_TEMPERATURE].scale == 100 && SENSOR_CHANNEL_TABLE[SENSOR_HUMIDITY].scale == 100 &&
+              SENSOR_CHANNEL_TABLE[SENSOR_LIGHT].scale == 1 && SENSOR_CHANNEL_TABLE[SENSOR_CO2].scale == 1 &&
+              SENSOR_CHANNEL_TABLE[SENSOR_SOIL].scale == 100 && SENSOR_CHANNEL_TABLE[SENSOR_VOLTAGE].scale == 1000,
+              "escala del registro distinta de la que dan los sensores");
+
+// Calibración de los sensores a partir de los parámetros (SensorSettings.h)
+void applyCalibration(const int32_t* settings) {
+  yl69Sensor.setCalibration(settings[SETTING_YL69_DRY], settings[SETTING_YL69_WET]);
+  voltageSensor.setCalibration((float)settings[SETTING_VOLT_R1], (float)settings[SETTING_VOLT_R2],
+                               settings[SETTING_VOLT_GAIN] / (float)SENSOR_SETTING_TABLE[SETTING_VOLT_GAIN].scale);
+  mq135Sensor.setCalibration(settings[SETTING_CO2_GAIN], settings[SETTING_CO2_OFFSET]);
+}
 
 // Tarea única: Leer sensores y enviar
 void taskReadAndSend(void *parameter) {
+  int32_t applied[SENSOR_SETTING_COUNT] = {0};
+  SensorData lastSent;
+  unsigned long lastSentMs = 0;
+  bool sentAny = false;
+
   while (true) {
     SensorData data;
 
+    // Parámetros vigentes (la consola o el Edge pueden haberlos cambiado)
+    int32_t settings[SENSOR_SETTING_COUNT];
+    config.copySettings(settings);
+    if (memcmp(settings, applied, sizeof(settings)) != 0) {
+      applyCalibration(settings);
+      memcpy(applied, settings, sizeof(settings));
+    }
+
+    // Instante de adquisición: la trama lleva su edad al enviarla
+    unsigned long acquiredMs = millis();
+
     // Leer sensores
     data.temperature  = dhtSensor.readTemperature();
     data.humidity     = dhtSensor.readHumidity();
@@ -40,26 +90,91 @@ void taskReadAndSend(void *parameter) {
     data.soilMoisture = yl69Sensor.readPercentage();
     data.voltage      = voltageSensor.readVoltage();
 
-    // Enviar datos
-    espNowSender.sendData(data);
+    // Enviar datos (mientras se busca el canal del Edge no llegarían);
+    // con envio_max, solo si algún canal cambió lo bastante o venció el plazo
+    bool due = !sentAny || sensorReportDue(settings, lastSent, data, millis() - lastSentMs);
+    if (pairing.isPaired() && due) {
+      espNowSender.sendData(data, acquiredMs);
+      lastSent = data;
+      lastSentMs = millis();
+      sentAny = true;
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(3000)); // Ejecutar cada 3 segundos
+    vTaskDelay(pdMS_TO_TICKS(settings[SETTING_PERIOD])); // periodo (3 s de fábrica)
   }
 }
 
 void setup() {
   Serial.begin(115200);
   delay(2000);
+  ota.begin();  // vuelve a la versión anterior si la nueva no se confirma
+
+  NodeConfigData defaults = {};
+  memcpy(defaults.edgeMac, receiverMac, 6);
+  defaults.channel = CHANNEL;
+  sensorSettingDefaults(defaults.settings);
+  config.begin(defaults);
+  espNowSender.configure(config.get().edgeMac, config.get().channel);
+
   dhtSensor.begin();
   ldrSensor.begin();
   mq135Sensor.begin();
   yl69Sensor.begin();
   espNowSender.begin();
 
+  // Camino hacia el Edge: todo lo propio sale en el sobre de relevo
+  linkRssi.begin();
+  router.begin(config.get().edgeMac, config.get().relay);
+  espNowSender.setEnvelope([](const uint8_t* data, int len, uint8_t* out) {
+    return router.wrap(data, len, edgeClock.now(), out);
+  });
+
+  // Emparejamiento por baliza: el Edge (o un relevo) anuncia su canal y su MAC
+  pairing.begin(config.get().channel, config.get().edgeMac);
+  espNowSender.onReceive([](const uint8_t* mac, const uint8_t* data, int len) {
+    // Lo que el Edge envía por relevos se atiende como si llegara directo
+    if (router.open(data, len)) mac = config.get().edgeMac;
+    if (router.handleFrame(mac, data, len) || pairing.handleFrame(mac, data, len)) return;
+    if (edgeClock.handleFrame(mac, data, len) || ota.handleFrame(mac, data, len)) return;
+    if (txPower.handleFrame(mac, data, len)) return;
+    remoteConfig.handleFrame(mac, data, len);
+  });
+  espNowSender.onSendStatus([](bool ok) { pairing.onSendResult(ok); });
+  ota.setSender([](const uint8_t* data, int len) { return espNowSender.sendFrame(data, len); });
+  pairing.onPaired([](const uint8_t* mac, uint8_t channel) {
+    memcpy(config.get().edgeMac, mac, 6);
+    config.get().channel = channel;
+    config.save();  // solo escribe si cambió
+  });
+
   // Crear una sola tarea
   xTaskCreatePinnedToCore(taskReadAndSend, "LeerYEnviar", 4096, NULL, 1, NULL, 1);
 }
 
 void loop() {
-  // Nada que hacer aquí
+  pairing.update();
+
+  // Padre hacia el Edge (el de menos saltos con buena señal) y reenvíos
+  if (router.update(linkRssi, pairing, edgeClock)) espNowSender.setPeer(router.parent());
+
+  // Consola de configuración (ver NodeConfig)
+  if (Serial.available()) {
+    String line = Serial.readStringUntil('\n');
+    Serial.println(config.handleCommand(line));
+  }
+
+  // Configuración enviada por el Edge: se aplica, se guarda y se confirma
+  SensorConfigFrame ack;
+  if (remoteConfig.update(config, ack)) espNowSender.sendFrame((const uint8_t*)&ack, ack.frameLength());
+
+  // Potencia de emisión: baja si sobra margen, sube si hay pérdidas; un
+  // relevo se queda al máximo (el Edge no mide a sus hijos)
+  LinkStatus linkStatus;
+  if (txPower.update(config.get().edgeMac, !router.isRelay(), linkStatus)) {
+    espNowSender.sendFrame((const uint8_t*)&linkStatus, sizeof(linkStatus));
+  }
+
+  // Actualización de firmware: la confirma en cuanto vuelve a oír al Edge
+  ota.update(pairing.isPaired(), config.get().edgeMac);
+  delay(ota.busy() ? 2 : 100);  // durante la transferencia, al ritmo del Edge
 }
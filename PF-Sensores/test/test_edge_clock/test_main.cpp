@@ -0,0 +1,91 @@
+// Reloj del Edge visto desde el nodo (EdgeClock.h): referencia, deriva y
+// vuelta a empezar si el Edge se reinicia. El reloj del host se adelanta
+// con HostClock::advance() en lugar de esperar.
+//   pio test -e native -f test_edge_clock
+#include <unity.h>
+#include "EdgeClock.h"
+
+static const uint8_t EDGE[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xEE};
+
+static EdgeClock* edgeClock = nullptr;
+static uint16_t seq = 0;
+
+static bool sync(uint32_t edgeMs) {
+    EdgeTimeSync frame;
+    frame.seq = seq++;
+    frame.edgeMs = edgeMs;
+    return edgeClock->handleFrame(EDGE, (const uint8_t*)&frame, sizeof(frame));
+}
+
+void setUp() { edgeClock = new EdgeClock(); }
+
+void tearDown() {
+    delete edgeClock;
+    edgeClock = nullptr;
+}
+
+void test_unsynced_reads_zero() {
+    TEST_ASSERT_FALSE(edgeClock->isSynced());
+    TEST_ASSERT_EQUAL_UINT32(0, edgeClock->now());
+    EdgeBeacon beacon;
+    beacon.channel = 1;
+    TEST_ASSERT_FALSE(edgeClock->handleFrame(EDGE, (const uint8_t*)&beacon, sizeof(beacon)));
+}
+
+void test_follows_edge_after_first_sync() {
+    TEST_ASSERT_TRUE(sync(1000000));
+    TEST_ASSERT_TRUE(edgeClock->isSynced());
+    TEST_ASSERT_INT_WITHIN(20, 1000000, edgeClock->now());
+    HostClock::advance(30000);
+    TEST_ASSERT_INT_WITHIN(20, 1030000, edgeClock->now());
+}
+
+void test_estimates_drift() {
+    // El Edge va 500 ppm más rápido que el nodo
+    sync(1000000);
+    HostClock::advance(120000);
+    sync(1000000 + 120000 + 60);
+    TEST_ASSERT_INT_WITHIN(50, 500, edgeClock->getDriftPpm());
+    TEST_ASSERT_INT_WITHIN(20, -60, edgeClock->getLastErrorMs());
+    // Entre sincronizaciones se extrapola con la deriva
+    HostClock::advance(200000);
+    TEST_ASSERT_INT_WITHIN(30, 1000000 + 320060 + 100, edgeClock->now());
+}
+
+void test_short_baseline_keeps_drift() {
+    sync(1000000);
+    HostClock::advance(EdgeClock::MIN_BASELINE_MS / 2);
+    sync(1000000 + EdgeClock::MIN_BASELINE_MS / 2 + 100);
+    TEST_ASSERT_EQUAL_INT(0, edgeClock->getDriftPpm());
+}
+
+void test_implausible_drift_is_ignored() {
+    sync(1000000);
+    HostClock::advance(120000);
+    sync(1000000 + 120000 + 600);   // 5000 ppm: medida errónea
+    TEST_ASSERT_EQUAL_INT(0, edgeClock->getDriftPpm());
+    TEST_ASSERT_EQUAL_UINT32(0, edgeClock->getResyncs());
+}
+
+void test_edge_reboot_restarts_but_keeps_drift() {
+    sync(1000000);
+    HostClock::advance(120000);
+    sync(1000000 + 120000 + 60);
+    long drift = edgeClock->getDriftPpm();
+    HostClock::advance(5000);
+    sync(5000);   // el Edge se reinició
+    TEST_ASSERT_EQUAL_UINT32(1, edgeClock->getResyncs());
+    TEST_ASSERT_EQUAL_INT(drift, edgeClock->getDriftPpm());
+    TEST_ASSERT_INT_WITHIN(20, 5000, edgeClock->now());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unsynced_reads_zero);
+    RUN_TEST(test_follows_edge_after_first_sync);
+    RUN_TEST(test_estimates_drift);
+    RUN_TEST(test_short_baseline_keeps_drift);
+    RUN_TEST(test_implausible_drift_is_ignored);
+    RUN_TEST(test_edge_reboot_restarts_but_keeps_drift);
+    return UNITY_END();
+}
@@ -0,0 +1,292 @@
+// Camino del nodo hacia el Edge (RelayRouter.h): elección de padre,
+// reenvío hacia arriba con filtro de duplicados y sobres de bajada. Las
+// tramas salen por el aire simulado del host (HostRadio) y se recogen en
+// los dispositivos conectados.
+//   pio test -e native -f test_relay_router
+#include <unity.h>
+#include <vector>
+#include "RelayRouter.h"
+
+static const uint8_t EDGE[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xEE};
+static const uint8_t OTHER_EDGE[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0xEF};
+static const uint8_t RELAY[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+static const uint8_t CHILD[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02};
+static uint8_t self[6];
+
+struct Sent {
+    HostRadio::Mac to;
+    std::vector<uint8_t> data;
+};
+
+static std::mutex sentMutex;
+static std::vector<Sent> sent;
+static RelayRouter* router = nullptr;
+static PairingClient pairing;
+static LinkRssi rssi;
+static EdgeClock edgeClock;
+
+static void listen(const uint8_t* mac) {
+    HostRadio::Mac to = HostRadio::toMac(mac);
+    HostRadio::attach(mac, [to](const uint8_t*, const uint8_t* data, int len) {
+        std::lock_guard<std::mutex> lock(sentMutex);
+        sent.push_back(Sent{to, std::vector<uint8_t>(data, data + len)});
+    });
+}
+
+// Las entregas van por el hilo del aire: espera a que lleguen `count`
+// tramas de tipo `type` (o un tiempo máximo)
+static std::vector<Sent> waitFor(uint8_t type, size_t count) {
+    std::vector<Sent> out;
+    for (int i = 0; i < 100 && out.size() < count; i++) {
+        delay(5);
+        std::lock_guard<std::mutex> lock(sentMutex);
+        out.clear();
+        for (const Sent& s : sent) {
+            if (!s.data.empty() && s.data[0] == type) out.push_back(s);
+        }
+    }
+    return out;
+}
+
+static bool receive(const uint8_t* mac, const void* frame, int len) {
+    return router->handleFrame(mac, (const uint8_t*)frame, len);
+}
+
+static void edgeBeacon(const uint8_t* mac = EDGE) {
+    EdgeBeacon beacon;
+    beacon.channel = 1;
+    receive(mac, &beacon, sizeof(beacon));
+}
+
+static void relayBeacon(const uint8_t* mac, uint8_t hops, const uint8_t* parent) {
+    RelayBeacon beacon;
+    beacon.channel = 1;
+    beacon.hops = hops;
+    memcpy(beacon.edgeMac, EDGE, 6);
+    memcpy(beacon.parent, parent, 6);
+    receive(mac, &beacon, sizeof(beacon));
+}
+
+static int childFrame(uint16_t seq, uint8_t* out) {
+    RelayHeader header;
+    memcpy(header.origin, CHILD, 6);
+    memcpy(header.parent, self, 6);
+    header.seq = seq;
+    const uint8_t payload[] = {1, 2, 3, 4};
+    return encodeRelayFrame(header, payload, sizeof(payload), out);
+}
+
+void setUp() {
+    esp_wifi_get_mac(WIFI_IF_STA, self);
+    static bool attached = false;
+    if (!attached) {
+        listen(EDGE);
+        listen(RELAY);
+        listen(CHILD);
+        attached = true;
+    }
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, EDGE, 6);
+    esp_now_add_peer(&peer);
+    memcpy(peer.peer_addr, RELAY, 6);
+    esp_now_add_peer(&peer);
+    pairing.begin(1, EDGE);
+    router = new RelayRouter();
+    router->begin(EDGE, true);
+}
+
+void tearDown() {
+    delay(20);   // lo que quede en el aire no pasa a la siguiente prueba
+    delete router;
+    router = nullptr;
+    std::lock_guard<std::mutex> lock(sentMutex);
+    sent.clear();
+}
+
+void test_prefers_fewer_hops() {
+    edgeBeacon();
+    relayBeacon(RELAY, 1, EDGE);
+    TEST_ASSERT_FALSE(router->update(rssi, pairing, edgeClock));
+    TEST_ASSERT_EQUAL_MEMORY(EDGE, router->parent(), 6);
+    TEST_ASSERT_EQUAL_UINT8(0, router->hops());
+}
+
+void test_switches_to_relay_when_edge_is_lost() {
+    edgeBeacon();
+    router->update(rssi, pairing, edgeClock);
+    HostClock::advance(RelayRouter::PARENT_LOST_MS);
+    relayBeacon(RELAY, 1, EDGE);
+    TEST_ASSERT_TRUE(router->update(rssi, pairing, edgeClock));
+    TEST_ASSERT_EQUAL_MEMORY(RELAY, router->parent(), 6);
+    TEST_ASSERT_EQUAL_UINT8(1, router->hops());
+}
+
+void test_never_picks_own_child_or_other_edge() {
+    HostClock::advance(RelayRouter::PARENT_LOST_MS);   // el Edge inicial, sin oír
+    relayBeacon(RELAY, 1, self);   // su padre soy yo: sería un bucle
+    edgeBeacon(OTHER_EDGE);
+    TEST_ASSERT_FALSE(router->update(rssi, pairing, edgeClock));
+    TEST_ASSERT_EQUAL_MEMORY(EDGE, router->parent(), 6);
+}
+
+void test_wrap_stamps_origin_parent_and_sequence() {
+    const uint8_t payload[] = {9, 8, 7};
+    uint8_t out[ESP_NOW_MAX_DATA_LEN];
+    RelayHeader header;
+    const uint8_t* inner;
+    int innerLen;
+    for (uint16_t seq = 0; seq < 2; seq++) {
+        int len = router->wrap(payload, sizeof(payload), 1234, out);
+        TEST_ASSERT_TRUE(decodeRelayFrame(out, len, header, inner, innerLen));
+        TEST_ASSERT_EQUAL_MEMORY(self, header.origin, 6);
+        TEST_ASSERT_EQUAL_MEMORY(EDGE, header.parent, 6);
+        TEST_ASSERT_EQUAL_UINT16(seq, header.seq);
+        TEST_ASSERT_EQUAL_UINT8(0, header.hops);
+        TEST_ASSERT_EQUAL_UINT32(1234, header.sentMs);
+        TEST_ASSERT_EQUAL_INT(sizeof(payload), innerLen);
+    }
+}
+
+void test_forwards_child_frames_once() {
+    edgeBeacon();
+    uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+    int len = childFrame(7, frame);
+    TEST_ASSERT_TRUE(receive(CHILD, frame, len));
+    TEST_ASSERT_TRUE(receive(CHILD, frame, len));   // repetida por otro relevo
+    router->update(rssi, pairing, edgeClock);
+
+    std::vector<Sent> up = waitFor(RELAY_FRAME_DATA, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, up.size());
+    TEST_ASSERT_TRUE(up[0].to == HostRadio::toMac(EDGE));
+    RelayHeader header;
+    const uint8_t* inner;
+    int innerLen;
+    TEST_ASSERT_TRUE(decodeRelayFrame(up[0].data.data(), (int)up[0].data.size(), header, inner, innerLen));
+    TEST_ASSERT_EQUAL_UINT8(1, header.hops);
+    TEST_ASSERT_EQUAL_MEMORY(CHILD, header.origin, 6);
+    TEST_ASSERT_EQUAL_UINT32(1, router->getForwarded());
+    TEST_ASSERT_EQUAL_UINT32(1, router->getDuplicates());
+}
+
+void test_own_frame_coming_back_is_dropped() {
+    edgeBeacon();
+    const uint8_t payload[] = {1};
+    uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+    int len = router->wrap(payload, sizeof(payload), 0, frame);
+    receive(RELAY, frame, len);
+    router->update(rssi, pairing, edgeClock);
+    TEST_ASSERT_EQUAL_UINT32(0, router->getForwarded());
+    TEST_ASSERT_EQUAL_UINT32(1, router->getDuplicates());
+}
+
+void test_not_relay_does_not_forward() {
+    delete router;
+    router = new RelayRouter();
+    router->begin(EDGE, false);
+    edgeBeacon();
+    uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+    int len = childFrame(1, frame);
+    TEST_ASSERT_TRUE(receive(CHILD, frame, len));
+    router->update(rssi, pairing, edgeClock);
+    TEST_ASSERT_EQUAL_UINT32(0, router->getForwarded());
+    TEST_ASSERT_EQUAL_UINT32(1, router->getDropped());
+}
+
+void test_down_envelope_goes_to_next_hop() {
+    const uint8_t route[2][6] = {{self[0], self[1], self[2], self[3], self[4], self[5]},
+                                 {CHILD[0], CHILD[1], CHILD[2], CHILD[3], CHILD[4], CHILD[5]}};
+    const uint8_t payload[] = {0x55, 0x66};
+    uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+    int len = encodeRelayDown(route, 2, payload, sizeof(payload), frame);
+
+    const uint8_t* data = frame;
+    int dataLen = len;
+    TEST_ASSERT_FALSE(router->open(data, dataLen));   // no soy el destino
+    TEST_ASSERT_TRUE(receive(EDGE, frame, len));
+    router->update(rssi, pairing, edgeClock);
+
+    std::vector<Sent> down = waitFor(RELAY_FRAME_DOWN, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, down.size());
+    TEST_ASSERT_TRUE(down[0].to == HostRadio::toMac(CHILD));
+    RelayDownHeader header;
+    const uint8_t* inner;
+    int innerLen;
+    TEST_ASSERT_TRUE(decodeRelayDown(down[0].data.data(), (int)down[0].data.size(), header, inner, innerLen));
+    TEST_ASSERT_EQUAL_UINT8(1, header.next);
+    TEST_ASSERT_EQUAL_MEMORY(payload, inner, sizeof(payload));
+}
+
+void test_down_envelope_for_me_is_opened() {
+    const uint8_t route[2][6] = {{RELAY[0], RELAY[1], RELAY[2], RELAY[3], RELAY[4], RELAY[5]},
+                                 {self[0], self[1], self[2], self[3], self[4], self[5]}};
+    const uint8_t payload[] = {0x55, 0x66, 0x77};
+    uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+    int len = encodeRelayDown(route, 2, payload, sizeof(payload), frame);
+    RelayDownHeader header;
+    memcpy(&header, frame, RELAY_DOWN_HEADER_LEN);
+    header.next = 1;   // ya pasó por RELAY
+    memcpy(frame, &header, RELAY_DOWN_HEADER_LEN);
+
+    const uint8_t* data = frame;
+    int dataLen = len;
+    TEST_ASSERT_TRUE(router->open(data, dataLen));
+    TEST_ASSERT_EQUAL_INT(sizeof(payload), dataLen);
+    TEST_ASSERT_EQUAL_MEMORY(payload, data, sizeof(payload));
+}
+
+void test_down_envelope_for_other_branch_is_consumed() {
+    const uint8_t route[2][6] = {{RELAY[0], RELAY[1], RELAY[2], RELAY[3], RELAY[4], RELAY[5]},
+                                 {CHILD[0], CHILD[1], CHILD[2], CHILD[3], CHILD[4], CHILD[5]}};
+    const uint8_t payload[] = {1};
+    uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+    int len = encodeRelayDown(route, 2, payload, sizeof(payload), frame);
+    TEST_ASSERT_TRUE(receive(EDGE, frame, len));
+    router->update(rssi, pairing, edgeClock);
+    TEST_ASSERT_EQUAL_UINT32(0, router->getForwarded());
+}
+
+void test_time_sync_only_from_parent() {
+    EdgeTimeSync sync;
+    TEST_ASSERT_FALSE(receive(EDGE, &sync, sizeof(sync)));   // pasa a EdgeClock
+    TEST_ASSERT_TRUE(receive(RELAY, &sync, sizeof(sync)));
+}
+
+void test_pairing_request_gets_relay_beacon() {
+    edgeBeacon();
+    router->update(rssi, pairing, edgeClock);   // primera baliza periódica
+    waitFor(PAIRING_FRAME_RELAY, 1);
+    {
+        std::lock_guard<std::mutex> lock(sentMutex);
+        sent.clear();
+    }
+    PairingRequest request;
+    TEST_ASSERT_TRUE(receive(CHILD, &request, sizeof(request)));
+    router->update(rssi, pairing, edgeClock);   // sin esperar RELAY_BEACON_PERIOD_MS
+    std::vector<Sent> beacons = waitFor(PAIRING_FRAME_RELAY, 1);
+    TEST_ASSERT_TRUE(beacons.size() >= 1);
+    RelayBeacon beacon;
+    TEST_ASSERT_TRUE(decodeRelayBeacon(beacons[0].data.data(), (int)beacons[0].data.size(), beacon));
+    TEST_ASSERT_EQUAL_UINT8(1, beacon.hops);
+    TEST_ASSERT_EQUAL_MEMORY(EDGE, beacon.edgeMac, 6);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_prefers_fewer_hops);
+    RUN_TEST(test_switches_to_relay_when_edge_is_lost);
+    RUN_TEST(test_never_picks_own_child_or_other_edge);
+    RUN_TEST(test_wrap_stamps_origin_parent_and_sequence);
+    RUN_TEST(test_forwards_child_frames_once);
+    RUN_TEST(test_own_frame_coming_back_is_dropped);
+    RUN_TEST(test_not_relay_does_not_forward);
+    RUN_TEST(test_down_envelope_goes_to_next_hop);
+    RUN_TEST(test_down_envelope_for_me_is_opened);
+    RUN_TEST(test_down_envelope_for_other_branch_is_consumed);
+    RUN_TEST(test_time_sync_only_from_parent);
+    RUN_TEST(test_pairing_request_gets_relay_beacon);
+    int failures = UNITY_END();
+    fflush(stdout);
+
+    // El hilo del aire no termina: salir sin destructores
+    std::_Exit(failures);
+}